@@ -0,0 +1,1413 @@
+/**
+ * @file bench.cpp
+ * @brief Micro-benchmarks for the runtime parts of this library.
+ *
+ * Each benchmark prints a small table on the standard output.
+ * Build in release mode to obtain meaningful numbers.
+ *
+ * @copyright MIT License
+ *
+ * This file is part of utf42.
+ * Copyright (c) 2025 Dante Doménech Martínez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <regex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "utf42.h"
+#include "utf42_transcode.h"
+
+#include "utf42_pipeline.h"
+#include "utf42_poly_string.h"
+#include "utf42_cache.h"
+#include "utf42_aho_corasick.h"
+#include "utf42_search.h"
+#include "utf42_regex.h"
+#include "utf42_valid.h"
+#include "utf42_hash.h"
+#include "utf42_string_switch.h"
+#include "utf42_info.h"
+#include "utf42_lazy.h"
+#include "utf42_catalog.h"
+#include "utf42_catalog_file.h"
+#include "utf42_catalog_reload.h"
+#include "utf42_intern.h"
+#include "utf42_format.h"
+
+#if __has_include(<unistd.h>)
+#include <unistd.h>
+#define UTF42_BENCH_POSIX 1
+#endif
+
+#if __has_include(<iconv.h>)
+#include <iconv.h>
+#define UTF42_BENCH_ICONV 1
+#endif
+
+/// Prevents the optimizer from discarding benchmarked results
+volatile std::size_t g_nSink = 0;
+
+/**
+ * @brief Measures the average duration of a callable
+ * @tparam function_t Callable type
+ * @param nIterations Number of calls
+ * @param fnBody Callable to measure
+ * @return Nanoseconds per call
+ */
+template<typename function_t>
+double measure_ns(const std::size_t nIterations, function_t &&fnBody) {
+    const auto tStart = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < nIterations; ++i) {
+        fnBody();
+    }
+    const auto tEnd = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(tEnd - tStart).count() / static_cast<double>(nIterations);
+}
+
+/**
+ * @brief Builds a mostly ASCII sample of at most `nUnits` code units
+ *
+ * The sample resembles keys and tags: ASCII with the occasional accented
+ * letter and a few characters outside the BMP. Code points are never split.
+ *
+ * @tparam char_t Character type
+ * @param nUnits Maximum length in code units
+ * @return The sample text
+ */
+template<typename char_t>
+std::basic_string<char_t> make_sample(const std::size_t nUnits) {
+    static constexpr char32_t aPattern[] = {
+        U'u', U's', U'e', U'r', U'_', U'n', U'a', U'm', U'e', U'.', U'é', U't', U'a', U'g',
+        U'-', U'世', U'k', U'e', U'y', U'/', U'\U0001F600', U'v', U'a', U'l', U'u', U'e',
+    };
+    std::basic_string<char_t> sResult;
+    char_t aUnits[4] = {};
+    for (std::size_t i = 0;; ++i) {
+        const char32_t nCode = aPattern[i % (sizeof(aPattern) / sizeof(aPattern[0]))];
+        if (sResult.size() + utf42::encoded_length<char_t>(nCode) > nUnits) break;
+        sResult.append(aUnits, utf42::encode(nCode, aUnits));
+    }
+    return sResult;
+}
+
+/// Input lengths (in source code units) of the small-string benchmark
+constexpr std::size_t g_aSmallSizes[] = {1, 2, 4, 8, 16, 24, 32, 40, 48, 64};
+
+/**
+ * @brief Prints the latency of one encoding pair for lengths in 1..64
+ * @tparam to_t Destination character type
+ * @tparam from_t Source character type
+ * @param pName Name of the encoding pair
+ */
+template<typename to_t, typename from_t>
+void bench_small_pair(const char *pName) {
+    constexpr std::size_t nIterations = 20000;
+    std::printf("%-14s", pName);
+    for (const std::size_t nUnits: g_aSmallSizes) {
+        const std::basic_string<from_t> sInput = make_sample<from_t>(nUnits);
+        const utf42::basic_string_view<from_t> sView(sInput);
+        const double nAuto = measure_ns(nIterations, [&] {
+            g_nSink = g_nSink + utf42::transcode<to_t>(sView).size();
+        });
+        const double nGeneral = measure_ns(nIterations, [&] {
+            g_nSink = g_nSink + utf42::detail::transcode_large<to_t>(sView).size();
+        });
+        std::printf(" %6.1f/%6.1f", nAuto, nGeneral);
+    }
+    std::printf("\n");
+}
+
+/**
+ * @brief Small-string latency benchmark (ns/op), small path versus general kernel
+ */
+void bench_small_strings() {
+    std::printf("Small-string transcoding latency, ns/op as transcode/general kernel\n");
+    std::printf("%-14s", "pair \\ units");
+    for (const std::size_t nUnits: g_aSmallSizes) {
+        std::printf(" %13zu", nUnits);
+    }
+    std::printf("\n");
+    bench_small_pair<char8_t, char8_t>("utf8->utf8");
+    bench_small_pair<char16_t, char8_t>("utf8->utf16");
+    bench_small_pair<char32_t, char8_t>("utf8->utf32");
+    bench_small_pair<char8_t, char16_t>("utf16->utf8");
+    bench_small_pair<char16_t, char16_t>("utf16->utf16");
+    bench_small_pair<char32_t, char16_t>("utf16->utf32");
+    bench_small_pair<char8_t, char32_t>("utf32->utf8");
+    bench_small_pair<char16_t, char32_t>("utf32->utf16");
+    bench_small_pair<char32_t, char32_t>("utf32->utf32");
+    std::printf("\n");
+}
+
+/**
+ * @brief Prints the throughput of one encoding pair on a large input
+ * @tparam to_t Destination character type
+ * @tparam from_t Source character type
+ * @param pName Name of the encoding pair
+ */
+template<typename to_t, typename from_t>
+void bench_large_pair(const char *pName) {
+    constexpr std::size_t nIterations = 20;
+    const std::basic_string<from_t> sInput = make_sample<from_t>(1 << 20);
+    const utf42::basic_string_view<from_t> sView(sInput);
+    std::basic_string<to_t> sOutput(utf42::max_transcoded_length<to_t, from_t>(sInput.size()), to_t());
+    const double nBytes = static_cast<double>(sInput.size() * sizeof(from_t));
+    const double nKernel = measure_ns(nIterations, [&] {
+        g_nSink = g_nSink + utf42::transcode_into(sView, sOutput.data());
+    });
+    const double nGeneric = measure_ns(nIterations, [&] {
+        g_nSink = g_nSink + utf42::detail::generic_transcode_into(sView, sOutput.data());
+    });
+    std::printf("%-14s %10.1f %10.1f\n", pName, nBytes / nKernel * 1e3, nBytes / nGeneric * 1e3);
+}
+
+/**
+ * @brief Large input throughput (MB/s), `transcode_into` versus the header-only kernel
+ *
+ * Both columns match unless the `utf42::dispatch` library is linked.
+ */
+void bench_large_strings() {
+#if defined(UTF42_DISPATCH)
+    std::printf("Large input transcoding throughput (MB/s), dispatched kernel vs header-only\n");
+#else
+    std::printf("Large input transcoding throughput (MB/s), header-only (dispatch not linked)\n");
+#endif
+    std::printf("%-14s %10s %10s\n", "pair", "kernel", "header");
+    bench_large_pair<char8_t, char8_t>("utf8->utf8");
+    bench_large_pair<char16_t, char8_t>("utf8->utf16");
+    bench_large_pair<char32_t, char8_t>("utf8->utf32");
+    bench_large_pair<char8_t, char16_t>("utf16->utf8");
+    bench_large_pair<char16_t, char16_t>("utf16->utf16");
+    bench_large_pair<char32_t, char16_t>("utf16->utf32");
+    bench_large_pair<char8_t, char32_t>("utf32->utf8");
+    bench_large_pair<char16_t, char32_t>("utf32->utf16");
+    bench_large_pair<char32_t, char32_t>("utf32->utf32");
+    std::printf("\n");
+}
+
+/**
+ * @brief Runs a callable on several threads released at the same time
+ * @tparam function_t Callable type, called with the thread index
+ * @param nThreads Number of threads
+ * @param fnBody Callable to run
+ * @return Wall time in seconds, from the release to the last thread exit
+ */
+template<typename function_t>
+double run_threads(const std::size_t nThreads, function_t &&fnBody) {
+    std::atomic<std::size_t> nReady{0};
+    std::atomic<bool> bGo{false};
+    std::vector<std::thread> aThreads;
+    aThreads.reserve(nThreads);
+    for (std::size_t i = 0; i < nThreads; ++i) {
+        aThreads.emplace_back([&, i] {
+            nReady.fetch_add(1);
+            while (!bGo.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            fnBody(i);
+        });
+    }
+    while (nReady.load() != nThreads) {
+        std::this_thread::yield();
+    }
+    const auto tStart = std::chrono::steady_clock::now();
+    bGo.store(true, std::memory_order_release);
+    for (std::thread &oThread: aThreads) {
+        oThread.join();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count();
+}
+
+/**
+ * @brief Baseline lazily transcoded string guarded by a mutex
+ */
+class locked_poly_string {
+public:
+    /**
+     * @brief Constructs the string
+     * @param sText Original UTF-8 string
+     */
+    explicit locked_poly_string(const std::string_view sText) : m_sText(sText) {
+    }
+
+    /// @return The UTF-16 representation, transcoded on first use
+    std::u16string_view visit16() const {
+        std::lock_guard<std::mutex> oLock(m_oMutex);
+        if (!m_sText16) m_sText16 = utf42::transcode<char16_t>(std::string_view(m_sText));
+        return *m_sText16;
+    }
+
+    /// @return The UTF-32 representation, transcoded on first use
+    std::u32string_view visit32() const {
+        std::lock_guard<std::mutex> oLock(m_oMutex);
+        if (!m_sText32) m_sText32 = utf42::transcode<char32_t>(std::string_view(m_sText));
+        return *m_sText32;
+    }
+
+private:
+    std::string m_sText; ///< Original string
+    mutable std::mutex m_oMutex; ///< Guards the cache
+    mutable std::optional<std::u16string> m_sText16; ///< Cached UTF-16 representation
+    mutable std::optional<std::u32string> m_sText32; ///< Cached UTF-32 representation
+};
+
+/**
+ * @brief Prints the cold and warm timings of one shared string type
+ * @tparam string_t String type, `poly_string` or `locked_poly_string`
+ * @tparam visit_t Callable returning the summed UTF-16 and UTF-32 lengths of a string
+ * @param pName Name of the string type
+ * @param aSamples Original strings
+ * @param nThreads Number of threads
+ * @param fnVisit Visitor
+ */
+template<typename string_t, typename visit_t>
+void bench_shared_case(const char *pName, const std::vector<std::string> &aSamples, const std::size_t nThreads,
+                       visit_t &&fnVisit) {
+    constexpr std::size_t nWarmVisits = 100000;
+    std::deque<string_t> aStrings;
+    for (const std::string &sSample: aSamples) {
+        aStrings.emplace_back(std::string_view(sSample));
+    }
+    // Every thread materializes every string, in the same order, to maximize contention
+    const double nCold = run_threads(nThreads, [&](std::size_t) {
+        std::size_t nTotal = 0;
+        for (const string_t &oString: aStrings) {
+            nTotal += fnVisit(oString);
+        }
+        g_nSink = g_nSink + nTotal;
+    });
+    const double nWarm = run_threads(nThreads, [&](const std::size_t nThread) {
+        std::size_t nTotal = 0;
+        for (std::size_t i = 0; i < nWarmVisits; ++i) {
+            nTotal += fnVisit(aStrings[(i * 7 + nThread) % aStrings.size()]);
+        }
+        g_nSink = g_nSink + nTotal;
+    });
+    std::printf("%-20s %10.2f %12.1f\n", pName, nCold * 1e3,
+                static_cast<double>(nThreads * nWarmVisits) / nWarm / 1e6);
+}
+
+/**
+ * @brief Contention benchmark of shared strings visited from many threads
+ *
+ * Compares the lock-free `poly_string` with a mutex-guarded cache. The cold
+ * column times the first materialization of 1024 strings raced by every
+ * thread; the warm column is the visit rate once everything is cached.
+ */
+void bench_shared_strings() {
+    const std::size_t nThreads = std::max<std::size_t>(32, std::thread::hardware_concurrency());
+    std::vector<std::string> aSamples;
+    for (std::size_t i = 0; i < 1024; ++i) {
+        aSamples.push_back(make_sample<char>(8 + i % 57));
+    }
+    std::printf("Shared strings, %zu threads, utf8 visited as utf16 and utf32\n", nThreads);
+    std::printf("%-20s %10s %12s\n", "string", "cold ms", "warm Mvisit/s");
+    bench_shared_case<utf42::poly_string>("poly_string", aSamples, nThreads, [](const utf42::poly_string &oString) {
+        return oString.visit<char16_t>().size() + oString.visit<char32_t>().size();
+    });
+    bench_shared_case<locked_poly_string>("mutex cache", aSamples, nThreads, [](const locked_poly_string &oString) {
+        return oString.visit16().size() + oString.visit32().size();
+    });
+    std::printf("\n");
+}
+
+/**
+ * @brief Draws a Zipf distributed sequence of ranks
+ * @param nKeys Number of distinct ranks
+ * @param nDraws Length of the sequence
+ * @param nExponent Exponent of the distribution
+ * @return Ranks in [0, nKeys), rank 0 being the most frequent
+ */
+std::vector<std::size_t> make_zipf(const std::size_t nKeys, const std::size_t nDraws, const double nExponent) {
+    std::vector<double> aCumulative(nKeys);
+    double nTotal = 0;
+    for (std::size_t i = 0; i < nKeys; ++i) {
+        nTotal += 1.0 / std::pow(static_cast<double>(i + 1), nExponent);
+        aCumulative[i] = nTotal;
+    }
+    std::mt19937_64 oEngine(42);
+    std::uniform_real_distribution<double> oUniform(0.0, nTotal);
+    std::vector<std::size_t> aResult(nDraws);
+    for (std::size_t &nRank: aResult) {
+        nRank = static_cast<std::size_t>(std::lower_bound(aCumulative.begin(), aCumulative.end(), oUniform(oEngine)) -
+                                         aCumulative.begin());
+        if (nRank == nKeys) nRank = nKeys - 1;
+    }
+    return aResult;
+}
+
+/**
+ * @brief Memoizing cache benchmark on Zipf distributed header-like keys
+ *
+ * Transcodes UTF-8 keys of 8 to 64 bytes to UTF-16, either each time or
+ * through a `transcode_cache` of varying capacity, single threaded and on
+ * 8 threads. The cache pays off once the hit ratio is high: a miss costs a
+ * transcoding plus an insertion.
+ */
+void bench_cache() {
+    constexpr std::size_t nKeys = 8192;
+    constexpr std::size_t nDraws = 1 << 20;
+    constexpr std::size_t nThreads = 8;
+    std::vector<std::string> aKeys;
+    for (std::size_t i = 0; i < nKeys; ++i) {
+        aKeys.push_back(make_sample<char>(8 + i % 57) + std::to_string(i));
+    }
+    const std::vector<std::size_t> aDraws = make_zipf(nKeys, nDraws, 1.0);
+
+    std::printf("Memoizing cache, utf8->utf16, %zu keys, Zipf s=1, ns/op\n", nKeys);
+    std::printf("%-10s %10s %10s %10s %12s %12s\n", "capacity", "hit ratio", "uncached", "cached",
+                "uncached x8", "cached x8");
+    const double nUncached = measure_ns(nDraws, [&, i = std::size_t(0)]() mutable {
+        g_nSink = g_nSink + utf42::transcode<char16_t>(std::string_view(aKeys[aDraws[i++]])).size();
+    });
+    const double nUncachedParallel = run_threads(nThreads, [&](const std::size_t nThread) {
+        std::size_t nTotal = 0;
+        for (std::size_t i = nThread; i < nDraws; i += nThreads) {
+            nTotal += utf42::transcode<char16_t>(std::string_view(aKeys[aDraws[i]])).size();
+        }
+        g_nSink = g_nSink + nTotal;
+    }) * 1e9 / nDraws;
+    for (const std::size_t nCapacity: {1024, 4096, 16384}) {
+        utf42::cache_options oOptions;
+        oOptions.nCapacity = nCapacity;
+        utf42::transcode_cache oCache(oOptions);
+        const double nCached = measure_ns(nDraws, [&, i = std::size_t(0)]() mutable {
+            g_nSink = g_nSink + oCache.transcode<char16_t>(std::string_view(aKeys[aDraws[i++]])).size();
+        });
+        const double nHitRatio = oCache.statistics().hit_ratio();
+        const double nCachedParallel = run_threads(nThreads, [&](const std::size_t nThread) {
+            std::size_t nTotal = 0;
+            for (std::size_t i = nThread; i < nDraws; i += nThreads) {
+                nTotal += oCache.transcode<char16_t>(std::string_view(aKeys[aDraws[i]])).size();
+            }
+            g_nSink = g_nSink + nTotal;
+        }) * 1e9 / nDraws;
+        std::printf("%-10zu %10.3f %10.1f %10.1f %12.1f %12.1f\n", nCapacity, nHitRatio, nUncached, nCached,
+                    nUncachedParallel, nCachedParallel);
+    }
+    std::printf("\n");
+}
+
+/// Literals searched by the multi-pattern benchmark, as in log redaction
+static constexpr utf42::poly_enc g_aRedactPatterns[] = {
+    cons_poly_enc("password="), cons_poly_enc("passwd="), cons_poly_enc("token="), cons_poly_enc("secret="),
+    cons_poly_enc("api_key="), cons_poly_enc("apikey="), cons_poly_enc("authorization:"), cons_poly_enc("bearer "),
+    cons_poly_enc("session_id="), cons_poly_enc("cookie:"), cons_poly_enc("private_key"), cons_poly_enc("client_secret"),
+    cons_poly_enc("access_token"), cons_poly_enc("refresh_token"), cons_poly_enc("ssn="), cons_poly_enc("credit_card"),
+    cons_poly_enc("iban="), cons_poly_enc("contrase\u00F1a="), cons_poly_enc("mot_de_passe="), cons_poly_enc("\u5BC6\u7801="),
+    cons_poly_enc("x-api-key"), cons_poly_enc("x-auth-token"), cons_poly_enc("aws_secret"), cons_poly_enc("gh_token"),
+    cons_poly_enc("slack_token"), cons_poly_enc("db_password"), cons_poly_enc("smtp_pass"), cons_poly_enc("jwt="),
+    cons_poly_enc("otp="), cons_poly_enc("pin="), cons_poly_enc("cvv="), cons_poly_enc("signature="),
+};
+
+/// Literals of the multi-pattern benchmark starting with few distinct units, so the prefilter is used
+static constexpr utf42::poly_enc g_aPrefilterPatterns[] = {
+    cons_poly_enc("password="), cons_poly_enc("passwd="), cons_poly_enc("token="), cons_poly_enc("tokens="),
+    cons_poly_enc("secret="), cons_poly_enc("session_id="), cons_poly_enc("ssn="), cons_poly_enc("signature="),
+};
+
+/**
+ * @brief Prints the throughput of an Aho-Corasick scan and of one search per pattern
+ * @tparam aPatterns Patterns
+ * @tparam char_t Character type of the text
+ * @param pName Name of the case
+ * @param sText Text to scan
+ */
+template<const auto &aPatterns, typename char_t>
+void bench_aho_corasick_case(const char *pName, const std::basic_string<char_t> &sText) {
+    using matcher = utf42::aho_corasick<aPatterns>;
+    const std::basic_string_view<char_t> sView(sText);
+    const double nBytes = static_cast<double>(sText.size() * sizeof(char_t));
+    std::size_t nMatches = 0;
+    const double nAutomaton = measure_ns(8, [&]() { nMatches = matcher::count(sView); });
+    std::size_t nNaiveMatches = 0;
+    const double nNaive = measure_ns(8, [&]() {
+        nNaiveMatches = 0;
+        for (std::size_t i = 0; i < matcher::size(); ++i) {
+            const std::basic_string_view<char_t> sPattern = matcher::pattern(i).template visit<char_t>();
+            for (std::size_t nAt = sView.find(sPattern); nAt != sView.npos; nAt = sView.find(sPattern, nAt + 1)) {
+                ++nNaiveMatches;
+            }
+        }
+    });
+    g_nSink = g_nSink + nMatches + nNaiveMatches;
+    std::printf("%-24s %8zu %8zu %12.0f %12.0f\n", pName, matcher::size(), nMatches, nBytes / nAutomaton * 1e3,
+                nBytes / nNaive * 1e3);
+}
+
+/**
+ * @brief Multi-pattern search benchmark on a log-like text
+ *
+ * Counts the occurrences of redaction literals in 4 MiB of mostly ASCII
+ * log lines, with one compile-time automaton or with one
+ * `basic_string_view::find` loop per pattern.
+ */
+void bench_aho_corasick() {
+    std::string sLog;
+    std::mt19937 oEngine(7);
+    while (sLog.size() < (std::size_t(4) << 20)) {
+        sLog += "2025-01-01T00:00:00Z INFO request ";
+        sLog += make_sample<char>(16 + oEngine() % 48);
+        sLog += oEngine() % 64 == 0 ? " token=abcdef\n" : " status=200 latency_ms=12\n";
+    }
+    const std::u16string sLog16 = utf42::transcode<char16_t>(std::string_view(sLog));
+
+    std::printf("Multi-pattern search, MB/s\n");
+    std::printf("%-24s %8s %8s %12s %12s\n", "case", "patterns", "matches", "automaton", "find loop");
+    bench_aho_corasick_case<g_aRedactPatterns>("utf8", sLog);
+    bench_aho_corasick_case<g_aRedactPatterns>("utf16", sLog16);
+    bench_aho_corasick_case<g_aPrefilterPatterns>("utf8 prefiltered", sLog);
+    bench_aho_corasick_case<g_aPrefilterPatterns>("utf16 prefiltered", sLog16);
+    std::printf("\n");
+}
+
+/**
+ * @brief Prints the throughput of one literal search on one text
+ * @tparam char_t Character type of the text
+ * @param pName Name of the case
+ * @param sText Text to search
+ * @param oNeedle Literal to count
+ */
+template<typename char_t>
+void bench_search_case(const char *pName, const std::basic_string<char_t> &sText, const utf42::poly_enc &oNeedle) {
+    const std::basic_string_view<char_t> sView(sText);
+    const double nBytes = static_cast<double>(sText.size() * sizeof(char_t));
+    std::size_t nMatches = 0;
+    const double nFiltered = measure_ns(8, [&]() { nMatches = utf42::count(sView, oNeedle); });
+    // Baseline: the needle transcoded at run time from UTF-8, then the standard search
+    const double nStandard = measure_ns(8, [&]() {
+        const std::basic_string<char_t> sNeedle = utf42::transcode<char_t>(oNeedle.visit<char>());
+        std::size_t nCount = 0;
+        for (std::size_t nAt = sView.find(sNeedle); nAt != sView.npos; nAt = sView.find(sNeedle, nAt + sNeedle.size())) {
+            ++nCount;
+        }
+        g_nSink = g_nSink + nCount;
+    });
+    g_nSink = g_nSink + nMatches;
+    std::printf("%-30s %8zu %12.0f %12.0f\n", pName, nMatches, nBytes / nFiltered * 1e3, nBytes / nStandard * 1e3);
+}
+
+/**
+ * @brief Literal search benchmark on a log-like text
+ *
+ * Counts a rare literal and a literal whose first unit is frequent in
+ * 4 MiB of log lines, with `utf42::count` or with `basic_string_view::find`.
+ */
+void bench_search() {
+    std::string sLog;
+    std::mt19937 oEngine(11);
+    while (sLog.size() < (std::size_t(4) << 20)) {
+        sLog += "2025-01-01T00:00:00Z INFO request ";
+        sLog += make_sample<char>(16 + oEngine() % 48);
+        sLog += oEngine() % 64 == 0 ? " status=503\n" : " status=200 latency_ms=12\n";
+    }
+    const std::u16string sLog16 = utf42::transcode<char16_t>(std::string_view(sLog));
+    const std::u32string sLog32 = utf42::transcode<char32_t>(std::string_view(sLog));
+
+    std::printf("Literal search, MB/s\n");
+    std::printf("%-30s %8s %12s %12s\n", "case", "matches", "utf42", "string_view");
+    bench_search_case("utf8 rare \"status=503\"", sLog, cons_poly_enc("status=503"));
+    bench_search_case("utf8 frequent \"e.\u00E9tag\"", sLog, cons_poly_enc("e.\u00E9tag"));
+    bench_search_case("utf16 rare \"status=503\"", sLog16, cons_poly_enc("status=503"));
+    bench_search_case("utf16 frequent \"e.\u00E9tag\"", sLog16, cons_poly_enc("e.\u00E9tag"));
+    bench_search_case("utf32 rare \"status=503\"", sLog32, cons_poly_enc("status=503"));
+    std::printf("\n");
+}
+
+/// Patterns of the regex benchmark
+static constexpr utf42::poly_enc g_oStatusRegex = cons_poly_enc("status=5\\d\\d");
+static constexpr utf42::poly_enc g_oKeyRegex = cons_poly_enc("[a-z]+\\.\u00E9[a-z]+-");
+
+/**
+ * @brief Prints the throughput of a compile-time regex and of std::regex / std::wregex
+ * @tparam oPattern Pattern
+ * @param pPattern Same pattern, for the standard library
+ * @param sText UTF-8 text
+ */
+template<const utf42::poly_enc &oPattern>
+void bench_regex_case(const char *pPattern, const std::string &sText) {
+    const std::wstring sWide = utf42::transcode<wchar_t>(std::string_view(sText));
+    const std::u16string sText16 = utf42::transcode<char16_t>(std::string_view(sText));
+    const auto fnCount = [](const auto sView) {
+        std::size_t nCount = 0;
+        for (auto oMatch = utf42::regex<oPattern>::search(sView); oMatch;
+             oMatch = utf42::regex<oPattern>::search(sView, oMatch->end() + (oMatch->nLength == 0))) {
+            ++nCount;
+        }
+        return nCount;
+    };
+    std::size_t nMatches = 0;
+    const double nUtf8 = measure_ns(2, [&]() { nMatches = fnCount(std::string_view(sText)); });
+    const double nUtf16 = measure_ns(2, [&]() { g_nSink = g_nSink + fnCount(std::u16string_view(sText16)); });
+    const double nWide = measure_ns(2, [&]() { g_nSink = g_nSink + fnCount(std::wstring_view(sWide)); });
+    const std::regex oRegex(pPattern);
+    const double nStd = measure_ns(2, [&]() {
+        g_nSink = g_nSink + static_cast<std::size_t>(
+                      std::distance(std::sregex_iterator(sText.begin(), sText.end(), oRegex), std::sregex_iterator()));
+    });
+    const std::wregex oWideRegex(utf42::transcode<wchar_t>(std::string_view(pPattern)));
+    const double nStdWide = measure_ns(2, [&]() {
+        g_nSink = g_nSink + static_cast<std::size_t>(
+                      std::distance(std::wsregex_iterator(sWide.begin(), sWide.end(), oWideRegex), std::wsregex_iterator()));
+    });
+    const double nCodePoints = static_cast<double>(utf42::transcoded_length<char32_t>(std::string_view(sText))) * 1e3;
+    std::printf("%-26s %8zu %8.1f %8.1f %8.1f %10.1f %10.1f\n", pPattern, nMatches, nCodePoints / nUtf8,
+                nCodePoints / nUtf16, nCodePoints / nWide, nCodePoints / nStd, nCodePoints / nStdWide);
+}
+
+/**
+ * @brief Regular expression benchmark on a log-like text
+ *
+ * Counts the matches of a pattern in 1 MiB of log lines with
+ * `utf42::regex` on UTF-8, UTF-16 and wide text, and with `std::regex`
+ * and `std::wregex`.
+ */
+void bench_regex() {
+    std::string sLog;
+    std::mt19937 oEngine(13);
+    while (sLog.size() < (std::size_t(1) << 20)) {
+        sLog += "2025-01-01T00:00:00Z INFO request ";
+        sLog += make_sample<char>(16 + oEngine() % 48);
+        sLog += oEngine() % 64 == 0 ? " status=503\n" : " status=200 latency_ms=12\n";
+    }
+    std::printf("Regular expressions, million code points/s\n");
+    std::printf("%-26s %8s %8s %8s %8s %10s %10s\n", "pattern", "matches", "utf8", "utf16", "wide", "std::regex",
+                "wregex");
+    bench_regex_case<g_oStatusRegex>("status=5\\d\\d", sLog);
+    bench_regex_case<g_oKeyRegex>("[a-z]+\\.\xC3\xA9[a-z]+-", sLog);
+    std::printf("\n");
+}
+
+/**
+ * @brief Prints the throughput of one encoding pair, checked kernels versus unchecked kernels
+ * @tparam to_t Destination character type
+ * @tparam from_t Source character type
+ * @param pName Name of the encoding pair
+ * @param sInput Well-formed text
+ */
+template<typename to_t, typename from_t>
+void bench_valid_pair(const char *pName, const std::basic_string<from_t> &sInput) {
+    constexpr std::size_t nIterations = 20;
+    const utf42::basic_string_view<from_t> sView(sInput);
+    const utf42::valid_view<from_t> sValid = *utf42::validated(sView);
+    const double nBytes = static_cast<double>(sInput.size() * sizeof(from_t));
+    std::basic_string<to_t> sOutput(utf42::max_transcoded_length<to_t, from_t>(sInput.size()), to_t());
+    const double nChecked = measure_ns(nIterations, [&] {
+        g_nSink = g_nSink + utf42::transcode_into(sView, sOutput.data());
+    });
+    const double nUnchecked = measure_ns(nIterations, [&] {
+        g_nSink = g_nSink + utf42::transcode_into(sValid, sOutput.data());
+    });
+    const double nCheckedLength = measure_ns(nIterations, [&] {
+        g_nSink = g_nSink + utf42::transcoded_length<to_t>(sView);
+    });
+    const double nUncheckedLength = measure_ns(nIterations, [&] {
+        g_nSink = g_nSink + utf42::transcoded_length<to_t>(sValid);
+    });
+    std::printf("%-14s %10.1f %10.1f %10.1f %10.1f\n", pName, nBytes / nChecked * 1e3, nBytes / nUnchecked * 1e3,
+                nBytes / nCheckedLength * 1e3, nBytes / nUncheckedLength * 1e3);
+}
+
+/**
+ * @brief Trusted view benchmark (MB/s): `transcode_into` and `transcoded_length`,
+ *        on a plain view versus a `valid_view`
+ */
+void bench_valid() {
+    const std::string sText = make_sample<char>(1 << 20);
+    const std::u16string sText16 = utf42::transcode<char16_t>(std::string_view(sText));
+    const std::u32string sText32 = utf42::transcode<char32_t>(std::string_view(sText));
+    std::printf("Trusted views, MB/s\n");
+    std::printf("%-14s %10s %10s %10s %10s\n", "pair", "into", "into valid", "length", "len valid");
+    bench_valid_pair<char16_t>("utf8->utf16", sText);
+    bench_valid_pair<char32_t>("utf8->utf32", sText);
+    bench_valid_pair<char>("utf16->utf8", sText16);
+    bench_valid_pair<char32_t>("utf16->utf32", sText16);
+    bench_valid_pair<char>("utf32->utf8", sText32);
+    bench_valid_pair<char16_t>("utf32->utf16", sText32);
+    std::printf("\n");
+}
+
+/**
+ * @brief Encoding independent hashing benchmark on UTF-16 keys, ns/op
+ *
+ * Hashes UTF-16 keys and looks them up in a map keyed by UTF-8 strings:
+ * with `utf42::hasher` and `utf42::equal_to` the key is used as is,
+ * otherwise it is transcoded to UTF-8 first for `std::hash`.
+ */
+void bench_hash() {
+    constexpr std::size_t nKeys = 1024;
+    constexpr std::size_t nLookups = 1 << 20;
+    std::vector<std::u16string> aQueries;
+    std::unordered_map<std::string, std::size_t, utf42::hasher, utf42::equal_to> mTransparent;
+    std::unordered_map<std::string, std::size_t> mStandard;
+    for (std::size_t i = 0; i < nKeys; ++i) {
+        const std::string sKey = make_sample<char>(4 + i % 29) + std::to_string(i);
+        aQueries.push_back(utf42::transcode<char16_t>(std::string_view(sKey)));
+        mTransparent.emplace(sKey, i);
+        mStandard.emplace(sKey, i);
+    }
+    static constexpr utf42::hashed_literal oLiteral(cons_poly_enc("user_name.étag-世key/\U0001F600v7"));
+    mTransparent.emplace(std::string(oLiteral.visit<char>()), nKeys);
+    mStandard.emplace(std::string(oLiteral.visit<char>()), nKeys);
+
+    std::printf("Encoding independent hashing, utf16 keys of 4 to 36 units, ns/op\n");
+    std::printf("%-34s %10s\n", "case", "ns/op");
+    const double nHash = measure_ns(nLookups, [&, i = std::size_t(0)]() mutable {
+        g_nSink = g_nSink + utf42::hash(std::u16string_view(aQueries[i++ % nKeys]));
+    });
+    const double nTranscodeHash = measure_ns(nLookups, [&, i = std::size_t(0)]() mutable {
+        const std::string sKey = utf42::transcode<char>(std::u16string_view(aQueries[i++ % nKeys]));
+        g_nSink = g_nSink + std::hash<std::string_view>()(sKey);
+    });
+    const double nTransparent = measure_ns(nLookups, [&, i = std::size_t(0)]() mutable {
+        g_nSink = g_nSink + mTransparent.find(std::u16string_view(aQueries[i++ % nKeys]))->second;
+    });
+    const double nStandard = measure_ns(nLookups, [&, i = std::size_t(0)]() mutable {
+        g_nSink = g_nSink + mStandard.find(utf42::transcode<char>(std::u16string_view(aQueries[i++ % nKeys])))->second;
+    });
+    const double nLiteral = measure_ns(nLookups, [&]() {
+        g_nSink = g_nSink + mTransparent.find(oLiteral)->second;
+    });
+    const double nLiteralStandard = measure_ns(nLookups, [&]() {
+        g_nSink = g_nSink + mStandard.find(std::string(oLiteral.visit<char>()))->second;
+    });
+    std::printf("%-34s %10.1f\n", "utf42::hash", nHash);
+    std::printf("%-34s %10.1f\n", "transcode + std::hash", nTranscodeHash);
+    std::printf("%-34s %10.1f\n", "find, utf42::hasher", nTransparent);
+    std::printf("%-34s %10.1f\n", "find, transcode + std::hash", nStandard);
+    std::printf("%-34s %10.1f\n", "find literal, hashed_literal", nLiteral);
+    std::printf("%-34s %10.1f\n", "find literal, std::hash", nLiteralStandard);
+    std::printf("\n");
+}
+
+/**
+ * @brief String switch benchmark on UTF-16 commands, ns/op
+ *
+ * Dispatches 24 commands, a quarter of the queries matching none, with
+ * `utf42::string_switch`, a chain of comparisons and a `std::unordered_map`.
+ */
+void bench_string_switch() {
+    constexpr std::size_t nQueries = 4096;
+    constexpr std::size_t nLookups = 1 << 22;
+    static constexpr utf42::poly_enc aCommands[] = {
+        cons_poly_enc("get"), cons_poly_enc("set"), cons_poly_enc("del"), cons_poly_enc("exists"),
+        cons_poly_enc("expire"), cons_poly_enc("ttl"), cons_poly_enc("incr"), cons_poly_enc("decr"),
+        cons_poly_enc("append"), cons_poly_enc("strlen"), cons_poly_enc("lpush"), cons_poly_enc("rpush"),
+        cons_poly_enc("lpop"), cons_poly_enc("rpop"), cons_poly_enc("lrange"), cons_poly_enc("sadd"),
+        cons_poly_enc("srem"), cons_poly_enc("smembers"), cons_poly_enc("hget"), cons_poly_enc("hset"),
+        cons_poly_enc("hdel"), cons_poly_enc("publish"), cons_poly_enc("subscribe"), cons_poly_enc("clé-été"),
+    };
+    static constexpr auto oSwitch = utf42::make_string_switch<char16_t>(aCommands);
+    static constexpr const char16_t *aMisses[] = {u"gets", u"sets", u"hgetall", u"lpushx", u"ping", u"echo"};
+
+    std::unordered_map<std::u16string_view, std::size_t> mCommands;
+    for (std::size_t i = 0; i < oSwitch.size(); ++i) mCommands.emplace(oSwitch.at(i), i);
+    std::vector<std::u16string> aQueries;
+    std::mt19937 oEngine(42);
+    for (std::size_t i = 0; i < nQueries; ++i) {
+        if (oEngine() % 4 == 0) aQueries.emplace_back(aMisses[oEngine() % std::size(aMisses)]);
+        else aQueries.emplace_back(oSwitch.at(oEngine() % oSwitch.size()));
+    }
+
+    std::printf("String switch, 24 utf16 commands and 25%% misses, ns/op\n");
+    std::printf("%-34s %10s\n", "case", "ns/op");
+    const double nSwitch = measure_ns(nLookups, [&, i = std::size_t(0)]() mutable {
+        g_nSink = g_nSink + oSwitch(aQueries[i++ % nQueries]);
+    });
+    const double nChain = measure_ns(nLookups, [&, i = std::size_t(0)]() mutable {
+        const std::u16string_view sQuery = aQueries[i++ % nQueries];
+        std::size_t nIndex = oSwitch.npos;
+        for (std::size_t j = 0; j < oSwitch.size(); ++j) {
+            if (sQuery == oSwitch.at(j)) {
+                nIndex = j;
+                break;
+            }
+        }
+        g_nSink = g_nSink + nIndex;
+    });
+    const double nMap = measure_ns(nLookups, [&, i = std::size_t(0)]() mutable {
+        const auto itCommand = mCommands.find(aQueries[i++ % nQueries]);
+        g_nSink = g_nSink + (itCommand == mCommands.end() ? oSwitch.npos : itCommand->second);
+    });
+    std::printf("%-34s %10.1f\n", "utf42::string_switch", nSwitch);
+    std::printf("%-34s %10.1f\n", "if-chain", nChain);
+    std::printf("%-34s %10.1f\n", "std::unordered_map", nMap);
+    std::printf("\n");
+}
+
+/**
+ * @brief Literal metadata benchmark, ns/op
+ *
+ * Appends a literal padded to 40 columns to a UTF-8 line, measuring the
+ * literal at run time or reading its `utf42::poly_enc_info`.
+ */
+void bench_info() {
+    constexpr std::size_t nLines = 1 << 22;
+    constexpr std::size_t nWidth = 40;
+    static constexpr utf42::poly_enc_info oLabel(cons_poly_enc("Résumé 履歴書 \U0001F600 naïve café"));
+    std::string sLine;
+
+    std::printf("Literal metadata, padding a literal to %zu columns, ns/op\n", nWidth);
+    std::printf("%-34s %10s\n", "case", "ns/op");
+    const double nScan = measure_ns(nLines, [&] {
+        const std::string_view sLabel = oLabel.visit<char>();
+        sLine.clear();
+        sLine.reserve(sLabel.size() + nWidth);
+        sLine += sLabel;
+        sLine.append(nWidth - utf42::columns(sLabel), ' ');
+        g_nSink = g_nSink + sLine.size();
+    });
+    const double nInfo = measure_ns(nLines, [&] {
+        sLine.clear();
+        sLine.reserve(oLabel.utf8_size() + nWidth);
+        sLine += oLabel.visit<char>();
+        sLine.append(nWidth - oLabel.columns(), ' ');
+        g_nSink = g_nSink + sLine.size();
+    });
+    std::printf("%-34s %10.1f\n", "utf42::columns at run time", nScan);
+    std::printf("%-34s %10.1f\n", "utf42::poly_enc_info", nInfo);
+    std::printf("\n");
+}
+
+/// One message of the lazy literal benchmark, the identifier is made of octal digits
+#define BENCH_MESSAGE(make, id) make("Erreur " #id " : le fichier « données-" #id ".txt » est introuvable ou l'accès est refusé")
+#define BENCH_MESSAGES_8(make, id) BENCH_MESSAGE(make, id##0), BENCH_MESSAGE(make, id##1), BENCH_MESSAGE(make, id##2), \
+    BENCH_MESSAGE(make, id##3), BENCH_MESSAGE(make, id##4), BENCH_MESSAGE(make, id##5), BENCH_MESSAGE(make, id##6), \
+    BENCH_MESSAGE(make, id##7)
+#define BENCH_MESSAGES_64(make, id) BENCH_MESSAGES_8(make, id##0), BENCH_MESSAGES_8(make, id##1), \
+    BENCH_MESSAGES_8(make, id##2), BENCH_MESSAGES_8(make, id##3), BENCH_MESSAGES_8(make, id##4), \
+    BENCH_MESSAGES_8(make, id##5), BENCH_MESSAGES_8(make, id##6), BENCH_MESSAGES_8(make, id##7)
+#define BENCH_MESSAGES_512(make, id) BENCH_MESSAGES_64(make, id##0), BENCH_MESSAGES_64(make, id##1), \
+    BENCH_MESSAGES_64(make, id##2), BENCH_MESSAGES_64(make, id##3), BENCH_MESSAGES_64(make, id##4), \
+    BENCH_MESSAGES_64(make, id##5), BENCH_MESSAGES_64(make, id##6), BENCH_MESSAGES_64(make, id##7)
+#define BENCH_MESSAGES(make) BENCH_MESSAGES_512(make, 1), BENCH_MESSAGES_512(make, 2), \
+    BENCH_MESSAGES_512(make, 3), BENCH_MESSAGES_512(make, 4)
+
+static constexpr utf42::poly_enc g_aEagerMessages[] = {BENCH_MESSAGES(cons_poly_enc)};
+static constinit utf42::lazy_enc g_aLazyVisited[] = {BENCH_MESSAGES(lazy_poly_enc)};
+static constinit utf42::lazy_enc g_aLazySerial[] = {BENCH_MESSAGES(lazy_poly_enc)};
+static constinit utf42::lazy_enc g_aLazyParallel[] = {BENCH_MESSAGES(lazy_poly_enc)};
+
+/**
+ * @brief Lazily materialized literal benchmark
+ *
+ * Compares a table of 2048 messages stored with `cons_poly_enc` and with
+ * `lazy_poly_enc`: bytes of literals in the binary, time to build the
+ * UTF-16 forms at first use, serially ahead of time and on every hardware
+ * thread, and cost of later visits. Memory is compared once the UTF-16
+ * forms are in use: the pages of UTF-16 literals for `cons_poly_enc`, the
+ * UTF-8 literals and the arena for `lazy_poly_enc`.
+ */
+void bench_lazy() {
+    constexpr std::size_t nMessages = std::size(g_aEagerMessages);
+    constexpr std::size_t nVisits = 1 << 22;
+    // Literals of the same code unit width are merged by the linker, so count one per encoding
+    std::size_t nEagerBytes = 0;
+    std::size_t nEagerUtf16 = 0;
+    std::size_t nLazyBytes = 0;
+    for (std::size_t i = 0; i < nMessages; ++i) {
+        nEagerBytes += g_aEagerMessages[i].visit<char8_t>().size() + 1 +
+                (g_aEagerMessages[i].visit<char16_t>().size() + 1) * 2 +
+                (g_aEagerMessages[i].visit<char32_t>().size() + 1) * 4;
+        nEagerUtf16 += (g_aEagerMessages[i].visit<char16_t>().size() + 1) * 2;
+        nLazyBytes += g_aLazyVisited[i].utf8().size() + 1;
+    }
+
+    const std::size_t nArena = utf42::lazy_arena_size();
+    const double nFirstUse = measure_ns(1, [&] {
+        for (const utf42::lazy_enc &oMessage: g_aLazyVisited) g_nSink = g_nSink + oMessage.visit<char16_t>().size();
+    });
+    const std::size_t nArenaUsed = utf42::lazy_arena_size() - nArena;
+    const double nSerial = measure_ns(1, [&] { utf42::materialize<char16_t>(g_aLazySerial, 1); });
+    const std::size_t nThreads = std::max(1u, std::thread::hardware_concurrency());
+    const double nParallel = measure_ns(1, [&] { utf42::materialize<char16_t>(g_aLazyParallel, nThreads); });
+    const double nLazyVisit = measure_ns(nVisits, [i = std::size_t(0)]() mutable {
+        g_nSink = g_nSink + g_aLazyVisited[i++ % nMessages].visit<char16_t>().size();
+    });
+    const double nEagerVisit = measure_ns(nVisits, [i = std::size_t(0)]() mutable {
+        g_nSink = g_nSink + g_aEagerMessages[i++ % nMessages].visit<char16_t>().size();
+    });
+
+    std::printf("Lazy literals, %zu messages of about 90 bytes, utf16 forms\n", nMessages);
+    std::printf("%-34s %10zu\n", "literal bytes, cons_poly_enc", nEagerBytes);
+    std::printf("%-34s %10zu\n", "literal bytes, lazy_poly_enc", nLazyBytes);
+    std::printf("%-34s %10.1f\n", "first use, us", nFirstUse / 1000);
+    std::printf("%-34s %10.1f\n", "materialize, 1 thread, us", nSerial / 1000);
+    std::printf("%-34s %10.1f\n", ("materialize, " + std::to_string(nThreads) + " threads, us").c_str(),
+                nParallel / 1000);
+    std::printf("%-34s %10zu\n", "utf16 in use, cons_poly_enc bytes", nEagerUtf16);
+    std::printf("%-34s %10zu\n", "utf16 in use, lazy_poly_enc bytes", nLazyBytes + nArenaUsed);
+    std::printf("%-34s %10.1f\n", "visit, lazy_enc, ns/op", nLazyVisit);
+    std::printf("%-34s %10.1f\n", "visit, poly_enc, ns/op", nEagerVisit);
+    std::printf("\n");
+}
+
+/// Messages of the catalog benchmark
+enum class bench_message { open, save, close, quit, undo, redo, cut, paste, count };
+
+/// Locales of the catalog benchmark
+enum class bench_locale { en, fr, de, ja, count };
+
+/**
+ * @brief Compile-time catalog benchmark, ns/op
+ *
+ * Looks up UTF-16 messages by runtime (locale, message) pairs in a
+ * `utf42::catalog` and in a `std::unordered_map` keyed by the pair.
+ */
+void bench_catalog() {
+    constexpr std::size_t nLookups = 1 << 22;
+    static constexpr utf42::catalog<bench_message, bench_locale> oCatalog({
+        {bench_message::open, bench_locale::en, cons_poly_enc("Open")},
+        {bench_message::save, bench_locale::en, cons_poly_enc("Save")},
+        {bench_message::close, bench_locale::en, cons_poly_enc("Close")},
+        {bench_message::quit, bench_locale::en, cons_poly_enc("Quit")},
+        {bench_message::undo, bench_locale::en, cons_poly_enc("Undo")},
+        {bench_message::redo, bench_locale::en, cons_poly_enc("Redo")},
+        {bench_message::cut, bench_locale::en, cons_poly_enc("Cut")},
+        {bench_message::paste, bench_locale::en, cons_poly_enc("Paste")},
+        {bench_message::open, bench_locale::fr, cons_poly_enc("Ouvrir")},
+        {bench_message::save, bench_locale::fr, cons_poly_enc("Enregistrer")},
+        {bench_message::close, bench_locale::fr, cons_poly_enc("Fermer")},
+        {bench_message::quit, bench_locale::fr, cons_poly_enc("Quitter")},
+        {bench_message::undo, bench_locale::fr, cons_poly_enc("Annuler")},
+        {bench_message::redo, bench_locale::fr, cons_poly_enc("Rétablir")},
+        {bench_message::open, bench_locale::de, cons_poly_enc("Öffnen")},
+        {bench_message::save, bench_locale::de, cons_poly_enc("Speichern")},
+        {bench_message::close, bench_locale::de, cons_poly_enc("Schließen")},
+        {bench_message::quit, bench_locale::de, cons_poly_enc("Beenden")},
+        {bench_message::open, bench_locale::ja, cons_poly_enc("開く")},
+        {bench_message::save, bench_locale::ja, cons_poly_enc("保存")},
+        {bench_message::close, bench_locale::ja, cons_poly_enc("閉じる")},
+        {bench_message::quit, bench_locale::ja, cons_poly_enc("終了")},
+    }, bench_locale::en);
+
+    std::unordered_map<std::size_t, std::u16string_view> mMessages;
+    for (std::size_t nLocale = 0; nLocale < oCatalog.locales; ++nLocale) {
+        for (std::size_t nId = 0; nId < oCatalog.ids; ++nId) {
+            mMessages.emplace(nLocale * oCatalog.ids + nId,
+                              oCatalog.get<char16_t>(static_cast<bench_locale>(nLocale), static_cast<bench_message>(nId)));
+        }
+    }
+    std::vector<std::pair<bench_locale, bench_message> > aQueries;
+    std::mt19937 oEngine(42);
+    for (std::size_t i = 0; i < 4096; ++i) {
+        aQueries.emplace_back(static_cast<bench_locale>(oEngine() % oCatalog.locales),
+                              static_cast<bench_message>(oEngine() % oCatalog.ids));
+    }
+
+    std::printf("Localization catalog, utf16 messages, ns/op\n");
+    std::printf("%-34s %10s\n", "case", "ns/op");
+    const double nCatalog = measure_ns(nLookups, [&, i = std::size_t(0)]() mutable {
+        const auto [eLocale, eId] = aQueries[i++ % aQueries.size()];
+        g_nSink = g_nSink + oCatalog.get<char16_t>(eLocale, eId).size();
+    });
+    const double nMap = measure_ns(nLookups, [&, i = std::size_t(0)]() mutable {
+        const auto [eLocale, eId] = aQueries[i++ % aQueries.size()];
+        g_nSink = g_nSink + mMessages.find(static_cast<std::size_t>(eLocale) * oCatalog.ids +
+                                           static_cast<std::size_t>(eId))->second.size();
+    });
+    std::printf("%-34s %10.1f\n", "utf42::catalog", nCatalog);
+    std::printf("%-34s %10.1f\n", "std::unordered_map", nMap);
+    std::printf("\n");
+}
+
+#if defined(UTF42_CATALOG_MMAP)
+/**
+ * @brief Memory-mapped catalog benchmark
+ *
+ * Opens a catalog of 16 locales of 4096 messages and reads the UTF-16
+ * messages of one locale: by mapping the catalog file, or by reading its
+ * UTF-8 messages from a file and transcoding them at startup.
+ */
+void bench_catalog_file() {
+    constexpr std::size_t nLocales = 16;
+    constexpr std::size_t nIds = 4096;
+    constexpr std::size_t nLookups = 1 << 22;
+    std::vector<std::string> aLocales;
+    for (std::size_t i = 0; i < nLocales; ++i) aLocales.push_back("locale-" + std::to_string(i));
+    utf42::catalog_file_builder oBuilder(aLocales, nIds);
+    std::string sSource;
+    for (std::size_t nLocale = 0; nLocale < nLocales; ++nLocale) {
+        for (std::size_t nId = 0; nId < nIds; ++nId) {
+            const std::string sText = make_sample<char>(20 + nId % 60) + std::to_string(nLocale * nIds + nId);
+            oBuilder.set(nLocale, nId, sText);
+            sSource += sText;
+            sSource += '\n';
+        }
+    }
+    const std::filesystem::path oDirectory = std::filesystem::temp_directory_path();
+    const std::string sCatalogPath = (oDirectory / "utf42_bench_catalog.bin").string();
+    const std::string sSourcePath = (oDirectory / "utf42_bench_catalog.txt").string();
+    oBuilder.write(sCatalogPath);
+    std::ofstream(sSourcePath, std::ios::binary) << sSource;
+
+    std::optional<utf42::mapped_catalog> oCatalog;
+    const double nMapped = measure_ns(1, [&] { oCatalog = utf42::mapped_catalog::open(sCatalogPath); });
+    std::vector<std::u16string> aMessages;
+    const double nParsed = measure_ns(1, [&] {
+        std::ifstream oFile(sSourcePath, std::ios::binary);
+        std::string sLine;
+        for (std::size_t i = 0; i < nIds * 3 && std::getline(oFile, sLine); ++i) {
+            // Keeps the third locale
+            if (i >= nIds * 2) aMessages.push_back(utf42::transcode<char16_t>(std::string_view(sLine)));
+        }
+    });
+    const double nMappedGet = measure_ns(nLookups, [&, i = std::size_t(0)]() mutable {
+        g_nSink = g_nSink + oCatalog->get<char16_t>(2, i++ * 7 % nIds).size();
+    });
+    const double nParsedGet = measure_ns(nLookups, [&, i = std::size_t(0)]() mutable {
+        g_nSink = g_nSink + aMessages[i++ * 7 % nIds].size();
+    });
+    std::filesystem::remove(sCatalogPath);
+    std::filesystem::remove(sSourcePath);
+
+    std::printf("Mapped catalog, %zu locales of %zu messages, utf16\n", nLocales, nIds);
+    std::printf("%-34s %10.1f\n", "open, mapped_catalog, us", nMapped / 1000);
+    std::printf("%-34s %10.1f\n", "open, read + transcode, us", nParsed / 1000);
+    std::printf("%-34s %10.1f\n", "get, mapped_catalog, ns/op", nMappedGet);
+    std::printf("%-34s %10.1f\n", "get, std::vector, ns/op", nParsedGet);
+    std::printf("\n");
+}
+
+/**
+ * @brief Hot-reload benchmark
+ *
+ * Looks up UTF-16 messages of a reloadable catalog through a snapshot per
+ * lookup, idle and while another thread reloads the catalog every
+ * millisecond, against a `std::shared_ptr` guarded by a `std::shared_mutex`
+ * under the same reloads.
+ */
+void bench_catalog_reload() {
+    constexpr std::size_t nIds = 4096;
+    constexpr std::size_t nLookups = 1 << 23;
+    const std::filesystem::path oDirectory = std::filesystem::temp_directory_path();
+    const std::string aPaths[2] = {
+        (oDirectory / "utf42_bench_reload_a.bin").string(), (oDirectory / "utf42_bench_reload_b.bin").string()
+    };
+    for (std::size_t nVersion = 0; nVersion < 2; ++nVersion) {
+        utf42::catalog_file_builder oBuilder({"en", "fr"}, nIds);
+        for (std::size_t nId = 0; nId < nIds; ++nId) {
+            oBuilder.set(0, nId, make_sample<char>(20 + nId % 60) + std::to_string(nVersion));
+            oBuilder.set(1, nId, make_sample<char>(30 + nId % 50) + std::to_string(nVersion));
+        }
+        oBuilder.write(aPaths[nVersion]);
+    }
+
+    utf42::reloadable_catalog oCatalog;
+    oCatalog.reload(aPaths[0]);
+    std::shared_mutex oMutex;
+    std::shared_ptr<utf42::mapped_catalog> pLocked =
+        std::make_shared<utf42::mapped_catalog>(std::move(*utf42::mapped_catalog::open(aPaths[0])));
+
+    auto fnSnapshot = [&, i = std::size_t(0)]() mutable {
+        const auto oSnapshot = oCatalog.read();
+        g_nSink = g_nSink + oSnapshot->get<char16_t>(1, i++ * 7 % nIds).size();
+    };
+    auto fnLocked = [&, i = std::size_t(0)]() mutable {
+        std::shared_lock<std::shared_mutex> oLock(oMutex);
+        g_nSink = g_nSink + pLocked->get<char16_t>(1, i++ * 7 % nIds).size();
+    };
+    // Runs a measurement while another thread reloads both catalogs every millisecond
+    std::size_t nReloads = 0;
+    const auto fnReloading = [&](auto fnLookup) {
+        std::atomic<bool> bDone{false};
+        std::thread oReloader([&] {
+            for (std::size_t nVersion = 1; !bDone.load(std::memory_order_relaxed); ++nVersion) {
+                oCatalog.reload(aPaths[nVersion % 2]);
+                auto pNext = std::make_shared<utf42::mapped_catalog>(
+                    std::move(*utf42::mapped_catalog::open(aPaths[nVersion % 2])));
+                {
+                    std::unique_lock<std::shared_mutex> oLock(oMutex);
+                    pLocked.swap(pNext);
+                }
+                ++nReloads;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+        const double nResult = measure_ns(nLookups, fnLookup);
+        bDone = true;
+        oReloader.join();
+        return nResult;
+    };
+    const double nIdle = measure_ns(nLookups, fnSnapshot);
+    const double nLockedIdle = measure_ns(nLookups, fnLocked);
+    const double nReloading = fnReloading(fnSnapshot);
+    const double nLockedReloading = fnReloading(fnLocked);
+    oCatalog.synchronize();
+    for (const std::string &sPath: aPaths) std::filesystem::remove(sPath);
+
+    std::printf("Reloadable catalog, %zu messages, utf16, %zu reloads\n", nIds, nReloads);
+    std::printf("%-34s %10.1f\n", "get, snapshot, idle, ns/op", nIdle);
+    std::printf("%-34s %10.1f\n", "get, snapshot, reloading, ns/op", nReloading);
+    std::printf("%-34s %10.1f\n", "get, shared_mutex, idle, ns/op", nLockedIdle);
+    std::printf("%-34s %10.1f\n", "get, shared_mutex, reloading, ns/op", nLockedReloading);
+    std::printf("\n");
+}
+#endif
+
+/**
+ * @brief Interning benchmark
+ *
+ * Threads intern names drawn from a shared set of metric names, each in
+ * its own order, into an `intern_table` or into a `std::unordered_set`
+ * behind one mutex. Most calls find an existing name, as in a server
+ * interning identifiers of incoming requests.
+ */
+void bench_intern() {
+    constexpr std::size_t nDistinct = 1 << 16;
+    constexpr std::size_t nCalls = 1 << 19;
+    std::vector<std::string> aNames;
+    for (std::size_t i = 0; i < nDistinct; ++i) {
+        aNames.push_back("tenant-" + std::to_string(i % 97) + ".metric." + make_sample<char>(8 + i % 24) +
+                         std::to_string(i));
+    }
+    // Runs nThreads threads each making nCalls calls and returns ns per call
+    const auto fnRun = [&](const std::size_t nThreads, auto fnIntern) {
+        std::vector<std::thread> aThreads;
+        const auto tStart = std::chrono::steady_clock::now();
+        for (std::size_t nThread = 0; nThread < nThreads; ++nThread) {
+            aThreads.emplace_back([&, nThread] {
+                std::size_t nLocal = 0;
+                for (std::size_t i = 0; i < nCalls; ++i) {
+                    nLocal += fnIntern(aNames[(i * (2 * nThread + 1) + nThread * 7919) % nDistinct]);
+                }
+                g_nSink = g_nSink + nLocal;
+            });
+        }
+        for (std::thread &oThread: aThreads) oThread.join();
+        const auto tEnd = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(tEnd - tStart).count() / static_cast<double>(nThreads * nCalls);
+    };
+
+    std::printf("Interning, %zu distinct names, %zu calls per thread, ns/call\n", nDistinct, nCalls);
+    std::printf("%-34s %10s %10s\n", "threads", "intern", "mutex+set");
+    for (const std::size_t nThreads: {std::size_t(1), std::size_t(4), std::size_t(16)}) {
+        utf42::intern_table oTable;
+        const double nTable = fnRun(nThreads, [&](const std::string &sName) {
+            return oTable.intern(sName).utf8().size();
+        });
+        std::mutex oMutex;
+        std::unordered_set<std::string> oSet;
+        const double nSet = fnRun(nThreads, [&](const std::string &sName) {
+            std::lock_guard<std::mutex> oLock(oMutex);
+            return oSet.insert(sName).first->size();
+        });
+        std::printf("%-34zu %10.1f %10.1f\n", nThreads, nTable, nSet);
+    }
+
+    std::printf("\n");
+}
+
+#if defined(UTF42_INTERN_SHARED)
+/**
+ * @brief Shared intern table benchmark
+ *
+ * A new worker either attaches to a shared table already holding the
+ * names, or interns them into a private table of its own. Lookups then
+ * find existing names in either table.
+ */
+void bench_shared_intern() {
+    constexpr std::size_t nDistinct = 1 << 16;
+    constexpr std::size_t nWorkers = 8;
+    constexpr std::size_t nLookups = 1 << 21;
+    std::vector<std::string> aNames;
+    for (std::size_t i = 0; i < nDistinct; ++i) {
+        aNames.push_back("tenant-" + std::to_string(i % 97) + ".metric." + make_sample<char>(8 + i % 24) +
+                         std::to_string(i));
+    }
+    std::optional<utf42::shared_intern_table> oShared = utf42::shared_intern_table::create(nDistinct, 32 << 20);
+    if (!oShared) return;
+    for (const std::string &sName: aNames) oShared->intern(sName);
+
+    std::optional<utf42::shared_intern_table> oAttached;
+    const double nAttach = measure_ns(1, [&] { oAttached = utf42::shared_intern_table::attach(oShared->fd()); });
+    utf42::intern_table oPrivate;
+    const double nBuild = measure_ns(1, [&] {
+        for (const std::string &sName: aNames) oPrivate.intern(sName);
+    });
+    const double nSharedFind = measure_ns(nLookups, [&, i = std::size_t(0)]() mutable {
+        g_nSink = g_nSink + oAttached->intern(aNames[i++ * 40503 % nDistinct]).nOffset;
+    });
+    const double nPrivateFind = measure_ns(nLookups, [&, i = std::size_t(0)]() mutable {
+        g_nSink = g_nSink + oPrivate.intern(aNames[i++ * 40503 % nDistinct]).utf8().size();
+    });
+    std::size_t nPrivateBytes = oPrivate.bytes();
+    for (const std::string &sName: aNames) {
+        // Forms a worker would build for UTF-16 and UTF-32 callers
+        nPrivateBytes += 6 * (oPrivate.intern(sName).visit<char32_t>().size() + 1) + 16;
+    }
+
+    std::printf("Shared intern table, %zu names, %zu workers\n", nDistinct, nWorkers);
+    std::printf("%-34s %10.1f\n", "worker startup, attach, us", nAttach / 1000);
+    std::printf("%-34s %10.1f\n", "worker startup, private, us", nBuild / 1000);
+    std::printf("%-34s %10.1f\n", "intern hit, shared, ns/op", nSharedFind);
+    std::printf("%-34s %10.1f\n", "intern hit, private, ns/op", nPrivateFind);
+    std::printf("%-34s %10.1f\n", "memory, shared, MiB", static_cast<double>(oShared->bytes()) / (1 << 20));
+    std::printf("%-34s %10.1f\n", "memory, private, MiB",
+                static_cast<double>(nWorkers * nPrivateBytes) / (1 << 20));
+    std::printf("\n");
+}
+#endif
+
+/**
+ * @brief Formatting benchmark
+ *
+ * Appends a right-aligned UTF-16 field to a UTF-8 log line, either
+ * transcoding it straight into the line as the `transcoded` formatter
+ * does, or transcoding it into a temporary string that is then padded
+ * into the line.
+ */
+void bench_format() {
+    constexpr std::size_t nIterations = 1 << 20;
+    utf42::detail::format_spec oSpec;
+    const std::string_view sSpec = ">72";
+    oSpec.parse(sSpec.data(), sSpec.data() + sSpec.size());
+
+    std::printf("Formatting a UTF-16 field into UTF-8, width 72, ns/op\n");
+    std::printf("%-34s %10s %10s\n", "units", "direct", "temporary");
+    for (const std::size_t nUnits: {std::size_t(8), std::size_t(32), std::size_t(64), std::size_t(256)}) {
+        const std::u16string sField = make_sample<char16_t>(nUnits);
+        std::string sLine;
+        sLine.reserve(1024);
+        const double nDirect = measure_ns(nIterations, [&] {
+            sLine.clear();
+            utf42::detail::write_formatted<char>(std::back_inserter(sLine), std::u16string_view(sField), oSpec);
+            g_nSink = g_nSink + sLine.size();
+        });
+        const double nTemporary = measure_ns(nIterations, [&] {
+            sLine.clear();
+            const std::string sTemporary = utf42::transcode<char>(std::u16string_view(sField));
+            utf42::detail::write_formatted<char>(std::back_inserter(sLine), std::string_view(sTemporary), oSpec);
+            g_nSink = g_nSink + sLine.size();
+        });
+        std::printf("%-34zu %10.1f %10.1f\n", nUnits, nDirect, nTemporary);
+    }
+    std::printf("\n");
+}
+
+#if defined(UTF42_BENCH_ICONV)
+/**
+ * @brief Prints the throughput of iconv and utf42 on one encoding pair
+ * @tparam to_t Destination character type
+ * @tparam from_t Source character type
+ * @param pName Name of the encoding pair
+ * @param pTo iconv name of the destination encoding
+ * @param pFrom iconv name of the source encoding
+ */
+template<typename to_t, typename from_t>
+void bench_iconv_pair(const char *pName, const char *pTo, const char *pFrom) {
+    constexpr std::size_t nIterations = 10;
+    std::basic_string<from_t> sInput = make_sample<from_t>(1 << 22);
+    const utf42::basic_string_view<from_t> sView(sInput);
+    std::basic_string<to_t> sOutput(utf42::max_transcoded_length<to_t, from_t>(sInput.size()), to_t());
+    const double nBytes = static_cast<double>(sInput.size() * sizeof(from_t));
+
+    const iconv_t pConverter = iconv_open(pTo, pFrom);
+    if (pConverter == reinterpret_cast<iconv_t>(-1)) return;
+    const double nIconv = measure_ns(nIterations, [&] {
+        char *pIn = reinterpret_cast<char *>(sInput.data());
+        char *pOut = reinterpret_cast<char *>(sOutput.data());
+        std::size_t nIn = sInput.size() * sizeof(from_t);
+        std::size_t nOut = sOutput.size() * sizeof(to_t);
+        iconv(pConverter, &pIn, &nIn, &pOut, &nOut);
+        g_nSink = g_nSink + nOut;
+    });
+    iconv_close(pConverter);
+
+    const double nUtf42 = measure_ns(nIterations, [&] {
+        g_nSink = g_nSink + utf42::transcode_into(sView, sOutput.data());
+    });
+    const double nUtf42Sized = measure_ns(nIterations, [&] {
+        g_nSink = g_nSink + utf42::transcoded_length<to_t>(sView);
+        g_nSink = g_nSink + utf42::transcode_into(sView, sOutput.data());
+    });
+    std::printf("%-14s %10.1f %10.1f %10.1f\n", pName, nBytes / nIconv * 1e3, nBytes / nUtf42 * 1e3,
+                nBytes / nUtf42Sized * 1e3);
+}
+
+/**
+ * @brief Large input throughput (MB/s) of iconv against utf42, single thread
+ *
+ * The last column includes the exact-length pre-pass used by `utf42_transcode`.
+ */
+void bench_iconv() {
+    std::printf("Transcoding throughput against iconv (MB/s), single thread\n");
+    std::printf("%-14s %10s %10s %10s\n", "pair", "iconv", "utf42", "utf42+len");
+    bench_iconv_pair<char16_t, char>("utf8->utf16", "UTF-16LE", "UTF-8");
+    bench_iconv_pair<char32_t, char>("utf8->utf32", "UTF-32LE", "UTF-8");
+    bench_iconv_pair<char, char16_t>("utf16->utf8", "UTF-8", "UTF-16LE");
+    bench_iconv_pair<char32_t, char16_t>("utf16->utf32", "UTF-32LE", "UTF-16LE");
+    bench_iconv_pair<char, char32_t>("utf32->utf8", "UTF-8", "UTF-32LE");
+    bench_iconv_pair<char16_t, char32_t>("utf32->utf16", "UTF-16LE", "UTF-32LE");
+    std::printf("\n");
+}
+#endif
+
+#if defined(UTF42_BENCH_POSIX)
+/**
+ * @brief Runs the pipeline between two pipes and prints throughput and latency
+ *
+ * A producer thread writes UTF-8 into the input pipe, the pipeline converts
+ * it to UTF-16 and writes it to the output pipe, drained by a consumer thread.
+ * Latency is measured from the end of each read to the sink call of the
+ * corresponding buffer.
+ *
+ * @param oOptions Sizing of the pipeline
+ */
+void bench_pipeline_case(const utf42::pipeline_options &oOptions) {
+    constexpr std::size_t nTotal = std::size_t(64) << 20;
+    const std::string sBlock = make_sample<char>(1 << 20);
+    int aInput[2] = {-1, -1}, aOutput[2] = {-1, -1};
+    if (pipe(aInput) != 0 || pipe(aOutput) != 0) return;
+
+    std::thread oProducer([&] {
+        for (std::size_t nSent = 0; nSent < nTotal; nSent += sBlock.size()) {
+            for (std::size_t nDone = 0; nDone < sBlock.size();) {
+                const ssize_t nWritten = write(aInput[1], sBlock.data() + nDone, sBlock.size() - nDone);
+                if (nWritten <= 0) break;
+                nDone += static_cast<std::size_t>(nWritten);
+            }
+        }
+        close(aInput[1]);
+    });
+    std::thread oConsumer([&] {
+        std::vector<char> aBuffer(1 << 16);
+        while (read(aOutput[0], aBuffer.data(), aBuffer.size()) > 0) {
+        }
+    });
+
+    using clock_type = std::chrono::steady_clock;
+    std::mutex oMutex;
+    std::deque<clock_type::time_point> aReads;
+    std::vector<double> aLatencies;
+    std::size_t nBytes = 0;
+    utf42::transcode_pipeline<char16_t, char> oPipeline(
+        [&](char *pBuffer, const std::size_t nCapacity) -> std::size_t {
+            const ssize_t nRead = read(aInput[0], pBuffer, nCapacity);
+            if (nRead <= 0) return 0;
+            std::lock_guard<std::mutex> oLock(oMutex);
+            aReads.push_back(clock_type::now());
+            nBytes += static_cast<std::size_t>(nRead);
+            return static_cast<std::size_t>(nRead);
+        },
+        [&](const std::u16string_view sChunk) {
+            const char *pData = reinterpret_cast<const char *>(sChunk.data());
+            for (std::size_t nDone = 0, nSize = sChunk.size() * sizeof(char16_t); nDone < nSize;) {
+                const ssize_t nWritten = write(aOutput[1], pData + nDone, nSize - nDone);
+                if (nWritten <= 0) break;
+                nDone += static_cast<std::size_t>(nWritten);
+            }
+            std::lock_guard<std::mutex> oLock(oMutex);
+            if (aReads.empty()) return;
+            aLatencies.push_back(std::chrono::duration<double, std::micro>(clock_type::now() - aReads.front()).count());
+            aReads.pop_front();
+        },
+        oOptions);
+
+    const auto tStart = clock_type::now();
+    oPipeline.run();
+    const double nSeconds = std::chrono::duration<double>(clock_type::now() - tStart).count();
+    close(aOutput[1]);
+    oProducer.join();
+    oConsumer.join();
+    close(aInput[0]);
+    close(aOutput[0]);
+
+    std::sort(aLatencies.begin(), aLatencies.end());
+    double nMean = 0;
+    for (const double nLatency: aLatencies) {
+        nMean += nLatency / static_cast<double>(aLatencies.size());
+    }
+    const double nP99 = aLatencies.empty() ? 0 : aLatencies[aLatencies.size() * 99 / 100];
+    std::printf("%8zu %8zu %8zu %10.1f %10.1f %10.1f\n", oOptions.nBufferSize, oOptions.nBuffers, oOptions.nWorkers,
+                static_cast<double>(nBytes) / nSeconds / 1e6, nMean, nP99);
+}
+
+/**
+ * @brief Pipe to pipe pipeline benchmark (UTF-8 to UTF-16)
+ */
+void bench_pipeline() {
+    std::printf("Pipe to pipe pipeline, utf8->utf16, 64 MiB\n");
+    std::printf("%8s %8s %8s %10s %10s %10s\n", "buffer", "buffers", "workers", "MB/s", "mean us", "p99 us");
+    for (const std::size_t nBufferSize: {std::size_t(16) << 10, std::size_t(64) << 10}) {
+        for (const std::size_t nWorkers: {1, 2}) {
+            utf42::pipeline_options oOptions;
+            oOptions.nBufferSize = nBufferSize;
+            oOptions.nBuffers = 4;
+            oOptions.nWorkers = nWorkers;
+            bench_pipeline_case(oOptions);
+        }
+    }
+    std::printf("\n");
+}
+#endif
+
+/**
+ * @brief Main function
+ * @return Exit status
+ */
+int main() {
+    bench_small_strings();
+    bench_large_strings();
+    bench_shared_strings();
+    bench_cache();
+    bench_aho_corasick();
+    bench_search();
+    bench_regex();
+    bench_valid();
+    bench_hash();
+    bench_string_switch();
+    bench_info();
+    bench_lazy();
+    bench_catalog();
+#if defined(UTF42_CATALOG_MMAP)
+    bench_catalog_file();
+    bench_catalog_reload();
+#endif
+    bench_intern();
+#if defined(UTF42_INTERN_SHARED)
+    bench_shared_intern();
+#endif
+    bench_format();
+#if defined(UTF42_BENCH_ICONV)
+    bench_iconv();
+#endif
+#if defined(UTF42_BENCH_POSIX)
+    bench_pipeline();
+#endif
+    return 0;
+}
@@ -0,0 +1,451 @@
+/**
+ * @file catalog.cpp
+ * @brief Offline compiler of translation files into utf42 catalogs.
+ *
+ * Reads one translation file per locale and writes either a C++ header
+ * defining a `utf42::catalog` of `cons_poly_enc` literals, or a catalog
+ * file for `utf42::mapped_catalog`. All the parsing and encoding happens at
+ * build time.
+ *
+ * Usage:
+ * @code
+ * utf42_catalog [-f header|binary] [-n NAMESPACE] [-b FALLBACK] -o OUTPUT LOCALE=FILE...
+ * @endcode
+ *
+ * Translation files are UTF-8, one `key = text` per line. Keys are C++
+ * identifiers, blank lines and lines starting with `#` are ignored, and
+ * texts may use the escapes `\\`, `\n`, `\t`, `\"`, `\uXXXX` and
+ * `\UXXXXXXXX`. Message ids are the keys in order of first appearance,
+ * starting with the fallback locale, which defaults to the first one and
+ * must translate every key: the other locales take their missing messages
+ * from it. Identical texts are stored once.
+ *
+ * @copyright MIT License
+ *
+ * This file is part of utf42.
+ * Copyright (c) 2025 Dante Doménech Martínez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "utf42.h"
+#include "utf42_transcode.h"
+#include "utf42_catalog_file.h"
+
+/**
+ * @brief Command-line options
+ */
+struct options {
+    bool bBinary = false; ///< Write a catalog file rather than a header
+    std::string sNamespace = "translations"; ///< Namespace of the generated header
+    std::string sFallback; ///< Fallback locale, empty for the first one
+    std::string sOutput; ///< Output path
+    std::vector<std::pair<std::string, std::string> > aSources; ///< Locale name and translation file of each locale
+};
+
+/**
+ * @brief Translations of every locale
+ */
+struct translations {
+    std::vector<std::string> aLocales; ///< Locale names, fallback first
+    std::vector<std::string> aKeys; ///< Message keys, in order of first appearance
+    std::vector<std::vector<std::optional<std::string> > > aTexts; ///< UTF-8 text by locale then key
+};
+
+/**
+ * @brief Checks whether a character may appear in a C++ identifier
+ * @param c Character
+ * @return True for ASCII letters, digits and underscores
+ */
+bool is_identifier_char(const char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+/**
+ * @brief Checks whether a string is a C++ identifier
+ * @param sName String to check
+ * @return True for a non empty string of identifier characters not starting with a digit
+ */
+bool is_identifier(const std::string_view sName) {
+    if (sName.empty() || (sName[0] >= '0' && sName[0] <= '9')) return false;
+    return std::all_of(sName.begin(), sName.end(), is_identifier_char);
+}
+
+/**
+ * @brief Checks whether an identifier cannot name a generated enumerator
+ *
+ * C++ keywords and alternative tokens cannot be identifiers, names with a
+ * double underscore or an underscore and a capital are reserved, and
+ * `count` ends both generated enumerations.
+ *
+ * @param sName Identifier
+ * @return True if the identifier cannot be used
+ */
+bool is_reserved(const std::string_view sName) {
+    static constexpr std::string_view aReserved[] = {
+        "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break", "case", "catch",
+        "char", "char16_t", "char32_t", "char8_t", "class", "co_await", "co_return", "co_yield", "compl", "concept",
+        "const", "const_cast", "consteval", "constexpr", "constinit", "continue", "count", "decltype", "default",
+        "delete", "do", "double", "dynamic_cast", "else", "enum", "explicit", "export", "extern", "false", "float",
+        "for", "friend", "goto", "if", "inline", "int", "long", "mutable", "namespace", "new", "noexcept", "not",
+        "not_eq", "nullptr", "operator", "or", "or_eq", "private", "protected", "public", "register",
+        "reinterpret_cast", "requires", "return", "short", "signed", "sizeof", "static", "static_assert",
+        "static_cast", "struct", "switch", "template", "this", "thread_local", "throw", "true", "try", "typedef",
+        "typeid", "typename", "union", "unsigned", "using", "virtual", "void", "volatile", "wchar_t", "while", "xor",
+        "xor_eq",
+    };
+    if (sName.find("__") != std::string_view::npos) return true;
+    if (sName.size() > 1 && sName[0] == '_' && sName[1] >= 'A' && sName[1] <= 'Z') return true;
+    return std::binary_search(std::begin(aReserved), std::end(aReserved), sName);
+}
+
+/**
+ * @brief Turns a locale name into an identifier, `pt-BR` into `pt_BR`
+ * @param sName Locale name
+ * @return The identifier
+ */
+std::string locale_identifier(const std::string &sName) {
+    std::string sResult = sName;
+    std::replace_if(sResult.begin(), sResult.end(), [](const char c) { return !is_identifier_char(c); }, '_');
+    if (!is_identifier(sResult)) sResult = "_" + sResult;
+    return sResult;
+}
+
+/**
+ * @brief Decodes the escapes of a translation
+ * @param sText Text after the `=`
+ * @param sResult Decoded UTF-8 text
+ * @return True if every escape is valid
+ */
+bool unescape(const std::string_view sText, std::string &sResult) {
+    sResult.clear();
+    for (std::size_t i = 0; i < sText.size(); ++i) {
+        if (sText[i] != '\\') {
+            sResult += sText[i];
+            continue;
+        }
+        if (++i == sText.size()) return false;
+        switch (sText[i]) {
+            case '\\': sResult += '\\'; break;
+            case 'n': sResult += '\n'; break;
+            case 't': sResult += '\t'; break;
+            case '"': sResult += '"'; break;
+            case 'u':
+            case 'U': {
+                const std::size_t nDigits = sText[i] == 'u' ? 4 : 8;
+                if (i + nDigits >= sText.size()) return false;
+                char32_t cCode = 0;
+                for (std::size_t j = 1; j <= nDigits; ++j) {
+                    const char c = sText[i + j];
+                    const int nDigit = c >= '0' && c <= '9' ? c - '0'
+                                       : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                                       : c >= 'A' && c <= 'F' ? c - 'A' + 10
+                                       : -1;
+                    if (nDigit < 0) return false;
+                    cCode = cCode << 4 | static_cast<char32_t>(nDigit);
+                }
+                if (cCode > 0x10FFFF || (cCode >= 0xD800 && cCode <= 0xDFFF)) return false;
+                char aUnits[4];
+                sResult.append(aUnits, utf42::encode(cCode, aUnits));
+                i += nDigits;
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Reads the translation file of a locale
+ * @param sPath Path of the file
+ * @param oTranslations Translations, extended with the locale
+ * @return True on success, errors are printed
+ */
+bool read_locale(const std::string &sPath, translations &oTranslations) {
+    std::ifstream oFile(sPath, std::ios::binary);
+    if (!oFile) {
+        std::cerr << "utf42_catalog: cannot read " << sPath << std::endl;
+        return false;
+    }
+    std::unordered_map<std::string, std::size_t> mKeys;
+    for (std::size_t i = 0; i < oTranslations.aKeys.size(); ++i) mKeys.emplace(oTranslations.aKeys[i], i);
+    std::vector<std::optional<std::string> > &aTexts = oTranslations.aTexts.emplace_back(oTranslations.aKeys.size());
+
+    std::string sLine;
+    std::string sText;
+    for (std::size_t nLine = 1; std::getline(oFile, sLine); ++nLine) {
+        if (!sLine.empty() && sLine.back() == '\r') sLine.pop_back();
+        const std::string_view sView(sLine);
+        const std::size_t nStart = sView.find_first_not_of(" \t");
+        if (nStart == std::string_view::npos || sView[nStart] == '#') continue;
+        const std::size_t nEqual = sView.find('=');
+        const std::size_t nKeyEnd = nEqual == std::string_view::npos ? nEqual : sView.find_last_not_of(" \t", nEqual - 1);
+        const std::size_t nTextStart = nEqual == std::string_view::npos ? nEqual : sView.find_first_not_of(" \t", nEqual + 1);
+        const std::string sKey(nKeyEnd == std::string_view::npos || nKeyEnd < nStart
+                                   ? std::string_view()
+                                   : sView.substr(nStart, nKeyEnd + 1 - nStart));
+        const char *pError = nullptr;
+        if (!is_identifier(sKey)) pError = "expected key = text";
+        else if (is_reserved(sKey)) pError = "key is a reserved word";
+        else if (!utf42::validate(sView)) pError = "ill-formed UTF-8";
+        else if (!unescape(nTextStart == std::string_view::npos ? std::string_view() : sView.substr(nTextStart), sText)) pError = "bad escape";
+        if (pError == nullptr) {
+            const auto [itKey, bNew] = mKeys.try_emplace(sKey, oTranslations.aKeys.size());
+            if (bNew) {
+                oTranslations.aKeys.push_back(sKey);
+                aTexts.emplace_back();
+            }
+            if (aTexts[itKey->second]) pError = "duplicate key";
+            else aTexts[itKey->second] = sText;
+        }
+        if (pError != nullptr) {
+            std::cerr << sPath << ":" << nLine << ": " << pError << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Writes a UTF-8 text as the body of a C++ string literal
+ *
+ * Non ASCII code points become universal character names, so the literal
+ * is encoded correctly whatever the source encoding assumed by the compiler.
+ *
+ * @param oOut Stream
+ * @param sText UTF-8 text
+ */
+void write_literal(std::ostream &oOut, const std::string &sText) {
+    static constexpr char aHex[] = "0123456789ABCDEF";
+    const std::u32string sCodes = utf42::transcode<char32_t>(std::string_view(sText));
+    for (const char32_t cCode: sCodes) {
+        if (cCode == '"' || cCode == '\\') {
+            oOut << '\\' << static_cast<char>(cCode);
+        } else if (cCode >= 0x20 && cCode < 0x7F) {
+            oOut << static_cast<char>(cCode);
+        } else if (cCode < 0x20 || cCode == 0x7F) {
+            // Three octal digits, so a following digit is never taken into the escape
+            oOut << '\\' << static_cast<char>('0' + (cCode >> 6)) << static_cast<char>('0' + ((cCode >> 3) & 7))
+                    << static_cast<char>('0' + (cCode & 7));
+        } else {
+            const int nDigits = cCode > 0xFFFF ? 8 : 4;
+            oOut << (nDigits == 8 ? "\\U" : "\\u");
+            for (int i = nDigits - 1; i >= 0; --i) oOut << aHex[(cCode >> (4 * i)) & 0xF];
+        }
+    }
+}
+
+/**
+ * @brief Writes a header defining the catalog
+ * @param oTranslations Translations
+ * @param oOptions Options
+ * @return The header
+ */
+std::string make_header(const translations &oTranslations, const options &oOptions) {
+    std::ostringstream oOut;
+    std::string sGuard = "UTF42_CATALOG_" + oOptions.sNamespace;
+    std::replace(sGuard.begin(), sGuard.end(), ':', '_');
+    std::transform(sGuard.begin(), sGuard.end(), sGuard.begin(),
+                   [](const char c) { return c >= 'a' && c <= 'z' ? static_cast<char>(c - 'a' + 'A') : c; });
+
+    oOut << "// Generated by utf42_catalog, do not edit.\n"
+            << "#ifndef " << sGuard << "\n#define " << sGuard << "\n\n"
+            << "#include <string_view>\n\n#include \"utf42_catalog.h\"\n\n"
+            << "namespace " << oOptions.sNamespace << " {\n"
+            << "    /// Messages\n    enum class message {\n";
+    for (const std::string &sKey: oTranslations.aKeys) oOut << "        " << sKey << ",\n";
+    oOut << "        count\n    };\n\n    /// Locales\n    enum class locale {\n";
+    for (const std::string &sLocale: oTranslations.aLocales) oOut << "        " << locale_identifier(sLocale) << ",\n";
+    oOut << "        count\n    };\n\n    /// Names of the locales\n    inline constexpr std::string_view locale_names[] = {\n";
+    for (const std::string &sLocale: oTranslations.aLocales) {
+        oOut << "        \"";
+        write_literal(oOut, sLocale);
+        oOut << "\",\n";
+    }
+
+    // Each distinct text is encoded once
+    std::unordered_map<std::string, std::size_t> mTexts;
+    std::vector<const std::string *> aDistinct;
+    std::vector<std::vector<std::size_t> > aIndex(oTranslations.aLocales.size());
+    for (std::size_t nLocale = 0; nLocale < oTranslations.aLocales.size(); ++nLocale) {
+        for (const std::optional<std::string> &oText: oTranslations.aTexts[nLocale]) {
+            if (!oText) {
+                aIndex[nLocale].push_back(0);
+                continue;
+            }
+            const auto [itText, bNew] = mTexts.try_emplace(*oText, aDistinct.size());
+            if (bNew) aDistinct.push_back(&itText->first);
+            aIndex[nLocale].push_back(itText->second);
+        }
+    }
+    oOut << "    };\n\n    namespace detail {\n        /// Distinct texts\n"
+            << "        inline constexpr utf42::poly_enc texts[] = {\n";
+    for (const std::string *pText: aDistinct) {
+        oOut << "            cons_poly_enc(\"";
+        write_literal(oOut, *pText);
+        oOut << "\"),\n";
+    }
+    oOut << "        };\n    }\n\n    /// Catalog, untranslated messages fall back to " << oTranslations.aLocales[0] << "\n"
+            << "    inline constexpr utf42::catalog<message, locale> catalog({\n";
+    for (std::size_t nLocale = 0; nLocale < oTranslations.aLocales.size(); ++nLocale) {
+        for (std::size_t nId = 0; nId < oTranslations.aKeys.size(); ++nId) {
+            if (!oTranslations.aTexts[nLocale][nId]) continue;
+            oOut << "        {message::" << oTranslations.aKeys[nId] << ", locale::"
+                    << locale_identifier(oTranslations.aLocales[nLocale]) << ", detail::texts["
+                    << aIndex[nLocale][nId] << "]},\n";
+        }
+    }
+    oOut << "    }, locale::" << locale_identifier(oTranslations.aLocales[0]) << ");\n"
+            << "} // namespace " << oOptions.sNamespace << "\n\n#endif // " << sGuard << "\n";
+    return oOut.str();
+}
+
+/**
+ * @brief Prints the command-line help
+ */
+void usage() {
+    std::cerr << "usage: utf42_catalog [-f header|binary] [-n NAMESPACE] [-b FALLBACK] -o OUTPUT LOCALE=FILE...\n"
+            << "  -f FORMAT     header of cons_poly_enc tables (default) or binary catalog file\n"
+            << "  -n NAMESPACE  namespace of the generated header (default translations)\n"
+            << "  -b FALLBACK   locale of untranslated messages (default the first one)\n"
+            << "  -o OUTPUT     output path\n"
+            << "  LOCALE=FILE   translation file of a locale, lines of key = text" << std::endl;
+}
+
+/**
+ * @brief Parses the command line
+ * @param nArgs Number of arguments
+ * @param pArgs Arguments
+ * @param oOptions Parsed options
+ * @return True on success
+ */
+bool parse_options(const int nArgs, char **pArgs, options &oOptions) {
+    for (int i = 1; i < nArgs; ++i) {
+        const std::string sArg = pArgs[i];
+        const bool bHasValue = i + 1 < nArgs;
+        if (sArg == "-f" && bHasValue) {
+            const std::string sFormat = pArgs[++i];
+            if (sFormat != "header" && sFormat != "binary") return false;
+            oOptions.bBinary = sFormat == "binary";
+        } else if (sArg == "-n" && bHasValue) {
+            oOptions.sNamespace = pArgs[++i];
+        } else if (sArg == "-b" && bHasValue) {
+            oOptions.sFallback = pArgs[++i];
+        } else if (sArg == "-o" && bHasValue) {
+            oOptions.sOutput = pArgs[++i];
+        } else if (sArg.size() > 1 && sArg[0] == '-') {
+            return false;
+        } else {
+            const std::size_t nEqual = sArg.find('=');
+            if (nEqual == 0 || nEqual == std::string::npos) return false;
+            oOptions.aSources.emplace_back(sArg.substr(0, nEqual), sArg.substr(nEqual + 1));
+        }
+    }
+    return !oOptions.sOutput.empty() && !oOptions.aSources.empty();
+}
+
+/**
+ * @brief Main function
+ * @param nArgs Number of arguments
+ * @param pArgs Arguments
+ * @return Exit status
+ */
+int main(const int nArgs, char **pArgs) {
+    options oOptions;
+    if (!parse_options(nArgs, pArgs, oOptions)) {
+        usage();
+        return 2;
+    }
+
+    // The fallback locale is read first so that its keys come first
+    if (!oOptions.sFallback.empty()) {
+        const auto itFallback = std::find_if(oOptions.aSources.begin(), oOptions.aSources.end(),
+                                             [&](const auto &oSource) { return oSource.first == oOptions.sFallback; });
+        if (itFallback == oOptions.aSources.end()) {
+            std::cerr << "utf42_catalog: no translation file for the fallback locale " << oOptions.sFallback << std::endl;
+            return 1;
+        }
+        std::rotate(oOptions.aSources.begin(), itFallback, itFallback + 1);
+    }
+    translations oTranslations;
+    std::unordered_map<std::string, std::string> mIdentifiers;
+    for (const auto &[sLocale, sPath]: oOptions.aSources) {
+        if (std::find(oTranslations.aLocales.begin(), oTranslations.aLocales.end(), sLocale) != oTranslations.aLocales.end()) {
+            std::cerr << "utf42_catalog: locale " << sLocale << " given twice" << std::endl;
+            return 1;
+        }
+        // Locales name enumerators of the header, which must be distinct identifiers
+        const std::string sIdentifier = locale_identifier(sLocale);
+        const auto [itIdentifier, bNew] = mIdentifiers.try_emplace(sIdentifier, sLocale);
+        if (is_reserved(sIdentifier)) {
+            std::cerr << sPath << ": locale " << sLocale << " is a reserved word" << std::endl;
+            return 1;
+        }
+        if (!bNew) {
+            std::cerr << sPath << ": locale " << sLocale << " has the same identifier " << sIdentifier
+                    << " as locale " << itIdentifier->second << std::endl;
+            return 1;
+        }
+        oTranslations.aLocales.push_back(sLocale);
+        if (!read_locale(sPath, oTranslations)) return 1;
+    }
+    for (std::vector<std::optional<std::string> > &aTexts: oTranslations.aTexts) aTexts.resize(oTranslations.aKeys.size());
+    for (std::size_t nId = 0; nId < oTranslations.aKeys.size(); ++nId) {
+        if (!oTranslations.aTexts[0][nId]) {
+            std::cerr << "utf42_catalog: " << oTranslations.aKeys[nId] << " is missing from the fallback locale "
+                    << oTranslations.aLocales[0] << std::endl;
+            return 1;
+        }
+    }
+
+    if (oOptions.bBinary) {
+        utf42::catalog_file_builder oBuilder(oTranslations.aLocales, oTranslations.aKeys.size());
+        for (std::size_t nLocale = 0; nLocale < oTranslations.aLocales.size(); ++nLocale) {
+            for (std::size_t nId = 0; nId < oTranslations.aKeys.size(); ++nId) {
+                const std::optional<std::string> &oText = oTranslations.aTexts[nLocale][nId];
+                oBuilder.set(nLocale, nId, oText ? *oText : *oTranslations.aTexts[0][nId]);
+            }
+        }
+        if (!oBuilder.write(oOptions.sOutput)) {
+            std::cerr << "utf42_catalog: cannot write " << oOptions.sOutput << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    std::ofstream oFile(oOptions.sOutput, std::ios::binary | std::ios::trunc);
+    oFile << make_header(oTranslations, oOptions);
+    if (!oFile.flush()) {
+        std::cerr << "utf42_catalog: cannot write " << oOptions.sOutput << std::endl;
+        return 1;
+    }
+    return 0;
+}
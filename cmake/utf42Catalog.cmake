@@ -0,0 +1,60 @@
+# ------------------------------------------------------------
+# utf42_add_catalog, shared by the build tree and the installed package
+# ------------------------------------------------------------
+# utf42_add_catalog(<output>
+#         [FORMAT header|binary] [NAMESPACE <namespace>] [FALLBACK <locale>]
+#         SOURCES <locale>=<file>...)
+#
+# Compiles translation files into a header of cons_poly_enc tables or into
+# a catalog file for utf42::mapped_catalog, rebuilt whenever a source changes.
+# Relative paths are taken from the current source and binary directories;
+# list the output among the sources of a target to have it built.
+function(utf42_add_catalog OUTPUT)
+    cmake_parse_arguments(PARSE_ARGV 1 ARG "" "FORMAT;NAMESPACE;FALLBACK" "SOURCES")
+    if (NOT ARG_SOURCES)
+        message(FATAL_ERROR "utf42_add_catalog: no SOURCES given for ${OUTPUT}")
+    endif ()
+
+    cmake_path(ABSOLUTE_PATH OUTPUT BASE_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR})
+    set(arguments -o ${OUTPUT})
+    if (ARG_FORMAT)
+        list(APPEND arguments -f ${ARG_FORMAT})
+    endif ()
+    if (ARG_NAMESPACE)
+        list(APPEND arguments -n ${ARG_NAMESPACE})
+    endif ()
+    if (ARG_FALLBACK)
+        list(APPEND arguments -b ${ARG_FALLBACK})
+    endif ()
+
+    set(depends)
+    foreach (source IN LISTS ARG_SOURCES)
+        string(FIND "${source}" "=" equal)
+        if (equal LESS 1)
+            message(FATAL_ERROR "utf42_add_catalog: expected <locale>=<file>, got ${source}")
+        endif ()
+        string(SUBSTRING "${source}" 0 ${equal} locale)
+        math(EXPR equal "${equal} + 1")
+        string(SUBSTRING "${source}" ${equal} -1 file)
+        cmake_path(ABSOLUTE_PATH file BASE_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR})
+        list(APPEND arguments "${locale}=${file}")
+        list(APPEND depends ${file})
+    endforeach ()
+
+    # The compiler is built by this project, or imported from an installed one
+    if (NOT TARGET utf42::catalog)
+        message(FATAL_ERROR "utf42_add_catalog: the utf42::catalog executable is not available")
+    endif ()
+    get_target_property(tool utf42::catalog ALIASED_TARGET)
+    if (NOT tool)
+        set(tool $<TARGET_FILE:utf42::catalog>)
+    endif ()
+
+    add_custom_command(
+            OUTPUT ${OUTPUT}
+            COMMAND ${tool} ${arguments}
+            DEPENDS ${tool} ${depends}
+            COMMENT "Compiling translation catalog ${OUTPUT}"
+            VERBATIM
+    )
+endfunction()
@@ -0,0 +1,5 @@
+# ------------------------------------------------------------
+# Package configuration of utf42
+# ------------------------------------------------------------
+include(${CMAKE_CURRENT_LIST_DIR}/utf42Targets.cmake)
+include(${CMAKE_CURRENT_LIST_DIR}/utf42Catalog.cmake)
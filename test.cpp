@@ -29,11 +29,48 @@
  * SOFTWARE.
  */
 
+#include <algorithm>
+#include <filesystem>
 #include <iostream>
+#include <optional>
+#include <random>
+#include <regex>
+#include <stdexcept>
 #include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
 #include <utf8cpp/utf8.h>
 
 #include "utf42.h"
+#if __cplusplus >= 201703L
+#include "utf42_transcode.h"
+#include "utf42_pipeline.h"
+#include "utf42_detect.h"
+#include "utf42_poly_string.h"
+#include "utf42_cache.h"
+#endif
+#if __cplusplus >= 202002L
+#include "utf42_coroutine.h"
+#include "utf42_perfect_hash.h"
+#include "utf42_aho_corasick.h"
+#include "utf42_search.h"
+#include "utf42_regex.h"
+#include "utf42_valid.h"
+#include "utf42_hash.h"
+#include "utf42_string_switch.h"
+#include "utf42_info.h"
+#include "utf42_lazy.h"
+#include "utf42_catalog.h"
+#include "utf42_catalog_file.h"
+#include "utf42_catalog_reload.h"
+#include "utf42_intern.h"
+#include "utf42_format.h"
+
+#if defined(UTF42_INTERN_SHARED)
+#include <sys/wait.h>
+#endif
+#endif
 
 #if __cplusplus <= 201402L
 namespace std {
@@ -147,6 +184,1558 @@ void test_template() {
     custom_assert(str_a, str_32);
 }
 
+#if __cplusplus >= 201703L
+/**
+ * @brief Checks one transcoding direction against the compiler generated literals
+ * @tparam to_t Destination character type
+ * @tparam from_t Source character type
+ * @param oText Polymorphic literal used as reference
+ */
+template<typename to_t, typename from_t>
+void check_transcode(const utf42::poly_enc &oText) {
+    const std::basic_string<to_t> sResult = utf42::transcode<to_t>(oText.visit<from_t>());
+    if (sResult != oText.visit<to_t>()) {
+        std::cerr << "transcode mismatch " << sizeof(from_t) << " -> " << sizeof(to_t) << std::endl;
+        std::abort();
+    }
+    if (utf42::transcoded_length<to_t>(oText.visit<from_t>()) != sResult.size()) {
+        std::cerr << "transcoded_length mismatch " << sizeof(from_t) << " -> " << sizeof(to_t) << std::endl;
+        std::abort();
+    }
+}
+
+/**
+ * @brief Checks every transcoding direction from a source character type
+ * @tparam from_t Source character type
+ * @param oText Polymorphic literal used as reference
+ */
+template<typename from_t>
+void check_transcode_from(const utf42::poly_enc &oText) {
+    check_transcode<char, from_t>(oText);
+    check_transcode<wchar_t, from_t>(oText);
+#if __cplusplus >= 202002L
+    check_transcode<char8_t, from_t>(oText);
+#endif
+    check_transcode<char16_t, from_t>(oText);
+    check_transcode<char32_t, from_t>(oText);
+}
+
+/**
+ * @brief Performs runtime transcoding tests
+ */
+void test_transcode() {
+    // Short strings take the small-string path, long strings the general kernel
+    constexpr utf42::poly_enc aTexts[] = {
+        cons_poly_enc(""),
+        cons_poly_enc("Hello World \U0001F600!"),
+        cons_poly_enc("Gr\u00FC\u00DFe, \u4E16\u754C \U0001F600 \u00E9t\u00E9 -- plain ASCII tail to exceed the threshold"),
+        cons_poly_enc("0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef\u00FF"),
+    };
+    for (const utf42::poly_enc &oText: aTexts) {
+        check_transcode_from<char>(oText);
+        check_transcode_from<wchar_t>(oText);
+#if __cplusplus >= 202002L
+        check_transcode_from<char8_t>(oText);
+#endif
+        check_transcode_from<char16_t>(oText);
+        check_transcode_from<char32_t>(oText);
+    }
+
+    // Ill-formed input is replaced by U+FFFD (one per maximal subpart)
+    custom_assert(utf42::transcode<char>(std::string_view("a\xE2\x82z\xFF")), "a\xEF\xBF\xBDz\xEF\xBF\xBD");
+    const char16_t aLone[] = {u'a', 0xD800, u'b', 0xDC00};
+    if (utf42::transcode<char32_t>(std::u16string_view(aLone, 4)) != U"a\uFFFDb\uFFFD") {
+        std::cerr << "lone surrogates not replaced" << std::endl;
+        std::abort();
+    }
+    if (utf42::validate(std::string_view("\xED\xA0\x80")) || !utf42::validate(std::string_view("\xF0\x9F\x98\x80"))) {
+        std::cerr << "validate failed" << std::endl;
+        std::abort();
+    }
+}
+
+/**
+ * @brief Performs streaming transcoding tests, cutting the input everywhere
+ */
+void test_stream() {
+    const std::string sInput = "a\xC3\xA9\xE4\xB8\x96\xF0\x9F\x98\x80z\xE2\x82\xFF\xF0\x9F\x98";
+    const std::u16string sExpected = utf42::transcode<char16_t>(std::string_view(sInput));
+    for (std::size_t nCut1 = 0; nCut1 <= sInput.size(); ++nCut1) {
+        for (std::size_t nCut2 = nCut1; nCut2 <= sInput.size(); ++nCut2) {
+            utf42::stream_transcoder<char16_t, char> oStream;
+            std::u16string sResult(3 * utf42::stream_transcoder<char16_t, char>::max_output(sInput.size()), u'\0');
+            std::size_t nSize = 0;
+            const std::string_view sView(sInput);
+            nSize += oStream.transcode(sView.substr(0, nCut1), sResult.data() + nSize);
+            nSize += oStream.transcode(sView.substr(nCut1, nCut2 - nCut1), sResult.data() + nSize);
+            nSize += oStream.transcode(sView.substr(nCut2), sResult.data() + nSize);
+            nSize += oStream.finish(sResult.data() + nSize);
+            sResult.resize(nSize);
+            if (sResult != sExpected) {
+                std::cerr << "stream mismatch at cuts " << nCut1 << ", " << nCut2 << std::endl;
+                std::abort();
+            }
+        }
+    }
+}
+
+/**
+ * @brief Performs pipeline tests with tiny buffers and several workers
+ */
+void test_pipeline() {
+    std::string sInput;
+    for (int i = 0; i < 200; ++i) {
+        sInput += "key\xC3\xA9-\xE4\xB8\x96\xF0\x9F\x98\x80;";
+    }
+    sInput += "\xE2\x82";
+    const std::u32string sExpected = utf42::transcode<char32_t>(std::string_view(sInput));
+    for (std::size_t nBufferSize = 1; nBufferSize <= 7; ++nBufferSize) {
+        std::size_t nOffset = 0;
+        std::u32string sResult;
+        utf42::pipeline_options oOptions;
+        oOptions.nBufferSize = nBufferSize;
+        oOptions.nBuffers = 3;
+        oOptions.nWorkers = 2;
+        utf42::transcode_pipeline<char32_t, char> oPipeline(
+            [&](char *pBuffer, const std::size_t nCapacity) {
+                const std::size_t nRead = std::min(nCapacity, sInput.size() - nOffset);
+                std::memcpy(pBuffer, sInput.data() + nOffset, nRead);
+                nOffset += nRead;
+                return nRead;
+            },
+            [&](const std::u32string_view sChunk) { sResult.append(sChunk); },
+            oOptions);
+        oPipeline.run();
+        if (sResult != sExpected) {
+            std::cerr << "pipeline mismatch with buffers of " << nBufferSize << std::endl;
+            std::abort();
+        }
+    }
+}
+
+/**
+ * @brief Checks the encoding detected for a byte buffer
+ * @param sBytes Bytes to inspect
+ * @param eExpected Expected encoding
+ * @param nBom Expected byte order mark size
+ */
+void check_detect(const std::string &sBytes, const utf42::byte_encoding eExpected, const std::size_t nBom) {
+    const utf42::detected_encoding oResult = utf42::detect_encoding(sBytes);
+    if (oResult.eEncoding != eExpected || oResult.nBom != nBom) {
+        std::cerr << "detect_encoding mismatch: " << static_cast<int>(oResult.eEncoding) << " != "
+                << static_cast<int>(eExpected) << std::endl;
+        std::abort();
+    }
+}
+
+/**
+ * @brief Performs encoding detection tests
+ */
+void test_detect() {
+    using utf42::byte_encoding;
+    const std::string sAscii = "The quick brown fox jumps over the lazy dog, again and again.";
+    std::string sUtf16Le, sUtf16Be, sUtf32Le, sUtf32Be;
+    for (const char cChar: sAscii) {
+        sUtf16Le += std::string{cChar, '\0'};
+        sUtf16Be += std::string{'\0', cChar};
+        sUtf32Le += std::string{cChar, '\0', '\0', '\0'};
+        sUtf32Be += std::string{'\0', '\0', '\0', cChar};
+    }
+    // Byte order marks
+    check_detect("\xEF\xBB\xBF" + sAscii, byte_encoding::utf8, 3);
+    check_detect("\xFF\xFE" + sUtf16Le, byte_encoding::utf16le, 2);
+    check_detect("\xFE\xFF" + sUtf16Be, byte_encoding::utf16be, 2);
+    check_detect(std::string("\xFF\xFE\0\0", 4) + sUtf32Le, byte_encoding::utf32le, 4);
+    check_detect(std::string("\0\0\xFE\xFF", 4) + sUtf32Be, byte_encoding::utf32be, 4);
+    // Sniffing
+    check_detect(sAscii, byte_encoding::utf8, 0);
+    check_detect("Gr\xC3\xBC\xC3\x9F Gott \xF0\x9F\x98\x80", byte_encoding::utf8, 0);
+    check_detect(sUtf16Le, byte_encoding::utf16le, 0);
+    check_detect(sUtf16Be, byte_encoding::utf16be, 0);
+    check_detect(sUtf32Le, byte_encoding::utf32le, 0);
+    check_detect(sUtf32Be, byte_encoding::utf32be, 0);
+    // Text without ASCII leaves no zero bytes in UTF-16, its pattern alone must tell
+    const std::u16string sCjk = u"天地玄黄宇宙洪荒日月盈昃辰宿列张寒来暑往秋收冬藏闰余成岁律吕调阳云腾致雨露结为霜金生丽水玉出昆冈";
+    std::string sCjkLe, sCjkBe;
+    for (const char16_t cUnit: sCjk) {
+        sCjkLe += std::string{static_cast<char>(cUnit & 0xFF), static_cast<char>(cUnit >> 8)};
+        sCjkBe += std::string{static_cast<char>(cUnit >> 8), static_cast<char>(cUnit & 0xFF)};
+    }
+    check_detect(sCjkLe, byte_encoding::utf16le, 0);
+    check_detect(sCjkBe, byte_encoding::utf16be, 0);
+    check_detect("\xFF\xFF\xC0\xC0\xC0", byte_encoding::unknown, 0);
+    // 8-bit text of even length is well-formed UTF-16 too, but does not look like it
+    check_detect("Hello, world! caf\xE9 au lait.\n", byte_encoding::unknown, 0);
+    check_detect("Stra\xDF" "e und Pl\xE4tze, \xE9t\xE9 \xE0 la campagne, ni\xF1os.", byte_encoding::unknown, 0);
+    // A prefix may end inside a code point
+    if (utf42::detect_encoding(sAscii + "\xE4\xB8\x96", sAscii.size() + 2).eEncoding != byte_encoding::utf8) {
+        std::cerr << "detect_encoding rejects a cut prefix" << std::endl;
+        std::abort();
+    }
+}
+
+/**
+ * @brief Checks one representation of a `poly_string` against the compiler generated literal
+ * @tparam char_t Character type of the representation
+ * @param oString String under test
+ * @param oText Polymorphic literal used as reference
+ */
+template<typename char_t>
+void check_poly_string(const utf42::poly_string &oString, const utf42::poly_enc &oText) {
+    const std::basic_string_view<char_t> sView = oString.visit<char_t>();
+    if (sView != oText.visit<char_t>() || sView.data()[sView.size()] != 0 || !oString.is_materialized<char_t>()) {
+        std::cerr << "poly_string mismatch for " << sizeof(char_t) << " byte units" << std::endl;
+        std::abort();
+    }
+}
+
+/**
+ * @brief Checks every representation of a `poly_string`
+ * @tparam from_t Character type of the original
+ * @param oText Polymorphic literal used as reference
+ */
+template<typename from_t>
+void check_poly_string_from(const utf42::poly_enc &oText) {
+    const utf42::poly_string oString(oText.visit<from_t>());
+    const std::basic_string_view<from_t> sOriginal = oString.visit<from_t>();
+    check_poly_string<char>(oString, oText);
+    check_poly_string<char16_t>(oString, oText);
+    const utf42::poly_string oCopy = oString;
+    check_poly_string<wchar_t>(oString, oText);
+#if __cplusplus >= 202002L
+    check_poly_string<char8_t>(oString, oText);
+#endif
+    check_poly_string<char32_t>(oString, oText);
+    check_poly_string<char32_t>(oCopy, oText);
+    // Earlier views survive later materializations
+    if (sOriginal != oText.visit<from_t>()) {
+        std::cerr << "poly_string invalidated a view" << std::endl;
+        std::abort();
+    }
+}
+
+/**
+ * @brief Performs owning polymorphic string tests
+ */
+void test_poly_string() {
+    constexpr utf42::poly_enc aTexts[] = {
+        cons_poly_enc(""),
+        cons_poly_enc("Hello World \U0001F600!"),
+        cons_poly_enc("Gr\u00FC\u00DFe, \u4E16\u754C \U0001F600 \u00E9t\u00E9 -- plain ASCII tail to exceed the threshold"),
+    };
+    for (const utf42::poly_enc &oText: aTexts) {
+        check_poly_string_from<char>(oText);
+        check_poly_string_from<wchar_t>(oText);
+#if __cplusplus >= 202002L
+        check_poly_string_from<char8_t>(oText);
+#endif
+        check_poly_string_from<char16_t>(oText);
+        check_poly_string_from<char32_t>(oText);
+    }
+
+    utf42::poly_string oString(u"caf\u00E9");
+    if (oString.source_encoding() != utf42::encoding::utf16 || oString.is_materialized<char>()) {
+        std::cerr << "poly_string materialized eagerly" << std::endl;
+        std::abort();
+    }
+    const utf42::poly_string oMoved = std::move(oString);
+    custom_assert(std::string(oMoved.visit<char>()), "caf\xC3\xA9");
+    oString = oMoved;
+    custom_assert(std::string(oString.visit<char>()), "caf\xC3\xA9");
+
+    // Threads racing on the same encodings all see the published representations
+    constexpr utf42::poly_enc oText = cons_poly_enc("Gr\u00FC\u00DFe, \u4E16\u754C \U0001F600");
+    for (int nRound = 0; nRound < 50; ++nRound) {
+        const utf42::poly_string oShared(oText.visit<char>());
+        std::vector<std::thread> aThreads;
+        for (int i = 0; i < 8; ++i) {
+            aThreads.emplace_back([&oShared, &oText, i] {
+                if (i % 2 == 0) check_poly_string<char16_t>(oShared, oText);
+                check_poly_string<char32_t>(oShared, oText);
+                check_poly_string<wchar_t>(oShared, oText);
+                check_poly_string<char16_t>(oShared, oText);
+            });
+        }
+        for (std::thread &oThread: aThreads) {
+            oThread.join();
+        }
+    }
+}
+
+/**
+ * @brief Performs memoizing transcoding cache tests
+ */
+void test_cache() {
+    utf42::cache_options oOptions;
+    oOptions.nCapacity = 4;
+    oOptions.nShards = 1;
+    oOptions.nMaxLength = 64;
+    utf42::transcode_cache oCache(oOptions);
+
+    const utf42::cached_string<char16_t> sFirst = oCache.transcode<char16_t>(std::string_view("caf\xC3\xA9"));
+    const utf42::cached_string<char16_t> sAgain = oCache.transcode<char16_t>(std::string_view("caf\xC3\xA9"));
+    const utf42::cached_string<char32_t> sOther = oCache.transcode<char32_t>(std::string_view("caf\xC3\xA9"));
+    if (sFirst.view() != u"caf\u00E9" || sAgain.data() != sFirst.data() || sOther.view() != U"caf\u00E9" ||
+        sFirst.data()[sFirst.size()] != 0) {
+        std::cerr << "transcode_cache returned a wrong result" << std::endl;
+        std::abort();
+    }
+
+    // Keep one key hot while cycling others through the remaining slots
+    for (int i = 0; i < 20; ++i) {
+        const std::string sKey = "key" + std::to_string(i);
+        custom_assert(std::string(oCache.transcode<char>(std::u16string_view(u"hot")).view()), "hot");
+        const utf42::cached_string<char> sCold = oCache.transcode<char>(std::string_view(sKey));
+        custom_assert(std::string(sCold.view()), sKey);
+    }
+    // Evicted entries stay alive through their handles
+    if (sFirst.view() != u"caf\u00E9") {
+        std::cerr << "transcode_cache invalidated a handle" << std::endl;
+        std::abort();
+    }
+    const utf42::cache_statistics oStatistics = oCache.statistics();
+    if (oCache.size() != 4 || oStatistics.nHits < 20 || oStatistics.nEvictions == 0 ||
+        oStatistics.nHits + oStatistics.nMisses != 43) {
+        std::cerr << "transcode_cache counters are wrong" << std::endl;
+        std::abort();
+    }
+    oCache.transcode<char>(std::u16string_view(u"hot"));
+    if (oCache.statistics().nHits != oStatistics.nHits + 1) {
+        std::cerr << "transcode_cache evicted a hot key" << std::endl;
+        std::abort();
+    }
+
+    // Long inputs are not cached
+    const std::string sLong(100, 'x');
+    custom_assert(std::string(oCache.transcode<char>(std::string_view(sLong)).view()), sLong);
+    oCache.clear();
+    if (oCache.size() != 0 || oCache.statistics().hit_ratio() != 0.0) {
+        std::cerr << "transcode_cache::clear failed" << std::endl;
+        std::abort();
+    }
+}
+#endif
+
+#if __cplusplus >= 202002L
+/**
+ * @brief Eagerly started coroutine used to drive generators in tests
+ */
+struct test_task {
+    /**
+     * @brief Coroutine promise of `test_task`
+     */
+    struct promise_type {
+        test_task get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::abort(); }
+    };
+};
+
+/**
+ * @brief Yields a text in chunks of a fixed size
+ * @param sText Text to split
+ * @param nChunk Chunk size in code units
+ * @return Asynchronous generator of chunks
+ */
+utf42::async_generator<std::string_view> chunked_source(const std::string_view sText, const std::size_t nChunk) {
+    for (std::size_t i = 0; i < sText.size(); i += nChunk) {
+        co_yield sText.substr(i, nChunk);
+    }
+}
+
+/**
+ * @brief Collects a coroutine transcoding stream into a string
+ * @param sText Text to transcode
+ * @param nChunk Input chunk size
+ * @param sResult Receives the output
+ * @return Driver coroutine
+ */
+test_task collect_stream(const std::string_view sText, const std::size_t nChunk, std::u16string &sResult) {
+    utf42::async_generator<std::u16string_view> oStream =
+            utf42::transcode_stream<char16_t>(chunked_source(sText, nChunk), 8, 2);
+    while (const std::optional<std::u16string_view> oChunk = co_await oStream.next()) {
+        sResult.append(*oChunk);
+    }
+}
+
+/// Patterns of the Aho-Corasick tests, sharing prefixes and suffixes
+static constexpr utf42::poly_enc g_aScanPatterns[] = {
+    cons_poly_enc("he"), cons_poly_enc("she"), cons_poly_enc("his"), cons_poly_enc("hers"),
+    cons_poly_enc("\u00E9t\u00E9"), cons_poly_enc("\u4E16\u754C"), cons_poly_enc("\U0001F600!"), cons_poly_enc("s"),
+};
+
+/// Patterns of the Aho-Corasick tests starting with few distinct units, so the prefilter is used
+static constexpr utf42::poly_enc g_aSecretPatterns[] = {
+    cons_poly_enc("password="), cons_poly_enc("pass="), cons_poly_enc("token="), cons_poly_enc("secret="),
+};
+
+static_assert(utf42::aho_corasick<g_aScanPatterns>::count(std::u16string_view(u"ushers")) == 5);
+
+/**
+ * @brief Compares an Aho-Corasick scan with a naive search of every pattern
+ * @tparam aPatterns Patterns
+ * @tparam char_t Character type of the text
+ * @param sText Text to scan
+ */
+template<const auto &aPatterns, typename char_t>
+void check_aho_corasick(const std::basic_string<char_t> &sText) {
+    using matcher = utf42::aho_corasick<aPatterns>;
+    const std::basic_string_view<char_t> sView(sText);
+    std::vector<utf42::aho_corasick_match> aExpected;
+    for (std::size_t nEnd = 1; nEnd <= sView.size(); ++nEnd) {
+        // Longest first among the patterns ending at the same unit
+        std::vector<utf42::aho_corasick_match> aEndingHere;
+        for (std::size_t i = 0; i < matcher::size(); ++i) {
+            const std::basic_string_view<char_t> sPattern = matcher::pattern(i).template visit<char_t>();
+            if (sPattern.size() <= nEnd && sView.substr(nEnd - sPattern.size(), sPattern.size()) == sPattern) {
+                aEndingHere.push_back({i, nEnd - sPattern.size(), sPattern.size()});
+            }
+        }
+        std::sort(aEndingHere.begin(), aEndingHere.end(), [](const auto &oLeft, const auto &oRight) {
+            return oLeft.nLength > oRight.nLength;
+        });
+        aExpected.insert(aExpected.end(), aEndingHere.begin(), aEndingHere.end());
+    }
+
+    std::vector<utf42::aho_corasick_match> aFound;
+    matcher::for_each_match(sView, [&](const utf42::aho_corasick_match &oMatch) { aFound.push_back(oMatch); });
+    const auto oFirst = matcher::find_first(sView);
+    bool bValid = aFound.size() == aExpected.size() && matcher::count(sView) == aExpected.size() &&
+                  matcher::contains(sView) == !aExpected.empty() && oFirst.has_value() == !aExpected.empty();
+    for (std::size_t i = 0; bValid && i < aFound.size(); ++i) {
+        bValid = aFound[i].nPattern == aExpected[i].nPattern && aFound[i].nPosition == aExpected[i].nPosition &&
+                 aFound[i].nLength == aExpected[i].nLength;
+    }
+    if (bValid && oFirst) bValid = oFirst->nPattern == aExpected.front().nPattern;
+    if (!bValid) {
+        std::cerr << "aho_corasick mismatch for " << sizeof(char_t) << " byte units: " << aFound.size()
+                << " matches, expected " << aExpected.size() << std::endl;
+        std::abort();
+    }
+}
+
+/**
+ * @brief Scans one UTF-8 text encoded for every character type
+ * @param sText UTF-8 text
+ */
+void check_aho_corasick_text(const std::string &sText) {
+    check_aho_corasick<g_aScanPatterns>(sText);
+    check_aho_corasick<g_aScanPatterns>(utf42::transcode<wchar_t>(std::string_view(sText)));
+    check_aho_corasick<g_aScanPatterns>(utf42::transcode<char8_t>(std::string_view(sText)));
+    check_aho_corasick<g_aScanPatterns>(utf42::transcode<char16_t>(std::string_view(sText)));
+    check_aho_corasick<g_aScanPatterns>(utf42::transcode<char32_t>(std::string_view(sText)));
+    check_aho_corasick<g_aSecretPatterns>(sText);
+    check_aho_corasick<g_aSecretPatterns>(utf42::transcode<char16_t>(std::string_view(sText)));
+    check_aho_corasick<g_aSecretPatterns>(utf42::transcode<char32_t>(std::string_view(sText)));
+}
+
+/**
+ * @brief Performs compile-time Aho-Corasick tests
+ */
+void test_aho_corasick() {
+    check_aho_corasick_text("");
+    check_aho_corasick_text("ushers");
+    check_aho_corasick_text("no match at all");
+    check_aho_corasick_text("user=she password=hunter2 token=abc pass=x \xC3\xA9t\xC3\xA9 "
+                            "\xE4\xB8\x96\xE7\x95\x8C\xF0\x9F\x98\x80! hishers");
+    // Prefilter hits at every offset within a 64-bit word, and the tail
+    std::string sLong;
+    for (std::size_t i = 0; i < 40; ++i) {
+        sLong += std::string(i % 11, '.') + (i % 2 ? "secret=" : "passwor") + (i % 3 ? "token" : "token=");
+    }
+    check_aho_corasick_text(sLong);
+}
+
+static_assert(utf42::find(std::u32string_view(U"caf\u00E9 caf\u00E9"), cons_poly_enc("\u00E9 c")) == 3);
+static_assert(utf42::ends_with(std::wstring_view(L"caf\u00E9"), cons_poly_enc("f\u00E9")));
+
+/**
+ * @brief Compares the literal search functions with `basic_string_view` for one character type
+ * @tparam char_t Character type of the text
+ * @param sText Text to search
+ * @param oNeedle Literal to find
+ */
+template<typename char_t>
+void check_search(const std::basic_string<char_t> &sText, const utf42::poly_enc &oNeedle) {
+    const std::basic_string_view<char_t> sView(sText);
+    const std::basic_string_view<char_t> sNeedle = oNeedle.visit<char_t>();
+    for (std::size_t nFrom = 0; nFrom <= sView.size() + 1; ++nFrom) {
+        const std::size_t nExpected = nFrom > sView.size() ? utf42::npos : sView.find(sNeedle, nFrom);
+        if (utf42::find(sView, oNeedle, nFrom) != nExpected) {
+            std::cerr << "find mismatch for " << sizeof(char_t) << " byte units from " << nFrom << std::endl;
+            std::abort();
+        }
+    }
+    std::size_t nCount = 0;
+    for (std::size_t nAt = sView.find(sNeedle); !sNeedle.empty() && nAt != sView.npos;
+         nAt = sView.find(sNeedle, nAt + sNeedle.size())) {
+        ++nCount;
+    }
+    if (utf42::count(sView, oNeedle) != nCount ||
+        utf42::contains(sView, oNeedle) != (sView.find(sNeedle) != sView.npos) ||
+        utf42::starts_with(sView, oNeedle) != sView.starts_with(sNeedle) ||
+        utf42::ends_with(sView, oNeedle) != sView.ends_with(sNeedle)) {
+        std::cerr << "search helpers mismatch for " << sizeof(char_t) << " byte units" << std::endl;
+        std::abort();
+    }
+}
+
+/**
+ * @brief Performs literal search tests
+ */
+void test_search() {
+    static constexpr utf42::poly_enc aNeedles[] = {
+        cons_poly_enc("a"), cons_poly_enc("ab"), cons_poly_enc("aba"), cons_poly_enc("\u00E9a"),
+        cons_poly_enc("bbbbbbbbbbba"), cons_poly_enc("\U0001F600"), cons_poly_enc(""),
+    };
+    std::mt19937 oEngine(3);
+    for (std::size_t nRound = 0; nRound < 200; ++nRound) {
+        // Few distinct units, so that the filter reports many candidates
+        std::string sText;
+        const std::size_t nLength = oEngine() % 40;
+        for (std::size_t i = 0; i < nLength; ++i) {
+            static constexpr const char *aPieces[] = {"a", "b", "\xC3\xA9", "\xF0\x9F\x98\x80"};
+            sText += aPieces[oEngine() % 4];
+        }
+        for (const utf42::poly_enc &oNeedle: aNeedles) {
+            check_search(sText, oNeedle);
+            check_search(utf42::transcode<wchar_t>(std::string_view(sText)), oNeedle);
+            check_search(utf42::transcode<char8_t>(std::string_view(sText)), oNeedle);
+            check_search(utf42::transcode<char16_t>(std::string_view(sText)), oNeedle);
+            check_search(utf42::transcode<char32_t>(std::string_view(sText)), oNeedle);
+        }
+    }
+}
+
+/// Patterns of the regex tests, and the same patterns for std::regex
+static constexpr utf42::poly_enc g_oRegexPlus = cons_poly_enc("a+b");
+static constexpr utf42::poly_enc g_oRegexPriority = cons_poly_enc("(ab|a)(c|bcd)");
+static constexpr utf42::poly_enc g_oRegexWord = cons_poly_enc("\\bfo+\\b");
+static constexpr utf42::poly_enc g_oRegexLazy = cons_poly_enc("^a{2,3}?$|(a|b)*?c");
+static constexpr utf42::poly_enc g_oRegexSet = cons_poly_enc("[^a-c\\d]{2}|x*");
+static constexpr utf42::poly_enc g_oRegexNested = cons_poly_enc("(?:a*)*b\\.?");
+static constexpr utf42::poly_enc g_oRegexUnicode = cons_poly_enc("\u00E9.[\u4E16-\u754C]+");
+
+static_assert(utf42::regex<g_oRegexPlus>::match(std::u16string_view(u"aaab")));
+static_assert(!utf42::regex<g_oRegexPlus>::match(std::u16string_view(u"aaabb")));
+
+/**
+ * @brief Compares a regex search and match with std::regex on UTF-8 text
+ * @tparam oPattern Pattern
+ * @param pPattern Same pattern, for std::regex
+ * @param sText Text
+ */
+template<const utf42::poly_enc &oPattern>
+void check_regex(const char *pPattern, const std::string &sText) {
+    const std::regex oExpected(pPattern);
+    std::smatch oMatch;
+    const bool bFound = std::regex_search(sText, oMatch, oExpected);
+    const auto oFound = utf42::regex<oPattern>::search(std::string_view(sText));
+    if (bFound != oFound.has_value() ||
+        (bFound && (static_cast<std::size_t>(oMatch.position(0)) != oFound->nPosition ||
+                    static_cast<std::size_t>(oMatch.length(0)) != oFound->nLength)) ||
+        std::regex_match(sText, oExpected) != utf42::regex<oPattern>::match(std::string_view(sText))) {
+        std::cerr << "regex mismatch for " << pPattern << " on '" << sText << "'" << std::endl;
+        std::abort();
+    }
+}
+
+/**
+ * @brief Performs compile-time regex tests
+ */
+void test_regex() {
+    std::mt19937 oEngine(5);
+    for (std::size_t nRound = 0; nRound < 1000; ++nRound) {
+        std::string sText;
+        const std::size_t nLength = oEngine() % 12;
+        for (std::size_t i = 0; i < nLength; ++i) {
+            sText += "abcx fo.1"[oEngine() % 9];
+        }
+        check_regex<g_oRegexPlus>("a+b", sText);
+        check_regex<g_oRegexPriority>("(ab|a)(c|bcd)", sText);
+        check_regex<g_oRegexWord>("\\bfo+\\b", sText);
+        check_regex<g_oRegexLazy>("^a{2,3}?$|(a|b)*?c", sText);
+        check_regex<g_oRegexSet>("[^a-c\\d]{2}|x*", sText);
+        check_regex<g_oRegexNested>("(?:a*)*b\\.?", sText);
+    }
+
+    // Code point semantics: offsets and lengths are in units of each encoding
+    const std::string sText = "xx\xC3\xA9\xF0\x9F\x98\x80\xE4\xB8\x96\xE7\x95\x8Cy";
+    using unicode = utf42::regex<g_oRegexUnicode>;
+    const auto oUtf8 = unicode::search(std::string_view(sText));
+    const auto oUtf16 = unicode::search(std::u16string_view(utf42::transcode<char16_t>(std::string_view(sText))));
+    const auto oWide = unicode::search(std::wstring_view(utf42::transcode<wchar_t>(std::string_view(sText))));
+    const auto oUtf32 = unicode::search(std::u32string_view(utf42::transcode<char32_t>(std::string_view(sText))));
+    const bool bWide16 = sizeof(wchar_t) == 2;
+    if (!oUtf8 || oUtf8->nPosition != 2 || oUtf8->nLength != 12 || !oUtf16 || oUtf16->nPosition != 2 ||
+        oUtf16->nLength != 5 || !oWide || oWide->nLength != (bWide16 ? 5u : 4u) || !oUtf32 || oUtf32->nLength != 4 ||
+        unicode::contains(std::u8string_view(u8"\u00E9\u4E16")) || !unicode::match(std::u8string_view(u8"\u00E9-\u754C"))) {
+        std::cerr << "regex code point semantics failed" << std::endl;
+        std::abort();
+    }
+}
+
+/**
+ * @brief Performs coroutine streaming tests
+ */
+void test_coroutine() {
+    const std::string sInput = "key\xC3\xA9-\xE4\xB8\x96\xF0\x9F\x98\x80; a longer run of ASCII text \xE2\x82\xFF\xF0\x9F";
+    const std::u16string sExpected = utf42::transcode<char16_t>(std::string_view(sInput));
+    for (std::size_t nChunk = 1; nChunk <= sInput.size(); ++nChunk) {
+        std::u16string sResult;
+        collect_stream(sInput, nChunk, sResult);
+        if (sResult != sExpected) {
+            std::cerr << "coroutine stream mismatch with chunks of " << nChunk << std::endl;
+            std::abort();
+        }
+    }
+}
+
+/// Keys of the perfect hash tests
+static constexpr utf42::poly_enc g_aHeaderNames[] = {
+    cons_poly_enc("Accept"), cons_poly_enc("Accept-Encoding"), cons_poly_enc("Authorization"),
+    cons_poly_enc("Cache-Control"), cons_poly_enc("Content-Length"), cons_poly_enc("Content-Type"),
+    cons_poly_enc("Cookie"), cons_poly_enc("Host"), cons_poly_enc("User-Agent"), cons_poly_enc(""),
+    cons_poly_enc("Gr\u00FC\u00DFe"), cons_poly_enc("\u4E16\u754C \U0001F600"),
+};
+
+/// Perfect hash of `g_aHeaderNames`
+static constexpr utf42::perfect_hash g_oHeaderNames(g_aHeaderNames);
+
+static_assert(g_oHeaderNames.find(std::u16string_view(u"Host")) == 7);
+static_assert(!g_oHeaderNames.contains(std::string_view("Hostname")));
+
+/**
+ * @brief Looks up every key of `g_aHeaderNames` encoded for one character type
+ * @tparam char_t Character type of the queries
+ */
+template<typename char_t>
+void check_perfect_hash() {
+    for (std::size_t i = 0; i < g_oHeaderNames.size(); ++i) {
+        const std::basic_string<char_t> sKey(g_aHeaderNames[i].visit<char_t>());
+        if (g_oHeaderNames.find(std::basic_string_view<char_t>(sKey)) != i) {
+            std::cerr << "perfect_hash misses key " << i << " for " << sizeof(char_t) << " byte units" << std::endl;
+            std::abort();
+        }
+        // Same length, different content
+        const std::basic_string<char_t> sOther = sKey + static_cast<char_t>('x');
+        if (!sKey.empty() && g_oHeaderNames.contains(std::basic_string_view<char_t>(sOther).substr(1))) {
+            std::cerr << "perfect_hash accepts an unknown key" << std::endl;
+            std::abort();
+        }
+    }
+}
+
+/**
+ * @brief Performs compile-time perfect hash tests
+ */
+void test_perfect_hash() {
+    check_perfect_hash<char>();
+    check_perfect_hash<wchar_t>();
+    check_perfect_hash<char8_t>();
+    check_perfect_hash<char16_t>();
+    check_perfect_hash<char32_t>();
+
+    static constexpr utf42::perfect_hash_map<int, 3> oStatus({
+        {cons_poly_enc("ok"), 200}, {cons_poly_enc("not found"), 404}, {cons_poly_enc("\u00E9chec"), 500},
+    });
+    static_assert(*oStatus.find(std::u32string_view(U"not found")) == 404);
+    const std::u16string sQuery = u"\u00E9chec";
+    const int* pStatus = oStatus.find(std::u16string_view(sQuery));
+    if (pStatus == nullptr || *pStatus != 500 || oStatus.find(std::wstring_view(L"OK")) != nullptr) {
+        std::cerr << "perfect_hash_map lookup failed" << std::endl;
+        std::abort();
+    }
+
+    // Empty and one-key tables still have a bucket and a slot to shift into
+    static constexpr utf42::perfect_hash<0> oEmpty(std::array<utf42::poly_enc, 0>{});
+    static constexpr utf42::perfect_hash<1> oSingle({cons_poly_enc("only")});
+    static_assert(oEmpty.find(std::string_view("only")) == oEmpty.npos);
+    static_assert(oSingle.find(std::u16string_view(u"only")) == 0 && !oSingle.contains(std::string_view("other")));
+    if (oEmpty.contains(std::wstring_view(L"")) || oSingle.find(std::u32string_view(U"only")) != 0) {
+        std::cerr << "perfect_hash edge sizes failed" << std::endl;
+        std::abort();
+    }
+}
+
+static_assert(utf42::validate(cons_poly_enc("café \U0001F600")));
+static_assert(!utf42::validate(utf42::poly_enc{"a", L"a", u8"a", u"\xD800", U"a"}));
+static_assert(make_valid_enc(char16_t, "\U0001F600").size() == 2);
+static_assert(utf42::count_code_points(make_valid_enc(char8_t, "café \U0001F600")) == 6);
+static_assert(utf42::transcoded_length<char16_t>(make_valid_enc(char8_t, "é\U0001F600")) == 3);
+static_assert(!utf42::validated(std::u16string_view(u"a\xDC00")).has_value());
+
+/**
+ * @brief Compares the unchecked kernels with the checked ones for one pair of character types
+ * @tparam to_t Destination character type
+ * @tparam from_t Source character type
+ * @param sText Well-formed text
+ */
+template<typename to_t, typename from_t>
+void check_valid(const std::basic_string<from_t> &sText) {
+    const std::optional<utf42::valid_view<from_t> > oValid = utf42::validated(std::basic_string_view<from_t>(sText));
+    if (!oValid) {
+        std::cerr << "validated rejects well-formed text" << std::endl;
+        std::abort();
+    }
+    const std::basic_string<to_t> sExpected = utf42::transcode<to_t>(std::basic_string_view<from_t>(sText));
+    if (utf42::transcoded_length<to_t>(*oValid) != sExpected.size() || utf42::transcode<to_t>(*oValid) != sExpected ||
+        utf42::count_code_points(*oValid) != utf42::transcode<char32_t>(std::basic_string_view<from_t>(sText)).size()) {
+        std::cerr << "unchecked kernel mismatch from " << sizeof(from_t) << " to " << sizeof(to_t) << " byte units"
+                  << std::endl;
+        std::abort();
+    }
+}
+
+/**
+ * @brief Runs `check_valid` from one source type to every destination type
+ * @tparam from_t Source character type
+ * @param sText Well-formed UTF-8 text
+ */
+template<typename from_t>
+void check_valid_from(const std::string &sText) {
+    const std::basic_string<from_t> sSource = utf42::transcode<from_t>(std::string_view(sText));
+    check_valid<char>(sSource);
+    check_valid<wchar_t>(sSource);
+    check_valid<char8_t>(sSource);
+    check_valid<char16_t>(sSource);
+    check_valid<char32_t>(sSource);
+}
+
+/**
+ * @brief Performs trusted view tests
+ */
+void test_valid() {
+    std::mt19937 oEngine(5);
+    for (std::size_t nRound = 0; nRound < 200; ++nRound) {
+        // Long enough runs of ASCII to take the block path
+        std::string sText;
+        const std::size_t nLength = oEngine() % 60;
+        for (std::size_t i = 0; i < nLength; ++i) {
+            static constexpr const char *aPieces[] = {
+                "abcdefgh", "x", "\xC3\xA9", "\xE4\xB8\x96", "\xF0\x9F\x98\x80", "\xEF\xBF\xBF", "\xF4\x8F\xBF\xBF",
+            };
+            sText += aPieces[oEngine() % 7];
+        }
+        check_valid_from<char>(sText);
+        check_valid_from<wchar_t>(sText);
+        check_valid_from<char8_t>(sText);
+        check_valid_from<char16_t>(sText);
+        check_valid_from<char32_t>(sText);
+    }
+
+    const std::string sBroken = "ok\xED\xA0\x80";
+    static constexpr utf42::valid_view<char> sLiteral = make_valid_enc(char, "été été");
+    if (utf42::validated(std::string_view(sBroken)) || utf42::count(sLiteral, cons_poly_enc("été")) != 2 ||
+        utf42::find(sLiteral, cons_poly_enc(" ")) != 5 || !utf42::contains(sLiteral, cons_poly_enc("té "))) {
+        std::cerr << "trusted view helpers failed" << std::endl;
+        std::abort();
+    }
+}
+
+static_assert(utf42::hash(std::string_view("clé \U0001F600")) == utf42::hash(std::u16string_view(u"clé \U0001F600")));
+static_assert(utf42::hash(cons_poly_enc("Host")) != utf42::hash(cons_poly_enc("host")));
+static_assert(utf42::hash(std::u32string_view(U"a", 1)) != utf42::hash(std::u32string_view(U"a\0", 2)));
+static_assert(utf42::equal(std::wstring_view(L"été"), std::u8string_view(u8"été")));
+
+/**
+ * @brief Checks that one text hashes alike in every encoding
+ * @param sText UTF-8 text, possibly ill-formed
+ */
+void check_hash(const std::string &sText) {
+    const std::uint64_t nExpected = utf42::hash(std::string_view(sText));
+    const std::u32string sCodes = utf42::transcode<char32_t>(std::string_view(sText));
+    if (utf42::hash(std::u32string_view(sCodes)) != nExpected ||
+        utf42::hash(std::u16string_view(utf42::transcode<char16_t>(std::string_view(sText)))) != nExpected ||
+        utf42::hash(std::wstring_view(utf42::transcode<wchar_t>(std::string_view(sText)))) != nExpected ||
+        utf42::hash(std::u8string_view(utf42::transcode<char8_t>(std::string_view(sText)))) != nExpected ||
+        utf42::hash(std::string_view(sText), 1) == nExpected) {
+        std::cerr << "hash depends on the encoding for a text of " << sText.size() << " bytes" << std::endl;
+        std::abort();
+    }
+    if (!utf42::equal(std::string_view(sText), std::u32string_view(sCodes)) ||
+        (!sCodes.empty() && utf42::equal(std::string_view(sText), std::u32string_view(sCodes).substr(1)))) {
+        std::cerr << "equal mismatch for a text of " << sText.size() << " bytes" << std::endl;
+        std::abort();
+    }
+}
+
+/**
+ * @brief Performs encoding independent hashing tests
+ */
+void test_hash() {
+    std::mt19937 oEngine(7);
+    for (std::size_t nRound = 0; nRound < 300; ++nRound) {
+        // Lengths across several buffer flushes, with ill-formed pieces
+        std::string sText;
+        const std::size_t nLength = oEngine() % 120;
+        for (std::size_t i = 0; i < nLength; ++i) {
+            static constexpr const char *aPieces[] = {
+                "abcdefghijklmnop", "x", "\xC3\xA9", "\xE4\xB8\x96", "\xF0\x9F\x98\x80", "\xFF", "\xE2\x82",
+            };
+            sText += aPieces[oEngine() % 7];
+        }
+        check_hash(sText);
+    }
+
+    static constexpr utf42::hashed_literal oHost(cons_poly_enc("Host"));
+    static_assert(oHost.hash() == utf42::hash(std::u16string_view(u"Host")));
+    std::unordered_map<std::u16string, int, utf42::hasher, utf42::equal_to> mHeaders;
+    mHeaders.emplace(u"Host", 1);
+    mHeaders.emplace(u"Clé", 2);
+    const auto itHost = mHeaders.find(oHost);
+    const auto itKey = mHeaders.find(std::string_view("Cl\xC3\xA9"));
+    if (itHost == mHeaders.end() || itHost->second != 1 || itKey == mHeaders.end() || itKey->second != 2 ||
+        mHeaders.find(std::wstring_view(L"host")) != mHeaders.end() || mHeaders.count(U"Clé") != 1) {
+        std::cerr << "heterogeneous hash map lookup failed" << std::endl;
+        std::abort();
+    }
+}
+
+static constexpr utf42::poly_enc g_aSwitchCases[] = {
+    cons_poly_enc("GET"), cons_poly_enc("PUT"), cons_poly_enc("POST"), cons_poly_enc("DELETE"),
+    cons_poly_enc("été"), cons_poly_enc(""), cons_poly_enc("abXcd"), cons_poly_enc("abYcd"),
+    cons_poly_enc("\U0001F600"),
+};
+static constexpr auto g_oSwitch = utf42::make_string_switch<char16_t>(g_aSwitchCases);
+static_assert(g_oSwitch(u"POST") == 2 && g_oSwitch(u"") == 5 && g_oSwitch(u"abYcd") == 7);
+static_assert(g_oSwitch(u"abZcd") == g_oSwitch.npos && g_oSwitch(u"POS") == g_oSwitch.npos);
+static_assert(g_oSwitch.index(cons_poly_enc("\U0001F600")) == 8);
+
+/**
+ * @brief Checks a string switch against a linear scan of its cases
+ * @tparam char_t Character type of the switch
+ * @tparam N Number of cases
+ * @param oSwitch Switch to check
+ * @param aCases Its cases
+ * @param sQuery UTF-8 query
+ */
+template<typename char_t, std::size_t N>
+void check_string_switch(const utf42::string_switch<char_t, N> &oSwitch, const utf42::poly_enc (&aCases)[N],
+                         const std::string &sQuery) {
+    const std::basic_string<char_t> sText = utf42::transcode<char_t>(std::string_view(sQuery));
+    std::size_t nExpected = oSwitch.npos;
+    for (std::size_t i = 0; i < N; ++i) {
+        if (aCases[i].template visit<char_t>() == sText) nExpected = i;
+    }
+    if (oSwitch(sText) != nExpected) {
+        std::cerr << "string switch mismatch for \"" << sQuery << "\"" << std::endl;
+        std::abort();
+    }
+}
+
+/**
+ * @brief Performs string switch tests
+ */
+void test_string_switch() {
+    // Cases only told apart in the middle fall back to hashing whole strings
+    static constexpr utf42::poly_enc aMiddle[] = {
+        cons_poly_enc("prefix-a-suffix"), cons_poly_enc("prefix-b-suffix"), cons_poly_enc("prefix-c-suffix"),
+    };
+    static constexpr auto oMiddle = utf42::make_string_switch<char>(aMiddle);
+    static_assert(oMiddle.samples() == static_cast<std::size_t>(-1));
+    static constexpr auto oSwitch8 = utf42::make_string_switch<char8_t>(g_aSwitchCases);
+    static constexpr auto oSwitch32 = utf42::make_string_switch<char32_t>(g_aSwitchCases);
+    static constexpr auto oSwitchW = utf42::make_string_switch<wchar_t>(g_aSwitchCases);
+    static_assert(g_oSwitch.samples() <= 4 && oSwitch8(u8"été") == 4);
+
+    static constexpr const char *aQueries[] = {
+        "GET", "get", "PUT", "POST", "POSTS", "DELETE", "DELETe", "été", "ete", "", "abXcd", "abYcd", "abZcd",
+        "\xF0\x9F\x98\x80", "\xF0\x9F\x98\x81", "prefix-a-suffix", "prefix-b-suffix", "prefix-d-suffix",
+        "a very long query that is longer than sixty three code units, so its length bit saturates",
+    };
+    for (const char *pQuery: aQueries) {
+        check_string_switch(g_oSwitch, g_aSwitchCases, pQuery);
+        check_string_switch(oSwitch8, g_aSwitchCases, pQuery);
+        check_string_switch(oSwitch32, g_aSwitchCases, pQuery);
+        check_string_switch(oSwitchW, g_aSwitchCases, pQuery);
+        check_string_switch(oMiddle, aMiddle, pQuery);
+    }
+
+    std::size_t nSelected = 0;
+    switch (g_oSwitch(std::u16string_view(u"DELETE"))) {
+        case g_oSwitch.index(cons_poly_enc("GET")): nSelected = 1; break;
+        case g_oSwitch.index(cons_poly_enc("DELETE")): nSelected = 2; break;
+        default: break;
+    }
+    if (nSelected != 2) {
+        std::cerr << "string switch dispatch failed" << std::endl;
+        std::abort();
+    }
+}
+
+static constexpr utf42::poly_enc_info g_oInfoTitle(cons_poly_enc("R\u00E9sum\u00E9 \u5C65\u6B74\u66F8 \U0001F600e\u0301"));
+static_assert(g_oInfoTitle.code_points() == 14 && g_oInfoTitle.columns() == 17 && !g_oInfoTitle.is_ascii());
+static_assert(g_oInfoTitle.utf8_size() == 26 && g_oInfoTitle.utf16_size() == 15);
+static_assert(utf42::poly_enc_info(cons_poly_enc("tab\there")).is_ascii());
+static_assert(utf42::poly_enc_info(cons_poly_enc("tab\there")).columns() == 7);
+static_assert(utf42::column_width(U'\uFF21') == 2 && utf42::column_width(U'\u200B') == 0);
+static_assert(utf42::column_width(U'\u00E9') == 1 && utf42::column_width(U'\x9B') == 0);
+
+/**
+ * @brief Checks that sorted range tables are sorted and disjoint
+ * @tparam N Number of ranges
+ * @param aRanges Table to check
+ * @return True if the table is well formed
+ */
+template<std::size_t N>
+consteval bool check_ranges(const utf42::detail::code_point_range (&aRanges)[N]) {
+    for (std::size_t i = 0; i < N; ++i) {
+        if (aRanges[i].nFirst > aRanges[i].nLast || (i != 0 && aRanges[i].nFirst <= aRanges[i - 1].nLast)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(check_ranges(utf42::detail::zero_width_ranges) && check_ranges(utf42::detail::wide_ranges));
+
+/**
+ * @brief Performs literal metadata tests
+ */
+void test_info() {
+    static constexpr utf42::poly_enc_info oInfo(cons_poly_enc("caf\u00E9 \uFF21\U0001F600 \u05D0\u05B8"));
+    const std::string sText(oInfo.visit<char>());
+    if (utf42::columns(std::string_view(sText)) != oInfo.columns() ||
+        utf42::columns(std::u16string_view(utf42::transcode<char16_t>(std::string_view(sText)))) != oInfo.columns() ||
+        utf42::transcoded_length<char16_t>(std::string_view(sText)) != oInfo.utf16_size() ||
+        utf42::transcoded_length<char32_t>(std::string_view(sText)) != oInfo.code_points() ||
+        utf42::columns(std::string_view("a\xFF\x7F\x1B")) != 2) {
+        std::cerr << "literal metadata mismatch" << std::endl;
+        std::abort();
+    }
+}
+
+static constinit utf42::lazy_enc g_aLazyMessages[] = {
+    lazy_poly_enc("File not found"), lazy_poly_enc("Acc\u00E8s refus\u00E9 \U0001F600"), lazy_poly_enc(""),
+    lazy_poly_enc("\u4E16\u754C"),
+};
+static constexpr utf42::poly_enc g_aEagerMessages[] = {
+    cons_poly_enc("File not found"), cons_poly_enc("Acc\u00E8s refus\u00E9 \U0001F600"), cons_poly_enc(""),
+    cons_poly_enc("\u4E16\u754C"),
+};
+
+/**
+ * @brief Checks that lazy literals match the compiler literals in one encoding
+ * @tparam char_t Character type
+ */
+template<typename char_t>
+void check_lazy() {
+    for (std::size_t i = 0; i < std::size(g_aLazyMessages); ++i) {
+        const utf42::basic_string_view<char_t> sLazy = g_aLazyMessages[i].visit<char_t>();
+        if (sLazy != g_aEagerMessages[i].visit<char_t>() || sLazy.data()[sLazy.size()] != 0 ||
+            !g_aLazyMessages[i].is_materialized<char_t>() || g_aLazyMessages[i].visit<char_t>().data() != sLazy.data()) {
+            std::cerr << "lazy literal " << i << " mismatch for " << sizeof(char_t) << " byte units" << std::endl;
+            std::abort();
+        }
+    }
+}
+
+/**
+ * @brief Performs lazily materialized literal tests
+ */
+void test_lazy() {
+    if (g_aLazyMessages[1].is_materialized<char16_t>() || !g_aLazyMessages[1].is_materialized<char>()) {
+        std::cerr << "lazy literal materialized too early" << std::endl;
+        std::abort();
+    }
+    // Threads racing on first use, and on eager materialization, publish one form each
+    std::vector<std::thread> aThreads;
+    std::atomic<bool> bMismatch{false};
+    for (std::size_t i = 0; i < 4; ++i) {
+        aThreads.emplace_back([&bMismatch, i] {
+            if (i % 2 == 0) utf42::materialize<char32_t>(g_aLazyMessages, 3);
+            const std::u16string_view sMessage = g_aLazyMessages[1].visit<char16_t>();
+            if (sMessage != u"Acc\u00E8s refus\u00E9 \U0001F600" || g_aLazyMessages[3].visit<char32_t>() != U"\u4E16\u754C") {
+                bMismatch = true;
+            }
+        });
+    }
+    for (std::thread &oThread: aThreads) oThread.join();
+    check_lazy<char>();
+    check_lazy<wchar_t>();
+    check_lazy<char8_t>();
+    check_lazy<char16_t>();
+    check_lazy<char32_t>();
+    if (bMismatch || utf42::lazy_arena_size() == 0 ||
+        utf42::find(std::u16string_view(u"Error: File not found"), g_aLazyMessages[0].to_poly_enc()) != 7) {
+        std::cerr << "lazy literal materialization failed" << std::endl;
+        std::abort();
+    }
+}
+
+/// Messages of the test catalog
+enum class test_message { greeting, farewell, file_missing, count };
+
+/// Locales of the test catalog
+enum class test_locale { en, fr, ja, count };
+
+static constexpr utf42::catalog<test_message, test_locale> g_oCatalog({
+    {test_message::greeting, test_locale::en, cons_poly_enc("Hello")},
+    {test_message::farewell, test_locale::en, cons_poly_enc("Goodbye")},
+    {test_message::file_missing, test_locale::en, cons_poly_enc("File not found")},
+    {test_message::greeting, test_locale::fr, cons_poly_enc("Bonjour")},
+    {test_message::file_missing, test_locale::fr, cons_poly_enc("Fichier introuvable \u00E0 l'emplacement")},
+    {test_message::greeting, test_locale::ja, cons_poly_enc("\u3053\u3093\u306B\u3061\u306F")},
+}, test_locale::en);
+static_assert(g_oCatalog.get<char16_t>(test_locale::ja, test_message::greeting) == u"\u3053\u3093\u306B\u3061\u306F");
+static_assert(g_oCatalog.get<char32_t>(test_locale::fr, test_message::farewell) == U"Goodbye");
+static_assert(g_oCatalog.translated(test_locale::fr, test_message::greeting));
+static_assert(!g_oCatalog.translated(test_locale::ja, test_message::file_missing));
+
+/**
+ * @brief Performs compile-time catalog tests
+ */
+void test_catalog() {
+    static constexpr utf42::catalog<test_message, test_locale> oComplete({
+        {test_message::greeting, test_locale::en, cons_poly_enc("Hi")},
+        {test_message::farewell, test_locale::en, cons_poly_enc("Bye")},
+        {test_message::file_missing, test_locale::en, cons_poly_enc("Missing")},
+        {test_message::greeting, test_locale::fr, cons_poly_enc("Salut")},
+        {test_message::farewell, test_locale::fr, cons_poly_enc("Ciao")},
+        {test_message::file_missing, test_locale::fr, cons_poly_enc("Absent")},
+        {test_message::greeting, test_locale::ja, cons_poly_enc("\u3084\u3042")},
+        {test_message::farewell, test_locale::ja, cons_poly_enc("\u3058\u3083\u3042")},
+        {test_message::file_missing, test_locale::ja, cons_poly_enc("\u306A\u3044")},
+    });
+    // Runtime locales, as read from the environment
+    for (std::size_t nLocale = 0; nLocale < g_oCatalog.locales; ++nLocale) {
+        const auto eLocale = static_cast<test_locale>(nLocale);
+        for (std::size_t nId = 0; nId < g_oCatalog.ids; ++nId) {
+            const auto eId = static_cast<test_message>(nId);
+            const std::string sText(g_oCatalog.get<char>(eLocale, eId));
+            if (utf42::transcode<char16_t>(std::string_view(sText)) != g_oCatalog.get<char16_t>(eLocale, eId) ||
+                utf42::transcode<wchar_t>(std::string_view(sText)) != g_oCatalog.get<wchar_t>(eLocale, eId) ||
+                oComplete.get<char8_t>(eLocale, eId).empty() || !oComplete.translated(eLocale, eId)) {
+                std::cerr << "catalog entry " << nLocale << "/" << nId << " mismatch" << std::endl;
+                std::abort();
+            }
+        }
+    }
+}
+
+/**
+ * @brief Checks a catalog file against the messages it was built from
+ * @param oCatalog Catalog to check
+ */
+void check_catalog_file(const utf42::catalog_view &oCatalog) {
+    if (oCatalog.locales() != 2 || oCatalog.ids() != 3 || oCatalog.find_locale("fr") != 1 ||
+        oCatalog.find_locale("de") != 2 || oCatalog.locale_name(0) != "en" ||
+        oCatalog.get<char16_t>(1, 2) != u"Fichier « données » introuvable \U0001F600" ||
+        oCatalog.get<char32_t>(1, 2) != U"Fichier « données » introuvable \U0001F600" ||
+        oCatalog.get<wchar_t>(0, 0) != L"Hello" || oCatalog.get<char8_t>(0, 1) != u8"" ||
+        oCatalog.get<char>(0, 2) != "File not found" || *(oCatalog.get<char16_t>(0, 0).data() + 5) != 0 ||
+        !oCatalog.contains(0, 1) || oCatalog.contains(1, 1) || !oCatalog.get<char>(1, 1).empty() ||
+        !oCatalog.get<char>(2, 0).empty() || !oCatalog.get<char>(0, 3).empty()) {
+        std::cerr << "catalog file lookup failed" << std::endl;
+        std::abort();
+    }
+}
+
+/**
+ * @brief Performs catalog file tests
+ */
+void test_catalog_file() {
+    utf42::catalog_file_builder oBuilder({"en", "fr"}, 3);
+    if (!oBuilder.set(0, 0, "Hello") || !oBuilder.set(0, 1, "") || !oBuilder.set(0, 2, "File not found") ||
+        !oBuilder.set(1, 0, "Bonjour") ||
+        !oBuilder.set(1, 2, "Fichier « données » introuvable \U0001F600") ||
+        oBuilder.set(1, 1, "\xC3") || oBuilder.set(2, 0, "x") || oBuilder.set(0, 3, "x")) {
+        std::cerr << "catalog builder accepted a bad message" << std::endl;
+        std::abort();
+    }
+    const std::vector<unsigned char> aBytes = oBuilder.serialize();
+    const std::optional<utf42::catalog_view> oView = utf42::catalog_view::parse(aBytes.data(), aBytes.size());
+    if (!oView ||
+        aBytes.size() != 3 * utf42::catalog_page_size + 6 * sizeof(utf42::catalog_span) + 64 * sizeof(char32_t)) {
+        std::cerr << "catalog file parse failed" << std::endl;
+        std::abort();
+    }
+    check_catalog_file(*oView);
+
+    // Identical messages share their storage
+    utf42::catalog_file_builder oShared({"en", "en-GB"}, 2);
+    oShared.set(0, 0, "Colour");
+    oShared.set(0, 1, "Color");
+    oShared.set(1, 0, "Colour");
+    oShared.set(1, 1, "Colour");
+    const std::vector<unsigned char> aShared = oShared.serialize();
+    const std::optional<utf42::catalog_view> oSharedView = utf42::catalog_view::parse(aShared.data(), aShared.size());
+    if (!oSharedView || oSharedView->get<char16_t>(1, 1) != u"Colour" ||
+        oSharedView->get<char16_t>(1, 1).data() != oSharedView->get<char16_t>(0, 0).data() ||
+        oSharedView->get<char32_t>(1, 0).data() != oSharedView->get<char32_t>(0, 0).data() ||
+        oSharedView->get<char8_t>(0, 1).data() == oSharedView->get<char8_t>(0, 0).data()) {
+        std::cerr << "catalog builder duplicated identical messages" << std::endl;
+        std::abort();
+    }
+
+    // Truncated, foreign and corrupted files are rejected or yield empty views
+    std::vector<unsigned char> aBroken(aBytes.begin(), aBytes.end() - 1);
+    if (utf42::catalog_view::parse(aBroken.data(), aBroken.size())) {
+        std::cerr << "truncated catalog accepted" << std::endl;
+        std::abort();
+    }
+    aBroken = aBytes;
+    aBroken[8] = 2;
+    if (utf42::catalog_view::parse(aBroken.data(), aBroken.size())) {
+        std::cerr << "catalog of another version accepted" << std::endl;
+        std::abort();
+    }
+    aBroken = aBytes;
+    const utf42::catalog_span oHuge{0, 0x7FFFFFFF};
+    std::memcpy(aBroken.data() + 2 * utf42::catalog_page_size, &oHuge, sizeof(oHuge));
+    const std::optional<utf42::catalog_view> oCorrupted = utf42::catalog_view::parse(aBroken.data(), aBroken.size());
+    if (!oCorrupted || !oCorrupted->get<char16_t>(0, 0).empty()) {
+        std::cerr << "corrupted catalog span not caught" << std::endl;
+        std::abort();
+    }
+
+#if defined(UTF42_CATALOG_MMAP)
+    const std::filesystem::path oPath = std::filesystem::temp_directory_path() / "utf42_test_catalog.bin";
+    const bool bWritten = oBuilder.write(oPath.string());
+    std::optional<utf42::mapped_catalog> oMapped = utf42::mapped_catalog::open(oPath.string());
+    std::filesystem::remove(oPath);
+    if (!bWritten || !oMapped || utf42::mapped_catalog::open(oPath.string())) {
+        std::cerr << "catalog file mapping failed" << std::endl;
+        std::abort();
+    }
+    const utf42::mapped_catalog oMoved = std::move(*oMapped);
+    check_catalog_file(oMoved.view());
+#endif
+}
+
+/**
+ * @brief Performs hot-reload tests
+ */
+void test_catalog_reload() {
+    // A snapshot pins its version until it is destroyed
+    utf42::hot_swap<std::string> oValue;
+    if (oValue.read()) {
+        std::cerr << "empty hot_swap has a value" << std::endl;
+        std::abort();
+    }
+    oValue.publish(std::make_unique<std::string>("first"));
+    {
+        const auto oFirst = oValue.read();
+        oValue.publish(std::make_unique<std::string>("second"));
+        const auto oSecond = oValue.read();
+        if (*oFirst != "first" || *oSecond != "second" || oValue.reclaim() != 1) {
+            std::cerr << "hot_swap released a pinned version" << std::endl;
+            std::abort();
+        }
+    }
+    if (oValue.reclaim() != 0 || *oValue.read() != "second") {
+        std::cerr << "hot_swap kept a released version" << std::endl;
+        std::abort();
+    }
+
+    // Readers always see a whole version while a writer keeps publishing
+    utf42::hot_swap<std::vector<std::size_t> > oVersions;
+    oVersions.publish(std::make_unique<std::vector<std::size_t> >(64, 0));
+    std::atomic<bool> bDone{false};
+    std::atomic<bool> bTorn{false};
+    std::vector<std::thread> aReaders;
+    for (int nThread = 0; nThread < 3; ++nThread) {
+        aReaders.emplace_back([&] {
+            while (!bDone.load(std::memory_order_relaxed)) {
+                const auto oSnapshot = oVersions.read();
+                const std::vector<std::size_t> &aVersion = *oSnapshot;
+                if (std::any_of(aVersion.begin(), aVersion.end(), [&](const std::size_t n) { return n != aVersion[0]; })) {
+                    bTorn = true;
+                }
+            }
+        });
+    }
+    for (std::size_t nVersion = 1; nVersion <= 2000; ++nVersion) {
+        oVersions.publish(std::make_unique<std::vector<std::size_t> >(64, nVersion));
+        if (nVersion % 64 == 0) std::this_thread::yield();
+    }
+    bDone = true;
+    for (std::thread &oReader: aReaders) oReader.join();
+    oVersions.synchronize();
+    if (bTorn || (*oVersions.read())[0] != 2000) {
+        std::cerr << "hot_swap readers saw a torn version" << std::endl;
+        std::abort();
+    }
+
+#if defined(UTF42_CATALOG_MMAP)
+    const std::filesystem::path oPath = std::filesystem::temp_directory_path() / "utf42_test_reload.bin";
+    const std::filesystem::path oNext = std::filesystem::temp_directory_path() / "utf42_test_reload.next";
+    utf42::catalog_file_builder oBuilder({"en"}, 1);
+    oBuilder.set(0, 0, "Old");
+    oBuilder.write(oPath.string());
+    utf42::reloadable_catalog oCatalog;
+    const bool bLoaded = oCatalog.reload(oPath.string());
+    const auto oOld = oCatalog.read();
+    oBuilder.set(0, 0, "New");
+    oBuilder.write(oNext.string());
+    std::filesystem::rename(oNext, oPath);
+    const bool bReloaded = oCatalog.reload(oPath.string());
+    const bool bMissing = oCatalog.reload(oNext.string());
+    std::filesystem::remove(oPath);
+    if (!bLoaded || !bReloaded || bMissing || oOld->get<char16_t>(0, 0) != u"Old" ||
+        oCatalog.read()->get<char32_t>(0, 0) != U"New") {
+        std::cerr << "catalog reload failed" << std::endl;
+        std::abort();
+    }
+#endif
+}
+
+/**
+ * @brief Performs interning tests
+ */
+void test_intern() {
+    utf42::intern_table oTable;
+    const utf42::interned oName = oTable.intern(std::string_view("clé.load"));
+    if (oName.empty() || oName != oTable.intern(std::u16string(u"clé.load")) ||
+        oName != oTable.intern(U"clé.load") || oName != oTable.find(std::wstring_view(L"clé.load")) ||
+        oName == oTable.intern(std::string_view("cle.load")) || !oTable.find(std::string_view("absent")).empty() ||
+        oTable.size() != 2) {
+        std::cerr << "interning identity failed" << std::endl;
+        std::abort();
+    }
+    if (oName.visit<char16_t>() != u"clé.load" || oName.visit<wchar_t>() != L"clé.load" ||
+        oName.utf8() != u8"clé.load" || oName.visit<char32_t>().data()[8] != 0 ||
+        oName.to_poly_enc().visit<char32_t>() != U"clé.load" ||
+        std::hash<utf42::interned>()(oName) != std::hash<utf42::interned>()(oTable.find("clé.load")) ||
+        !utf42::interned().visit<char>().empty()) {
+        std::cerr << "interned views failed" << std::endl;
+        std::abort();
+    }
+    // Forms built by visit belong to the table and are freed with it, not kept by the process-wide arena
+    const std::size_t nArena = utf42::lazy_arena_size();
+    for (std::size_t i = 0; i < 64; ++i) {
+        utf42::intern_table oRequest;
+        if (oRequest.intern(std::string(2000, 'x')).visit<char32_t>().size() != 2000) {
+            std::cerr << "interned view of a short-lived table failed" << std::endl;
+            std::abort();
+        }
+    }
+    if (utf42::lazy_arena_size() != nArena) {
+        std::cerr << "interned forms leaked into the process-wide arena" << std::endl;
+        std::abort();
+    }
+    // Ill-formed input is stored as U+FFFD, and the empty string is a string
+    if (oTable.intern(std::string_view("a\xC3")).visit<char32_t>() != U"a\uFFFD" ||
+        oTable.intern(std::string_view("a\xC3")) != oTable.intern(std::u32string_view(U"a\uFFFD")) ||
+        oTable.intern(std::string_view()).empty()) {
+        std::cerr << "interning of edge cases failed" << std::endl;
+        std::abort();
+    }
+
+    // Threads interning overlapping names agree on every handle
+    constexpr std::size_t nNames = 4096;
+    std::vector<std::vector<utf42::interned> > aHandles(4, std::vector<utf42::interned>(nNames));
+    std::vector<std::thread> aThreads;
+    for (std::size_t nThread = 0; nThread < aHandles.size(); ++nThread) {
+        aThreads.emplace_back([&, nThread] {
+            for (std::size_t i = 0; i < nNames; ++i) {
+                const std::size_t nName = (i * (2 * nThread + 1)) % nNames;
+                const std::string sName = "metric." + std::to_string(nName) + ".é";
+                aHandles[nThread][nName] = nThread % 2 == 0
+                                               ? oTable.intern(sName)
+                                               : oTable.intern(utf42::transcode<char16_t>(std::string_view(sName)));
+            }
+        });
+    }
+    for (std::thread &oThread: aThreads) oThread.join();
+    for (std::size_t nName = 0; nName < nNames; ++nName) {
+        for (const std::vector<utf42::interned> &aThread: aHandles) {
+            if (aThread[nName] != aHandles[0][nName] ||
+                aThread[nName].visit<char>() != "metric." + std::to_string(nName) + ".é") {
+                std::cerr << "concurrent interning failed" << std::endl;
+                std::abort();
+            }
+        }
+    }
+    if (oTable.size() != nNames + 4) {
+        std::cerr << "concurrent interning stored duplicates" << std::endl;
+        std::abort();
+    }
+}
+
+#if defined(UTF42_INTERN_SHARED)
+/**
+ * @brief Performs shared intern table tests
+ */
+void test_shared_intern() {
+    std::optional<utf42::shared_intern_table> oTable = utf42::shared_intern_table::create(64, 4096);
+    if (!oTable) {
+        std::cout << "shared memory unavailable, shared intern tests skipped" << std::endl;
+        return;
+    }
+    const utf42::shared_interned oName = oTable->intern(std::string_view("clé.load"));
+    if (oName.empty() || oName != oTable->intern(std::u16string_view(u"clé.load")) ||
+        oName != oTable->intern(U"clé.load") || oName != oTable->find(std::wstring(L"clé.load")) ||
+        oName == oTable->intern(std::string_view("cle.load")) || !oTable->find(std::string_view("absent")).empty() ||
+        oTable->intern(std::string_view("a\xC3")) != oTable->intern(std::u32string_view(U"a\uFFFD")) ||
+        oTable->size() != 3) {
+        std::cerr << "shared interning identity failed" << std::endl;
+        std::abort();
+    }
+    if (oTable->visit<char>(oName) != "clé.load" || oTable->visit<char16_t>(oName) != u"clé.load" ||
+        oTable->visit<wchar_t>(oName) != L"clé.load" || oTable->visit<char32_t>(oName).data()[8] != 0 ||
+        !oTable->visit<char>(utf42::shared_interned()).empty() ||
+        !oTable->visit<char>(utf42::shared_interned{0xFFFFFFFF}).empty()) {
+        std::cerr << "shared interned views failed" << std::endl;
+        std::abort();
+    }
+
+    // Another mapping, at another address, resolves the same handles
+    std::optional<utf42::shared_intern_table> oAttached = utf42::shared_intern_table::attach(oTable->fd());
+    if (!oAttached || oAttached->find(std::string_view("clé.load")) != oName ||
+        oAttached->visit<char16_t>(oName).data() == oTable->visit<char16_t>(oName).data() ||
+        oAttached->visit<char16_t>(oName) != u"clé.load") {
+        std::cerr << "shared intern table attach failed" << std::endl;
+        std::abort();
+    }
+
+    // Strings interned by a child process are seen by the parent
+    const pid_t nChild = fork();
+    if (nChild == 0) {
+        utf42::shared_interned oChild = oAttached->intern(std::string_view("from.child"));
+        _exit(oChild.empty() || oAttached->intern(std::string_view("clé.load")) != oName ? 1 : 0);
+    }
+    int nStatus = 0;
+    if (nChild < 0 || waitpid(nChild, &nStatus, 0) != nChild || !WIFEXITED(nStatus) || WEXITSTATUS(nStatus) != 0 ||
+        oTable->visit<char32_t>(oTable->find(std::u16string_view(u"from.child"))) != U"from.child") {
+        std::cerr << "shared interning across processes failed" << std::endl;
+        std::abort();
+    }
+
+    // Full tables return empty handles
+    std::optional<utf42::shared_intern_table> oSmall = utf42::shared_intern_table::create(2, 4096);
+    if (!oSmall || oSmall->intern(std::string_view("a")).empty() || oSmall->intern(std::string_view("b")).empty() ||
+        !oSmall->intern(std::string_view("c")).empty() || oSmall->intern(std::string_view("a")).empty() ||
+        oSmall->size() != 2) {
+        std::cerr << "full shared intern table accepted a string" << std::endl;
+        std::abort();
+    }
+
+    // File-backed tables are created once and reopened with their contents
+    const std::filesystem::path oPath = std::filesystem::temp_directory_path() / "utf42_test_intern.bin";
+    std::filesystem::remove(oPath);
+    std::optional<utf42::shared_intern_table> oFile = utf42::shared_intern_table::open(oPath.string(), 16, 1024);
+    const utf42::shared_interned oStored = oFile ? oFile->intern(std::string_view("stored")) : utf42::shared_interned();
+    std::optional<utf42::shared_intern_table> oReopened = utf42::shared_intern_table::open(oPath.string(), 1, 1);
+    std::filesystem::remove(oPath);
+    if (oStored.empty() || !oReopened || oReopened->capacity() != 16 ||
+        oReopened->find(std::string_view("stored")) != oStored) {
+        std::cerr << "file-backed shared intern table failed" << std::endl;
+        std::abort();
+    }
+}
+#endif
+
+/**
+ * @brief Formats a string through the specification parser and writer.
+ * @tparam char_t Character type of the output.
+ * @tparam from_t Character type of the string.
+ * @param sSpec Specification, without braces.
+ * @param sText String.
+ * @return The formatted string, or "<invalid>" if the specification is rejected.
+ */
+template<typename char_t, typename from_t>
+std::basic_string<char_t> format_with(const std::string_view sSpec, const std::basic_string_view<from_t> sText) {
+    utf42::detail::format_spec oSpec;
+    const char *pStop = oSpec.parse(sSpec.data(), sSpec.data() + sSpec.size());
+    if (pStop != sSpec.data() + sSpec.size()) return utf42::transcode<char_t>(std::string_view("<invalid>"));
+    std::basic_string<char_t> sOut;
+    utf42::detail::write_formatted<char_t>(std::back_inserter(sOut), sText, oSpec);
+    return sOut;
+}
+
+/**
+ * @brief Argument of the mock format context.
+ */
+using mock_format_arg = std::variant<std::monostate, bool, char, int, unsigned, long long, double>;
+
+/**
+ * @brief Ties the formatter to the mock contexts, as std_format_traits does to `<format>`.
+ */
+struct mock_format_traits {
+    using error_type = std::runtime_error; ///< Error of invalid specifications and arguments
+
+    /**
+     * @brief Visits a mock argument.
+     * @tparam visitor_t Visitor.
+     * @param fnVisitor Visitor.
+     * @param oArg Argument.
+     * @return The result of the visitor.
+     */
+    template<typename visitor_t>
+    static decltype(auto) visit(visitor_t &&fnVisitor, const mock_format_arg &oArg) {
+        return std::visit(std::forward<visitor_t>(fnVisitor), oArg);
+    }
+};
+
+/**
+ * @brief Parse context with the interface of std::basic_format_parse_context.
+ * @tparam char_t Character type of the format string.
+ */
+template<typename char_t>
+struct mock_parse_context {
+    std::basic_string_view<char_t> sSpec; ///< Specification, up to the closing brace
+    std::size_t nArgs; ///< Number of arguments
+    std::size_t nNext = 1; ///< Next automatic argument index, past the formatted value
+
+    constexpr const char_t *begin() const { return sSpec.data(); }
+    constexpr const char_t *end() const { return sSpec.data() + sSpec.size(); }
+    constexpr std::size_t next_arg_id() { return nNext++; }
+
+    constexpr void check_arg_id(const std::size_t nId) const {
+        if (nId >= nArgs) throw std::runtime_error("argument index out of range");
+    }
+};
+
+/**
+ * @brief Format context with the interface of std::basic_format_context.
+ * @tparam char_t Character type of the output.
+ */
+template<typename char_t>
+struct mock_format_context {
+    std::basic_string<char_t> sOut; ///< Output
+    std::vector<mock_format_arg> aArgs; ///< Arguments, the formatted value first
+
+    auto out() { return std::back_inserter(sOut); }
+
+    mock_format_arg arg(const std::size_t nId) const { return nId < aArgs.size() ? aArgs[nId] : mock_format_arg(); }
+};
+
+/**
+ * @brief Formats a value through the formatter the std::formatter specializations derive from.
+ * @tparam char_t Character type of the format string.
+ * @tparam value_t Formatted value.
+ * @param sSpec Specification, after the `:` and up to the closing brace.
+ * @param oValue Value.
+ * @param aArgs Width and precision arguments, numbered from 1.
+ * @return The formatted string, or "<error>" if the formatter throws.
+ */
+template<typename char_t, typename value_t>
+std::basic_string<char_t> format_mock(const std::basic_string_view<char_t> sSpec, const value_t &oValue,
+                                      std::vector<mock_format_arg> aArgs = {}) {
+    aArgs.insert(aArgs.begin(), mock_format_arg());
+    utf42::detail::text_formatter<char_t, mock_format_traits> oFormatter;
+    mock_parse_context<char_t> oParse{sSpec, aArgs.size()};
+    mock_format_context<char_t> oFormat{{}, std::move(aArgs)};
+    try {
+        if (oFormatter.parse(oParse) != oParse.end() - 1) return utf42::transcode<char_t>(std::string_view("<open>"));
+        oFormatter.format(oValue, oFormat);
+    } catch (const std::runtime_error &) {
+        return utf42::transcode<char_t>(std::string_view("<error>"));
+    }
+    return oFormat.sOut;
+}
+
+/**
+ * @brief Performs formatting tests
+ */
+void test_format() {
+    using namespace std::literals;
+    constexpr utf42::poly_enc oName = cons_poly_enc("clé");
+
+    // Width, precision and alignment count code points in every encoding
+    if (format_with<char>("", oName.visit<char>()) != "clé" ||
+        format_with<char>(">6", oName.visit<char>()) != "   clé" ||
+        format_with<char>("*<6", oName.visit<char>()) != "clé***" ||
+        format_with<char>("€^8s", oName.visit<char>()) != "€€clé€€€" ||
+        format_with<char>(".2", oName.visit<char>()) != "cl" ||
+        format_with<char>("_>4.1", oName.visit<char>()) != "___c" ||
+        format_with<char>("2", oName.visit<char>()) != "clé" ||
+        format_with<wchar_t>("€>5", oName.visit<wchar_t>()) != L"€€clé" ||
+        format_with<char16_t>("^7", oName.visit<char16_t>()) != u"  clé  " ||
+        format_with<char32_t>("😀<4", oName.visit<char32_t>()) != U"clé😀") {
+        std::cerr << "formatting of literals failed" << std::endl;
+        std::abort();
+    }
+
+    // Other encodings are transcoded into the output; ill-formed input becomes U+FFFD
+    if (format_with<char>(">5", u"h😀llo"sv) != "h😀llo" ||
+        format_with<char>(".2", u"😀😀😀"sv) != "😀😀" ||
+        format_with<wchar_t>("->4", "ñ"sv) != L"---ñ" ||
+        format_with<char16_t>("", U"😀é"sv) != u"😀é" ||
+        format_with<char32_t>(".3", "a\xC3z"sv) != U"a�z" ||
+        format_with<char>("^5", U""sv) != "     ") {
+        std::cerr << "formatting of transcoded strings failed" << std::endl;
+        std::abort();
+    }
+    // Long strings are transcoded in chunks, which must not split code points
+    std::string sLong;
+    for (std::size_t i = 0; i < 50; ++i) sLong += i % 7 == 3 ? "\xF0\x9F" : "a€😀";
+    const std::u16string sLong16 = utf42::transcode<char16_t>(std::string_view(sLong));
+    if (format_with<char16_t>("", std::string_view(sLong)) != sLong16 ||
+        format_with<char>("", std::u16string_view(sLong16)) != utf42::transcode<char>(std::u16string_view(sLong16)) ||
+        format_with<char32_t>("", std::string_view(sLong)) != utf42::transcode<char32_t>(std::string_view(sLong)) ||
+        format_with<char16_t>("#>200", std::string_view(sLong)) != std::u16string(200 - 136, u'#') + sLong16) {
+        std::cerr << "formatting of long transcoded strings failed" << std::endl;
+        std::abort();
+    }
+
+    // Dynamic counts are recorded for the formatter; invalid specifications are rejected
+    utf42::detail::format_spec oSpec;
+    const std::string_view sDynamic = "*^{}.{3}}";
+    if (oSpec.parse(sDynamic.data(), sDynamic.data() + sDynamic.size()) != sDynamic.data() + 8 ||
+        oSpec.eWidth != utf42::detail::format_count::next_arg ||
+        oSpec.ePrecision != utf42::detail::format_count::arg || oSpec.nPrecision != 3 || oSpec.cFill != U'*') {
+        std::cerr << "parsing of dynamic counts failed" << std::endl;
+        std::abort();
+    }
+    for (const std::string_view sSpec: {"+5"sv, "05"sv, "#"sv, ".x"sv, "{<5"sv, "5d"sv, "{x}"sv, "99999999999"sv}) {
+        if (format_with<char>(sSpec, "text"sv) != "<invalid>") {
+            std::cerr << "invalid specification accepted: " << sSpec << std::endl;
+            std::abort();
+        }
+    }
+    static_assert([] {
+        utf42::detail::format_spec oStatic;
+        const char8_t aSpec[] = u8"é>10";
+        return oStatic.parse(aSpec, aSpec + 5) == aSpec + 5 && oStatic.cFill == U'é' && oStatic.nWidth == 10;
+    }());
+
+    // The formatter behind the std::formatter specializations, driven through mock contexts
+    if (format_mock(">6}"sv, oName) != "   clé" || format_mock(L"*<6}"sv, oName) != L"clé***" ||
+        format_mock("{}.{}}"sv, oName, {5, 2}) != "cl   " || format_mock(">{1}}"sv, oName, {4u}) != " clé" ||
+        format_mock(".{1}}"sv, oName, {2LL}) != "cl" ||
+        format_mock(".2}"sv, utf42::transcoded(u"héllo"sv)) != "hé" ||
+        format_mock(L"}"sv, utf42::transcoded(u8"😀")) != L"😀") {
+        std::cerr << "formatter failed" << std::endl;
+        std::abort();
+    }
+    // Width and precision arguments must be non negative integers, not characters nor booleans
+    for (const mock_format_arg &oArg: {mock_format_arg(-1), mock_format_arg(true), mock_format_arg(5.0),
+                                       mock_format_arg()}) {
+        if (format_mock("{}}"sv, oName, {oArg}) != "<error>" || format_mock(L".{1}}"sv, oName, {oArg}) != L"<error>" ||
+            format_mock(".{}}"sv, oName, {'5'}) != "<error>") {
+            std::cerr << "formatter accepted an invalid count argument" << std::endl;
+            std::abort();
+        }
+    }
+    if (format_mock("+5}"sv, oName) != "<error>" || format_mock(">{2}}"sv, oName, {4}) != "<error>" ||
+        format_mock(">5"sv, oName) != "<open>") {
+        std::cerr << "formatter accepted an invalid specification" << std::endl;
+        std::abort();
+    }
+    // Parsing runs in constant expressions, as std::format checks format strings at compile time
+    static_assert([] {
+        utf42::detail::text_formatter<char, mock_format_traits> oFormatter;
+        mock_parse_context<char> oParse{"_^{}.{}}", 3};
+        return oFormatter.parse(oParse) == oParse.end() - 1 && oParse.nNext == 3;
+    }());
+
+#if defined(__cpp_lib_format)
+    if (std::format("[{:>6}]", oName) != "[   clé]" || std::format(L"[{:*<6}]", oName) != L"[clé***]" ||
+        std::format("{:{}.{}}", oName, 5, 2) != "cl   " || std::format("{0:>{1}}", oName, 4) != " clé" ||
+        std::format("{:.2}", utf42::transcoded(u"héllo"sv)) != "hé" ||
+        std::format(L"{}", utf42::transcoded(u8"😀")) != L"😀") {
+        std::cerr << "std::format failed" << std::endl;
+        std::abort();
+    }
+#endif
+}
+#endif
+
 /**
  * @brief Main function
  * @return Exit status
@@ -155,6 +1744,34 @@ int main() {
     std::cout << "Performing tests..." << std::endl;
     test_simple();
     test_template();
+#if __cplusplus >= 201703L
+    test_transcode();
+    test_stream();
+    test_pipeline();
+    test_detect();
+    test_poly_string();
+    test_cache();
+#endif
+#if __cplusplus >= 202002L
+    test_coroutine();
+    test_perfect_hash();
+    test_aho_corasick();
+    test_search();
+    test_regex();
+    test_valid();
+    test_hash();
+    test_string_switch();
+    test_info();
+    test_lazy();
+    test_catalog();
+    test_catalog_file();
+    test_catalog_reload();
+    test_intern();
+#if defined(UTF42_INTERN_SHARED)
+    test_shared_intern();
+#endif
+    test_format();
+#endif
     std::cout << "Tests passed!" << std::endl;
     return 0;
 }
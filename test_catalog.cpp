@@ -0,0 +1,106 @@
+/**
+ * @file test_catalog.cpp
+ * @brief Tests of catalogs compiled by `utf42_add_catalog`.
+ *
+ * The build compiles the translation files of `tests/catalog` into the
+ * header `test_messages.h` and into the catalog file named by
+ * `UTF42_TEST_CATALOG_FILE`, both with `utf42_catalog`.
+ *
+ * @copyright MIT License
+ *
+ * This file is part of utf42.
+ * Copyright (c) 2025 Dante Doménech Martínez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string_view>
+
+#include "utf42_catalog.h"
+#include "utf42_catalog_file.h"
+#include "test_messages.h"
+
+using test_messages::locale;
+using test_messages::message;
+
+// The generated header is usable in constant expressions
+static_assert(test_messages::catalog.get<char>(locale::en, message::greeting) == "Hello, \"world\"");
+static_assert(test_messages::catalog.get<char32_t>(locale::fr, message::greeting) == U"Bonjour \U0001F600");
+static_assert(test_messages::locale_names[static_cast<std::size_t>(locale::pt_BR)] == "pt-BR");
+
+/**
+ * @brief Tests the header generated from the translation files
+ */
+void test_header() {
+    const auto &oCatalog = test_messages::catalog;
+    if (oCatalog.get<char16_t>(locale::pt_BR, message::greeting) != u"Olá, mundo" ||
+        oCatalog.get<wchar_t>(locale::fr, message::farewell) != L"Au revoir\tà bientôt" ||
+        oCatalog.get<char8_t>(locale::en, message::unit) != u8"5 km") {
+        std::cerr << "generated header has wrong texts" << std::endl;
+        std::abort();
+    }
+    // pt-BR has no unit message and falls back to en
+    if (oCatalog.get<char>(locale::pt_BR, message::unit) != oCatalog.get<char>(locale::en, message::unit) ||
+        oCatalog.translated(locale::pt_BR, message::unit) || !oCatalog.translated(locale::fr, message::unit)) {
+        std::cerr << "generated header has a wrong fallback" << std::endl;
+        std::abort();
+    }
+}
+
+#if defined(UTF42_CATALOG_MMAP)
+/**
+ * @brief Tests the catalog file built from the same translation files
+ */
+void test_binary() {
+    const std::optional<utf42::mapped_catalog> oCatalog = utf42::mapped_catalog::open(UTF42_TEST_CATALOG_FILE);
+    if (!oCatalog) {
+        std::cerr << "cannot open " << UTF42_TEST_CATALOG_FILE << std::endl;
+        std::abort();
+    }
+    // Messages are numbered as in the header, in order of first appearance in the fallback locale
+    const utf42::catalog_view &oView = oCatalog->view();
+    const std::size_t nPortuguese = oView.find_locale("pt-BR");
+    const std::size_t nFrench = oView.find_locale("fr");
+    const auto fnId = [](const message eId) { return static_cast<std::size_t>(eId); };
+    if (oView.locales() != 3 || nPortuguese == oView.locales() || nFrench == oView.locales() ||
+        oCatalog->get<char16_t>(nPortuguese, fnId(message::greeting)) != u"Olá, mundo" ||
+        oCatalog->get<char32_t>(nFrench, fnId(message::greeting)) != U"Bonjour \U0001F600" ||
+        oCatalog->get<char>(nPortuguese, fnId(message::unit)) != "5 km") {
+        std::cerr << "catalog file has wrong texts" << std::endl;
+        std::abort();
+    }
+}
+#endif
+
+/**
+ * @brief Main function
+ * @return Exit status
+ */
+int main() {
+    std::cout << "Performing catalog compiler tests..." << std::endl;
+    test_header();
+#if defined(UTF42_CATALOG_MMAP)
+    test_binary();
+#endif
+    std::cout << "Tests passed!" << std::endl;
+    return 0;
+}
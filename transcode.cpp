@@ -0,0 +1,622 @@
+/**
+ * @file transcode.cpp
+ * @brief Command-line transcoder and validator for large files.
+ *
+ * The input file is memory-mapped, split into chunks on code point
+ * boundaries and processed by one or several threads. The output file is
+ * sized by the exact-length pre-pass and written through a shared mapping,
+ * so no intermediate buffer is ever allocated.
+ *
+ * Usage:
+ * @code
+ * utf42_transcode [-f FROM] [-t TO] [-j THREADS] [-b] [-s] INPUT OUTPUT
+ * utf42_transcode --validate [-f FROM] [-j THREADS] INPUT
+ * @endcode
+ *
+ * Encodings: `utf8`, `utf16le`, `utf16be`, `utf32le`, `utf32be`.
+ * The source encoding defaults to `auto`, which uses `utf42::detect_encoding`
+ * (byte order mark, then sniffing) and falls back to UTF-8 when the guess is
+ * not confident. An output of `-` writes to the standard output.
+ *
+ * @note POSIX only.
+ *
+ * @copyright MIT License
+ *
+ * This file is part of utf42.
+ * Copyright (c) 2025 Dante Doménech Martínez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "utf42.h"
+#include "utf42_transcode.h"
+#include "utf42_detect.h"
+
+/// Minimum confidence for a guessed source encoding, UTF-8 is assumed below it
+constexpr unsigned g_nMinConfidence = 50;
+
+/// Maximum worker threads per hardware thread, `-j` is clamped to it
+constexpr unsigned g_nThreadsPerCore = 4;
+
+/// Minimum code units per chunk, smaller inputs use fewer threads
+constexpr std::size_t g_nMinChunk = 64 * 1024;
+
+/**
+ * @brief Command-line options
+ */
+struct options {
+    utf42::byte_encoding eFrom = utf42::byte_encoding::unknown; ///< Source encoding, unknown to detect it
+    utf42::byte_encoding eTo = utf42::byte_encoding::utf8; ///< Destination encoding
+    unsigned nThreads = 1; ///< Number of worker threads
+    bool bValidate = false; ///< Only validate the input
+    bool bBom = false; ///< Write a byte order mark
+    bool bStats = false; ///< Print throughput on the standard error
+    std::string sInput; ///< Input path
+    std::string sOutput; ///< Output path, `-` for the standard output
+};
+
+/**
+ * @brief Read-only or read-write memory mapping of a file
+ *
+ * An output is written into a temporary file next to its path and only
+ * replaces it on commit, so a failed run leaves the previous file alone and
+ * an output that is also the input does not truncate the mapped input.
+ */
+class mapped_file {
+public:
+    /// Constructs an empty mapping
+    mapped_file() = default;
+
+    mapped_file(const mapped_file &) = delete;
+
+    mapped_file &operator=(const mapped_file &) = delete;
+
+    /// Unmaps the file and removes an output that was not committed
+    ~mapped_file() {
+        unmap();
+        if (!m_sTemporary.empty()) unlink(m_sTemporary.c_str());
+    }
+
+    /**
+     * @brief Maps an input file privately
+     *
+     * The mapping is writable copy-on-write so that the byte order can be
+     * fixed in place without touching the file. Pipes and devices have no
+     * size to map and are rejected, see stream().
+     *
+     * @param sPath Path of the file
+     * @return True on success
+     */
+    bool open_input(const std::string &sPath) {
+        m_nFd = open(sPath.c_str(), O_RDONLY);
+        if (m_nFd < 0) return false;
+        struct stat oStat{};
+        if (fstat(m_nFd, &oStat) != 0) return false;
+        if (!S_ISREG(oStat.st_mode)) {
+            m_bStream = true;
+            return false;
+        }
+        return map(static_cast<std::size_t>(oStat.st_size), MAP_PRIVATE, PROT_READ | PROT_WRITE);
+    }
+
+    /**
+     * @brief Creates a temporary output file of a given size and maps it shared
+     *
+     * The temporary file takes the permissions of the file it replaces, or
+     * 0644 less the umask for a new file.
+     *
+     * @param sPath Path of the file, which must be a regular file if it exists
+     * @param nSize Size of the file in bytes
+     * @return True on success
+     */
+    bool open_output(const std::string &sPath, const std::size_t nSize) {
+        struct stat oStat{};
+        mode_t nMode = 0;
+        if (stat(sPath.c_str(), &oStat) == 0) {
+            if (!S_ISREG(oStat.st_mode)) {
+                m_bStream = true;
+                return false;
+            }
+            nMode = oStat.st_mode & 07777;
+        } else {
+            const mode_t nMask = umask(0);
+            umask(nMask);
+            nMode = 0644 & ~nMask;
+        }
+        std::string sTemporary = sPath + ".XXXXXX";
+        m_nFd = mkstemp(sTemporary.data());
+        if (m_nFd < 0) return false;
+        m_sTemporary = std::move(sTemporary);
+        m_sPath = sPath;
+        if (fchmod(m_nFd, nMode) != 0) return false;
+        if (ftruncate(m_nFd, static_cast<off_t>(nSize)) != 0) return false;
+        return map(nSize, MAP_SHARED, PROT_READ | PROT_WRITE);
+    }
+
+    /**
+     * @brief Replaces the output path with the written temporary file
+     * @return True on success
+     */
+    bool commit() {
+        unmap();
+        if (rename(m_sTemporary.c_str(), m_sPath.c_str()) != 0) return false;
+        m_sTemporary.clear();
+        return true;
+    }
+
+    /// @return Pointer to the mapped bytes
+    unsigned char *data() const noexcept { return m_pData; }
+
+    /// @return Size of the mapping in bytes
+    std::size_t size() const noexcept { return m_nSize; }
+
+    /// @return True if opening failed because the path is not a regular file
+    bool stream() const noexcept { return m_bStream; }
+
+private:
+    /**
+     * @brief Maps the open file descriptor
+     * @param nSize Size in bytes
+     * @param nFlags Mapping flags
+     * @param nProtection Protection flags
+     * @return True on success
+     */
+    bool map(const std::size_t nSize, const int nFlags, const int nProtection) {
+        m_nSize = nSize;
+        if (nSize == 0) return true;
+        void *pData = mmap(nullptr, nSize, nProtection, nFlags, m_nFd, 0);
+        if (pData == MAP_FAILED) return false;
+        m_pData = static_cast<unsigned char *>(pData);
+        madvise(m_pData, m_nSize, MADV_SEQUENTIAL);
+        return true;
+    }
+
+    /// Unmaps the bytes and closes the file descriptor
+    void unmap() {
+        if (m_pData != nullptr) munmap(m_pData, m_nSize);
+        if (m_nFd >= 0) close(m_nFd);
+        m_pData = nullptr;
+        m_nFd = -1;
+    }
+
+    int m_nFd = -1; ///< File descriptor
+    unsigned char *m_pData = nullptr; ///< Mapped bytes
+    std::size_t m_nSize = 0; ///< Size of the mapping
+    bool m_bStream = false; ///< The path is a pipe, a device or a directory
+    std::string m_sPath; ///< Output path
+    std::string m_sTemporary; ///< Temporary output file, empty once committed
+};
+
+/**
+ * @brief Parses an encoding name
+ * @param sName Name given on the command line
+ * @param eResult Parsed encoding
+ * @return True if the name is known
+ */
+bool parse_encoding(const std::string &sName, utf42::byte_encoding &eResult) {
+    constexpr bool bLittle = std::endian::native == std::endian::little;
+    if (sName == "auto") eResult = utf42::byte_encoding::unknown;
+    else if (sName == "utf8" || sName == "utf-8") eResult = utf42::byte_encoding::utf8;
+    else if (sName == "utf16" || sName == "utf-16") eResult = bLittle ? utf42::byte_encoding::utf16le : utf42::byte_encoding::utf16be;
+    else if (sName == "utf16le" || sName == "utf-16le") eResult = utf42::byte_encoding::utf16le;
+    else if (sName == "utf16be" || sName == "utf-16be") eResult = utf42::byte_encoding::utf16be;
+    else if (sName == "utf32" || sName == "utf-32") eResult = bLittle ? utf42::byte_encoding::utf32le : utf42::byte_encoding::utf32be;
+    else if (sName == "utf32le" || sName == "utf-32le") eResult = utf42::byte_encoding::utf32le;
+    else if (sName == "utf32be" || sName == "utf-32be") eResult = utf42::byte_encoding::utf32be;
+    else return false;
+    return true;
+}
+
+/**
+ * @brief Size of the byte order mark stripped for an explicit source encoding
+ * @param eEncoding Source encoding
+ * @param pData File contents
+ * @param nSize File size in bytes
+ * @return Size of the byte order mark in bytes, 0 if absent or different
+ */
+std::size_t explicit_bom(const utf42::byte_encoding eEncoding, const unsigned char *pData, const std::size_t nSize) {
+    const utf42::detected_encoding oBom = utf42::detect_bom(pData, nSize);
+    return oBom.eEncoding == eEncoding ? oBom.nBom : 0;
+}
+
+/**
+ * @brief Checks whether an encoding is stored in the opposite byte order
+ * @param eEncoding Encoding
+ * @return True if the code units must be byte swapped
+ */
+constexpr bool is_swapped(const utf42::byte_encoding eEncoding) {
+    if constexpr (std::endian::native == std::endian::little) {
+        return eEncoding == utf42::byte_encoding::utf16be || eEncoding == utf42::byte_encoding::utf32be;
+    } else {
+        return eEncoding == utf42::byte_encoding::utf16le || eEncoding == utf42::byte_encoding::utf32le;
+    }
+}
+
+/**
+ * @brief Reverses the byte order of code units in place
+ * @tparam char_t Character type
+ * @param pData Code units
+ * @param nSize Number of code units
+ */
+template<typename char_t>
+void swap_units(char_t *pData, const std::size_t nSize) {
+    for (std::size_t i = 0; i < nSize; ++i) {
+        if constexpr (sizeof(char_t) == 2) {
+            pData[i] = static_cast<char_t>(__builtin_bswap16(static_cast<std::uint16_t>(pData[i])));
+        } else if constexpr (sizeof(char_t) == 4) {
+            pData[i] = static_cast<char_t>(__builtin_bswap32(static_cast<std::uint32_t>(pData[i])));
+        }
+    }
+}
+
+/**
+ * @brief Moves a split point forward so that it does not cut a code point
+ *
+ * Ill-formed input is split where a whole-buffer conversion would also
+ * emit a replacement boundary, so the output does not depend on the split.
+ *
+ * @tparam char_t Character type
+ * @param pSplit Candidate split point
+ * @param pEnd End of the input
+ * @return The adjusted split point
+ */
+template<typename char_t>
+const char_t *align_split(const char_t *pSplit, const char_t *pEnd) {
+    if constexpr (sizeof(char_t) == 1) {
+        for (int i = 0; i < 3 && pSplit != pEnd && (utf42::detail::to_unit(*pSplit) & 0xC0) == 0x80; ++i) {
+            ++pSplit;
+        }
+    } else if constexpr (sizeof(char_t) == 2) {
+        if (pSplit != pEnd && (utf42::detail::to_unit(*pSplit) & 0xFC00) == 0xDC00) ++pSplit;
+    }
+    return pSplit;
+}
+
+/**
+ * @brief Splits an input into chunks that start on code point boundaries
+ * @tparam char_t Character type
+ * @param sText Input text
+ * @param nChunks Desired number of chunks
+ * @return The chunks, possibly fewer than requested
+ */
+template<typename char_t>
+std::vector<utf42::basic_string_view<char_t> >
+split_chunks(const utf42::basic_string_view<char_t> sText, const std::size_t nChunks) {
+    std::vector<utf42::basic_string_view<char_t> > aChunks;
+    const char_t *pBegin = sText.data();
+    const char_t *pEnd = pBegin + sText.size();
+    const std::size_t nStep = sText.size() / nChunks + 1;
+    while (pBegin != pEnd) {
+        const char_t *pSplit = static_cast<std::size_t>(pEnd - pBegin) > nStep ? pBegin + nStep : pEnd;
+        pSplit = align_split(pSplit, pEnd);
+        aChunks.emplace_back(pBegin, static_cast<std::size_t>(pSplit - pBegin));
+        pBegin = pSplit;
+    }
+    return aChunks;
+}
+
+/**
+ * @brief Runs a function on every chunk, one thread per chunk
+ *
+ * If a thread cannot be started, the threads already running are joined
+ * and the error is reported.
+ *
+ * @tparam function_t Callable taking the chunk index
+ * @param nChunks Number of chunks
+ * @param fnBody Function to run
+ * @return True if every chunk was processed
+ */
+template<typename function_t>
+bool parallel_for(const std::size_t nChunks, function_t &&fnBody) {
+    if (nChunks <= 1) {
+        if (nChunks == 1) fnBody(0);
+        return true;
+    }
+    std::vector<std::thread> aThreads;
+    aThreads.reserve(nChunks - 1);
+    bool bStarted = true;
+    try {
+        for (std::size_t i = 1; i < nChunks; ++i) {
+            aThreads.emplace_back(fnBody, i);
+        }
+    } catch (const std::system_error &oError) {
+        std::cerr << "utf42_transcode: cannot start " << nChunks << " threads: " << oError.what() << std::endl;
+        bStarted = false;
+    }
+    if (bStarted) fnBody(0);
+    for (std::thread &oThread: aThreads) {
+        oThread.join();
+    }
+    return bStarted;
+}
+
+/**
+ * @brief Validates the input
+ * @tparam from_t Source character type
+ * @param aChunks Input chunks
+ * @return Exit status: 0 if valid, 1 otherwise or on error
+ */
+template<typename from_t>
+int run_validate(const std::vector<utf42::basic_string_view<from_t> > &aChunks) {
+    std::vector<char> aValid(aChunks.size(), 0);
+    const bool bDone = parallel_for(aChunks.size(), [&](const std::size_t i) {
+        aValid[i] = utf42::validate(aChunks[i]) ? 1 : 0;
+    });
+    if (!bDone) return 1;
+    for (const char bValid: aValid) {
+        if (!bValid) {
+            std::cout << "invalid" << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "valid" << std::endl;
+    return 0;
+}
+
+/**
+ * @brief Transcodes the input into the output file
+ * @tparam to_t Destination character type
+ * @tparam from_t Source character type
+ * @param aChunks Input chunks
+ * @param oOptions Command-line options
+ * @param bTruncated True if the input ends with an incomplete code unit
+ * @return Exit status
+ */
+template<typename to_t, typename from_t>
+int run_transcode(const std::vector<utf42::basic_string_view<from_t> > &aChunks, const options &oOptions,
+                  const bool bTruncated) {
+    // Exact-length pre-pass, one offset per chunk
+    std::vector<std::size_t> aOffsets(aChunks.size() + 1, 0);
+    const bool bMeasured = parallel_for(aChunks.size(), [&](const std::size_t i) {
+        aOffsets[i + 1] = utf42::transcoded_length<to_t>(aChunks[i]);
+    });
+    if (!bMeasured) return 1;
+    const std::size_t nBom = oOptions.bBom ? 1 : 0;
+    aOffsets[0] = nBom;
+    for (std::size_t i = 0; i < aChunks.size(); ++i) {
+        aOffsets[i + 1] += aOffsets[i];
+    }
+    const std::size_t nTail = bTruncated ? utf42::encoded_length<to_t>(utf42::replacement_character) : 0;
+    const std::size_t nUnits = aOffsets.back() + nTail;
+
+    // Destination: shared mapping of the output file, or memory for the standard output
+    mapped_file oOutput;
+    std::vector<to_t> aMemory;
+    to_t *pOut = nullptr;
+    if (oOptions.sOutput == "-") {
+        aMemory.resize(nUnits);
+        pOut = aMemory.data();
+    } else {
+        if (!oOutput.open_output(oOptions.sOutput, nUnits * sizeof(to_t))) {
+            if (oOutput.stream()) {
+                std::cerr << "utf42_transcode: " << oOptions.sOutput
+                        << " is not a regular file, use - to write to the standard output" << std::endl;
+            } else {
+                std::cerr << "utf42_transcode: cannot create " << oOptions.sOutput << ": " << std::strerror(errno)
+                        << std::endl;
+            }
+            return 1;
+        }
+        pOut = reinterpret_cast<to_t *>(oOutput.data());
+    }
+
+    const bool bSwap = is_swapped(oOptions.eTo);
+    const bool bWritten = parallel_for(aChunks.size(), [&](const std::size_t i) {
+        to_t *pChunk = pOut + aOffsets[i];
+        const std::size_t nWritten = utf42::transcode_into(aChunks[i], pChunk);
+        if (bSwap) swap_units(pChunk, nWritten);
+    });
+    if (!bWritten) return 1;
+    if (nBom != 0) {
+        utf42::encode(U'\uFEFF', pOut);
+        if (bSwap) swap_units(pOut, 1);
+    }
+    if (nTail != 0) {
+        utf42::encode(utf42::replacement_character, pOut + aOffsets.back());
+        if (bSwap) swap_units(pOut + aOffsets.back(), nTail);
+    }
+
+    if (oOptions.sOutput == "-") {
+        std::cout.write(reinterpret_cast<const char *>(aMemory.data()),
+                        static_cast<std::streamsize>(aMemory.size() * sizeof(to_t)));
+        std::cout.flush();
+    } else if (!oOutput.commit()) {
+        std::cerr << "utf42_transcode: cannot replace " << oOptions.sOutput << ": " << std::strerror(errno)
+                << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Dispatches on the destination encoding
+ * @tparam from_t Source character type
+ * @param sText Input text
+ * @param oOptions Command-line options
+ * @param bTruncated True if the input ends with an incomplete code unit
+ * @return Exit status
+ */
+template<typename from_t>
+int run(const utf42::basic_string_view<from_t> sText, const options &oOptions, const bool bTruncated) {
+    const std::size_t nChunks = std::min<std::size_t>(oOptions.nThreads, sText.size() / g_nMinChunk + 1);
+    const std::vector<utf42::basic_string_view<from_t> > aChunks = split_chunks(sText, nChunks);
+    if (oOptions.bValidate) {
+        return bTruncated ? (std::cout << "invalid" << std::endl, 1) : run_validate(aChunks);
+    }
+    switch (oOptions.eTo) {
+        case utf42::byte_encoding::utf16le:
+        case utf42::byte_encoding::utf16be:
+            return run_transcode<char16_t>(aChunks, oOptions, bTruncated);
+        case utf42::byte_encoding::utf32le:
+        case utf42::byte_encoding::utf32be:
+            return run_transcode<char32_t>(aChunks, oOptions, bTruncated);
+        default:
+            return run_transcode<char>(aChunks, oOptions, bTruncated);
+    }
+}
+
+/**
+ * @brief Prints the command-line help
+ */
+void usage() {
+    std::cerr << "usage: utf42_transcode [-f FROM] [-t TO] [-j THREADS] [-b] [-s] INPUT OUTPUT\n"
+            << "       utf42_transcode --validate [-f FROM] [-j THREADS] INPUT\n"
+            << "  -f FROM      source encoding (default auto: byte order mark or sniffing, else utf8)\n"
+            << "  -t TO        destination encoding (default utf8)\n"
+            << "  -j THREADS   worker threads, at least 1, at most 4 per core (default 1)\n"
+            << "  -b           write a byte order mark\n"
+            << "  -s           print throughput on the standard error\n"
+            << "  encodings: utf8, utf16, utf16le, utf16be, utf32, utf32le, utf32be\n"
+            << "  OUTPUT may be - for the standard output" << std::endl;
+}
+
+/**
+ * @brief Parses the command line
+ * @param nArgs Number of arguments
+ * @param pArgs Arguments
+ * @param oOptions Parsed options
+ * @return True on success
+ */
+bool parse_options(const int nArgs, char **pArgs, options &oOptions) {
+    std::vector<std::string> aPositional;
+    for (int i = 1; i < nArgs; ++i) {
+        const std::string sArg = pArgs[i];
+        const bool bHasValue = i + 1 < nArgs;
+        if (sArg == "-f" && bHasValue) {
+            if (!parse_encoding(pArgs[++i], oOptions.eFrom)) return false;
+        } else if (sArg == "-t" && bHasValue) {
+            if (!parse_encoding(pArgs[++i], oOptions.eTo) || oOptions.eTo == utf42::byte_encoding::unknown) return false;
+        } else if (sArg == "-j" && bHasValue) {
+            const std::string_view sThreads = pArgs[++i];
+            const auto [pStop, eError] = std::from_chars(sThreads.data(), sThreads.data() + sThreads.size(),
+                                                         oOptions.nThreads);
+            if (eError != std::errc() || pStop != sThreads.data() + sThreads.size() || oOptions.nThreads == 0) {
+                return false;
+            }
+        } else if (sArg == "-b") {
+            oOptions.bBom = true;
+        } else if (sArg == "-s") {
+            oOptions.bStats = true;
+        } else if (sArg == "--validate") {
+            oOptions.bValidate = true;
+        } else if (sArg == "-h" || sArg == "--help" || (sArg.size() > 1 && sArg[0] == '-')) {
+            return false;
+        } else {
+            aPositional.push_back(sArg);
+        }
+    }
+    if (aPositional.size() != (oOptions.bValidate ? 1u : 2u)) return false;
+    oOptions.sInput = aPositional[0];
+    if (!oOptions.bValidate) oOptions.sOutput = aPositional[1];
+    return true;
+}
+
+/**
+ * @brief Main function
+ * @param nArgs Number of arguments
+ * @param pArgs Arguments
+ * @return Exit status
+ */
+int main(const int nArgs, char **pArgs) {
+    options oOptions;
+    if (!parse_options(nArgs, pArgs, oOptions)) {
+        usage();
+        return 2;
+    }
+    // Threads beyond a few per core only add start-up cost and may exhaust the process limits
+    const unsigned nCores = std::max(1u, std::thread::hardware_concurrency());
+    oOptions.nThreads = std::min(oOptions.nThreads, nCores * g_nThreadsPerCore);
+
+    const auto tStart = std::chrono::steady_clock::now();
+    mapped_file oInput;
+    if (!oInput.open_input(oOptions.sInput)) {
+        if (oInput.stream()) {
+            std::cerr << "utf42_transcode: " << oOptions.sInput << " is not a regular file; pipes and devices "
+                    << "cannot be mapped, stream them with utf42::transcode_pipeline (utf42_pipeline.h)" << std::endl;
+        } else {
+            std::cerr << "utf42_transcode: cannot map " << oOptions.sInput << ": " << std::strerror(errno) << std::endl;
+        }
+        return 1;
+    }
+
+    // Resolve the source encoding and strip its byte order mark
+    std::size_t nBom = 0;
+    if (oOptions.eFrom == utf42::byte_encoding::unknown) {
+        const utf42::detected_encoding oDetected = utf42::detect_encoding(oInput.data(), oInput.size());
+        const bool bConfident = oDetected.eEncoding != utf42::byte_encoding::unknown &&
+                                oDetected.nConfidence >= g_nMinConfidence;
+        oOptions.eFrom = bConfident ? oDetected.eEncoding : utf42::byte_encoding::utf8;
+        nBom = bConfident ? oDetected.nBom : 0;
+    } else {
+        nBom = explicit_bom(oOptions.eFrom, oInput.data(), oInput.size());
+    }
+    unsigned char *pData = oInput.data() + nBom;
+    const std::size_t nBytes = oInput.size() - nBom;
+
+    int nStatus = 0;
+    switch (oOptions.eFrom) {
+        case utf42::byte_encoding::utf16le:
+        case utf42::byte_encoding::utf16be: {
+            char16_t *pUnits = reinterpret_cast<char16_t *>(pData);
+            const std::size_t nUnits = nBytes / sizeof(char16_t);
+            if (is_swapped(oOptions.eFrom)) swap_units(pUnits, nUnits);
+            nStatus = run(utf42::basic_string_view<char16_t>(pUnits, nUnits), oOptions, nBytes % sizeof(char16_t) != 0);
+            break;
+        }
+        case utf42::byte_encoding::utf32le:
+        case utf42::byte_encoding::utf32be: {
+            char32_t *pUnits = reinterpret_cast<char32_t *>(pData);
+            const std::size_t nUnits = nBytes / sizeof(char32_t);
+            if (is_swapped(oOptions.eFrom)) swap_units(pUnits, nUnits);
+            nStatus = run(utf42::basic_string_view<char32_t>(pUnits, nUnits), oOptions, nBytes % sizeof(char32_t) != 0);
+            break;
+        }
+        default:
+            nStatus = run(utf42::basic_string_view<char>(reinterpret_cast<const char *>(pData), nBytes), oOptions, false);
+            break;
+    }
+
+    if (oOptions.bStats) {
+        const double nSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count();
+        std::cerr << "utf42_transcode: " << oInput.size() << " bytes in " << nSeconds * 1e3 << " ms ("
+                << static_cast<double>(oInput.size()) / nSeconds / 1e6 << " MB/s, " << oOptions.nThreads
+                << " threads)" << std::endl;
+    }
+    return nStatus;
+}
@@ -0,0 +1,572 @@
+/**
+ * @file utf42_aho_corasick.h
+ * @brief Compile-time Aho-Corasick automata matching many `poly_enc` patterns at once.
+ *
+ * `utf42::aho_corasick` is parameterized by a static array of
+ * `cons_poly_enc` literals. The first time a text of a given character
+ * type is scanned, the automaton of that character type is built by a
+ * `consteval` function from the patterns encoded for that type, so the
+ * program carries only the automata it uses and the text is never
+ * transcoded.
+ *
+ * Each automaton is a deterministic transition table over the code units
+ * found in the patterns (every other unit shares a single class), with
+ * states numbered breadth first and the transitions premultiplied by the
+ * row size, so the scanning loop costs two loads per code unit. When the
+ * patterns start with at most three distinct code units, the scan skips to
+ * the next candidate start with `memchr` or a 64-bit word filter.
+ *
+ * @note Requires C++20 or later.
+ *
+ * @copyright MIT License
+ *
+ * This file is part of utf42.
+ * Copyright (c) 2025 Dante Doménech Martínez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef LIB_UTF_42_AHO_CORASICK
+#define LIB_UTF_42_AHO_CORASICK
+
+#include "utf42.h"
+
+// C++ version requirements
+#if __cplusplus < 202002L
+#error "utf42_aho_corasick.h requires C++20 or later"
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace utf42 {
+    /**
+     * @brief Occurrence of a pattern reported by `aho_corasick`.
+     */
+    struct aho_corasick_match {
+        std::size_t nPattern; ///< Index of the pattern in the pattern array
+        std::size_t nPosition; ///< Offset of the first code unit of the occurrence
+        std::size_t nLength; ///< Length of the occurrence in code units
+
+        /// @return Offset one past the last code unit of the occurrence.
+        constexpr std::size_t end() const noexcept { return nPosition + nLength; }
+    };
+
+    namespace detail {
+        /// Marker of "no pattern ends here"
+        constexpr std::uint32_t no_pattern = static_cast<std::uint32_t>(-1);
+
+        /// Largest number of distinct first code units handled by the prefilter
+        constexpr std::size_t max_prefilter_units = 3;
+
+        /**
+         * @brief Trie of the patterns encoded for one character type.
+         *
+         * Only used during constant evaluation, to size and then fill the
+         * tables of an `aho_corasick_automaton`.
+         *
+         * @tparam char_t Character type.
+         */
+        template<CharacterType char_t>
+        struct aho_corasick_trie {
+            using unit_t = std::make_unsigned_t<char_t>;
+
+            std::vector<unit_t> aUnits; ///< Distinct units of the patterns, sorted. The class of `aUnits[i]` is `i + 1`
+            std::vector<unit_t> aFirstUnits; ///< Distinct first units of the patterns, sorted
+            std::vector<std::size_t> aFirstChild; ///< First child of each state, 0 if none
+            std::vector<std::size_t> aSibling; ///< Next child of the parent of each state, 0 if none
+            std::vector<std::size_t> aClass; ///< Class of the unit leading to each state
+            std::vector<std::uint32_t> aPattern; ///< Pattern ending at each state, `no_pattern` if none
+
+            /**
+             * @brief Builds the trie. Fails to compile on empty or duplicate patterns.
+             * @param pPatterns Patterns.
+             * @param nPatterns Number of patterns.
+             */
+            consteval aho_corasick_trie(const poly_enc *pPatterns, const std::size_t nPatterns) {
+                for (std::size_t i = 0; i < nPatterns; ++i) {
+                    const basic_string_view<char_t> sPattern = pPatterns[i].template visit<char_t>();
+                    if (sPattern.empty()) throw "utf42::aho_corasick: empty pattern";
+                    insert_unit(aFirstUnits, static_cast<unit_t>(sPattern.front()));
+                    for (const char_t cUnit: sPattern) {
+                        insert_unit(aUnits, static_cast<unit_t>(cUnit));
+                    }
+                }
+
+                // A pattern adds at most one state per unit
+                std::size_t nMaxStates = 1;
+                for (std::size_t i = 0; i < nPatterns; ++i) {
+                    nMaxStates += pPatterns[i].template visit<char_t>().size();
+                }
+                aFirstChild.reserve(nMaxStates);
+                aSibling.reserve(nMaxStates);
+                aClass.reserve(nMaxStates);
+                aPattern.reserve(nMaxStates);
+                add_state(0);
+                for (std::size_t i = 0; i < nPatterns; ++i) {
+                    std::size_t nState = 0;
+                    for (const char_t cUnit: pPatterns[i].template visit<char_t>()) {
+                        const std::size_t nClass = class_of(static_cast<unit_t>(cUnit));
+                        std::size_t nChild = child(nState, nClass);
+                        if (nChild == 0) {
+                            nChild = add_state(nClass);
+                            aSibling[nChild] = aFirstChild[nState];
+                            aFirstChild[nState] = nChild;
+                        }
+                        nState = nChild;
+                    }
+                    if (aPattern[nState] != no_pattern) throw "utf42::aho_corasick: duplicate pattern";
+                    aPattern[nState] = static_cast<std::uint32_t>(i);
+                }
+            }
+
+            /**
+             * @brief Inserts a unit in a sorted set of units.
+             * @param aSet Sorted distinct units.
+             * @param nUnit Unit to insert if absent.
+             */
+            static consteval void insert_unit(std::vector<unit_t> &aSet, const unit_t nUnit) {
+                const auto pFound = std::lower_bound(aSet.begin(), aSet.end(), nUnit);
+                if (pFound == aSet.end() || *pFound != nUnit) aSet.insert(pFound, nUnit);
+            }
+
+            /**
+             * @brief Follows a trie edge.
+             * @param nState State.
+             * @param nClass Class of the next unit.
+             * @return Child of `nState` through `nClass`, 0 if none.
+             */
+            consteval std::size_t child(const std::size_t nState, const std::size_t nClass) const noexcept {
+                std::size_t nChild = aFirstChild[nState];
+                while (nChild != 0 && aClass[nChild] != nClass) {
+                    nChild = aSibling[nChild];
+                }
+                return nChild;
+            }
+
+            /**
+             * @brief Appends a childless state.
+             * @param nClass Class of the unit leading to it.
+             * @return The new state.
+             */
+            consteval std::size_t add_state(const std::size_t nClass) {
+                aFirstChild.push_back(0);
+                aSibling.push_back(0);
+                aClass.push_back(nClass);
+                aPattern.push_back(no_pattern);
+                return aPattern.size() - 1;
+            }
+
+            /**
+             * @brief Class of a unit found in the patterns.
+             * @param nUnit Code unit.
+             * @return Class of `nUnit`.
+             */
+            consteval std::size_t class_of(const unit_t nUnit) const noexcept {
+                return static_cast<std::size_t>(std::lower_bound(aUnits.begin(), aUnits.end(), nUnit) - aUnits.begin())
+                       + 1;
+            }
+
+            /// @return Number of unit classes, class 0 gathers the units absent from the patterns.
+            consteval std::size_t classes() const noexcept { return aUnits.size() + 1; }
+
+            /// @return Number of states, the root included.
+            consteval std::size_t states() const noexcept { return aPattern.size(); }
+
+            /// @return Number of pattern units that do not fit the direct class table.
+            consteval std::size_t wide_units() const noexcept {
+                return static_cast<std::size_t>(aUnits.end() - std::lower_bound(aUnits.begin(), aUnits.end(), 256u));
+            }
+        };
+
+        /**
+         * @brief Sizes of the tables of an automaton.
+         */
+        struct aho_corasick_shape {
+            std::size_t nStates; ///< Number of states
+            std::size_t nClasses; ///< Number of unit classes
+            std::size_t nWideUnits; ///< Number of pattern units above 255
+            std::size_t nFirstUnits; ///< Number of distinct first units, 0 if too many for the prefilter
+        };
+
+        /**
+         * @brief Scanning tables of one character type.
+         *
+         * @tparam char_t Character type.
+         * @tparam shape Sizes of the tables.
+         */
+        template<CharacterType char_t, aho_corasick_shape shape>
+        struct aho_corasick_automaton {
+            using unit_t = std::make_unsigned_t<char_t>;
+
+            /// Type of the transitions, wide enough for premultiplied states
+            using state_type = std::conditional_t<(shape.nStates * shape.nClasses <= 0xFFFF),
+                std::uint16_t, std::uint32_t>;
+
+            std::array<std::uint16_t, 256> aNarrowClasses; ///< Class of each unit below 256
+            std::array<unit_t, shape.nWideUnits> aWideUnits; ///< Pattern units above 255, sorted
+            std::array<std::uint16_t, shape.nWideUnits> aWideClasses; ///< Class of each of `aWideUnits`
+            std::array<state_type, shape.nStates * shape.nClasses> aNext; ///< Premultiplied transitions
+            std::array<std::uint32_t, shape.nStates> aPattern; ///< Pattern ending at each state, `no_pattern` if none
+            std::array<state_type, shape.nStates> aOutput; ///< Next reporting proper suffix of each state, 0 if none
+            std::array<unit_t, max_prefilter_units> aFirstUnits; ///< First units of the patterns, for the prefilter
+            std::size_t nFirstReporting; ///< First premultiplied state that reports a match
+
+            /**
+             * @brief Class of a code unit.
+             * @param nUnit Code unit.
+             * @return Class of `nUnit`, 0 if absent from the patterns.
+             */
+            constexpr std::size_t class_of(const unit_t nUnit) const noexcept {
+                if (nUnit < 256) return aNarrowClasses[nUnit];
+                if constexpr (shape.nWideUnits == 0) {
+                    return 0;
+                } else {
+                    const auto pFound = std::lower_bound(aWideUnits.begin(), aWideUnits.end(), nUnit);
+                    return pFound != aWideUnits.end() && *pFound == nUnit
+                               ? aWideClasses[static_cast<std::size_t>(pFound - aWideUnits.begin())]
+                               : 0;
+                }
+            }
+        };
+
+        /**
+         * @brief Finds the first code unit equal to one of a few units.
+         *
+         * A single byte is searched with `memchr`. Otherwise 8 bytes are
+         * tested at once: a lane of `x ^ unit` is zero on a match, and
+         * `(v - low) & ~v & high` is non zero if and only if a lane of `v`
+         * is zero.
+         *
+         * @tparam char_t Character type.
+         * @tparam K Number of units to look for.
+         * @param pBegin Start of the text.
+         * @param pEnd End of the text.
+         * @param aUnits Units to look for.
+         * @return First matching position, `pEnd` if none.
+         */
+        template<typename char_t, std::size_t K>
+        inline const char_t *find_any_unit(const char_t *pBegin, const char_t *pEnd,
+                                           const std::array<std::make_unsigned_t<char_t>, K> &aUnits) noexcept {
+            if constexpr (sizeof(char_t) == 1 && K == 1) {
+                const void *pFound = std::memchr(pBegin, aUnits[0], static_cast<std::size_t>(pEnd - pBegin));
+                return pFound != nullptr ? static_cast<const char_t *>(pFound) : pEnd;
+            } else {
+                constexpr std::size_t nLanes = 8 / sizeof(char_t);
+                constexpr std::uint64_t nLow = sizeof(char_t) == 1
+                                                   ? 0x0101010101010101ull
+                                                   : sizeof(char_t) == 2
+                                                         ? 0x0001000100010001ull
+                                                         : 0x0000000100000001ull;
+                constexpr std::uint64_t nHigh = nLow << (8 * sizeof(char_t) - 1);
+                std::array<std::uint64_t, K> aBroadcast{};
+                for (std::size_t k = 0; k < K; ++k) {
+                    aBroadcast[k] = nLow * aUnits[k];
+                }
+                for (; static_cast<std::size_t>(pEnd - pBegin) >= nLanes; pBegin += nLanes) {
+                    std::uint64_t nWord = 0;
+                    std::memcpy(&nWord, pBegin, sizeof(nWord));
+                    std::uint64_t nHits = 0;
+                    for (std::size_t k = 0; k < K; ++k) {
+                        const std::uint64_t nDifference = nWord ^ aBroadcast[k];
+                        nHits |= (nDifference - nLow) & ~nDifference & nHigh;
+                    }
+                    if (nHits != 0) break;
+                }
+                // Locates the hit within the word, or scans the tail
+                for (; pBegin != pEnd; ++pBegin) {
+                    for (std::size_t k = 0; k < K; ++k) {
+                        if (static_cast<std::make_unsigned_t<char_t>>(*pBegin) == aUnits[k]) return pBegin;
+                    }
+                }
+                return pEnd;
+            }
+        }
+    }
+
+    /**
+     * @brief Compile-time Aho-Corasick matcher of a static array of `poly_enc` patterns.
+     *
+     * All member functions are static; an instance may be declared for
+     * convenience. Occurrences are reported by increasing end position,
+     * the longest first when several patterns end at the same unit, and
+     * may overlap.
+     *
+     * @code
+     * static constexpr utf42::poly_enc aSecrets[] = {cons_poly_enc("password="), cons_poly_enc("token=")};
+     * using secrets = utf42::aho_corasick<aSecrets>;
+     * bool bLeak = secrets::contains(std::u16string_view(sLine));
+     * @endcode
+     *
+     * Empty or duplicate patterns fail to compile.
+     *
+     * @tparam aPatterns Array of patterns with static storage duration.
+     */
+    template<const auto &aPatterns>
+    class aho_corasick {
+    public:
+        /**
+         * @brief Calls a function on every occurrence of the patterns.
+         * @tparam char_t Character type of the text.
+         * @tparam fn_t Type of the function, invocable with an `aho_corasick_match`.
+         * @param sText Text to scan.
+         * @param fnMatch Function to call.
+         */
+        template<CharacterType char_t, typename fn_t>
+        static constexpr void for_each_match(const basic_string_view<char_t> sText, fn_t &&fnMatch) {
+            scan(sText, [&](const aho_corasick_match &oMatch) {
+                fnMatch(oMatch);
+                return true;
+            });
+        }
+
+        /**
+         * @brief Finds the occurrence that ends first.
+         * @tparam char_t Character type of the text.
+         * @param sText Text to scan.
+         * @return The occurrence, or nothing if no pattern occurs in `sText`.
+         */
+        template<CharacterType char_t>
+        static constexpr std::optional<aho_corasick_match> find_first(const basic_string_view<char_t> sText) noexcept {
+            std::optional<aho_corasick_match> oFirst;
+            scan(sText, [&](const aho_corasick_match &oMatch) {
+                oFirst = oMatch;
+                return false;
+            });
+            return oFirst;
+        }
+
+        /**
+         * @brief Checks whether any pattern occurs in a text.
+         * @tparam char_t Character type of the text.
+         * @param sText Text to scan.
+         * @return True if a pattern occurs in `sText`.
+         */
+        template<CharacterType char_t>
+        static constexpr bool contains(const basic_string_view<char_t> sText) noexcept {
+            return find_first(sText).has_value();
+        }
+
+        /**
+         * @brief Counts the occurrences of the patterns, overlapping ones included.
+         * @tparam char_t Character type of the text.
+         * @param sText Text to scan.
+         * @return Number of occurrences.
+         */
+        template<CharacterType char_t>
+        static constexpr std::size_t count(const basic_string_view<char_t> sText) noexcept {
+            std::size_t nCount = 0;
+            scan(sText, [&](const aho_corasick_match &) {
+                ++nCount;
+                return true;
+            });
+            return nCount;
+        }
+
+        /**
+         * @brief Accesses a pattern.
+         * @param nPattern Index of the pattern.
+         * @return The pattern.
+         */
+        static constexpr const poly_enc &pattern(const std::size_t nPattern) noexcept {
+            return std::data(aPatterns)[nPattern];
+        }
+
+        /// @return Number of patterns.
+        static constexpr std::size_t size() noexcept { return std::size(aPatterns); }
+
+        /**
+         * @brief Number of states of the automaton of a character type.
+         * @tparam char_t Character type.
+         * @return Number of states, the root included.
+         */
+        template<CharacterType char_t>
+        static constexpr std::size_t states() noexcept { return shape_v<char_t>.nStates; }
+
+    private:
+        /**
+         * @brief Measures the automaton of a character type.
+         * @tparam char_t Character type.
+         * @return Sizes of its tables.
+         */
+        template<CharacterType char_t>
+        static consteval detail::aho_corasick_shape measure() {
+            const detail::aho_corasick_trie<char_t> oTrie(std::data(aPatterns), std::size(aPatterns));
+            if (oTrie.classes() > 0xFFFF) throw "utf42::aho_corasick: too many distinct code units";
+            return {
+                oTrie.states(), oTrie.classes(), oTrie.wide_units(),
+                oTrie.aFirstUnits.size() <= detail::max_prefilter_units ? oTrie.aFirstUnits.size() : 0
+            };
+        }
+
+        /// Sizes of the tables of each character type
+        template<CharacterType char_t>
+        static constexpr detail::aho_corasick_shape shape_v = measure<char_t>();
+
+        /// Automaton of a character type
+        template<CharacterType char_t>
+        using automaton_type = detail::aho_corasick_automaton<char_t, shape_v<char_t>>;
+
+        /**
+         * @brief Builds the automaton of a character type.
+         * @tparam char_t Character type.
+         * @return The automaton.
+         */
+        template<CharacterType char_t>
+        static consteval automaton_type<char_t> build() {
+            using state_type = typename automaton_type<char_t>::state_type;
+            const detail::aho_corasick_trie<char_t> oTrie(std::data(aPatterns), std::size(aPatterns));
+            const std::size_t nClasses = oTrie.classes();
+            const std::size_t nStates = oTrie.states();
+            automaton_type<char_t> oAutomaton{};
+
+            std::size_t nWide = 0;
+            for (std::size_t i = 0; i < oTrie.aUnits.size(); ++i) {
+                if (oTrie.aUnits[i] < 256) {
+                    oAutomaton.aNarrowClasses[oTrie.aUnits[i]] = static_cast<std::uint16_t>(i + 1);
+                } else {
+                    oAutomaton.aWideUnits[nWide] = oTrie.aUnits[i];
+                    oAutomaton.aWideClasses[nWide++] = static_cast<std::uint16_t>(i + 1);
+                }
+            }
+            for (std::size_t i = 0; i < shape_v<char_t>.nFirstUnits; ++i) {
+                oAutomaton.aFirstUnits[i] = oTrie.aFirstUnits[i];
+            }
+
+            // Breadth first: failure and output links
+            std::vector<std::size_t> aFail(nStates, 0);
+            std::vector<std::size_t> aOutput(nStates, 0);
+            std::vector<std::size_t> aOrder(1, 0);
+            aOrder.reserve(nStates);
+            for (std::size_t nHead = 0; nHead < aOrder.size(); ++nHead) {
+                const std::size_t nState = aOrder[nHead];
+                for (std::size_t nChild = oTrie.aFirstChild[nState]; nChild != 0; nChild = oTrie.aSibling[nChild]) {
+                    std::size_t nFail = 0;
+                    for (std::size_t nSuffix = nState; nSuffix != 0;) {
+                        nSuffix = aFail[nSuffix];
+                        nFail = oTrie.child(nSuffix, oTrie.aClass[nChild]);
+                        if (nFail != 0) break;
+                    }
+                    aFail[nChild] = nFail;
+                    aOutput[nChild] = oTrie.aPattern[nFail] != detail::no_pattern ? nFail : aOutput[nFail];
+                    aOrder.push_back(nChild);
+                }
+            }
+
+            // Renumbers the states in breadth first order, the reporting ones last
+            std::vector<std::size_t> aNumber(nStates, 0);
+            std::size_t nNumber = 0;
+            for (const bool bReporting: {false, true}) {
+                if (bReporting) oAutomaton.nFirstReporting = nNumber * nClasses;
+                for (const std::size_t nState: aOrder) {
+                    if ((oTrie.aPattern[nState] != detail::no_pattern || aOutput[nState] != 0) == bReporting) {
+                        aNumber[nState] = nNumber++;
+                    }
+                }
+            }
+
+            // A row is the row of the failure state, already filled, plus the trie edges
+            state_type *const pNext = oAutomaton.aNext.data();
+            for (const std::size_t nState: aOrder) {
+                state_type *const pRow = pNext + aNumber[nState] * nClasses;
+                if (nState != 0) {
+                    const state_type *const pFailRow = pNext + aNumber[aFail[nState]] * nClasses;
+                    for (std::size_t nClass = 0; nClass < nClasses; ++nClass) {
+                        pRow[nClass] = pFailRow[nClass];
+                    }
+                }
+                for (std::size_t nChild = oTrie.aFirstChild[nState]; nChild != 0; nChild = oTrie.aSibling[nChild]) {
+                    pRow[oTrie.aClass[nChild]] = static_cast<state_type>(aNumber[nChild] * nClasses);
+                }
+                oAutomaton.aPattern[aNumber[nState]] = oTrie.aPattern[nState];
+                oAutomaton.aOutput[aNumber[nState]] =
+                        static_cast<state_type>(aOutput[nState] == 0 ? 0 : aNumber[aOutput[nState]]);
+            }
+            return oAutomaton;
+        }
+
+        /// Automaton of a character type, built on first use
+        template<CharacterType char_t>
+        static constexpr automaton_type<char_t> automaton_v = build<char_t>();
+
+        /**
+         * @brief Runs the automaton over a text.
+         * @tparam char_t Character type of the text.
+         * @tparam fn_t Type of the function, returns false to stop the scan.
+         * @param sText Text to scan.
+         * @param fnMatch Function called on every occurrence.
+         */
+        template<CharacterType char_t, typename fn_t>
+        static constexpr void scan(const basic_string_view<char_t> sText, fn_t &&fnMatch) {
+            using unit_t = std::make_unsigned_t<char_t>;
+            constexpr const automaton_type<char_t> &oAutomaton = automaton_v<char_t>;
+            constexpr std::size_t nClasses = shape_v<char_t>.nClasses;
+            constexpr std::size_t nFirstUnits = shape_v<char_t>.nFirstUnits;
+
+            const char_t *const pBegin = sText.data();
+            const char_t *const pEnd = pBegin + sText.size();
+            std::size_t nState = 0;
+            for (const char_t *pUnit = pBegin; pUnit != pEnd;) {
+                if constexpr (nFirstUnits != 0) {
+                    // At the root, only a first unit can leave it
+                    if (nState == 0 && !std::is_constant_evaluated()) {
+                        pUnit = detail::find_any_unit(pUnit, pEnd, first_units_v<char_t>);
+                        if (pUnit == pEnd) break;
+                    }
+                }
+                nState = oAutomaton.aNext[nState + oAutomaton.class_of(static_cast<unit_t>(*pUnit++))];
+                if (nState < oAutomaton.nFirstReporting) continue;
+
+                const std::size_t nEnd = static_cast<std::size_t>(pUnit - pBegin);
+                for (std::size_t nReport = nState / nClasses; nReport != 0; nReport = oAutomaton.aOutput[nReport]) {
+                    const std::uint32_t nPattern = oAutomaton.aPattern[nReport];
+                    if (nPattern == detail::no_pattern) continue;
+                    const std::size_t nLength = pattern(nPattern).template visit<char_t>().size();
+                    if (!fnMatch(aho_corasick_match{nPattern, nEnd - nLength, nLength})) return;
+                }
+            }
+        }
+
+        /**
+         * @brief Copies the first units of the patterns into an array sized for `detail::find_any_unit`.
+         * @tparam char_t Character type.
+         * @return The distinct first units.
+         */
+        template<CharacterType char_t>
+        static consteval std::array<std::make_unsigned_t<char_t>, shape_v<char_t>.nFirstUnits> first_units() noexcept {
+            std::array<std::make_unsigned_t<char_t>, shape_v<char_t>.nFirstUnits> aUnits{};
+            for (std::size_t i = 0; i < aUnits.size(); ++i) {
+                aUnits[i] = automaton_v<char_t>.aFirstUnits[i];
+            }
+            return aUnits;
+        }
+
+        /// First units of the patterns of a character type
+        template<CharacterType char_t>
+        static constexpr auto first_units_v = first_units<char_t>();
+    };
+} // namespace utf42
+
+#endif //LIB_UTF_42_AHO_CORASICK
@@ -0,0 +1,544 @@
+/**
+ * @file utf42_cache.h
+ * @brief Bounded memoizing cache of runtime transcodings.
+ *
+ * Programs often transcode the same few thousand short strings (header
+ * names, keys, tags) over and over. `utf42::transcode_cache` remembers the
+ * results, keyed by the content of the input and by the source and target
+ * encodings, and evicts rarely used entries with the CLOCK algorithm once
+ * its capacity is reached.
+ *
+ * The cache is split into independently locked shards, so concurrent
+ * lookups of different strings rarely contend. Results are returned as
+ * `utf42::cached_string` handles, which keep their entry alive after
+ * eviction: the views they hand out are stable for the handle's lifetime.
+ *
+ * @note Requires C++17 or later.
+ *
+ * @copyright MIT License
+ *
+ * This file is part of utf42.
+ * Copyright (c) 2025 Dante Doménech Martínez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef LIB_UTF_42_CACHE
+#define LIB_UTF_42_CACHE
+
+#include "utf42_transcode.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace utf42 {
+    /**
+     * @brief Sizing of a `transcode_cache`.
+     */
+    struct cache_options {
+        std::size_t nCapacity = 4096; ///< Maximum number of cached results
+        std::size_t nShards = 16; ///< Number of independently locked shards, rounded up to a power of two
+        std::size_t nMaxLength = 256; ///< Longer inputs, in code units, are transcoded but not cached
+    };
+
+    /**
+     * @brief Counters of a `transcode_cache`.
+     */
+    struct cache_statistics {
+        std::uint64_t nHits = 0; ///< Lookups answered from the cache
+        std::uint64_t nMisses = 0; ///< Lookups that transcoded, including uncacheable inputs
+        std::uint64_t nEvictions = 0; ///< Entries evicted to make room
+
+        /// @return Fraction of lookups answered from the cache, 0 before any lookup.
+        double hit_ratio() const noexcept {
+            const std::uint64_t nLookups = nHits + nMisses;
+            return nLookups == 0 ? 0.0 : static_cast<double>(nHits) / static_cast<double>(nLookups);
+        }
+    };
+
+    namespace detail {
+        /**
+         * @brief Reference counted transcoding result.
+         *
+         * The header is followed in the same allocation by the null
+         * terminated result and then by the bytes of the source string.
+         */
+        struct cache_entry {
+            mutable std::atomic<std::size_t> nReferences; ///< Number of owners, the cache and the handles
+            mutable std::size_t nSlot; ///< Position in the ring of its shard, guarded by the shard
+            std::size_t nHash; ///< Hash of the key
+            std::size_t nSource; ///< Size of the source string in bytes
+            std::size_t nResult; ///< Length of the result in code units
+            encoding eFrom; ///< Source encoding
+            encoding eTo; ///< Target encoding
+
+            /// @return The null terminated result.
+            const void *result() const noexcept { return this + 1; }
+
+            /// @return The bytes of the source string.
+            const char *source() const noexcept {
+                return static_cast<const char *>(result()) + (nResult + 1) * static_cast<std::size_t>(eTo);
+            }
+
+            /**
+             * @brief Checks whether this entry answers a lookup.
+             * @param nKeyHash Hash of the key.
+             * @param eKeyFrom Source encoding.
+             * @param eKeyTo Target encoding.
+             * @param sBytes Bytes of the source string.
+             * @return True if the key matches.
+             */
+            bool matches(const std::size_t nKeyHash, const encoding eKeyFrom, const encoding eKeyTo,
+                         const std::string_view sBytes) const noexcept {
+                return nHash == nKeyHash && eFrom == eKeyFrom && eTo == eKeyTo && nSource == sBytes.size() &&
+                       std::memcmp(source(), sBytes.data(), nSource) == 0;
+            }
+
+            /**
+             * @brief Transcodes a string into a new entry with one reference.
+             * @tparam to_t Destination character type.
+             * @tparam from_t Source character type.
+             * @param sText String to transcode.
+             * @param nHash Hash of the key.
+             * @param sBytes Bytes of the key, empty if the entry is not cached.
+             * @return The entry.
+             */
+            template<typename to_t, typename from_t>
+            static cache_entry *create(const basic_string_view<from_t> sText, const std::size_t nHash,
+                                       const std::string_view sBytes) {
+                // Short inputs are transcoded once on the stack instead of measured first
+                constexpr std::size_t nSmall = max_transcoded_length<to_t, from_t>(small_string_threshold);
+                to_t aSmall[nSmall];
+                const bool bSmall = sText.size() <= small_string_threshold;
+                const std::size_t nResult = bSmall ? transcode_into(sText, aSmall) : transcoded_length<to_t>(sText);
+                void *pMemory = ::operator new(sizeof(cache_entry) + (nResult + 1) * sizeof(to_t) + sBytes.size());
+                auto *pEntry = new(pMemory) cache_entry{
+                    {1}, 0, nHash, sBytes.size(), nResult, encoding_of_v<from_t>, encoding_of_v<to_t>
+                };
+                to_t *pOut = reinterpret_cast<to_t *>(pEntry + 1);
+                if (bSmall) {
+                    std::memcpy(pOut, aSmall, nResult * sizeof(to_t));
+                } else {
+                    transcode_into(sText, pOut);
+                }
+                pOut[nResult] = 0;
+                if (!sBytes.empty()) std::memcpy(pOut + nResult + 1, sBytes.data(), sBytes.size());
+                return pEntry;
+            }
+
+            /**
+             * @brief Adds an owner.
+             * @param pEntry Entry, may be null.
+             * @return The entry.
+             */
+            static const cache_entry *acquire(const cache_entry *pEntry) noexcept {
+                if (pEntry != nullptr) pEntry->nReferences.fetch_add(1, std::memory_order_relaxed);
+                return pEntry;
+            }
+
+            /**
+             * @brief Removes an owner, freeing the entry after the last one.
+             * @param pEntry Entry, may be null.
+             */
+            static void release(const cache_entry *pEntry) noexcept {
+                if (pEntry != nullptr && pEntry->nReferences.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    pEntry->~cache_entry();
+                    ::operator delete(const_cast<cache_entry *>(pEntry));
+                }
+            }
+        };
+
+        /**
+         * @brief Views the bytes of a string.
+         * @tparam char_t Character type.
+         * @param sText String.
+         * @return View of the same memory as bytes.
+         */
+        template<typename char_t>
+        std::string_view as_bytes(const basic_string_view<char_t> sText) noexcept {
+            return {reinterpret_cast<const char *>(sText.data()), sText.size() * sizeof(char_t)};
+        }
+
+        /**
+         * @brief Hashes a cache key.
+         * @param sBytes Bytes of the source string.
+         * @param eFrom Source encoding.
+         * @param eTo Target encoding.
+         * @return Hash of the content mixed with both encodings.
+         */
+        inline std::size_t cache_hash(const std::string_view sBytes, const encoding eFrom, const encoding eTo) noexcept {
+            const std::size_t nEncodings = static_cast<std::size_t>(eFrom) << 8 | static_cast<std::size_t>(eTo);
+            return std::hash<std::string_view>{}(sBytes) ^ nEncodings * static_cast<std::size_t>(0x9E3779B97F4A7C15ull);
+        }
+    }
+
+    /**
+     * @brief Handle to a transcoding result owned by a `transcode_cache`.
+     *
+     * The result stays valid while the handle lives, even if the entry is
+     * evicted or the cache destroyed.
+     *
+     * @tparam char_t Character type of the result.
+     */
+    template<typename char_t>
+    class cached_string {
+    public:
+        /// Constructs an empty handle.
+        cached_string() noexcept = default;
+
+        /**
+         * @brief Adopts a reference to an entry.
+         * @param pEntry Entry holding a result of type `char_t`, whose reference is transferred.
+         */
+        explicit cached_string(const detail::cache_entry *pEntry) noexcept : m_pEntry(pEntry) {
+        }
+
+        /**
+         * @brief Shares the result of another handle.
+         * @param oOther Handle to copy.
+         */
+        cached_string(const cached_string &oOther) noexcept
+            : m_pEntry(detail::cache_entry::acquire(oOther.m_pEntry)) {
+        }
+
+        /**
+         * @brief Takes the result of another handle.
+         * @param oOther Handle to move from, left empty.
+         */
+        cached_string(cached_string &&oOther) noexcept : m_pEntry(std::exchange(oOther.m_pEntry, nullptr)) {
+        }
+
+        /**
+         * @brief Replaces the result with that of another handle.
+         * @param oOther Handle to copy or move from.
+         * @return This handle.
+         */
+        cached_string &operator=(cached_string oOther) noexcept {
+            std::swap(m_pEntry, oOther.m_pEntry);
+            return *this;
+        }
+
+        /// Releases the result.
+        ~cached_string() {
+            detail::cache_entry::release(m_pEntry);
+        }
+
+        /// @return A null terminated view of the result.
+        basic_string_view<char_t> view() const noexcept {
+            if (m_pEntry == nullptr) return {};
+            return {static_cast<const char_t *>(m_pEntry->result()), m_pEntry->nResult};
+        }
+
+        /// @return A null terminated view of the result.
+        operator basic_string_view<char_t>() const noexcept { return view(); }
+
+        /// @return Pointer to the null terminated result, null for an empty handle.
+        const char_t *data() const noexcept { return view().data(); }
+
+        /// @return Length of the result in code units.
+        std::size_t size() const noexcept { return view().size(); }
+
+    private:
+        const detail::cache_entry *m_pEntry = nullptr; ///< Owned reference
+    };
+
+    /**
+     * @brief Sharded, bounded cache of transcoding results with CLOCK eviction.
+     *
+     * Each shard owns `nCapacity / nShards` entries arranged in a ring and an
+     * open addressing index pointing directly to them, so a hit touches one
+     * bucket and one entry. A hit sets the reference bit of its slot; on
+     * insertion into a full shard the clock hand clears set bits until it
+     * finds an unreferenced entry, which is evicted.
+     *
+     * All member functions are thread safe.
+     */
+    class transcode_cache {
+    public:
+        /**
+         * @brief Constructs an empty cache.
+         * @param oOptions Sizing of the cache.
+         */
+        explicit transcode_cache(const cache_options &oOptions = {})
+            : m_nShardBits(shard_bits(oOptions.nShards)),
+              m_nShards(std::size_t(1) << m_nShardBits),
+              m_nMaxLength(oOptions.nMaxLength),
+              m_pShards(new shard[m_nShards]) {
+            const std::size_t nPerShard = oOptions.nCapacity / m_nShards;
+            for (std::size_t i = 0; i < m_nShards; ++i) {
+                m_pShards[i].reserve(nPerShard != 0 ? nPerShard : 1);
+            }
+        }
+
+        transcode_cache(const transcode_cache &) = delete;
+
+        transcode_cache &operator=(const transcode_cache &) = delete;
+
+        /**
+         * @brief Transcodes a string, reusing a cached result when possible.
+         *
+         * On a miss the string is transcoded without holding any lock.
+         *
+         * @tparam to_t Destination character type.
+         * @tparam from_t Source character type.
+         * @param sText String to transcode.
+         * @return Handle to the result.
+         */
+#if __cplusplus >= 202002L
+        template<CharacterType to_t, CharacterType from_t>
+#else
+        template<typename to_t, typename from_t>
+#endif
+        cached_string<to_t> transcode(const basic_string_view<from_t> sText) {
+            constexpr encoding eFrom = encoding_of_v<from_t>;
+            constexpr encoding eTo = encoding_of_v<to_t>;
+            if (sText.size() > m_nMaxLength) {
+                m_nUncached.fetch_add(1, std::memory_order_relaxed);
+                return cached_string<to_t>(detail::cache_entry::create<to_t>(sText, 0, std::string_view()));
+            }
+
+            const std::string_view sBytes = detail::as_bytes(sText);
+            const std::size_t nHash = detail::cache_hash(sBytes, eFrom, eTo);
+            // The low bits select the shard, the remaining ones the bucket
+            shard &oShard = m_pShards[nHash & (m_nShards - 1)];
+            const std::size_t nLocal = nHash >> m_nShardBits;
+            {
+                std::lock_guard<std::mutex> oLock(oShard.oMutex);
+                if (const detail::cache_entry *pFound = oShard.find(nLocal, nHash, eFrom, eTo, sBytes)) {
+                    ++oShard.nHits;
+                    oShard.aReferenced[pFound->nSlot] = 1;
+                    return cached_string<to_t>(detail::cache_entry::acquire(pFound));
+                }
+                ++oShard.nMisses;
+            }
+
+            const detail::cache_entry *pEntry = detail::cache_entry::create<to_t>(sText, nHash, sBytes);
+            std::lock_guard<std::mutex> oLock(oShard.oMutex);
+            // Another thread may have inserted the same key meanwhile
+            if (const detail::cache_entry *pFound = oShard.find(nLocal, nHash, eFrom, eTo, sBytes)) {
+                detail::cache_entry::release(pEntry);
+                return cached_string<to_t>(detail::cache_entry::acquire(pFound));
+            }
+            oShard.insert(nLocal, detail::cache_entry::acquire(pEntry));
+            return cached_string<to_t>(pEntry);
+        }
+
+        /// @return Counters summed over every shard.
+        cache_statistics statistics() const {
+            cache_statistics oResult;
+            oResult.nMisses = m_nUncached.load(std::memory_order_relaxed);
+            for (std::size_t i = 0; i < m_nShards; ++i) {
+                std::lock_guard<std::mutex> oLock(m_pShards[i].oMutex);
+                oResult.nHits += m_pShards[i].nHits;
+                oResult.nMisses += m_pShards[i].nMisses;
+                oResult.nEvictions += m_pShards[i].nEvictions;
+            }
+            return oResult;
+        }
+
+        /// @return Number of cached results.
+        std::size_t size() const {
+            std::size_t nResult = 0;
+            for (std::size_t i = 0; i < m_nShards; ++i) {
+                std::lock_guard<std::mutex> oLock(m_pShards[i].oMutex);
+                nResult += m_pShards[i].aSlots.size();
+            }
+            return nResult;
+        }
+
+        /**
+         * @brief Removes every entry and resets the counters.
+         *
+         * Outstanding handles remain valid.
+         */
+        void clear() {
+            m_nUncached.store(0, std::memory_order_relaxed);
+            for (std::size_t i = 0; i < m_nShards; ++i) {
+                std::lock_guard<std::mutex> oLock(m_pShards[i].oMutex);
+                m_pShards[i].clear();
+            }
+        }
+
+    private:
+        /**
+         * @brief Computes the number of bits selecting a shard.
+         * @param nShards Requested number of shards.
+         * @return Base two logarithm of `nShards` rounded up to a power of two.
+         */
+        static std::size_t shard_bits(const std::size_t nShards) noexcept {
+            std::size_t nBits = 0;
+            while ((std::size_t(1) << nBits) < nShards) ++nBits;
+            return nBits;
+        }
+
+        /**
+         * @brief Position of the ring of a shard
+         */
+        struct slot {
+            const detail::cache_entry *pEntry; ///< Cached result, owning one reference
+            std::size_t nLocal; ///< Hash of the key without the shard bits
+        };
+
+        /**
+         * @brief Position of the open addressing index of a shard
+         */
+        struct bucket {
+            std::size_t nLocal; ///< Hash of the key without the shard bits
+            const detail::cache_entry *pEntry; ///< Indexed entry, null if unused
+        };
+
+        /**
+         * @brief Independently locked part of the cache
+         */
+        struct shard {
+            shard() = default;
+
+            shard(const shard &) = delete;
+
+            shard &operator=(const shard &) = delete;
+
+            /// Releases the entries.
+            ~shard() {
+                clear();
+            }
+
+            /**
+             * @brief Allocates the ring and the index.
+             * @param nSlots Maximum number of entries.
+             */
+            void reserve(const std::size_t nSlots) {
+                nCapacity = nSlots;
+                aSlots.reserve(nSlots);
+                aReferenced.assign(nSlots, 0);
+                std::size_t nBuckets = 2;
+                while (nBuckets < nSlots * 2) nBuckets *= 2;
+                aBuckets.assign(nBuckets, bucket{0, nullptr});
+                nMask = nBuckets - 1;
+            }
+
+            /**
+             * @brief Releases every entry and resets the counters.
+             */
+            void clear() {
+                for (const slot &oSlot: aSlots) {
+                    detail::cache_entry::release(oSlot.pEntry);
+                }
+                aSlots.clear();
+                std::fill(aReferenced.begin(), aReferenced.end(), 0);
+                std::fill(aBuckets.begin(), aBuckets.end(), bucket{0, nullptr});
+                nHand = 0;
+                nHits = nMisses = nEvictions = 0;
+            }
+
+            /**
+             * @brief Looks up a key.
+             * @param nLocal Hash of the key without the shard bits.
+             * @param nHash Hash of the key.
+             * @param eFrom Source encoding.
+             * @param eTo Target encoding.
+             * @param sBytes Bytes of the source string.
+             * @return The entry of the key, null if absent.
+             */
+            const detail::cache_entry *find(const std::size_t nLocal, const std::size_t nHash, const encoding eFrom,
+                                            const encoding eTo, const std::string_view sBytes) const noexcept {
+                for (std::size_t i = nLocal & nMask; aBuckets[i].pEntry != nullptr; i = (i + 1) & nMask) {
+                    if (aBuckets[i].nLocal == nLocal && aBuckets[i].pEntry->matches(nHash, eFrom, eTo, sBytes)) {
+                        return aBuckets[i].pEntry;
+                    }
+                }
+                return nullptr;
+            }
+
+            /**
+             * @brief Inserts an entry, evicting one if the shard is full.
+             * @param nLocal Hash of the key without the shard bits.
+             * @param pEntry Entry to insert, whose reference is transferred.
+             */
+            void insert(const std::size_t nLocal, const detail::cache_entry *pEntry) {
+                if (aSlots.size() < nCapacity) {
+                    pEntry->nSlot = aSlots.size();
+                    aSlots.push_back(slot{pEntry, nLocal});
+                } else {
+                    // Second chance: clear reference bits until an unreferenced entry comes up
+                    while (aReferenced[nHand] != 0) {
+                        aReferenced[nHand] = 0;
+                        nHand = (nHand + 1) % aSlots.size();
+                    }
+                    slot &oVictim = aSlots[nHand];
+                    erase_bucket(oVictim);
+                    detail::cache_entry::release(oVictim.pEntry);
+                    pEntry->nSlot = nHand;
+                    oVictim = slot{pEntry, nLocal};
+                    nHand = (nHand + 1) % aSlots.size();
+                    ++nEvictions;
+                }
+                std::size_t i = nLocal & nMask;
+                while (aBuckets[i].pEntry != nullptr) i = (i + 1) & nMask;
+                aBuckets[i] = bucket{nLocal, pEntry};
+            }
+
+            /**
+             * @brief Removes the bucket pointing to the entry of a slot.
+             *
+             * Later buckets of the probe sequence are shifted back, so the
+             * index never needs tombstones.
+             *
+             * @param oSlot Slot whose bucket is removed.
+             */
+            void erase_bucket(const slot &oSlot) noexcept {
+                std::size_t i = oSlot.nLocal & nMask;
+                while (aBuckets[i].pEntry != oSlot.pEntry) i = (i + 1) & nMask;
+                for (std::size_t j = (i + 1) & nMask; aBuckets[j].pEntry != nullptr; j = (j + 1) & nMask) {
+                    const std::size_t nHome = aBuckets[j].nLocal & nMask;
+                    if (((j - nHome) & nMask) >= ((j - i) & nMask)) {
+                        aBuckets[i] = aBuckets[j];
+                        i = j;
+                    }
+                }
+                aBuckets[i].pEntry = nullptr;
+            }
+
+            mutable std::mutex oMutex; ///< Protects the shard
+            std::vector<slot> aSlots; ///< Ring of entries
+            std::vector<unsigned char> aReferenced; ///< Reference bit of each slot, hit since the hand last passed
+            std::vector<bucket> aBuckets; ///< Index, at most half full
+            std::size_t nMask = 0; ///< Number of buckets minus one
+            std::size_t nCapacity = 1; ///< Maximum number of entries
+            std::size_t nHand = 0; ///< Clock hand
+            std::uint64_t nHits = 0; ///< Lookups answered
+            std::uint64_t nMisses = 0; ///< Lookups that transcoded
+            std::uint64_t nEvictions = 0; ///< Entries evicted
+        };
+
+        std::size_t m_nShardBits; ///< Number of hash bits selecting a shard
+        std::size_t m_nShards; ///< Number of shards
+        std::size_t m_nMaxLength; ///< Longest cached input in code units
+        std::unique_ptr<shard[]> m_pShards; ///< Shards
+        std::atomic<std::uint64_t> m_nUncached{0}; ///< Lookups of inputs too long to be cached
+    };
+} // namespace utf42
+
+#endif //LIB_UTF_42_CACHE
@@ -0,0 +1,240 @@
+/**
+ * @file utf42_catalog.h
+ * @brief Compile-time localization catalogs.
+ *
+ * A `utf42::catalog` maps a (locale, message id) pair, both given as
+ * enumerations, to a translated message in the encoding of any character
+ * type. The catalog is built at compile time from `cons_poly_enc` entries
+ * into one dense table per encoding, so `get<char_t>(eLocale, eId)` indexes
+ * an array and nothing runs at startup or hashes at lookup.
+ *
+ * @code
+ * enum class message { hello, bye, count };
+ * enum class language { en, fr, count };
+ *
+ * static constexpr utf42::catalog<message, language> g_oCatalog({
+ *     {message::hello, language::en, cons_poly_enc("Hello")},
+ *     {message::hello, language::fr, cons_poly_enc("Bonjour")},
+ *     {message::bye, language::en, cons_poly_enc("Bye")},
+ * }, language::en); // "bye" falls back to English in French
+ *
+ * std::u16string_view sText = g_oCatalog.get<char16_t>(language::fr, message::hello);
+ * @endcode
+ *
+ * @note Requires C++20 or later.
+ *
+ * @copyright MIT License
+ *
+ * This file is part of utf42.
+ * Copyright (c) 2025 Dante Doménech Martínez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef LIB_UTF_42_CATALOG
+#define LIB_UTF_42_CATALOG
+
+#include "utf42.h"
+
+// C++ version requirements
+#if __cplusplus < 202002L
+#error "utf42_catalog.h requires C++20 or later"
+#endif
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+namespace utf42 {
+    /**
+     * @brief Concept for the enumerations indexing a catalog.
+     *
+     * Enumerators are numbered from 0 and a last `count` enumerator gives
+     * their number.
+     */
+    template<typename enum_t>
+    concept CatalogKey = std::is_enum_v<enum_t> && requires { enum_t::count; };
+
+    /// Number of enumerators of a catalog key, excluding `count`
+    template<CatalogKey enum_t>
+    constexpr std::size_t enum_count_v = static_cast<std::size_t>(enum_t::count);
+
+    /**
+     * @brief Translation of one message into one locale.
+     * @tparam id_t Enumeration of the messages.
+     * @tparam locale_t Enumeration of the locales.
+     */
+    template<CatalogKey id_t, CatalogKey locale_t>
+    struct catalog_entry {
+        id_t eId; ///< Message
+        locale_t eLocale; ///< Locale
+        poly_enc oText; ///< Translation, usually a `cons_poly_enc` literal
+    };
+
+    /**
+     * @brief Messages of every locale in every encoding, built at compile time.
+     *
+     * Each encoding has its own table of views, ordered by locale then by
+     * message, so the messages of one locale and encoding are contiguous.
+     *
+     * @tparam id_t Enumeration of the messages.
+     * @tparam locale_t Enumeration of the locales.
+     */
+    template<CatalogKey id_t, CatalogKey locale_t>
+    class catalog {
+    public:
+        /// Number of messages
+        static constexpr std::size_t ids = enum_count_v<id_t>;
+
+        /// Number of locales
+        static constexpr std::size_t locales = enum_count_v<locale_t>;
+
+        /**
+         * @brief Builds a catalog where every message is translated into every locale.
+         *
+         * Fails to compile if an entry is missing or given twice.
+         *
+         * @tparam N Number of entries.
+         * @param aEntries Translations.
+         */
+        template<std::size_t N>
+        consteval explicit catalog(const catalog_entry<id_t, locale_t> (&aEntries)[N]) {
+            build(aEntries, locales);
+        }
+
+        /**
+         * @brief Builds a catalog, untranslated messages taking their text in a fallback locale.
+         *
+         * Fails to compile if an entry is given twice or a message is
+         * missing in the fallback locale.
+         *
+         * @tparam N Number of entries.
+         * @param aEntries Translations.
+         * @param eFallback Locale of untranslated messages.
+         */
+        template<std::size_t N>
+        consteval catalog(const catalog_entry<id_t, locale_t> (&aEntries)[N], const locale_t eFallback) {
+            build(aEntries, static_cast<std::size_t>(eFallback));
+        }
+
+        /**
+         * @brief Message in a locale, in the encoding of a character type.
+         * @tparam char_t Character type.
+         * @param eLocale Locale, below `locale_t::count`.
+         * @param eId Message, below `id_t::count`.
+         * @return View of the message.
+         */
+        template<CharacterType char_t>
+        constexpr basic_string_view<char_t> get(const locale_t eLocale, const id_t eId) const noexcept {
+            return table<char_t>()[static_cast<std::size_t>(eLocale) * ids + static_cast<std::size_t>(eId)];
+        }
+
+        /**
+         * @brief Checks whether a message was translated, rather than taken from the fallback locale.
+         * @param eLocale Locale, below `locale_t::count`.
+         * @param eId Message, below `id_t::count`.
+         * @return True if the catalog has an entry for the pair.
+         */
+        constexpr bool translated(const locale_t eLocale, const id_t eId) const noexcept {
+            return m_aTranslated[static_cast<std::size_t>(eLocale) * ids + static_cast<std::size_t>(eId)];
+        }
+
+    private:
+        /// Table of the views of one encoding
+        template<typename char_t>
+        using table_type = std::array<basic_string_view<char_t>, ids * locales>;
+
+        /**
+         * @brief Table of a character type.
+         * @tparam char_t Character type.
+         * @return The views of every message in its encoding.
+         */
+        template<typename char_t>
+        constexpr const table_type<char_t> &table() const noexcept {
+            if constexpr (std::is_same_v<char_t, char>) return m_aChar;
+            else if constexpr (std::is_same_v<char_t, wchar_t>) return m_aWide;
+            else if constexpr (std::is_same_v<char_t, char8_t>) return m_aUtf8;
+            else if constexpr (std::is_same_v<char_t, char16_t>) return m_aUtf16;
+            else return m_aUtf32;
+        }
+
+        /**
+         * @brief Fills the tables.
+         * @tparam N Number of entries.
+         * @param aEntries Translations.
+         * @param nFallback Index of the fallback locale, `locales` for none.
+         */
+        template<std::size_t N>
+        consteval void build(const catalog_entry<id_t, locale_t> (&aEntries)[N], const std::size_t nFallback) {
+            if (nFallback > locales) throw "utf42::catalog: fallback locale out of range";
+            for (const catalog_entry<id_t, locale_t> &oEntry: aEntries) {
+                const std::size_t nId = static_cast<std::size_t>(oEntry.eId);
+                const std::size_t nLocale = static_cast<std::size_t>(oEntry.eLocale);
+                if (nId >= ids) throw "utf42::catalog: message id out of range";
+                if (nLocale >= locales) throw "utf42::catalog: locale out of range";
+                if (m_aTranslated[nLocale * ids + nId]) throw "utf42::catalog: duplicate entry";
+                m_aTranslated[nLocale * ids + nId] = true;
+                store(nLocale * ids + nId, oEntry.oText);
+            }
+            for (std::size_t nLocale = 0; nLocale < locales; ++nLocale) {
+                for (std::size_t nId = 0; nId < ids; ++nId) {
+                    if (m_aTranslated[nLocale * ids + nId]) continue;
+                    if (nFallback == locales || !m_aTranslated[nFallback * ids + nId]) {
+                        throw "utf42::catalog: missing message";
+                    }
+                    copy(nLocale * ids + nId, nFallback * ids + nId);
+                }
+            }
+        }
+
+        /**
+         * @brief Stores a translation in every table.
+         * @param nCell Index of the (locale, message) pair.
+         * @param oText Translation.
+         */
+        consteval void store(const std::size_t nCell, const poly_enc &oText) {
+            m_aChar[nCell] = oText.visit<char>();
+            m_aWide[nCell] = oText.visit<wchar_t>();
+            m_aUtf8[nCell] = oText.visit<char8_t>();
+            m_aUtf16[nCell] = oText.visit<char16_t>();
+            m_aUtf32[nCell] = oText.visit<char32_t>();
+        }
+
+        /**
+         * @brief Copies a translation between cells of every table.
+         * @param nTo Index of the untranslated pair.
+         * @param nFrom Index of the pair in the fallback locale.
+         */
+        consteval void copy(const std::size_t nTo, const std::size_t nFrom) {
+            m_aChar[nTo] = m_aChar[nFrom];
+            m_aWide[nTo] = m_aWide[nFrom];
+            m_aUtf8[nTo] = m_aUtf8[nFrom];
+            m_aUtf16[nTo] = m_aUtf16[nFrom];
+            m_aUtf32[nTo] = m_aUtf32[nFrom];
+        }
+
+        table_type<char> m_aChar{}; ///< Narrow messages
+        table_type<wchar_t> m_aWide{}; ///< Wide messages
+        table_type<char8_t> m_aUtf8{}; ///< UTF-8 messages
+        table_type<char16_t> m_aUtf16{}; ///< UTF-16 messages
+        table_type<char32_t> m_aUtf32{}; ///< UTF-32 messages
+        std::array<bool, ids * locales> m_aTranslated{}; ///< Whether each pair has an entry
+    };
+} // namespace utf42
+
+#endif //LIB_UTF_42_CATALOG
@@ -0,0 +1,503 @@
+/**
+ * @file utf42_catalog_file.h
+ * @brief Memory-mapped message catalogs with every encoding precomputed.
+ *
+ * Translations shipped apart from the binary cannot be `cons_poly_enc`
+ * literals. This header defines an on-disk catalog holding every message
+ * of every locale already encoded in UTF-8, UTF-16 and UTF-32, which a
+ * program maps read-only: `get<char_t>(nLocale, nId)` returns a view
+ * directly into the mapping, with no parsing, copying or transcoding, and
+ * the pages are shared by every process using the catalog.
+ *
+ * Layout, in native byte order, all offsets in bytes from the file start:
+ *
+ * | Part           | Contents                                                     |
+ * |----------------|--------------------------------------------------------------|
+ * | header         | `catalog_file_header`                                        |
+ * | locale names   | one `catalog_span` per locale, then the UTF-8 names          |
+ * | UTF-8 section  | one `catalog_span` per (locale, message), then the messages   |
+ * | UTF-16 section | same, UTF-16 code units                                      |
+ * | UTF-32 section | same, UTF-32 code units                                      |
+ *
+ * Each encoding section starts on a `catalog_page_size` boundary, so a
+ * program using one encoding only touches the pages of that encoding.
+ * Spans are indexed by `nLocale * ids() + nId` and count code units from
+ * the end of the span table. Messages are null terminated.
+ *
+ * `catalog_file_builder` writes catalogs, `catalog_view` reads them from
+ * memory and `mapped_catalog` maps them from a file (POSIX only).
+ *
+ * @note Requires C++20 or later.
+ *
+ * @copyright MIT License
+ *
+ * This file is part of utf42.
+ * Copyright (c) 2025 Dante Doménech Martínez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef LIB_UTF_42_CATALOG_FILE
+#define LIB_UTF_42_CATALOG_FILE
+
+#include "utf42.h"
+#include "utf42_transcode.h"
+
+// C++ version requirements
+#if __cplusplus < 202002L
+#error "utf42_catalog_file.h requires C++20 or later"
+#endif
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define UTF42_CATALOG_MMAP 1
+#endif
+
+namespace utf42 {
+    /// Alignment of the encoding sections of a catalog file
+    constexpr std::size_t catalog_page_size = 4096;
+
+    /// Current version of the catalog file format
+    constexpr std::uint32_t catalog_file_version = 1;
+
+    /// Number of encoding sections of a catalog file: UTF-8, UTF-16 and UTF-32
+    constexpr std::size_t catalog_encodings = 3;
+
+    /**
+     * @brief Header at the start of a catalog file.
+     */
+    struct catalog_file_header {
+        char aMagic[8]; ///< `"UTF42CAT"`
+        std::uint32_t nVersion; ///< `catalog_file_version`
+        std::uint32_t nByteOrder; ///< `0x01020304` written in the byte order of the file
+        std::uint32_t nLocales; ///< Number of locales
+        std::uint32_t nIds; ///< Number of messages per locale
+        std::uint64_t nNames; ///< Offset of the locale names
+        std::uint64_t aSection[catalog_encodings]; ///< Offset of each encoding section
+        std::uint64_t aSectionSize[catalog_encodings]; ///< Size of each encoding section
+        std::uint64_t nFileSize; ///< Size of the file
+    };
+
+    /**
+     * @brief Location of a string in a catalog file.
+     */
+    struct catalog_span {
+        std::uint32_t nOffset; ///< Offset in code units, `catalog_span::missing` if absent
+        std::uint32_t nLength; ///< Length in code units, excluding the terminator
+
+        /// Offset of absent messages
+        static constexpr std::uint32_t missing = 0xFFFFFFFFu;
+    };
+
+    namespace detail {
+        /// Magic bytes of a catalog file
+        constexpr char catalog_magic[8] = {'U', 'T', 'F', '4', '2', 'C', 'A', 'T'};
+
+        /// Byte order marker of a catalog file
+        constexpr std::uint32_t catalog_byte_order = 0x01020304u;
+
+        /**
+         * @brief Index of the encoding section of a character type.
+         * @tparam char_t Character type.
+         * @return 0 for UTF-8, 1 for UTF-16, 2 for UTF-32.
+         */
+        template<typename char_t>
+        constexpr std::size_t catalog_section() noexcept { return sizeof(char_t) == 1 ? 0 : sizeof(char_t) == 2 ? 1 : 2; }
+
+        /**
+         * @brief Rounds a size up to a power of two.
+         * @param nSize Size.
+         * @param nAlignment Power of two.
+         * @return The smallest multiple of `nAlignment` not below `nSize`.
+         */
+        constexpr std::size_t align_up(const std::size_t nSize, const std::size_t nAlignment) noexcept {
+            return (nSize + nAlignment - 1) & ~(nAlignment - 1);
+        }
+    }
+
+    /**
+     * @brief Read-only view of a catalog in memory.
+     *
+     * Opening checks the header and the bounds of the sections only, in
+     * constant time; every lookup checks its span against its section.
+     */
+    class catalog_view {
+    public:
+        /// Constructs a view of an empty catalog.
+        catalog_view() noexcept = default;
+
+        /**
+         * @brief Views catalog bytes.
+         * @param pData Catalog, aligned to 8 bytes and outliving the view.
+         * @param nSize Size in bytes.
+         * @return The view, or nothing if the bytes are not a catalog of this version and byte order.
+         */
+        static std::optional<catalog_view> parse(const void *pData, const std::size_t nSize) noexcept {
+            const auto *pBytes = static_cast<const unsigned char *>(pData);
+            if (nSize < sizeof(catalog_file_header) || reinterpret_cast<std::uintptr_t>(pBytes) % 8 != 0) {
+                return std::nullopt;
+            }
+            const auto *pHeader = reinterpret_cast<const catalog_file_header *>(pBytes);
+            if (std::memcmp(pHeader->aMagic, detail::catalog_magic, sizeof(detail::catalog_magic)) != 0 ||
+                pHeader->nVersion != catalog_file_version || pHeader->nByteOrder != detail::catalog_byte_order ||
+                pHeader->nFileSize != nSize) {
+                return std::nullopt;
+            }
+            catalog_view oView;
+            oView.m_nLocales = pHeader->nLocales;
+            oView.m_nIds = pHeader->nIds;
+            const std::uint64_t nCells = std::uint64_t(oView.m_nLocales) * oView.m_nIds;
+            if (!oView.bind(pBytes, nSize, pHeader->nNames, nSize - pHeader->nNames, oView.m_nLocales, 1,
+                            oView.m_oNames)) {
+                return std::nullopt;
+            }
+            for (std::size_t i = 0; i < catalog_encodings; ++i) {
+                if (pHeader->aSection[i] % catalog_page_size != 0 ||
+                    !oView.bind(pBytes, nSize, pHeader->aSection[i], pHeader->aSectionSize[i], nCells,
+                                std::size_t(1) << i, oView.m_aSections[i])) {
+                    return std::nullopt;
+                }
+            }
+            return oView;
+        }
+
+        /**
+         * @brief Message in a locale, in the encoding of a character type.
+         * @tparam char_t Character type.
+         * @param nLocale Index of the locale.
+         * @param nId Index of the message.
+         * @return Null terminated view into the catalog, empty if absent or out of range.
+         */
+        template<CharacterType char_t>
+        basic_string_view<char_t> get(const std::size_t nLocale, const std::size_t nId) const noexcept {
+            if (nLocale >= m_nLocales || nId >= m_nIds) return {};
+            return m_aSections[detail::catalog_section<char_t>()].template view<char_t>(nLocale * m_nIds + nId);
+        }
+
+        /**
+         * @brief Checks whether the catalog has a message.
+         * @param nLocale Index of the locale.
+         * @param nId Index of the message.
+         * @return True if the message was given for the locale.
+         */
+        bool contains(const std::size_t nLocale, const std::size_t nId) const noexcept {
+            return nLocale < m_nLocales && nId < m_nIds &&
+                   m_aSections[0].pSpans[nLocale * m_nIds + nId].nOffset != catalog_span::missing;
+        }
+
+        /**
+         * @brief Name of a locale.
+         * @param nLocale Index of the locale.
+         * @return UTF-8 name, empty if out of range.
+         */
+        std::string_view locale_name(const std::size_t nLocale) const noexcept {
+            if (nLocale >= m_nLocales) return {};
+            return m_oNames.view<char>(nLocale);
+        }
+
+        /**
+         * @brief Finds a locale by name.
+         * @param sName UTF-8 name.
+         * @return Index of the locale, `locales()` if absent.
+         */
+        std::size_t find_locale(const std::string_view sName) const noexcept {
+            for (std::size_t i = 0; i < m_nLocales; ++i) {
+                if (locale_name(i) == sName) return i;
+            }
+            return m_nLocales;
+        }
+
+        /// @return Number of locales.
+        std::size_t locales() const noexcept { return m_nLocales; }
+
+        /// @return Number of messages per locale.
+        std::size_t ids() const noexcept { return m_nIds; }
+
+    private:
+        /**
+         * @brief A span table followed by the code units it indexes.
+         */
+        struct section {
+            const catalog_span *pSpans = nullptr; ///< Span of each string
+            const unsigned char *pUnits = nullptr; ///< Code units
+            std::size_t nUnits = 0; ///< Number of code units
+
+            /**
+             * @brief Views a string.
+             * @tparam char_t Character type, of the width of the units.
+             * @param nIndex Index of the span.
+             * @return View of the string, empty if absent or out of bounds.
+             */
+            template<typename char_t>
+            basic_string_view<char_t> view(const std::size_t nIndex) const noexcept {
+                const catalog_span oSpan = pSpans[nIndex];
+                if (oSpan.nOffset > nUnits || oSpan.nLength >= nUnits - oSpan.nOffset) return {};
+                return {reinterpret_cast<const char_t *>(pUnits) + oSpan.nOffset, oSpan.nLength};
+            }
+        };
+
+        /**
+         * @brief Locates a section and checks that it lies within the catalog.
+         * @param pBytes Catalog.
+         * @param nSize Size of the catalog.
+         * @param nOffset Offset of the section.
+         * @param nSectionSize Size of the section.
+         * @param nSpans Number of spans of the section.
+         * @param nUnitSize Size of a code unit.
+         * @param oSection Filled with the section.
+         * @return True if the section is within bounds.
+         */
+        static bool bind(const unsigned char *pBytes, const std::size_t nSize, const std::uint64_t nOffset,
+                         const std::uint64_t nSectionSize, const std::uint64_t nSpans, const std::size_t nUnitSize,
+                         section &oSection) noexcept {
+            const std::uint64_t nTable = nSpans * sizeof(catalog_span);
+            if (nOffset % alignof(catalog_span) != 0 || nOffset > nSize || nSectionSize > nSize - nOffset ||
+                nTable > nSectionSize) {
+                return false;
+            }
+            oSection.pSpans = reinterpret_cast<const catalog_span *>(pBytes + nOffset);
+            oSection.pUnits = pBytes + nOffset + nTable;
+            oSection.nUnits = static_cast<std::size_t>((nSectionSize - nTable) / nUnitSize);
+            return true;
+        }
+
+        std::size_t m_nLocales = 0; ///< Number of locales
+        std::size_t m_nIds = 0; ///< Number of messages per locale
+        section m_oNames; ///< Locale names
+        section m_aSections[catalog_encodings]; ///< UTF-8, UTF-16 and UTF-32 messages
+    };
+
+    /**
+     * @brief Writes catalog files.
+     *
+     * Messages are given in UTF-8 and encoded in the three sections when
+     * the catalog is serialized, in (locale, message) order. Identical
+     * messages are stored once per section.
+     */
+    class catalog_file_builder {
+    public:
+        /**
+         * @brief Starts an empty catalog.
+         * @param aLocales UTF-8 names of the locales.
+         * @param nIds Number of messages per locale.
+         */
+        catalog_file_builder(std::vector<std::string> aLocales, const std::size_t nIds)
+            : m_aLocales(std::move(aLocales)), m_nIds(nIds), m_aMessages(m_aLocales.size() * nIds) {
+        }
+
+        /**
+         * @brief Sets a message.
+         * @param nLocale Index of the locale.
+         * @param nId Index of the message.
+         * @param sText UTF-8 message.
+         * @return False if the indices are out of range or the message is ill-formed.
+         */
+        bool set(const std::size_t nLocale, const std::size_t nId, const std::string_view sText) {
+            if (nLocale >= m_aLocales.size() || nId >= m_nIds || !utf42::validate(sText)) return false;
+            m_aMessages[nLocale * m_nIds + nId] = std::string(sText);
+            return true;
+        }
+
+        /**
+         * @brief Encodes the catalog.
+         * @return The bytes of the catalog file.
+         */
+        std::vector<unsigned char> serialize() const {
+            catalog_file_header oHeader{};
+            std::memcpy(oHeader.aMagic, detail::catalog_magic, sizeof(oHeader.aMagic));
+            oHeader.nVersion = catalog_file_version;
+            oHeader.nByteOrder = detail::catalog_byte_order;
+            oHeader.nLocales = static_cast<std::uint32_t>(m_aLocales.size());
+            oHeader.nIds = static_cast<std::uint32_t>(m_nIds);
+            oHeader.nNames = sizeof(catalog_file_header);
+
+            std::vector<unsigned char> aBytes(sizeof(catalog_file_header));
+            std::vector<const std::string *> aNames;
+            for (const std::string &sName: m_aLocales) aNames.push_back(&sName);
+            append_section<char>(aBytes, aNames);
+            std::vector<const std::string *> aTexts;
+            for (const std::optional<std::string> &oText: m_aMessages) aTexts.push_back(oText ? &*oText : nullptr);
+            for (std::size_t i = 0; i < catalog_encodings; ++i) {
+                aBytes.resize(detail::align_up(aBytes.size(), catalog_page_size));
+                oHeader.aSection[i] = aBytes.size();
+                if (i == 0) append_section<char>(aBytes, aTexts);
+                else if (i == 1) append_section<char16_t>(aBytes, aTexts);
+                else append_section<char32_t>(aBytes, aTexts);
+                oHeader.aSectionSize[i] = aBytes.size() - oHeader.aSection[i];
+            }
+            oHeader.nFileSize = aBytes.size();
+            std::memcpy(aBytes.data(), &oHeader, sizeof(oHeader));
+            return aBytes;
+        }
+
+        /**
+         * @brief Writes the catalog to a file.
+         * @param sPath Path of the file.
+         * @return True on success.
+         */
+        bool write(const std::string &sPath) const {
+            const std::vector<unsigned char> aBytes = serialize();
+            std::ofstream oFile(sPath, std::ios::binary | std::ios::trunc);
+            oFile.write(reinterpret_cast<const char *>(aBytes.data()), static_cast<std::streamsize>(aBytes.size()));
+            return static_cast<bool>(oFile.flush());
+        }
+
+    private:
+        /**
+         * @brief Appends a span table and the strings it indexes.
+         *
+         * Strings are stored in the order of their first span, so the
+         * messages of a locale are contiguous, and identical strings once.
+         *
+         * @tparam char_t Character type of the section.
+         * @param aBytes Catalog being written.
+         * @param aTexts UTF-8 strings, null for absent ones.
+         */
+        template<typename char_t>
+        static void append_section(std::vector<unsigned char> &aBytes, const std::vector<const std::string *> &aTexts) {
+            const std::size_t nTable = aBytes.size();
+            aBytes.resize(nTable + aTexts.size() * sizeof(catalog_span));
+            std::basic_string<char_t> sUnits;
+            std::unordered_map<std::string_view, catalog_span> mStored;
+            for (std::size_t i = 0; i < aTexts.size(); ++i) {
+                catalog_span oSpan{catalog_span::missing, 0};
+                if (aTexts[i] != nullptr) {
+                    const auto [itStored, bNew] = mStored.try_emplace(*aTexts[i]);
+                    if (bNew) {
+                        const std::basic_string<char_t> sText = utf42::transcode<char_t>(std::string_view(*aTexts[i]));
+                        itStored->second = {static_cast<std::uint32_t>(sUnits.size()),
+                                            static_cast<std::uint32_t>(sText.size())};
+                        sUnits += sText;
+                        sUnits += char_t();
+                    }
+                    oSpan = itStored->second;
+                }
+                std::memcpy(aBytes.data() + nTable + i * sizeof(catalog_span), &oSpan, sizeof(oSpan));
+            }
+            const auto *pUnits = reinterpret_cast<const unsigned char *>(sUnits.data());
+            aBytes.insert(aBytes.end(), pUnits, pUnits + sUnits.size() * sizeof(char_t));
+        }
+
+        std::vector<std::string> m_aLocales; ///< Locale names
+        std::size_t m_nIds; ///< Number of messages per locale
+        std::vector<std::optional<std::string> > m_aMessages; ///< UTF-8 messages by locale then message
+    };
+
+#if defined(UTF42_CATALOG_MMAP)
+    /**
+     * @brief Catalog file mapped read-only.
+     *
+     * The mapping is shared: processes mapping the same file share its
+     * pages through the page cache.
+     */
+    class mapped_catalog {
+    public:
+        /// Constructs an empty catalog.
+        mapped_catalog() noexcept = default;
+
+        mapped_catalog(const mapped_catalog &) = delete;
+
+        mapped_catalog &operator=(const mapped_catalog &) = delete;
+
+        /**
+         * @brief Takes over another mapping.
+         * @param oOther Mapping to move, left empty.
+         */
+        mapped_catalog(mapped_catalog &&oOther) noexcept
+            : m_pData(std::exchange(oOther.m_pData, nullptr)), m_nSize(std::exchange(oOther.m_nSize, 0)),
+              m_oView(std::exchange(oOther.m_oView, catalog_view())) {
+        }
+
+        /**
+         * @brief Takes over another mapping.
+         * @param oOther Mapping to move, left empty.
+         * @return This catalog.
+         */
+        mapped_catalog &operator=(mapped_catalog &&oOther) noexcept {
+            if (this != &oOther) {
+                unmap();
+                m_pData = std::exchange(oOther.m_pData, nullptr);
+                m_nSize = std::exchange(oOther.m_nSize, 0);
+                m_oView = std::exchange(oOther.m_oView, catalog_view());
+            }
+            return *this;
+        }
+
+        /// Unmaps the file.
+        ~mapped_catalog() { unmap(); }
+
+        /**
+         * @brief Maps a catalog file.
+         * @param sPath Path of the file.
+         * @return The catalog, or nothing if the file cannot be mapped or is not a catalog.
+         */
+        static std::optional<mapped_catalog> open(const std::string &sPath) {
+            const int nFd = ::open(sPath.c_str(), O_RDONLY | O_CLOEXEC);
+            if (nFd < 0) return std::nullopt;
+            struct stat oStat{};
+            void *pData = MAP_FAILED;
+            if (fstat(nFd, &oStat) == 0 && oStat.st_size > 0) {
+                pData = mmap(nullptr, static_cast<std::size_t>(oStat.st_size), PROT_READ, MAP_SHARED, nFd, 0);
+            }
+            ::close(nFd);
+            if (pData == MAP_FAILED) return std::nullopt;
+            mapped_catalog oCatalog;
+            oCatalog.m_pData = pData;
+            oCatalog.m_nSize = static_cast<std::size_t>(oStat.st_size);
+            const std::optional<catalog_view> oView = catalog_view::parse(pData, oCatalog.m_nSize);
+            if (!oView) return std::nullopt;
+            oCatalog.m_oView = *oView;
+            return oCatalog;
+        }
+
+        /// @return The catalog.
+        const catalog_view &view() const noexcept { return m_oView; }
+
+        /// @copydoc catalog_view::get
+        template<CharacterType char_t>
+        basic_string_view<char_t> get(const std::size_t nLocale, const std::size_t nId) const noexcept {
+            return m_oView.get<char_t>(nLocale, nId);
+        }
+
+    private:
+        /// Releases the mapping
+        void unmap() noexcept {
+            if (m_pData != nullptr) munmap(m_pData, m_nSize);
+            m_pData = nullptr;
+        }
+
+        void *m_pData = nullptr; ///< Mapped file
+        std::size_t m_nSize = 0; ///< Size of the mapping
+        catalog_view m_oView; ///< View of the mapping
+    };
+#endif
+} // namespace utf42
+
+#endif //LIB_UTF_42_CATALOG_FILE
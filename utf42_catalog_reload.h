@@ -0,0 +1,364 @@
+/**
+ * @file utf42_catalog_reload.h
+ * @brief Hot-reloadable catalogs.
+ *
+ * A `utf42::reloadable_catalog` holds the current version of a catalog
+ * file and replaces it while other threads read it. Readers take a
+ * `snapshot`, which costs a thread-local store and an atomic load and never
+ * blocks. A reload maps the new file outside any lock, publishes it with one
+ * atomic exchange, and unmaps the old version once no snapshot taken before
+ * the exchange is alive (epoch-based reclamation, as in read-copy-update).
+ *
+ * @code
+ * utf42::reloadable_catalog oCatalog;
+ * oCatalog.reload("messages.cat");
+ *
+ * // Any thread
+ * const auto oSnapshot = oCatalog.read();
+ * std::u16string_view sText = oSnapshot->get<char16_t>(nLocale, nId); // valid while oSnapshot lives
+ *
+ * // Background thread, when a new version is pushed
+ * oCatalog.reload("messages.cat");
+ * @endcode
+ *
+ * The swapping itself is provided for any type by `utf42::hot_swap`.
+ *
+ * @note Requires C++20 or later.
+ *
+ * @copyright MIT License
+ *
+ * This file is part of utf42.
+ * Copyright (c) 2025 Dante Doménech Martínez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef LIB_UTF_42_CATALOG_RELOAD
+#define LIB_UTF_42_CATALOG_RELOAD
+
+#include "utf42_catalog_file.h"
+
+// C++ version requirements
+#if __cplusplus < 202002L
+#error "utf42_catalog_reload.h requires C++20 or later"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace utf42 {
+    namespace detail {
+        /**
+         * @brief Read-side state of one thread.
+         *
+         * Records are linked into a list that only grows; a record is
+         * reused by another thread once its thread exits.
+         */
+        struct alignas(64) rcu_record {
+            std::atomic<std::uint64_t> nEpoch{0}; ///< Epoch at which the outermost read started, 0 outside reads
+            std::atomic<bool> bInUse{true}; ///< Whether a thread owns the record
+            std::size_t nDepth = 0; ///< Nesting of the reads of the owning thread
+            rcu_record *pNext = nullptr; ///< Next record
+        };
+
+        /**
+         * @brief Process-wide epochs and reader records.
+         *
+         * Every publication advances the epoch. A reader stores the epoch
+         * before loading the published pointer, so a version retired at
+         * epoch `e` can only be held by readers whose stored epoch is below `e`.
+         */
+        class rcu_domain {
+        public:
+            /// @return The domain, created on first use and never destroyed.
+            static rcu_domain &instance() {
+                static rcu_domain *const pDomain = new rcu_domain();
+                return *pDomain;
+            }
+
+            /// @brief Starts a read on the calling thread, reads nest.
+            void enter() noexcept {
+                rcu_record &oRecord = record();
+                if (oRecord.nDepth++ == 0) {
+                    // Reading an epoch advanced by a publication synchronizes with it, so the pointer
+                    // loaded next is at least the one published; the sequentially consistent store is
+                    // then seen by any later collection before it frees what this read may load.
+                    // A record linked by the first read of a thread is covered too: the link and the
+                    // scan of the records in oldest() are also sequentially consistent, so a scan that
+                    // misses the record comes before the link, and its publication before this read
+                    oRecord.nEpoch.store(m_nEpoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+                }
+            }
+
+            /// @brief Ends a read started on the calling thread.
+            void leave() noexcept {
+                rcu_record &oRecord = record();
+                if (--oRecord.nDepth == 0) oRecord.nEpoch.store(0, std::memory_order_release);
+            }
+
+            /**
+             * @brief Advances the epoch, after a new version was published.
+             * @return The new epoch, at which the previous version is retired.
+             */
+            std::uint64_t advance() noexcept { return m_nEpoch.fetch_add(1, std::memory_order_seq_cst) + 1; }
+
+            /**
+             * @brief Scans the reader records.
+             *
+             * The list head is loaded in the sequentially consistent order of
+             * `advance` and of the links of `acquire`, see `enter`.
+             *
+             * @return The epoch of the oldest read in progress, or the maximum epoch if there is none.
+             */
+            std::uint64_t oldest() const noexcept {
+                std::uint64_t nOldest = std::numeric_limits<std::uint64_t>::max();
+                for (const rcu_record *pRecord = m_pHead.load(std::memory_order_seq_cst); pRecord != nullptr;
+                     pRecord = pRecord->pNext) {
+                    const std::uint64_t nEpoch = pRecord->nEpoch.load(std::memory_order_seq_cst);
+                    if (nEpoch != 0) nOldest = std::min(nOldest, nEpoch);
+                }
+                return nOldest;
+            }
+
+        private:
+            /// Owner of the record of a thread, releasing it at thread exit
+            struct thread_record {
+                rcu_record *pRecord = nullptr; ///< Record, taken on the first read
+
+                ~thread_record() {
+                    if (pRecord != nullptr) pRecord->bInUse.store(false, std::memory_order_release);
+                }
+            };
+
+            rcu_domain() = default;
+
+            /// @return The record of the calling thread.
+            rcu_record &record() noexcept {
+                static thread_local thread_record oThread;
+                if (oThread.pRecord == nullptr) [[unlikely]] oThread.pRecord = acquire();
+                return *oThread.pRecord;
+            }
+
+            /**
+             * @brief Takes a record for the calling thread.
+             *
+             * A new record is linked with a sequentially consistent
+             * compare-and-swap, ordered with the scans of `oldest`.
+             *
+             * @return A free record, reused or newly linked.
+             */
+            rcu_record *acquire() {
+                for (rcu_record *pRecord = m_pHead.load(std::memory_order_acquire); pRecord != nullptr;
+                     pRecord = pRecord->pNext) {
+                    bool bInUse = false;
+                    if (pRecord->bInUse.compare_exchange_strong(bInUse, true, std::memory_order_acquire)) {
+                        return pRecord;
+                    }
+                }
+                rcu_record *pRecord = new rcu_record();
+                pRecord->pNext = m_pHead.load(std::memory_order_relaxed);
+                while (!m_pHead.compare_exchange_weak(pRecord->pNext, pRecord, std::memory_order_seq_cst,
+                                                      std::memory_order_relaxed)) {
+                }
+                return pRecord;
+            }
+
+            std::atomic<std::uint64_t> m_nEpoch{1}; ///< Current epoch, 0 is reserved for idle records
+            std::atomic<rcu_record *> m_pHead{nullptr}; ///< Reader records
+        };
+    }
+
+    /**
+     * @brief A value replaced while other threads read it.
+     *
+     * Readers never block: `read` pins the current version until the
+     * returned snapshot is destroyed. `publish` swaps in a new version and
+     * destroys the versions no snapshot can still see. Publications are
+     * serialized among themselves only.
+     *
+     * @tparam value_t Type of the value.
+     */
+    template<typename value_t>
+    class hot_swap {
+    public:
+        /**
+         * @brief Pins the version current when it was taken.
+         *
+         * A snapshot must be destroyed on the thread that took it. Older
+         * versions are kept alive while it exists, so snapshots should be
+         * short-lived, as around one lookup or one request.
+         */
+        class snapshot {
+        public:
+            snapshot(const snapshot &) = delete;
+
+            snapshot &operator=(const snapshot &) = delete;
+
+            /**
+             * @brief Takes over another snapshot.
+             * @param oOther Snapshot to move, left released.
+             */
+            snapshot(snapshot &&oOther) noexcept
+                : m_pValue(std::exchange(oOther.m_pValue, nullptr)), m_bPinned(std::exchange(oOther.m_bPinned, false)) {
+            }
+
+            snapshot &operator=(snapshot &&) = delete;
+
+            /// Releases the version.
+            ~snapshot() {
+                if (m_bPinned) detail::rcu_domain::instance().leave();
+            }
+
+            /// @return The version, null if nothing was published.
+            const value_t *get() const noexcept { return m_pValue; }
+
+            /// @return The version, which must exist.
+            const value_t *operator->() const noexcept { return m_pValue; }
+
+            /// @return The version, which must exist.
+            const value_t &operator*() const noexcept { return *m_pValue; }
+
+            /// @return True if a version was published.
+            explicit operator bool() const noexcept { return m_pValue != nullptr; }
+
+        private:
+            friend class hot_swap;
+
+            /**
+             * @brief Pins the current version.
+             * @param oCurrent Published pointer.
+             */
+            explicit snapshot(const std::atomic<value_t *> &oCurrent) noexcept {
+                detail::rcu_domain::instance().enter();
+                m_pValue = oCurrent.load(std::memory_order_seq_cst);
+            }
+
+            const value_t *m_pValue = nullptr; ///< Pinned version
+            bool m_bPinned = true; ///< Whether the snapshot must leave its read
+        };
+
+        /// Constructs an empty value.
+        hot_swap() noexcept = default;
+
+        hot_swap(const hot_swap &) = delete;
+
+        hot_swap &operator=(const hot_swap &) = delete;
+
+        /// Destroys every version. No snapshot may be alive.
+        ~hot_swap() {
+            delete m_pCurrent.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Pins the current version.
+         * @return Snapshot of the current version, which may be empty.
+         */
+        snapshot read() const noexcept { return snapshot(m_pCurrent); }
+
+        /**
+         * @brief Replaces the current version.
+         *
+         * Readers see either version until the swap and the new one
+         * afterwards. The old version is destroyed here or in a later call
+         * once the snapshots that may hold it are gone.
+         *
+         * @param pValue New version, may be null.
+         */
+        void publish(std::unique_ptr<value_t> pValue) {
+            std::lock_guard<std::mutex> oLock(m_oWriters);
+            value_t *pOld = m_pCurrent.exchange(pValue.release(), std::memory_order_seq_cst);
+            const std::uint64_t nEpoch = detail::rcu_domain::instance().advance();
+            if (pOld != nullptr) m_aRetired.emplace_back(nEpoch, std::unique_ptr<value_t>(pOld));
+            collect();
+        }
+
+        /**
+         * @brief Destroys the retired versions no snapshot can still see.
+         * @return Number of retired versions left.
+         */
+        std::size_t reclaim() {
+            std::lock_guard<std::mutex> oLock(m_oWriters);
+            return collect();
+        }
+
+        /**
+         * @brief Waits until every retired version is destroyed.
+         *
+         * Must not be called while the calling thread holds a snapshot.
+         */
+        void synchronize() {
+            while (reclaim() != 0) std::this_thread::yield();
+        }
+
+    private:
+        /**
+         * @brief Destroys the retired versions older than every read in progress. The caller holds the writer lock.
+         * @return Number of retired versions left.
+         */
+        std::size_t collect() {
+            if (m_aRetired.empty()) return 0;
+            const std::uint64_t nOldest = detail::rcu_domain::instance().oldest();
+            std::erase_if(m_aRetired, [nOldest](const auto &oRetired) { return oRetired.first <= nOldest; });
+            return m_aRetired.size();
+        }
+
+        std::atomic<value_t *> m_pCurrent{nullptr}; ///< Published version
+        std::mutex m_oWriters; ///< Serializes publications and reclamation
+        std::vector<std::pair<std::uint64_t, std::unique_ptr<value_t> > > m_aRetired; ///< Replaced versions and the epochs they were retired at
+    };
+
+#if defined(UTF42_CATALOG_MMAP)
+    /**
+     * @brief A mapped catalog file that can be reloaded while it is read.
+     *
+     * Lookups go through a `snapshot`, whose views stay valid until it is
+     * destroyed even if the catalog is reloaded meanwhile.
+     */
+    class reloadable_catalog : public hot_swap<mapped_catalog> {
+    public:
+        /**
+         * @brief Maps a catalog file and makes it the current version.
+         *
+         * The file is mapped and checked before the swap, readers are never
+         * blocked, and a file that cannot be mapped leaves the current
+         * version in place. New versions should be written to another path
+         * and renamed over the old one, so that the mapped file never changes.
+         *
+         * @param sPath Path of the file.
+         * @return True if the file was mapped and published.
+         */
+        bool reload(const std::string &sPath) {
+            std::optional<mapped_catalog> oCatalog = mapped_catalog::open(sPath);
+            if (!oCatalog) return false;
+            publish(std::make_unique<mapped_catalog>(std::move(*oCatalog)));
+            return true;
+        }
+    };
+#endif
+} // namespace utf42
+
+#endif //LIB_UTF_42_CATALOG_RELOAD
@@ -0,0 +1,267 @@
+/**
+ * @file utf42_coroutine.h
+ * @brief Coroutine interface for streaming transcoding.
+ *
+ * `utf42::transcode_stream` is an asynchronous generator stage: it pulls
+ * chunks from an asynchronous source of `basic_string_view<from_t>` and
+ * yields transcoded `basic_string_view<to_t>` chunks. Since its output has
+ * the same type as its input, stages compose into pipelines.
+ *
+ * Output is written into a fixed set of buffers allocated once per stream,
+ * so no allocation happens per chunk. The stage only suspends at chunk
+ * boundaries: to wait for the next input chunk or to hand out a result.
+ *
+ * @note Requires C++20 or later.
+ *
+ * @copyright MIT License
+ *
+ * This file is part of utf42.
+ * Copyright (c) 2025 Dante Doménech Martínez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef LIB_UTF_42_COROUTINE
+#define LIB_UTF_42_COROUTINE
+
+#include "utf42_transcode.h"
+
+// C++ version requirements
+#if __cplusplus < 202002L
+#error "utf42_coroutine.h requires C++20 or later"
+#endif
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace utf42 {
+    /**
+     * @brief Lazily started asynchronous generator.
+     *
+     * The body may `co_await` anything and `co_yield` values. A consumer
+     * coroutine obtains the values with `co_await oGenerator.next()`, which
+     * returns `std::nullopt` once the body has finished. Control is passed
+     * between consumer and body by symmetric transfer, without any scheduler.
+     *
+     * @tparam value_t Type of the yielded values.
+     */
+    template<typename value_t>
+    class async_generator {
+    public:
+        /**
+         * @brief Coroutine promise of `async_generator`.
+         */
+        struct promise_type;
+
+        /// Handle to the generator coroutine
+        using handle_type = std::coroutine_handle<promise_type>;
+
+        /**
+         * @brief Awaiter resuming whoever waits for the generator.
+         */
+        struct yield_awaiter {
+            /// @return Always false, the generator suspends.
+            bool await_ready() const noexcept { return false; }
+
+            /**
+             * @brief Transfers control to the consumer.
+             * @param hSelf The suspending generator.
+             * @return The consumer, or a no-op coroutine if there is none.
+             */
+            std::coroutine_handle<> await_suspend(handle_type hSelf) const noexcept {
+                const std::coroutine_handle<> hConsumer = hSelf.promise().m_hConsumer;
+                return hConsumer ? hConsumer : std::noop_coroutine();
+            }
+
+            /// Nothing to return on resumption.
+            void await_resume() const noexcept {
+            }
+        };
+
+        struct promise_type {
+            /// @return The generator owning this coroutine.
+            async_generator get_return_object() noexcept {
+                return async_generator(handle_type::from_promise(*this));
+            }
+
+            /// @return The body only starts on the first `next()`.
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+
+            /// @return Resumes the consumer waiting for the end.
+            yield_awaiter final_suspend() const noexcept { return {}; }
+
+            /**
+             * @brief Publishes a value and resumes the consumer.
+             * @param oValue Yielded value.
+             * @return Awaiter transferring control.
+             */
+            yield_awaiter yield_value(value_t oValue) noexcept(std::is_nothrow_move_constructible_v<value_t>) {
+                m_oValue = std::move(oValue);
+                return {};
+            }
+
+            /// The body finished.
+            void return_void() const noexcept {
+            }
+
+            /// Keeps the exception for the consumer.
+            void unhandled_exception() noexcept {
+                m_pError = std::current_exception();
+            }
+
+            std::optional<value_t> m_oValue; ///< Last yielded value
+            std::coroutine_handle<> m_hConsumer; ///< Coroutine waiting in `next()`
+            std::exception_ptr m_pError; ///< Exception escaped from the body
+        };
+
+        /**
+         * @brief Awaiter returned by `next()`.
+         */
+        struct next_awaiter {
+            /// @return True if the generator has already finished.
+            bool await_ready() const noexcept { return !m_hCoroutine || m_hCoroutine.done(); }
+
+            /**
+             * @brief Runs the generator until its next value.
+             * @param hConsumer The awaiting coroutine.
+             * @return The generator to resume.
+             */
+            std::coroutine_handle<> await_suspend(const std::coroutine_handle<> hConsumer) noexcept {
+                m_hCoroutine.promise().m_hConsumer = hConsumer;
+                m_hCoroutine.promise().m_oValue.reset();
+                return m_hCoroutine;
+            }
+
+            /**
+             * @brief Retrieves the value.
+             * @return The yielded value, or `std::nullopt` at the end.
+             */
+            std::optional<value_t> await_resume() {
+                if (!m_hCoroutine) return std::nullopt;
+                promise_type &oPromise = m_hCoroutine.promise();
+                if (m_hCoroutine.done()) {
+                    if (oPromise.m_pError) std::rethrow_exception(std::exchange(oPromise.m_pError, nullptr));
+                    return std::nullopt;
+                }
+                return std::move(oPromise.m_oValue);
+            }
+
+            handle_type m_hCoroutine; ///< Generator being awaited
+        };
+
+        /// Constructs an empty generator.
+        async_generator() noexcept = default;
+
+        /**
+         * @brief Takes ownership of another generator.
+         * @param oOther Generator to move from.
+         */
+        async_generator(async_generator &&oOther) noexcept
+            : m_hCoroutine(std::exchange(oOther.m_hCoroutine, nullptr)) {
+        }
+
+        /**
+         * @brief Takes ownership of another generator.
+         * @param oOther Generator to move from.
+         * @return This generator.
+         */
+        async_generator &operator=(async_generator &&oOther) noexcept {
+            if (this != &oOther) {
+                if (m_hCoroutine) m_hCoroutine.destroy();
+                m_hCoroutine = std::exchange(oOther.m_hCoroutine, nullptr);
+            }
+            return *this;
+        }
+
+        /// Destroys the coroutine frame.
+        ~async_generator() {
+            if (m_hCoroutine) m_hCoroutine.destroy();
+        }
+
+        /**
+         * @brief Requests the next value.
+         * @return An awaiter yielding `std::optional<value_t>`.
+         */
+        next_awaiter next() noexcept { return next_awaiter{m_hCoroutine}; }
+
+    private:
+        /**
+         * @brief Wraps a coroutine handle.
+         * @param hCoroutine Handle to own.
+         */
+        explicit async_generator(const handle_type hCoroutine) noexcept : m_hCoroutine(hCoroutine) {
+        }
+
+        handle_type m_hCoroutine; ///< Owned coroutine
+    };
+
+    /**
+     * @brief Transcodes an asynchronous stream of chunks.
+     *
+     * Input chunks may be cut anywhere, unfinished code points are carried
+     * over. Input chunks too large for one output buffer are transcoded in
+     * several pieces. Empty results are not yielded.
+     *
+     * The output buffers are allocated once. A yielded chunk remains valid
+     * while fewer than `nBuffers` further chunks have been requested.
+     *
+     * @tparam to_t Destination character type.
+     * @tparam from_t Source character type.
+     * @param oSource Asynchronous source of input chunks.
+     * @param nBufferSize Capacity of each output buffer in code units.
+     * @param nBuffers Number of output buffers used in rotation.
+     * @return Asynchronous generator of transcoded chunks.
+     */
+    template<CharacterType to_t, CharacterType from_t>
+    async_generator<basic_string_view<to_t> >
+    transcode_stream(async_generator<basic_string_view<from_t> > oSource,
+                     std::size_t nBufferSize = 16 * 1024, std::size_t nBuffers = 2) {
+        using transcoder = stream_transcoder<to_t, from_t>;
+        // Each output buffer must fit at least one input unit plus the pending state
+        if (nBufferSize < transcoder::max_output(1)) nBufferSize = transcoder::max_output(1);
+        if (nBuffers == 0) nBuffers = 1;
+        const std::size_t nPiece = nBufferSize / detail::max_expansion<to_t, from_t>() - transcoder::max_pending;
+
+        std::vector<to_t> aStorage(nBufferSize * nBuffers);
+        transcoder oTranscoder;
+        std::size_t nNext = 0;
+        while (std::optional<basic_string_view<from_t> > oChunk = co_await oSource.next()) {
+            basic_string_view<from_t> sChunk = *oChunk;
+            while (!sChunk.empty()) {
+                const basic_string_view<from_t> sPiece = sChunk.substr(0, nPiece);
+                sChunk.remove_prefix(sPiece.size());
+                to_t *pOut = aStorage.data() + (nNext % nBuffers) * nBufferSize;
+                const std::size_t nWritten = oTranscoder.transcode(sPiece, pOut);
+                if (nWritten != 0) {
+                    ++nNext;
+                    co_yield basic_string_view<to_t>(pOut, nWritten);
+                }
+            }
+        }
+        to_t *pOut = aStorage.data() + (nNext % nBuffers) * nBufferSize;
+        const std::size_t nWritten = oTranscoder.finish(pOut);
+        if (nWritten != 0) {
+            co_yield basic_string_view<to_t>(pOut, nWritten);
+        }
+    }
+} // namespace utf42
+
+#endif //LIB_UTF_42_COROUTINE
@@ -0,0 +1,335 @@
+/**
+ * @file utf42_detect.h
+ * @brief Byte order mark detection and encoding sniffing.
+ *
+ * `utf42::detect_encoding` tells which Unicode encoding scheme a byte
+ * buffer most likely uses, so that the right transcoder can be chosen
+ * without a failed full decode attempt:
+ * 1. A byte order mark is decisive.
+ * 2. Otherwise the zero bytes of a bounded prefix are counted per position
+ *    modulo 4, eight bytes at a time (SWAR). ASCII-heavy UTF-16 and UTF-32
+ *    text leaves a very distinctive pattern of zero bytes.
+ * 3. The candidate is confirmed by validating the prefix.
+ *
+ * @note Requires C++17 or later.
+ *
+ * @copyright MIT License
+ *
+ * This file is part of utf42.
+ * Copyright (c) 2025 Dante Doménech Martínez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef LIB_UTF_42_DETECT
+#define LIB_UTF_42_DETECT
+
+#include "utf42_transcode.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace utf42 {
+    /**
+     * @brief Unicode encoding scheme of a byte buffer, including its byte order.
+     */
+    enum class byte_encoding : unsigned char {
+        unknown, ///< Not recognized
+        utf8, ///< UTF-8
+        utf16le, ///< UTF-16 little endian
+        utf16be, ///< UTF-16 big endian
+        utf32le, ///< UTF-32 little endian
+        utf32be, ///< UTF-32 big endian
+    };
+
+    /**
+     * @brief Result of `detect_encoding`.
+     */
+    struct detected_encoding {
+        byte_encoding eEncoding = byte_encoding::unknown; ///< Most likely encoding
+        std::size_t nBom = 0; ///< Size of the byte order mark in bytes, 0 if absent
+        unsigned nConfidence = 0; ///< Confidence in percent, 100 for a byte order mark
+    };
+
+    namespace detail {
+        /**
+         * @brief Population count of a 64-bit word.
+         *
+         * @param nWord Word to count.
+         * @return Number of set bits.
+         */
+        inline unsigned popcount64(std::uint64_t nWord) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<unsigned>(__builtin_popcountll(nWord));
+#else
+            nWord = nWord - ((nWord >> 1) & 0x5555555555555555ull);
+            nWord = (nWord & 0x3333333333333333ull) + ((nWord >> 2) & 0x3333333333333333ull);
+            nWord = (nWord + (nWord >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+            return static_cast<unsigned>((nWord * 0x0101010101010101ull) >> 56);
+#endif
+        }
+
+        /**
+         * @brief Counts the zero bytes of a buffer by position modulo 4.
+         *
+         * @param pData Bytes to inspect.
+         * @param nSize Number of bytes.
+         * @param aZeros Receives the counts, indexed by position modulo 4.
+         */
+        inline void count_zero_lanes(const unsigned char *pData, const std::size_t nSize, std::size_t aZeros[4]) noexcept {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            constexpr bool bLittle = false;
+#else
+            constexpr bool bLittle = true;
+#endif
+            constexpr std::uint64_t nLow = 0x7F7F7F7F7F7F7F7Full;
+            aZeros[0] = aZeros[1] = aZeros[2] = aZeros[3] = 0;
+            std::size_t i = 0;
+            for (; i + 8 <= nSize; i += 8) {
+                std::uint64_t nWord = 0;
+                std::memcpy(&nWord, pData + i, sizeof(nWord));
+                // Exactly the high bit of every zero byte
+                const std::uint64_t nZero = ~(((nWord & nLow) + nLow) | nWord | nLow);
+                for (unsigned k = 0; k < 4; ++k) {
+                    const std::uint64_t nLane = bLittle
+                                                    ? 0x0000008000000080ull << (8 * k)
+                                                    : 0x8000000080000000ull >> (8 * k);
+                    aZeros[k] += popcount64(nZero & nLane);
+                }
+            }
+            for (; i < nSize; ++i) {
+                if (pData[i] == 0) ++aZeros[i % 4];
+            }
+        }
+
+        /**
+         * @brief Validates UTF-16 or UTF-32 code units stored with a given byte order.
+         *
+         * @tparam nUnit Code unit size in bytes (2 or 4).
+         * @tparam bLittle True for little endian storage.
+         * @param pData Bytes to validate.
+         * @param nSize Number of bytes, a multiple of `nUnit`.
+         * @param bCut True if the buffer is a prefix, which may end inside a surrogate pair.
+         * @return True if the code units are well-formed.
+         */
+        template<std::size_t nUnit, bool bLittle>
+        bool validate_units(const unsigned char *pData, const std::size_t nSize, const bool bCut) noexcept {
+            bool bHigh = false;
+            for (std::size_t i = 0; i < nSize; i += nUnit) {
+                std::uint32_t nCode = 0;
+                for (std::size_t k = 0; k < nUnit; ++k) {
+                    nCode |= static_cast<std::uint32_t>(pData[i + k]) << (8 * (bLittle ? k : nUnit - 1 - k));
+                }
+                if constexpr (nUnit == 2) {
+                    const bool bLow = (nCode & 0xFC00) == 0xDC00;
+                    if (bLow != bHigh) return false;
+                    bHigh = (nCode & 0xFC00) == 0xD800;
+                } else {
+                    if (nCode > 0x10FFFF || (nCode >= 0xD800 && nCode <= 0xDFFF)) return false;
+                }
+            }
+            return !bHigh || bCut;
+        }
+
+        /**
+         * @brief Checks whether well-formed UTF-16 without zero bytes looks like text.
+         *
+         * Text without ASCII, such as CJK, keeps its high bytes within a few
+         * script blocks while its low bytes spread over the whole range. An
+         * 8-bit text read as UTF-16 shows neither: both halves of each unit
+         * are mostly ASCII, and non-ASCII letters land in control or private
+         * use code points.
+         *
+         * @tparam bLittle True for little endian storage.
+         * @param pData Bytes to inspect.
+         * @param nSize Number of bytes, a multiple of 2.
+         * @return True if the units show the UTF-16 pattern.
+         */
+        template<bool bLittle>
+        bool looks_like_utf16(const unsigned char *pData, const std::size_t nSize) noexcept {
+            const std::size_t nUnits = nSize / 2;
+            if (nUnits < 4) return false;
+            std::uint64_t aHigh[4] = {}, aLow[4] = {};
+            std::size_t nSpread = 0;
+            for (std::size_t i = 0; i < nSize; i += 2) {
+                const unsigned nHigh = pData[bLittle ? i + 1 : i];
+                const unsigned nLow = pData[bLittle ? i : i + 1];
+                const unsigned nCode = nHigh << 8 | nLow;
+                if ((nCode < 0x20 && nCode != '\t' && nCode != '\n' && nCode != '\r') ||
+                    (nCode >= 0xE000 && nCode < 0xF900)) {
+                    return false;
+                }
+                aHigh[nHigh / 64] |= std::uint64_t(1) << (nHigh % 64);
+                aLow[nLow / 64] |= std::uint64_t(1) << (nLow % 64);
+                if (nLow >= 0x80) ++nSpread;
+            }
+            unsigned nDistinctHigh = 0, nDistinctLow = 0;
+            for (std::size_t k = 0; k < 4; ++k) {
+                nDistinctHigh += popcount64(aHigh[k]);
+                nDistinctLow += popcount64(aLow[k]);
+            }
+            return nSpread * 4 >= nUnits && nDistinctHigh < nDistinctLow;
+        }
+
+        /**
+         * @brief Checks whether a text only contains ASCII.
+         *
+         * @param sText Text to inspect.
+         * @return True if every byte is below 0x80.
+         */
+        inline bool is_ascii(const std::string_view sText) noexcept {
+            const char *pBegin = sText.data();
+            const char *pEnd = pBegin + sText.size();
+            for (; pEnd - pBegin >= 16; pBegin += 16) {
+                if (!is_ascii_block(pBegin)) return false;
+            }
+            for (; pBegin != pEnd; ++pBegin) {
+                if (to_unit(*pBegin) >= 0x80) return false;
+            }
+            return true;
+        }
+
+        /**
+         * @brief Scales a ratio to a confidence between a floor and 99 percent.
+         *
+         * @param nPart Numerator.
+         * @param nWhole Denominator, non-zero.
+         * @param nFloor Confidence for a ratio of 0.
+         * @return Confidence in percent.
+         */
+        inline unsigned scale_confidence(const std::size_t nPart, const std::size_t nWhole, const unsigned nFloor) noexcept {
+            const std::size_t nRange = 99 - nFloor;
+            const std::size_t nScaled = nPart >= nWhole ? nRange : nPart * nRange / nWhole;
+            return nFloor + static_cast<unsigned>(nScaled);
+        }
+    }
+
+    /**
+     * @brief Detects a byte order mark.
+     *
+     * UTF-32LE is checked before UTF-16LE since both start with `FF FE`.
+     *
+     * @param pData Bytes to inspect.
+     * @param nSize Number of bytes.
+     * @return The encoding with `nBom` and a confidence of 100, or `unknown`.
+     */
+    inline detected_encoding detect_bom(const void *pData, const std::size_t nSize) noexcept {
+        const unsigned char *pBytes = static_cast<const unsigned char *>(pData);
+        const auto starts_with = [&](const char *pBom, const std::size_t nBom) {
+            return nSize >= nBom && std::memcmp(pBytes, pBom, nBom) == 0;
+        };
+        if (starts_with("\xFF\xFE\x00\x00", 4)) return {byte_encoding::utf32le, 4, 100};
+        if (starts_with("\x00\x00\xFE\xFF", 4)) return {byte_encoding::utf32be, 4, 100};
+        if (starts_with("\xEF\xBB\xBF", 3)) return {byte_encoding::utf8, 3, 100};
+        if (starts_with("\xFF\xFE", 2)) return {byte_encoding::utf16le, 2, 100};
+        if (starts_with("\xFE\xFF", 2)) return {byte_encoding::utf16be, 2, 100};
+        return {};
+    }
+
+    /**
+     * @brief Detects the encoding of a byte buffer.
+     *
+     * Without a byte order mark only the first `nPrefix` bytes are analyzed.
+     * ASCII-only input is reported as UTF-8. Input that is neither valid UTF-8
+     * nor shows a UTF-16/UTF-32 pattern is reported as `unknown`.
+     *
+     * @param pData Bytes to inspect.
+     * @param nSize Number of bytes.
+     * @param nPrefix Maximum number of bytes analyzed.
+     * @return The most likely encoding and the confidence of the guess.
+     */
+    inline detected_encoding detect_encoding(const void *pData, const std::size_t nSize,
+                                             const std::size_t nPrefix = 64 * 1024) noexcept {
+        const detected_encoding oBom = detect_bom(pData, nSize);
+        if (oBom.eEncoding != byte_encoding::unknown) return oBom;
+
+        const unsigned char *pBytes = static_cast<const unsigned char *>(pData);
+        const std::size_t nBytes = nSize < nPrefix ? nSize : nPrefix;
+        const bool bCut = nBytes < nSize;
+        if (nBytes == 0) return {byte_encoding::utf8, 0, 0};
+
+        std::size_t aZeros[4];
+        detail::count_zero_lanes(pBytes, nBytes, aZeros);
+        const std::size_t nQuarter = nBytes / 4;
+        const std::size_t nHalf = nBytes / 2;
+
+        // UTF-32: the high byte is always zero, the next one is zero below U+10000
+        if (nBytes % 4 == 0 || bCut) {
+            const std::size_t nUnits = nBytes / 4 * 4;
+            if (nQuarter != 0 && aZeros[3] >= nQuarter && aZeros[2] * 10 >= nQuarter * 9 &&
+                detail::validate_units<4, true>(pBytes, nUnits, bCut)) {
+                return {byte_encoding::utf32le, 0, 95};
+            }
+            if (nQuarter != 0 && aZeros[0] >= nQuarter && aZeros[1] * 10 >= nQuarter * 9 &&
+                detail::validate_units<4, false>(pBytes, nUnits, bCut)) {
+                return {byte_encoding::utf32be, 0, 95};
+            }
+        }
+
+        // UTF-16: zero bytes concentrated on one parity (the high byte of ASCII)
+        const std::size_t nEven = aZeros[0] + aZeros[2];
+        const std::size_t nOdd = aZeros[1] + aZeros[3];
+        if (nBytes % 2 == 0 || bCut) {
+            const std::size_t nUnits = nBytes / 2 * 2;
+            if (nOdd > 4 * nEven && nOdd * 16 >= nHalf && detail::validate_units<2, true>(pBytes, nUnits, bCut)) {
+                return {byte_encoding::utf16le, 0, detail::scale_confidence(nOdd - nEven, nHalf, 60)};
+            }
+            if (nEven > 4 * nOdd && nEven * 16 >= nHalf && detail::validate_units<2, false>(pBytes, nUnits, bCut)) {
+                return {byte_encoding::utf16be, 0, detail::scale_confidence(nEven - nOdd, nHalf, 60)};
+            }
+        }
+
+        // UTF-8: must validate, a prefix may end inside a code point
+        std::string_view sText(reinterpret_cast<const char *>(pBytes), nBytes);
+        if (bCut) sText.remove_suffix(incomplete_suffix(sText));
+        if (validate(sText)) {
+            const std::size_t nZeros = nEven + nOdd;
+            if (nZeros != 0) return {byte_encoding::utf8, 0, 50};
+            const bool bAscii = detail::is_ascii(sText);
+            return {byte_encoding::utf8, 0, bAscii ? 90u : 99u};
+        }
+
+        // Text without ASCII, such as CJK, leaves no zero bytes in UTF-16, so its pattern must be checked
+        if (nBytes % 2 == 0 || bCut) {
+            const std::size_t nUnits = nBytes / 2 * 2;
+            if (detail::validate_units<2, true>(pBytes, nUnits, bCut) && detail::looks_like_utf16<true>(pBytes, nUnits)) {
+                return {byte_encoding::utf16le, 0, 30};
+            }
+            if (detail::validate_units<2, false>(pBytes, nUnits, bCut) &&
+                detail::looks_like_utf16<false>(pBytes, nUnits)) {
+                return {byte_encoding::utf16be, 0, 30};
+            }
+        }
+        return {};
+    }
+
+    /**
+     * @brief Detects the encoding of a byte buffer.
+     *
+     * @param sBytes Bytes to inspect.
+     * @param nPrefix Maximum number of bytes analyzed.
+     * @return The most likely encoding and the confidence of the guess.
+     */
+    inline detected_encoding detect_encoding(const std::string_view sBytes,
+                                             const std::size_t nPrefix = 64 * 1024) noexcept {
+        return detect_encoding(sBytes.data(), sBytes.size(), nPrefix);
+    }
+} // namespace utf42
+
+#endif //LIB_UTF_42_DETECT
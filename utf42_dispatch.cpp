@@ -0,0 +1,70 @@
+/**
+ * @file utf42_dispatch.cpp
+ * @brief Compiled transcoding kernels with load-time instruction set selection.
+ *
+ * Every kernel declared in `utf42::kernels` is instantiated here from the
+ * header-only implementation. On x86-64 ELF platforms with GCC or Clang the
+ * kernels are cloned for several instruction sets with `target_clones`; the
+ * compiler emits a GNU IFUNC resolver so the dynamic loader binds the best
+ * clone once, at load time, and every later call is a plain call.
+ *
+ * On other platforms the kernels are compiled for the baseline target only.
+ *
+ * @copyright MIT License
+ *
+ * This file is part of utf42.
+ * Copyright (c) 2025 Dante Doménech Martínez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef UTF42_DISPATCH
+#define UTF42_DISPATCH
+#endif
+// Keeps the kernel list of utf42_transcode.h defined
+#define UTF42_DISPATCH_KERNELS
+
+#include "utf42_transcode.h"
+
+// Kernel attributes: clone per instruction set and inline the whole header kernel into each clone
+#if defined(__x86_64__) && defined(__ELF__) && (defined(__GNUC__) || defined(__clang__))
+#define UTF42_KERNEL_ATTRIBUTES __attribute__((target_clones("avx2", "sse4.2", "default"), flatten))
+#else
+#define UTF42_KERNEL_ATTRIBUTES
+#endif
+
+namespace utf42 {
+    namespace kernels {
+#define UTF42_KERNEL_DEFINE(to_t, from_t) \
+        UTF42_KERNEL_ATTRIBUTES \
+        std::size_t transcoded_length(const from_t *pData, const std::size_t nSize, unit_tag<to_t>) noexcept { \
+            return detail::generic_transcoded_length<to_t>(basic_string_view<from_t>(pData, nSize)); \
+        } \
+        UTF42_KERNEL_ATTRIBUTES \
+        std::size_t transcode_into(const from_t *pData, const std::size_t nSize, to_t *pOut) noexcept { \
+            return detail::generic_transcode_into(basic_string_view<from_t>(pData, nSize), pOut); \
+        }
+
+        UTF42_FOR_EACH_KERNEL(UTF42_KERNEL_DEFINE)
+
+#undef UTF42_KERNEL_DEFINE
+#undef UTF42_FOR_EACH_KERNEL
+#undef UTF42_KERNEL_ROW
+    }
+}
@@ -0,0 +1,492 @@
+/**
+ * @file utf42_format.h
+ * @brief `std::format` support for polymorphic literals and foreign encodings.
+ *
+ * `std::formatter<utf42::poly_enc, char_t>` writes the view of the literal
+ * in the encoding of the format string, so formatting a `poly_enc` with
+ * `std::format` or `std::format(L"...")` copies code units and converts
+ * nothing. `utf42::transcoded(sText)` formats a runtime string of another
+ * encoding by decoding it straight into the output iterator, without a
+ * temporary string.
+ *
+ * Both accept the standard string specification,
+ * `[[fill]align][width][.precision][s]`, with width and precision counted
+ * in code points and nested `{}` arguments allowed for either.
+ *
+ * @code
+ * static constexpr utf42::poly_enc oName = cons_poly_enc("clé");
+ * std::string sLine = std::format("[{:>6}]", oName);                   // "[   clé]"
+ * std::wstring sWide = std::format(L"[{:*<6}]", oName);                // L"[clé***]"
+ * std::string sUser = std::format("{:.2}", utf42::transcoded(u"héllo"sv)); // "hé"
+ * @endcode
+ *
+ * The formatters are defined when the standard library provides
+ * `<format>`; `std::format` itself only supports `char` and `wchar_t`
+ * format strings.
+ *
+ * @note Requires C++20 or later.
+ *
+ * @copyright MIT License
+ *
+ * This file is part of utf42.
+ * Copyright (c) 2025 Dante Doménech Martínez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef LIB_UTF_42_FORMAT
+#define LIB_UTF_42_FORMAT
+
+#include "utf42.h"
+#include "utf42_transcode.h"
+
+// C++ version requirements
+#if __cplusplus < 202002L
+#error "utf42_format.h requires C++20 or later"
+#endif
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <version>
+
+#if __has_include(<format>)
+#include <format>
+#endif
+
+namespace utf42 {
+    /**
+     * @brief A string formatted in the encoding of the format string.
+     *
+     * Made by `utf42::transcoded`. It only views the string, which must
+     * outlive the formatting call.
+     *
+     * @tparam from_t Character type of the string.
+     */
+    template<CharacterType from_t>
+    struct transcoded_text {
+        basic_string_view<from_t> sText; ///< String to format
+    };
+
+    /**
+     * @brief Marks a string to be transcoded while it is formatted.
+     * @tparam from_t Character type of the string.
+     * @param sText String, ill-formed sequences being written as U+FFFD.
+     * @return Argument for `std::format`.
+     */
+    template<CharacterType from_t>
+    constexpr transcoded_text<from_t> transcoded(const basic_string_view<from_t> sText) noexcept {
+        return {sText};
+    }
+
+    /// @copydoc transcoded
+    template<CharacterType from_t>
+    constexpr transcoded_text<from_t> transcoded(const from_t *pText) noexcept {
+        return {basic_string_view<from_t>(pText)};
+    }
+
+    namespace detail {
+        /// How a width or precision is given
+        enum class format_count {
+            none, ///< Not given
+            value, ///< Given in the specification
+            next_arg, ///< Given by the next argument, `{}`
+            arg ///< Given by a numbered argument, `{n}`
+        };
+
+        /**
+         * @brief Parsed string format specification.
+         *
+         * Parsing does not depend on `<format>`, so it can be checked at
+         * compile time and tested without it.
+         */
+        struct format_spec {
+            char32_t cFill = U' '; ///< Fill code point
+            char cAlign = '<'; ///< Alignment, `<`, `>` or `^`
+            format_count eWidth = format_count::none; ///< How the width is given
+            format_count ePrecision = format_count::none; ///< How the precision is given
+            std::size_t nWidth = 0; ///< Width in code points, or index of its argument
+            std::size_t nPrecision = 0; ///< Maximum code points, or index of its argument
+
+            /**
+             * @brief Parses a specification.
+             * @tparam char_t Character type of the format string.
+             * @param pBegin Start of the specification, after the `:`.
+             * @param pEnd End of the format string.
+             * @return The `}` closing the field or `pEnd`, or null if the specification is invalid.
+             */
+            template<CharacterType char_t>
+            constexpr const char_t *parse(const char_t *pBegin, const char_t *pEnd) {
+                const char_t *pCursor = pBegin;
+                if (pCursor == pEnd || *pCursor == '}') return pCursor;
+
+                // Fill and alignment: a code point followed by an alignment, or an alignment alone
+                const char_t *pAfterFill = pCursor;
+                const char32_t cFirst = decode(pAfterFill, pEnd);
+                if (pAfterFill != pEnd && is_align(*pAfterFill) && cFirst != U'{' && cFirst != U'}') {
+                    cFill = cFirst;
+                    cAlign = static_cast<char>(*pAfterFill);
+                    pCursor = pAfterFill + 1;
+                } else if (is_align(*pCursor)) {
+                    cAlign = static_cast<char>(*pCursor);
+                    ++pCursor;
+                }
+
+                // A leading zero would be the zero-padding flag, which strings do not take
+                if (pCursor != pEnd && *pCursor == '0') return nullptr;
+                pCursor = parse_count(pCursor, pEnd, eWidth, nWidth);
+                if (pCursor == nullptr) return nullptr;
+                if (pCursor != pEnd && *pCursor == '.') {
+                    pCursor = parse_count(pCursor + 1, pEnd, ePrecision, nPrecision);
+                    if (pCursor == nullptr || ePrecision == format_count::none) return nullptr;
+                }
+                if (pCursor != pEnd && *pCursor == 's') ++pCursor;
+                return pCursor == pEnd || *pCursor == '}' ? pCursor : nullptr;
+            }
+
+        private:
+            /**
+             * @brief Checks whether a code unit is an alignment.
+             * @tparam char_t Character type.
+             * @param cUnit Code unit.
+             * @return True for `<`, `>` and `^`.
+             */
+            template<CharacterType char_t>
+            static constexpr bool is_align(const char_t cUnit) noexcept {
+                return cUnit == '<' || cUnit == '>' || cUnit == '^';
+            }
+
+            /**
+             * @brief Parses a width or precision: digits, `{}` or `{n}`.
+             * @tparam char_t Character type.
+             * @param pCursor Start of the count.
+             * @param pEnd End of the format string.
+             * @param eCount How the count is given, set.
+             * @param nCount Count or argument index, set.
+             * @return Past the count, or null if it is invalid.
+             */
+            template<CharacterType char_t>
+            static constexpr const char_t *parse_count(const char_t *pCursor, const char_t *pEnd,
+                                                       format_count &eCount, std::size_t &nCount) {
+                if (pCursor != pEnd && *pCursor == '{') {
+                    ++pCursor;
+                    if (pCursor != pEnd && *pCursor == '}') {
+                        eCount = format_count::next_arg;
+                        return pCursor + 1;
+                    }
+                    eCount = format_count::arg;
+                    pCursor = parse_number(pCursor, pEnd, nCount);
+                    return pCursor != nullptr && pCursor != pEnd && *pCursor == '}' ? pCursor + 1 : nullptr;
+                }
+                if (pCursor == pEnd || *pCursor < '0' || *pCursor > '9') return pCursor;
+                eCount = format_count::value;
+                return parse_number(pCursor, pEnd, nCount);
+            }
+
+            /**
+             * @brief Parses a decimal number.
+             * @tparam char_t Character type.
+             * @param pCursor Start of the digits.
+             * @param pEnd End of the format string.
+             * @param nNumber Number, set.
+             * @return Past the digits, or null if there are none or the number overflows.
+             */
+            template<CharacterType char_t>
+            static constexpr const char_t *parse_number(const char_t *pCursor, const char_t *pEnd,
+                                                        std::size_t &nNumber) {
+                constexpr std::size_t nLimit = std::numeric_limits<int>::max();
+                if (pCursor == pEnd || *pCursor < '0' || *pCursor > '9') return nullptr;
+                nNumber = 0;
+                for (; pCursor != pEnd && *pCursor >= '0' && *pCursor <= '9'; ++pCursor) {
+                    nNumber = nNumber * 10 + static_cast<std::size_t>(*pCursor - '0');
+                    if (nNumber > nLimit) return nullptr;
+                }
+                return pCursor;
+            }
+        };
+
+        /**
+         * @brief Number of code points of a string, ill-formed sequences counting as one.
+         * @tparam char_t Character type.
+         * @param sText String.
+         * @return The number of code points.
+         */
+        template<CharacterType char_t>
+        constexpr std::size_t text_length(const basic_string_view<char_t> sText) noexcept {
+            if constexpr (sizeof(char_t) == 4) {
+                return sText.size();
+            } else {
+                // Outside constant evaluation the length pre-pass of the transcoder counts faster
+                if (!std::is_constant_evaluated()) return transcoded_length<char32_t>(sText);
+                std::size_t nCodePoints = 0;
+                const char_t *pCursor = sText.data();
+                const char_t *pEnd = pCursor + sText.size();
+                for (; pCursor != pEnd; ++nCodePoints) decode(pCursor, pEnd);
+                return nCodePoints;
+            }
+        }
+
+        /**
+         * @brief Writes a string to an output iterator in another encoding.
+         *
+         * Long strings are transcoded in chunks through a buffer on the stack,
+         * each cut before an unfinished code point, so no string is allocated.
+         *
+         * @tparam char_t Character type of the output.
+         * @tparam from_t Character type of the string.
+         * @tparam out_t Output iterator.
+         * @param oOut Output.
+         * @param sText String.
+         * @return The output past the string.
+         */
+        template<CharacterType char_t, CharacterType from_t, typename out_t>
+        constexpr out_t write_transcoded(out_t oOut, basic_string_view<from_t> sText) {
+            if constexpr (sizeof(from_t) == sizeof(char_t)) {
+                for (const from_t cUnit: sText) *oOut++ = static_cast<char_t>(cUnit);
+            } else if (std::is_constant_evaluated() || sText.size() <= small_string_threshold) {
+                // Short strings skip the kernel call, as in `transcode`
+                const from_t *pCursor = sText.data();
+                const from_t *pEnd = pCursor + sText.size();
+                char_t aUnits[4] = {};
+                while (pCursor != pEnd) {
+                    if (detail::to_unit(*pCursor) < 0x80) {
+                        *oOut++ = static_cast<char_t>(*pCursor++);
+                        continue;
+                    }
+                    const std::size_t nUnits = encode(decode(pCursor, pEnd), aUnits);
+                    for (std::size_t i = 0; i < nUnits; ++i) *oOut++ = aUnits[i];
+                }
+            } else {
+                constexpr std::size_t nChunk = 64;
+                char_t aBuffer[max_transcoded_length<char_t, from_t>(nChunk)];
+                while (!sText.empty()) {
+                    std::size_t nSize = sText.size() < nChunk ? sText.size() : nChunk;
+                    if (nSize < sText.size()) nSize -= incomplete_suffix(sText.substr(0, nSize));
+                    const std::size_t nUnits = transcode_into<char_t>(sText.substr(0, nSize), aBuffer);
+                    for (std::size_t i = 0; i < nUnits; ++i) *oOut++ = aBuffer[i];
+                    sText.remove_prefix(nSize);
+                }
+            }
+            return oOut;
+        }
+
+        /**
+         * @brief Writes a string padded and truncated according to a specification.
+         * @tparam char_t Character type of the output.
+         * @tparam from_t Character type of the string.
+         * @tparam out_t Output iterator.
+         * @param oOut Output.
+         * @param sText String.
+         * @param oSpec Specification, with resolved width and precision.
+         * @return The output past the string.
+         */
+        template<CharacterType char_t, CharacterType from_t, typename out_t>
+        constexpr out_t write_formatted(out_t oOut, basic_string_view<from_t> sText, const format_spec &oSpec) {
+            // The precision cuts the string, whose length is then only needed for padding
+            std::size_t nCodePoints = 0;
+            if (oSpec.ePrecision != format_count::none) {
+                const from_t *pStop = sText.data();
+                const from_t *pEnd = pStop + sText.size();
+                for (; pStop != pEnd && nCodePoints < oSpec.nPrecision; ++nCodePoints) decode(pStop, pEnd);
+                sText = sText.substr(0, static_cast<std::size_t>(pStop - sText.data()));
+            } else if (oSpec.eWidth != format_count::none) {
+                nCodePoints = text_length(sText);
+            }
+            const std::size_t nPadding = oSpec.eWidth != format_count::none && oSpec.nWidth > nCodePoints
+                                             ? oSpec.nWidth - nCodePoints
+                                             : 0;
+            const std::size_t nBefore = oSpec.cAlign == '>' ? nPadding : oSpec.cAlign == '^' ? nPadding / 2 : 0;
+
+            // The fill is encoded once for all the padding
+            char_t aFill[4] = {};
+            const std::size_t nFill = nPadding != 0 ? encode(oSpec.cFill, aFill) : 0;
+            for (std::size_t i = 0; i < nBefore; ++i) {
+                for (std::size_t j = 0; j < nFill; ++j) *oOut++ = aFill[j];
+            }
+            oOut = write_transcoded<char_t>(oOut, sText);
+            for (std::size_t i = nBefore; i < nPadding; ++i) {
+                for (std::size_t j = 0; j < nFill; ++j) *oOut++ = aFill[j];
+            }
+            return oOut;
+        }
+
+        /**
+         * @brief Formatter of strings of any encoding, apart from `<format>`.
+         *
+         * `traits_t` supplies the error type and the visit of width and precision
+         * arguments, so the formatter also builds against other contexts.
+         * @tparam char_t Character type of the format string.
+         * @tparam traits_t Provides `error_type` and `visit(fnVisitor, oArg)`.
+         */
+        template<CharacterType char_t, typename traits_t>
+        class text_formatter {
+        public:
+            /**
+             * @brief Parses the specification of a replacement field.
+             * @tparam parse_context_t Parse context.
+             * @param oContext Parse context.
+             * @return The `}` closing the field.
+             */
+            template<typename parse_context_t>
+            constexpr auto parse(parse_context_t &oContext) {
+                const char_t *pBegin = std::to_address(oContext.begin());
+                const char_t *pStop = m_oSpec.parse(pBegin, std::to_address(oContext.end()));
+                if (pStop == nullptr) throw typename traits_t::error_type("utf42: invalid string format specification");
+                resolve_id(oContext, m_oSpec.eWidth, m_oSpec.nWidth);
+                resolve_id(oContext, m_oSpec.ePrecision, m_oSpec.nPrecision);
+                return oContext.begin() + (pStop - pBegin);
+            }
+
+            /**
+             * @brief Writes a polymorphic literal in the encoding of the format string.
+             * @tparam context_t Format context.
+             * @param oText Literal.
+             * @param oContext Format context.
+             * @return The output past the literal.
+             */
+            template<typename context_t>
+            auto format(const poly_enc &oText, context_t &oContext) const {
+                return write(oText.template visit<char_t>(), oContext);
+            }
+
+            /**
+             * @brief Writes a string of another encoding, transcoding it.
+             * @tparam from_t Character type of the string.
+             * @tparam context_t Format context.
+             * @param oText String.
+             * @param oContext Format context.
+             * @return The output past the string.
+             */
+            template<CharacterType from_t, typename context_t>
+            auto format(const transcoded_text<from_t> &oText, context_t &oContext) const {
+                return write(oText.sText, oContext);
+            }
+
+        private:
+            /**
+             * @brief Writes a string into the format output.
+             * @tparam from_t Character type of the string.
+             * @tparam context_t Format context.
+             * @param sText String.
+             * @param oContext Format context.
+             * @return The output past the string.
+             */
+            template<CharacterType from_t, typename context_t>
+            auto write(const basic_string_view<from_t> sText, context_t &oContext) const {
+                format_spec oSpec = m_oSpec;
+                if (oSpec.eWidth == format_count::arg) {
+                    oSpec.eWidth = format_count::value;
+                    oSpec.nWidth = count_arg(oContext.arg(oSpec.nWidth));
+                }
+                if (oSpec.ePrecision == format_count::arg) {
+                    oSpec.ePrecision = format_count::value;
+                    oSpec.nPrecision = count_arg(oContext.arg(oSpec.nPrecision));
+                }
+                return write_formatted<char_t>(oContext.out(), sText, oSpec);
+            }
+
+            /**
+             * @brief Takes the argument index of a nested `{}` from the parse context.
+             * @tparam parse_context_t Parse context.
+             * @param oContext Parse context.
+             * @param eCount How the count is given, `arg` once resolved.
+             * @param nCount Argument index, set for `{}`.
+             */
+            template<typename parse_context_t>
+            static constexpr void resolve_id(parse_context_t &oContext, format_count &eCount, std::size_t &nCount) {
+                if (eCount == format_count::next_arg) {
+                    nCount = oContext.next_arg_id();
+                    eCount = format_count::arg;
+                } else if (eCount == format_count::arg) {
+                    oContext.check_arg_id(nCount);
+                }
+            }
+
+            /**
+             * @brief Reads a width or precision argument.
+             * @tparam arg_t Format argument.
+             * @param oArg Argument.
+             * @return Its value, which must be a non negative integer.
+             */
+            template<typename arg_t>
+            static std::size_t count_arg(const arg_t &oArg) {
+                return traits_t::visit([](const auto nValue) -> std::size_t {
+                    using value_t = std::remove_cvref_t<decltype(nValue)>;
+                    if constexpr (std::is_integral_v<value_t> && !std::is_same_v<value_t, bool> &&
+                                  !std::is_same_v<value_t, char_t>) {
+                        if constexpr (std::is_signed_v<value_t>) {
+                            if (nValue < 0) throw typename traits_t::error_type("utf42: negative width or precision");
+                        }
+                        return static_cast<std::size_t>(nValue);
+                    } else {
+                        throw typename traits_t::error_type("utf42: width or precision is not an integer");
+                    }
+                }, oArg);
+            }
+
+            format_spec m_oSpec; ///< Parsed specification
+        };
+
+#if defined(__cpp_lib_format)
+        /**
+         * @brief Ties text_formatter to `<format>`.
+         */
+        struct std_format_traits {
+            using error_type = std::format_error; ///< Error of invalid specifications and arguments
+
+            /**
+             * @brief Visits a format argument.
+             * @tparam visitor_t Visitor.
+             * @tparam arg_t Format argument.
+             * @param fnVisitor Visitor.
+             * @param oArg Argument.
+             * @return The result of the visitor.
+             */
+            template<typename visitor_t, typename arg_t>
+            static decltype(auto) visit(visitor_t &&fnVisitor, const arg_t &oArg) {
+                return std::visit_format_arg(std::forward<visitor_t>(fnVisitor), oArg);
+            }
+        };
+#endif
+    }
+} // namespace utf42
+
+#if defined(__cpp_lib_format)
+/**
+ * @brief Formats a polymorphic literal in the encoding of the format string, without conversion.
+ * @tparam char_t Character type of the format string.
+ */
+template<utf42::CharacterType char_t>
+struct std::formatter<utf42::poly_enc, char_t>
+    : utf42::detail::text_formatter<char_t, utf42::detail::std_format_traits> {
+};
+
+/**
+ * @brief Formats a string of another encoding, transcoding it into the output.
+ * @tparam from_t Character type of the string.
+ * @tparam char_t Character type of the format string.
+ */
+template<utf42::CharacterType from_t, utf42::CharacterType char_t>
+struct std::formatter<utf42::transcoded_text<from_t>, char_t>
+    : utf42::detail::text_formatter<char_t, utf42::detail::std_format_traits> {
+};
+#endif
+
+#endif //LIB_UTF_42_FORMAT
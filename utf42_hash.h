@@ -0,0 +1,404 @@
+/**
+ * @file utf42_hash.h
+ * @brief String hashing that gives the same value in every encoding.
+ *
+ * `utf42::hash` hashes the sequence of code points of a text rather than
+ * its code units, so `"clé"`, `u"clé"` and `U"clé"` hash alike and a hash
+ * map can be queried with keys of any character type without transcoding
+ * them. Ill-formed input hashes as the U+FFFD it transcodes to.
+ *
+ * Code points are absorbed four at a time with a 64x64->128 bit multiply,
+ * in the manner of wyhash. Groups of four ASCII units are absorbed
+ * directly, other code points are decoded and shifted into two words
+ * held in registers. The same function runs at compile
+ * time, so `hashed_literal` stores the hash of a `poly_enc` next to it.
+ *
+ * @note Requires C++20 or later.
+ *
+ * @copyright MIT License
+ *
+ * This file is part of utf42.
+ * Copyright (c) 2025 Dante Doménech Martínez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef LIB_UTF_42_HASH
+#define LIB_UTF_42_HASH
+
+#include "utf42.h"
+#include "utf42_transcode.h"
+
+// C++ version requirements
+#if __cplusplus < 202002L
+#error "utf42_hash.h requires C++20 or later"
+#endif
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace utf42 {
+    namespace detail {
+        /// Constants of the hash rounds (the wyhash secrets)
+        constexpr std::uint64_t hash_secret[4] = {
+            0x2D358DCCAA6C78A5ull, 0x8BB84B93962EACC9ull, 0x4B33A62ED433D4A3ull, 0x4D5A2DA51DE1AA47ull,
+        };
+
+        /**
+         * @brief Multiplies two words and folds the 128-bit product.
+         * @param nLeft First factor.
+         * @param nRight Second factor.
+         * @return Low half of the product xor its high half.
+         */
+        constexpr std::uint64_t fold_multiply(const std::uint64_t nLeft, const std::uint64_t nRight) noexcept {
+#if defined(__SIZEOF_INT128__)
+            __extension__ using uint128_t = unsigned __int128;
+            const uint128_t nProduct = static_cast<uint128_t>(nLeft) * nRight;
+            return static_cast<std::uint64_t>(nProduct) ^ static_cast<std::uint64_t>(nProduct >> 64);
+#else
+            const std::uint64_t nLow = (nLeft & 0xFFFFFFFFull) * (nRight & 0xFFFFFFFFull);
+            const std::uint64_t nCross1 = (nLeft >> 32) * (nRight & 0xFFFFFFFFull);
+            const std::uint64_t nCross2 = (nLeft & 0xFFFFFFFFull) * (nRight >> 32);
+            const std::uint64_t nHigh = (nLeft >> 32) * (nRight >> 32);
+            const std::uint64_t nMiddle = (nLow >> 32) + (nCross1 & 0xFFFFFFFFull) + (nCross2 & 0xFFFFFFFFull);
+            const std::uint64_t nProductLow = (nMiddle << 32) | (nLow & 0xFFFFFFFFull);
+            const std::uint64_t nProductHigh = nHigh + (nCross1 >> 32) + (nCross2 >> 32) + (nMiddle >> 32);
+            return nProductLow ^ nProductHigh;
+#endif
+        }
+
+        /**
+         * @brief Running hash of a sequence of code points.
+         *
+         * The last four code points are kept in two words, which are
+         * absorbed into the state each time they have all been replaced.
+         */
+        struct hash_state {
+            std::uint64_t nState; ///< Absorbed code points
+            std::uint64_t nFirst = 0; ///< Oldest two pending code points
+            std::uint64_t nSecond = 0; ///< Newest two pending code points
+            std::uint64_t nCount = 0; ///< Code points pushed so far
+
+            /**
+             * @brief Appends a code point.
+             * @param nCode Code point.
+             */
+            constexpr void push(const char32_t nCode) noexcept {
+                nFirst = (nFirst >> 32) | (nSecond << 32);
+                nSecond = (nSecond >> 32) | (static_cast<std::uint64_t>(nCode) << 32);
+                if ((++nCount & 3) == 0) nState = fold_multiply(nFirst ^ hash_secret[1], nSecond ^ nState);
+            }
+
+            /**
+             * @brief Appends four code points, when none is pending.
+             * @param nCode0 First code point.
+             * @param nCode1 Second code point.
+             * @param nCode2 Third code point.
+             * @param nCode3 Fourth code point.
+             */
+            constexpr void push4(const std::uint32_t nCode0, const std::uint32_t nCode1, const std::uint32_t nCode2,
+                                 const std::uint32_t nCode3) noexcept {
+                const std::uint64_t nLow = nCode0 | static_cast<std::uint64_t>(nCode1) << 32;
+                const std::uint64_t nHigh = nCode2 | static_cast<std::uint64_t>(nCode3) << 32;
+                nState = fold_multiply(nLow ^ hash_secret[1], nHigh ^ nState);
+                nCount += 4;
+            }
+
+            /**
+             * @brief Absorbs the pending code points and finalizes.
+             * @return The hash value.
+             */
+            constexpr std::uint64_t finish() noexcept {
+                const std::uint64_t nTotal = nCount;
+                // The padding is told apart from U+0000 by the count
+                while ((nCount & 3) != 0) {
+                    push(0);
+                }
+                return fold_multiply(nTotal ^ hash_secret[2], nState ^ hash_secret[3]);
+            }
+        };
+    }
+
+    /**
+     * @brief Hashes the code points of a text.
+     *
+     * The value does not depend on the encoding: `hash(sText)` equals
+     * `hash(transcode<to_t>(sText))` for every `to_t`, ill-formed input included.
+     *
+     * @code
+     * static_assert(utf42::hash(std::string_view("clé")) == utf42::hash(std::u16string_view(u"clé")));
+     * @endcode
+     *
+     * @tparam char_t Character type.
+     * @param sText Text to hash.
+     * @param nSeed Seed, to vary the hash between processes.
+     * @return The 64-bit hash value.
+     */
+    template<CharacterType char_t>
+    constexpr std::uint64_t hash(const basic_string_view<char_t> sText, const std::uint64_t nSeed = 0) noexcept {
+        detail::hash_state oState{nSeed ^ detail::hash_secret[0]};
+        const char_t *pBegin = sText.data();
+        const char_t *pEnd = pBegin + sText.size();
+        while (pBegin != pEnd) {
+            // Groups of four ASCII units skip the shifting when no code point is pending
+            if ((oState.nCount & 3) == 0 && pEnd - pBegin >= 4) {
+                const std::uint32_t nUnit0 = detail::to_unit(pBegin[0]);
+                const std::uint32_t nUnit1 = detail::to_unit(pBegin[1]);
+                const std::uint32_t nUnit2 = detail::to_unit(pBegin[2]);
+                const std::uint32_t nUnit3 = detail::to_unit(pBegin[3]);
+                if ((nUnit0 | nUnit1 | nUnit2 | nUnit3) < 0x80) {
+                    oState.push4(nUnit0, nUnit1, nUnit2, nUnit3);
+                    pBegin += 4;
+                    continue;
+                }
+            }
+            const std::uint32_t nUnit = detail::to_unit(*pBegin);
+            if (nUnit < 0x80) {
+                oState.push(static_cast<char32_t>(nUnit));
+                ++pBegin;
+            } else {
+                oState.push(decode(pBegin, pEnd));
+            }
+        }
+        return oState.finish();
+    }
+
+    /**
+     * @brief Hashes the code points of a literal.
+     * @param oText Polymorphic literal.
+     * @param nSeed Seed.
+     * @return The hash value of any of its encodings.
+     */
+    constexpr std::uint64_t hash(const poly_enc &oText, const std::uint64_t nSeed = 0) noexcept {
+        return utf42::hash(oText.TXT_CHAR_32, nSeed);
+    }
+
+    /**
+     * @brief Compares two texts code point by code point.
+     *
+     * Texts of the same encoding are compared with `memcmp` first. Consistent
+     * with `hash`: equal texts have equal hashes.
+     *
+     * @tparam left_t Character type of the first text.
+     * @tparam right_t Character type of the second text.
+     * @param sLeft First text.
+     * @param sRight Second text.
+     * @return True if both texts transcode to the same code points.
+     */
+    template<CharacterType left_t, CharacterType right_t>
+    constexpr bool equal(const basic_string_view<left_t> sLeft, const basic_string_view<right_t> sRight) noexcept {
+        if constexpr (sizeof(left_t) == sizeof(right_t)) {
+            if (!std::is_constant_evaluated() && sLeft.size() == sRight.size() &&
+                (sLeft.empty() || std::memcmp(sLeft.data(), sRight.data(), sLeft.size() * sizeof(left_t)) == 0)) {
+                return true;
+            }
+        }
+        const left_t *pLeft = sLeft.data();
+        const left_t *pLeftEnd = pLeft + sLeft.size();
+        const right_t *pRight = sRight.data();
+        const right_t *pRightEnd = pRight + sRight.size();
+        while (pLeft != pLeftEnd && pRight != pRightEnd) {
+            if (pLeftEnd - pLeft >= 4 && pRightEnd - pRight >= 4) {
+                // Groups of four ASCII units are compared without decoding
+                std::uint32_t nAscii = 0, nDifferent = 0;
+                for (std::size_t i = 0; i < 4; ++i) {
+                    const std::uint32_t nLeft = detail::to_unit(pLeft[i]);
+                    const std::uint32_t nRight = detail::to_unit(pRight[i]);
+                    nAscii |= nLeft | nRight;
+                    nDifferent |= nLeft ^ nRight;
+                }
+                if (nAscii < 0x80) {
+                    if (nDifferent != 0) return false;
+                    pLeft += 4;
+                    pRight += 4;
+                    continue;
+                }
+            }
+            const std::uint32_t nLeft = detail::to_unit(*pLeft);
+            const std::uint32_t nRight = detail::to_unit(*pRight);
+            if ((nLeft | nRight) < 0x80) {
+                if (nLeft != nRight) return false;
+                ++pLeft;
+                ++pRight;
+            } else if (decode(pLeft, pLeftEnd) != decode(pRight, pRightEnd)) {
+                return false;
+            }
+        }
+        return pLeft == pLeftEnd && pRight == pRightEnd;
+    }
+
+    /**
+     * @brief A literal together with its hash, computed at compile time.
+     *
+     * Looking a `hashed_literal` up through `utf42::hasher` costs no hashing
+     * at run time.
+     *
+     * @code
+     * static constexpr utf42::hashed_literal oHost(cons_poly_enc("Host"));
+     * auto it = mHeaders.find(oHost);
+     * @endcode
+     */
+    class hashed_literal {
+    public:
+        /**
+         * @brief Hashes a literal at compile time.
+         * @param oText Polymorphic literal.
+         */
+        consteval hashed_literal(const poly_enc &oText) noexcept : m_oText(oText), m_nHash(utf42::hash(oText)) {
+        }
+
+        /**
+         * @brief Literal encoded for a character type.
+         * @tparam char_t Character type.
+         * @return View of the literal.
+         */
+        template<CharacterType char_t>
+        constexpr basic_string_view<char_t> visit() const noexcept { return m_oText.visit<char_t>(); }
+
+        /**
+         * @brief The literal.
+         * @return The polymorphic literal.
+         */
+        constexpr const poly_enc &text() const noexcept { return m_oText; }
+
+        /**
+         * @brief Hash of the literal, as returned by `utf42::hash` with a zero seed.
+         * @return The hash value.
+         */
+        constexpr std::uint64_t hash() const noexcept { return m_nHash; }
+
+    private:
+        poly_enc m_oText; ///< Literal
+        std::uint64_t m_nHash; ///< Hash of the literal
+    };
+
+    namespace detail {
+        /**
+         * @brief Views a string or string view argument of `hasher` or `equal_to`.
+         * @tparam char_t Character type.
+         * @param sText Text.
+         * @return The view.
+         */
+        template<CharacterType char_t>
+        constexpr basic_string_view<char_t> as_hash_view(const basic_string_view<char_t> sText) noexcept {
+            return sText;
+        }
+
+        /// @copydoc as_hash_view
+        template<CharacterType char_t>
+        constexpr basic_string_view<char_t> as_hash_view(const std::basic_string<char_t> &sText) noexcept {
+            return sText;
+        }
+
+        /// @copydoc as_hash_view
+        template<CharacterType char_t>
+        constexpr basic_string_view<char_t> as_hash_view(const char_t *pText) noexcept {
+            return pText;
+        }
+
+    }
+
+    /**
+     * @brief Transparent hash functor for keys of any character type.
+     *
+     * With `utf42::equal_to`, an unordered container keyed by strings of one
+     * encoding can be searched with strings, string views or `hashed_literal`s
+     * of any encoding.
+     *
+     * The call operator is deliberately not `noexcept`: libstdc++ then stores
+     * the hash code of every key in its node, so walking a bucket does not
+     * hash the keys again.
+     *
+     * @code
+     * std::unordered_map<std::u16string, int, utf42::hasher, utf42::equal_to> mCodes;
+     * auto it = mCodes.find(std::string_view(sUtf8Key)); // Not transcoded
+     * @endcode
+     */
+    struct hasher {
+        using is_transparent = void; ///< Enables heterogeneous lookup
+
+        /**
+         * @brief Hashes a string or string view.
+         * @tparam text_t String, string view or character pointer type.
+         * @param oText Text to hash.
+         * @return The hash value.
+         */
+        template<typename text_t>
+        std::size_t operator()(const text_t &oText) const {
+            return static_cast<std::size_t>(utf42::hash(detail::as_hash_view(oText)));
+        }
+
+        /**
+         * @brief Returns the precomputed hash of a literal.
+         * @param oText Hashed literal.
+         * @return The hash value.
+         */
+        std::size_t operator()(const hashed_literal &oText) const noexcept {
+            return static_cast<std::size_t>(oText.hash());
+        }
+    };
+
+    /**
+     * @brief Transparent equality functor comparing code points. See `hasher`.
+     */
+    struct equal_to {
+        using is_transparent = void; ///< Enables heterogeneous lookup
+
+        /**
+         * @brief Compares two texts of any character types.
+         * @tparam left_t String, string view or character pointer type.
+         * @tparam right_t String, string view or character pointer type.
+         * @param oLeft First text.
+         * @param oRight Second text.
+         * @return True if both texts have the same code points.
+         */
+        template<typename left_t, typename right_t>
+        bool operator()(const left_t &oLeft, const right_t &oRight) const noexcept {
+            return utf42::equal(detail::as_hash_view(oLeft), detail::as_hash_view(oRight));
+        }
+
+        /**
+         * @brief Compares a hashed literal with a text.
+         * @tparam right_t String, string view or character pointer type.
+         * @param oLeft Hashed literal.
+         * @param oRight Text.
+         * @return True if both have the same code points.
+         */
+        template<typename right_t>
+        bool operator()(const hashed_literal &oLeft, const right_t &oRight) const noexcept {
+            const auto sRight = detail::as_hash_view(oRight);
+            return utf42::equal(oLeft.visit<typename decltype(sRight)::value_type>(), sRight);
+        }
+
+        /**
+         * @brief Compares a text with a hashed literal.
+         * @tparam left_t String, string view or character pointer type.
+         * @param oLeft Text.
+         * @param oRight Hashed literal.
+         * @return True if both have the same code points.
+         */
+        template<typename left_t>
+        bool operator()(const left_t &oLeft, const hashed_literal &oRight) const noexcept {
+            return (*this)(oRight, oLeft);
+        }
+    };
+} // namespace utf42
+
+#endif //LIB_UTF_42_HASH
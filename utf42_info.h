@@ -0,0 +1,239 @@
+/**
+ * @file utf42_info.h
+ * @brief Facts about `poly_enc` literals computed at compile time.
+ *
+ * Formatting code often needs to know whether a literal is ASCII, how many
+ * code points it has, its size in UTF-8 or UTF-16 and how many terminal
+ * columns it takes. `poly_enc_info` stores these facts next to the literal,
+ * computed at compile time, so nothing is scanned at run time.
+ *
+ * Column widths follow `wcwidth`: East Asian wide and fullwidth characters
+ * and most emoji take two columns, combining marks, format characters and
+ * control characters take none, anything else takes one.
+ *
+ * @note Requires C++20 or later.
+ *
+ * @copyright MIT License
+ *
+ * This file is part of utf42.
+ * Copyright (c) 2025 Dante Doménech Martínez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef LIB_UTF_42_INFO
+#define LIB_UTF_42_INFO
+
+#include "utf42.h"
+#include "utf42_transcode.h"
+
+// C++ version requirements
+#if __cplusplus < 202002L
+#error "utf42_info.h requires C++20 or later"
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace utf42 {
+    namespace detail {
+        /// Inclusive range of code points
+        struct code_point_range {
+            char32_t nFirst; ///< First code point
+            char32_t nLast; ///< Last code point
+        };
+
+        /// Combining marks and format characters of the main scripts, sorted
+        constexpr code_point_range zero_width_ranges[] = {
+            {0x00AD, 0x00AD}, {0x0300, 0x036F}, {0x0483, 0x0489}, {0x0591, 0x05BD}, {0x05BF, 0x05BF},
+            {0x05C1, 0x05C2}, {0x05C4, 0x05C5}, {0x05C7, 0x05C7}, {0x0600, 0x0605}, {0x0610, 0x061A},
+            {0x061C, 0x061C}, {0x064B, 0x065F}, {0x0670, 0x0670}, {0x06D6, 0x06DD}, {0x06DF, 0x06E4},
+            {0x06E7, 0x06E8}, {0x06EA, 0x06ED}, {0x070F, 0x070F}, {0x0711, 0x0711}, {0x0730, 0x074A},
+            {0x07A6, 0x07B0}, {0x07EB, 0x07F3}, {0x0816, 0x0819}, {0x081B, 0x0823}, {0x0825, 0x0827},
+            {0x0829, 0x082D}, {0x0859, 0x085B}, {0x08D3, 0x0902}, {0x093A, 0x093A}, {0x093C, 0x093C},
+            {0x0941, 0x0948}, {0x094D, 0x094D}, {0x0951, 0x0957}, {0x0962, 0x0963}, {0x0981, 0x0981},
+            {0x09BC, 0x09BC}, {0x09C1, 0x09C4}, {0x09CD, 0x09CD}, {0x09E2, 0x09E3}, {0x0A01, 0x0A02},
+            {0x0A3C, 0x0A3C}, {0x0A41, 0x0A42}, {0x0A47, 0x0A48}, {0x0A4B, 0x0A4D}, {0x0A70, 0x0A71},
+            {0x0A81, 0x0A82}, {0x0ABC, 0x0ABC}, {0x0AC1, 0x0AC5}, {0x0AC7, 0x0AC8}, {0x0ACD, 0x0ACD},
+            {0x0B01, 0x0B01}, {0x0B3C, 0x0B3C}, {0x0B3F, 0x0B3F}, {0x0B41, 0x0B44}, {0x0B4D, 0x0B4D},
+            {0x0B82, 0x0B82}, {0x0BC0, 0x0BC0}, {0x0BCD, 0x0BCD}, {0x0C3E, 0x0C40}, {0x0C46, 0x0C48},
+            {0x0C4A, 0x0C4D}, {0x0C55, 0x0C56}, {0x0CBC, 0x0CBC}, {0x0CBF, 0x0CBF}, {0x0CC6, 0x0CC6},
+            {0x0CCC, 0x0CCD}, {0x0D41, 0x0D44}, {0x0D4D, 0x0D4D}, {0x0DCA, 0x0DCA}, {0x0DD2, 0x0DD4},
+            {0x0DD6, 0x0DD6}, {0x0E31, 0x0E31}, {0x0E34, 0x0E3A}, {0x0E47, 0x0E4E}, {0x0EB1, 0x0EB1},
+            {0x0EB4, 0x0EBC}, {0x0EC8, 0x0ECD}, {0x0F18, 0x0F19}, {0x0F35, 0x0F35}, {0x0F37, 0x0F37},
+            {0x0F39, 0x0F39}, {0x0F71, 0x0F7E}, {0x0F80, 0x0F84}, {0x0F86, 0x0F87}, {0x0F8D, 0x0FBC},
+            {0x0FC6, 0x0FC6}, {0x102D, 0x1030}, {0x1032, 0x1037}, {0x1039, 0x103A}, {0x1058, 0x1059},
+            {0x1160, 0x11FF}, {0x135D, 0x135F}, {0x1712, 0x1714}, {0x1732, 0x1734}, {0x17B4, 0x17B5},
+            {0x17B7, 0x17BD}, {0x17C6, 0x17C6}, {0x17C9, 0x17D3}, {0x17DD, 0x17DD}, {0x180B, 0x180E},
+            {0x18A9, 0x18A9}, {0x1AB0, 0x1AFF}, {0x1B00, 0x1B03}, {0x1B34, 0x1B34}, {0x1B36, 0x1B3A},
+            {0x1B6B, 0x1B73}, {0x1DC0, 0x1DFF}, {0x200B, 0x200F}, {0x202A, 0x202E}, {0x2060, 0x2064},
+            {0x2066, 0x206F}, {0x20D0, 0x20F0}, {0x2CEF, 0x2CF1}, {0x2D7F, 0x2D7F}, {0x2DE0, 0x2DFF},
+            {0x302A, 0x302D}, {0x3099, 0x309A}, {0xA66F, 0xA672}, {0xA674, 0xA67D}, {0xA69E, 0xA69F},
+            {0xA6F0, 0xA6F1}, {0xA802, 0xA802}, {0xA806, 0xA806}, {0xA80B, 0xA80B}, {0xA825, 0xA826},
+            {0xA8C4, 0xA8C5}, {0xA8E0, 0xA8F1}, {0xA926, 0xA92D}, {0xA947, 0xA951}, {0xA980, 0xA982},
+            {0xA9B3, 0xA9B3}, {0xA9B6, 0xA9B9}, {0xA9BC, 0xA9BD}, {0xAAB0, 0xAAB0}, {0xAAB2, 0xAAB4},
+            {0xAAB7, 0xAAB8}, {0xAABE, 0xAABF}, {0xAAC1, 0xAAC1}, {0xABE5, 0xABE5}, {0xABE8, 0xABE8},
+            {0xABED, 0xABED}, {0xD7B0, 0xD7FF}, {0xFB1E, 0xFB1E}, {0xFE00, 0xFE0F}, {0xFE20, 0xFE2F},
+            {0xFEFF, 0xFEFF}, {0xFFF9, 0xFFFB}, {0x101FD, 0x101FD}, {0x10A01, 0x10A0F}, {0x10A38, 0x10A3F},
+            {0x11001, 0x11001}, {0x11038, 0x11046}, {0x1107F, 0x11081}, {0x110B3, 0x110B6}, {0x110B9, 0x110BA},
+            {0x110BD, 0x110BD}, {0x1D167, 0x1D169}, {0x1D173, 0x1D182}, {0x1D185, 0x1D18B}, {0x1D1AA, 0x1D1AD},
+            {0x1E000, 0x1E02A}, {0x1E8D0, 0x1E8D6}, {0x1E944, 0x1E94A}, {0x1F3FB, 0x1F3FF}, {0xE0001, 0xE0001},
+            {0xE0020, 0xE007F}, {0xE0100, 0xE01EF},
+        };
+
+        /// East Asian wide and fullwidth characters and emoji presented as such, sorted
+        constexpr code_point_range wide_ranges[] = {
+            {0x1100, 0x115F}, {0x231A, 0x231B}, {0x2329, 0x232A}, {0x23E9, 0x23EC}, {0x23F0, 0x23F0},
+            {0x23F3, 0x23F3}, {0x25FD, 0x25FE}, {0x2614, 0x2615}, {0x2648, 0x2653}, {0x267F, 0x267F},
+            {0x2693, 0x2693}, {0x26A1, 0x26A1}, {0x26AA, 0x26AB}, {0x26BD, 0x26BE}, {0x26C4, 0x26C5},
+            {0x26CE, 0x26CE}, {0x26D4, 0x26D4}, {0x26EA, 0x26EA}, {0x26F2, 0x26F3}, {0x26F5, 0x26F5},
+            {0x26FA, 0x26FA}, {0x26FD, 0x26FD}, {0x2705, 0x2705}, {0x270A, 0x270B}, {0x2728, 0x2728},
+            {0x274C, 0x274C}, {0x274E, 0x274E}, {0x2753, 0x2755}, {0x2757, 0x2757}, {0x2795, 0x2797},
+            {0x27B0, 0x27B0}, {0x27BF, 0x27BF}, {0x2B1B, 0x2B1C}, {0x2B50, 0x2B50}, {0x2B55, 0x2B55},
+            {0x2E80, 0x3029}, {0x302E, 0x303E}, {0x3041, 0x3098}, {0x309B, 0x33FF}, {0x3400, 0x4DBF},
+            {0x4E00, 0x9FFF}, {0xA000, 0xA4CF}, {0xA960, 0xA97F}, {0xAC00, 0xD7A3}, {0xF900, 0xFAFF},
+            {0xFE10, 0xFE19}, {0xFE30, 0xFE6F}, {0xFF00, 0xFF60}, {0xFFE0, 0xFFE6}, {0x16FE0, 0x16FE4},
+            {0x17000, 0x18AFF}, {0x1B000, 0x1B2FF}, {0x1F004, 0x1F004}, {0x1F0CF, 0x1F0CF}, {0x1F18E, 0x1F18E},
+            {0x1F191, 0x1F19A}, {0x1F200, 0x1F202}, {0x1F210, 0x1F23B}, {0x1F240, 0x1F248}, {0x1F250, 0x1F251},
+            {0x1F260, 0x1F265}, {0x1F300, 0x1F320}, {0x1F32D, 0x1F335}, {0x1F337, 0x1F37C}, {0x1F37E, 0x1F393},
+            {0x1F3A0, 0x1F3CA}, {0x1F3CF, 0x1F3D3}, {0x1F3E0, 0x1F3F0}, {0x1F3F4, 0x1F3F4}, {0x1F3F8, 0x1F3FA},
+            {0x1F400, 0x1F43E}, {0x1F440, 0x1F440}, {0x1F442, 0x1F4FC}, {0x1F4FF, 0x1F53D}, {0x1F54B, 0x1F54E},
+            {0x1F550, 0x1F567}, {0x1F57A, 0x1F57A}, {0x1F595, 0x1F596}, {0x1F5A4, 0x1F5A4}, {0x1F5FB, 0x1F64F},
+            {0x1F680, 0x1F6C5}, {0x1F6CC, 0x1F6CC}, {0x1F6D0, 0x1F6D2}, {0x1F6D5, 0x1F6D7}, {0x1F6EB, 0x1F6EC},
+            {0x1F6F4, 0x1F6FC}, {0x1F7E0, 0x1F7EB}, {0x1F90C, 0x1F93A}, {0x1F93C, 0x1F945}, {0x1F947, 0x1F9FF},
+            {0x1FA70, 0x1FAFF}, {0x20000, 0x2FFFD}, {0x30000, 0x3FFFD},
+        };
+
+        /**
+         * @brief Checks whether a code point lies in a sorted table of ranges.
+         * @tparam N Number of ranges.
+         * @param aRanges Ranges, sorted and disjoint.
+         * @param cCode Code point.
+         * @return True if a range contains `cCode`.
+         */
+        template<std::size_t N>
+        constexpr bool in_ranges(const code_point_range (&aRanges)[N], const char32_t cCode) noexcept {
+            const code_point_range *pRange = std::upper_bound(aRanges, aRanges + N, cCode,
+                                                              [](const char32_t cValue, const code_point_range &oRange) {
+                                                                  return cValue < oRange.nFirst;
+                                                              });
+            return pRange != aRanges && cCode <= pRange[-1].nLast;
+        }
+    }
+
+    /**
+     * @brief Number of terminal columns of a code point.
+     * @param cCode Code point.
+     * @return 0 for control, combining and format characters, 2 for wide characters, 1 otherwise.
+     */
+    constexpr std::size_t column_width(const char32_t cCode) noexcept {
+        if (cCode < 0x7F) return cCode >= 0x20 ? 1 : 0;
+        if (cCode < 0xA0) return 0;
+        if (cCode < 0x0300) return cCode == 0x00AD ? 0 : 1;
+        if (detail::in_ranges(detail::zero_width_ranges, cCode)) return 0;
+        return cCode >= 0x1100 && detail::in_ranges(detail::wide_ranges, cCode) ? 2 : 1;
+    }
+
+    /**
+     * @brief Number of terminal columns of a text.
+     *
+     * Ill-formed sequences count as the U+FFFD they transcode to.
+     *
+     * @tparam char_t Character type.
+     * @param sText Text to measure.
+     * @return Sum of the `column_width` of its code points.
+     */
+    template<CharacterType char_t>
+    constexpr std::size_t columns(const basic_string_view<char_t> sText) noexcept {
+        const char_t *pBegin = sText.data();
+        const char_t *const pEnd = pBegin + sText.size();
+        std::size_t nColumns = 0;
+        while (pBegin != pEnd) {
+            const std::uint32_t nUnit = detail::to_unit(*pBegin);
+            if (nUnit < 0x80) {
+                nColumns += nUnit >= 0x20 && nUnit != 0x7F;
+                ++pBegin;
+            } else {
+                nColumns += column_width(decode(pBegin, pEnd));
+            }
+        }
+        return nColumns;
+    }
+
+    /**
+     * @brief A literal together with facts about it, computed at compile time.
+     *
+     * @code
+     * static constexpr utf42::poly_enc_info oTitle(cons_poly_enc("Résumé 履歴書"));
+     * std::string sLine;
+     * sLine.reserve(oTitle.utf8_size() + nWidth);
+     * sLine += oTitle.visit<char>();
+     * sLine.append(nWidth - oTitle.columns(), ' ');
+     * @endcode
+     */
+    class poly_enc_info {
+    public:
+        /**
+         * @brief Measures a literal at compile time.
+         * @param oText Polymorphic literal.
+         */
+        consteval poly_enc_info(const poly_enc &oText) noexcept
+            : m_oText(oText),
+              m_nColumns(utf42::columns(oText.TXT_CHAR_32)),
+              m_bAscii(std::all_of(oText.TXT_CHAR_32.begin(), oText.TXT_CHAR_32.end(),
+                                   [](const char32_t cCode) { return cCode < 0x80; })) {
+        }
+
+        /**
+         * @brief Literal encoded for a character type.
+         * @tparam char_t Character type.
+         * @return View of the literal.
+         */
+        template<CharacterType char_t>
+        constexpr basic_string_view<char_t> visit() const noexcept { return m_oText.visit<char_t>(); }
+
+        /**
+         * @brief The literal.
+         * @return The polymorphic literal.
+         */
+        constexpr const poly_enc &text() const noexcept { return m_oText; }
+
+        /// @return Number of code points.
+        constexpr std::size_t code_points() const noexcept { return m_oText.TXT_CHAR_32.size(); }
+
+        /// @return True if every code point is below U+0080, so all encodings share the same units.
+        constexpr bool is_ascii() const noexcept { return m_bAscii; }
+
+        /// @return Size of the literal in UTF-8 code units.
+        constexpr std::size_t utf8_size() const noexcept { return m_oText.TXT_CHAR_8.size(); }
+
+        /// @return Size of the literal in UTF-16 code units.
+        constexpr std::size_t utf16_size() const noexcept { return m_oText.TXT_CHAR_16.size(); }
+
+        /// @return Number of terminal columns, see `utf42::column_width`.
+        constexpr std::size_t columns() const noexcept { return m_nColumns; }
+
+    private:
+        poly_enc m_oText; ///< Literal
+        std::size_t m_nColumns; ///< Terminal columns
+        bool m_bAscii; ///< Whether the literal is ASCII
+    };
+} // namespace utf42
+
+#endif //LIB_UTF_42_INFO
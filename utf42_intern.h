@@ -0,0 +1,919 @@
+/**
+ * @file utf42_intern.h
+ * @brief Concurrent string interning with multi-encoding handles.
+ *
+ * A `utf42::intern_table` stores each distinct string once, in UTF-8, and
+ * returns an `interned` handle: one pointer wide, compared by address, and
+ * viewable in the encoding of any character type like a `poly_enc`. The
+ * other encodings are built on first use, as for `lazy_enc`, in storage
+ * of the table that is freed with it.
+ *
+ * Strings of any encoding can be interned and are keyed by their UTF-8
+ * form, so `"clé"`, `u"clé"` and `U"clé"` give the same handle. UTF-8
+ * input is hashed and compared as it is, and only validated when it is not
+ * found; other input is transcoded first into a per-thread buffer. The table is split into shards, each with its
+ * own lock, so threads interning different strings rarely wait for each
+ * other.
+ *
+ * @code
+ * utf42::intern_table oNames;
+ * utf42::interned oName = oNames.intern(std::u16string_view(u"cpu.load"));
+ * bool bSame = oName == oNames.intern(std::string_view("cpu.load")); // true
+ * std::wstring_view sWide = oName.visit<wchar_t>();
+ * @endcode
+ *
+ * @note Requires C++20 or later.
+ *
+ * @copyright MIT License
+ *
+ * This file is part of utf42.
+ * Copyright (c) 2025 Dante Doménech Martínez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef LIB_UTF_42_INTERN
+#define LIB_UTF_42_INTERN
+
+#include "utf42.h"
+#include "utf42_transcode.h"
+#include "utf42_hash.h"
+#include "utf42_lazy.h"
+
+// C++ version requirements
+#if __cplusplus < 202002L
+#error "utf42_intern.h requires C++20 or later"
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define UTF42_INTERN_SHARED 1
+#endif
+
+namespace utf42 {
+    class intern_table;
+
+    namespace detail {
+        /**
+         * @brief Entry of an intern table.
+         *
+         * The null terminated UTF-8 string follows the entry.
+         */
+        struct intern_entry {
+            lazy_enc oText; ///< String, viewing the UTF-8 that follows
+            lazy_arena *pForms; ///< Arena of the shard holding the other encodings
+        };
+    }
+
+    /**
+     * @brief Handle of an interned string.
+     *
+     * Two handles from the same table are equal exactly when their strings
+     * are. A handle is valid as long as its table; the default handle is
+     * empty and views as an empty string.
+     */
+    class interned {
+    public:
+        /// Constructs an empty handle.
+        constexpr interned() noexcept = default;
+
+        /**
+         * @brief Views the string in the encoding of a character type.
+         * @tparam char_t Character type.
+         * @return A null terminated view, valid as long as the table, or an empty view for an empty handle.
+         */
+        template<CharacterType char_t>
+        basic_string_view<char_t> visit() const {
+            return m_pEntry != nullptr ? m_pEntry->oText.visit_in<char_t>(*m_pEntry->pForms)
+                                       : basic_string_view<char_t>();
+        }
+
+        /// @return The stored UTF-8 string.
+        basic_string_view<char8_t> utf8() const noexcept {
+            return m_pEntry != nullptr ? m_pEntry->oText.utf8() : basic_string_view<char8_t>();
+        }
+
+        /**
+         * @brief Views the string in every encoding, for functions taking a `poly_enc`.
+         * @return A `poly_enc` over the stored and materialized forms.
+         */
+        poly_enc to_poly_enc() const {
+            return poly_enc(visit<char>(), visit<wchar_t>(), visit<char8_t>(), visit<char16_t>(), visit<char32_t>());
+        }
+
+        /// @return True for the empty handle.
+        constexpr bool empty() const noexcept { return m_pEntry == nullptr; }
+
+        /// @return True if both handles refer to the same string.
+        friend constexpr bool operator==(interned, interned) noexcept = default;
+
+    private:
+        friend class intern_table;
+        friend struct std::hash<interned>;
+
+        /**
+         * @brief Wraps a stored string.
+         * @param pEntry Entry in the table.
+         */
+        constexpr explicit interned(const detail::intern_entry *pEntry) noexcept : m_pEntry(pEntry) {
+        }
+
+        const detail::intern_entry *m_pEntry = nullptr; ///< Entry in the table, null for the empty handle
+    };
+
+    namespace detail {
+        /**
+         * @brief Hashes the UTF-8 form of a string.
+         *
+         * Unlike `std::hash`, the value is fixed by this header, so every
+         * process sharing a table agrees on it. Bytes are absorbed sixteen at a
+         * time with the multiply of `utf42::hash`, the last ones with
+         * overlapping loads as in wyhash; the length is mixed in first.
+         *
+         * @param sKey UTF-8 string.
+         * @return The hash value.
+         */
+        inline std::uint64_t intern_hash(const basic_string_view<char8_t> sKey) noexcept {
+            const char8_t *pData = sKey.data();
+            std::size_t nLeft = sKey.size();
+            std::uint64_t nState = hash_secret[0] ^ fold_multiply(nLeft ^ hash_secret[2], hash_secret[3]);
+            std::uint64_t aWords[2];
+            while (nLeft > 16) {
+                std::memcpy(aWords, pData, 16);
+                nState = fold_multiply(aWords[0] ^ hash_secret[1], aWords[1] ^ nState);
+                pData += 16;
+                nLeft -= 16;
+            }
+            // The last one to sixteen bytes, with overlapping fixed-size loads
+            if (nLeft > 8) {
+                std::memcpy(&aWords[0], pData, 8);
+                std::memcpy(&aWords[1], pData + nLeft - 8, 8);
+            } else if (nLeft >= 4) {
+                std::uint32_t nFirst, nLast;
+                std::memcpy(&nFirst, pData, 4);
+                std::memcpy(&nLast, pData + nLeft - 4, 4);
+                aWords[0] = nFirst;
+                aWords[1] = nLast;
+            } else {
+                aWords[0] = nLeft == 0 ? 0 : pData[0] | pData[nLeft / 2] << 8 | pData[nLeft - 1] << 16;
+                aWords[1] = 0;
+            }
+            nState = fold_multiply(aWords[0] ^ hash_secret[1], aWords[1] ^ nState);
+            return fold_multiply(nState ^ hash_secret[2], nState ^ hash_secret[3]);
+        }
+
+        /**
+         * @brief Looks up a string of any encoding under its UTF-8 form.
+         *
+         * Stored strings are well-formed, so UTF-8 input is looked up as it
+         * is and only validated when it is not found. Other input, and
+         * ill-formed UTF-8, is first transcoded into a thread-local buffer.
+         *
+         * @tparam char_t Character type.
+         * @tparam lookup_t Callable `(nHash, sKey, bStore)` finding a well-formed UTF-8 key, and
+         *                  storing it if `bStore` is set and it is absent. A value initialized
+         *                  result means absent.
+         * @param sText String.
+         * @param bInsert Whether to store the string if it is absent.
+         * @param fnLookup Lookup of the table.
+         * @return The result of `fnLookup` for the UTF-8 form of the string.
+         */
+        template<CharacterType char_t, typename lookup_t>
+        auto intern_lookup(const basic_string_view<char_t> sText, const bool bInsert, lookup_t &&fnLookup) {
+            using result_t = decltype(fnLookup(std::uint64_t(), basic_string_view<char8_t>(), false));
+            if constexpr (sizeof(char_t) == 1) {
+                const basic_string_view<char8_t> sKey(reinterpret_cast<const char8_t *>(sText.data()), sText.size());
+                const std::uint64_t nHash = intern_hash(sKey);
+                const result_t oFound = fnLookup(nHash, sKey, false);
+                if (oFound != result_t()) return oFound;
+                if (validate(sText)) return bInsert ? fnLookup(nHash, sKey, true) : result_t();
+            }
+            static thread_local std::u8string sBuffer;
+            sBuffer.resize(transcoded_length<char8_t>(sText));
+            transcode_into<char8_t>(sText, sBuffer.data());
+            return fnLookup(intern_hash(sBuffer), basic_string_view<char8_t>(sBuffer), bInsert);
+        }
+
+        /// Slot of a shard hash table
+        struct intern_slot {
+            std::uint64_t nHash; ///< Hash of the string
+            const intern_entry *pEntry; ///< Entry, null for a free slot
+        };
+
+        /**
+         * @brief Part of an intern table with its own lock, hash table and storage.
+         *
+         * Entries are an `intern_entry` followed by its null terminated UTF-8
+         * string, bump allocated from chunks that live as long as the shard.
+         * The other encodings built by `interned::visit` go to an arena of
+         * the shard, also freed with it.
+         */
+        class alignas(64) intern_shard {
+        public:
+            /**
+             * @brief Finds a string. The caller holds `mutex()`.
+             * @param nHash Hash of the string.
+             * @param sText Well-formed UTF-8 string.
+             * @return The entry, or null.
+             */
+            const intern_entry *find(const std::uint64_t nHash, const basic_string_view<char8_t> sText) const noexcept {
+                if (m_aSlots.empty()) return nullptr;
+                const std::size_t nMask = m_aSlots.size() - 1;
+                for (std::size_t i = static_cast<std::size_t>(nHash) & nMask;; i = (i + 1) & nMask) {
+                    const intern_slot &oSlot = m_aSlots[i];
+                    if (oSlot.pEntry == nullptr) return nullptr;
+                    if (oSlot.nHash == nHash && oSlot.pEntry->oText.utf8() == sText) return oSlot.pEntry;
+                }
+            }
+
+            /**
+             * @brief Stores a string known to be absent. The caller holds `mutex()`.
+             * @param nHash Hash of the string.
+             * @param sText Well-formed UTF-8 string.
+             * @return The new entry.
+             */
+            const intern_entry *insert(const std::uint64_t nHash, const basic_string_view<char8_t> sText) {
+                if (2 * (m_nSize + 1) > m_aSlots.size()) grow();
+                void *pMemory = allocate(sizeof(intern_entry) + sText.size() + 1);
+                char8_t *pText = reinterpret_cast<char8_t *>(static_cast<unsigned char *>(pMemory) + sizeof(intern_entry));
+                std::copy(sText.begin(), sText.end(), pText);
+                pText[sText.size()] = 0;
+                const intern_entry *pEntry = ::new(pMemory) intern_entry{
+                    lazy_enc(basic_string_view<char8_t>(pText, sText.size())), &m_oForms};
+                place({nHash, pEntry});
+                ++m_nSize;
+                m_nBytes += sizeof(intern_entry) + sText.size() + 1;
+                return pEntry;
+            }
+
+            /// @return Mutex protecting the shard.
+            std::mutex &mutex() const noexcept { return m_oMutex; }
+
+            /// @return Number of strings. The caller holds `mutex()`.
+            std::size_t size() const noexcept { return m_nSize; }
+
+            /// @return Bytes taken by the entries. The caller holds `mutex()`.
+            std::size_t bytes() const noexcept { return m_nBytes; }
+
+        private:
+            /// Size of the chunks taken from the heap
+            static constexpr std::size_t chunk_size = 16 * 1024;
+
+            /**
+             * @brief Allocates entry memory.
+             * @param nBytes Size.
+             * @return Memory aligned for `intern_entry`.
+             */
+            void *allocate(std::size_t nBytes) {
+                nBytes = (nBytes + alignof(intern_entry) - 1) & ~(alignof(intern_entry) - 1);
+                if (nBytes > m_nLeft) {
+                    const std::size_t nChunk = std::max(nBytes, chunk_size);
+                    m_aChunks.push_back(std::make_unique<std::max_align_t[]>(
+                        (nChunk + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t)));
+                    m_pNext = reinterpret_cast<unsigned char *>(m_aChunks.back().get());
+                    m_nLeft = nChunk;
+                }
+                void *pResult = m_pNext;
+                m_pNext += nBytes;
+                m_nLeft -= nBytes;
+                return pResult;
+            }
+
+            /// Doubles the hash table.
+            void grow() {
+                std::vector<intern_slot> aOld(std::max<std::size_t>(16, 2 * m_aSlots.size()), intern_slot{0, nullptr});
+                aOld.swap(m_aSlots);
+                for (const intern_slot &oSlot: aOld) {
+                    if (oSlot.pEntry != nullptr) place(oSlot);
+                }
+            }
+
+            /**
+             * @brief Puts an entry in the first free slot of its probe sequence.
+             * @param oSlot Entry and its hash.
+             */
+            void place(const intern_slot &oSlot) noexcept {
+                const std::size_t nMask = m_aSlots.size() - 1;
+                std::size_t i = static_cast<std::size_t>(oSlot.nHash) & nMask;
+                while (m_aSlots[i].pEntry != nullptr) i = (i + 1) & nMask;
+                m_aSlots[i] = oSlot;
+            }
+
+            mutable std::mutex m_oMutex; ///< Protects the shard
+            std::vector<intern_slot> m_aSlots; ///< Open addressing table, a power of two in size
+            std::size_t m_nSize = 0; ///< Number of strings
+            std::size_t m_nBytes = 0; ///< Bytes taken by the entries
+            std::vector<std::unique_ptr<std::max_align_t[]> > m_aChunks; ///< Chunks taken from the heap
+            unsigned char *m_pNext = nullptr; ///< Next free byte of the current chunk
+            std::size_t m_nLeft = 0; ///< Free bytes in the current chunk
+            lazy_arena m_oForms; ///< UTF-16 and UTF-32 forms of the entries
+        };
+    }
+
+    /**
+     * @brief Thread-safe table storing each distinct string once.
+     *
+     * `intern` and `find` may be called from any thread. Entries are never
+     * removed, so handles and the views they return stay valid until the
+     * table is destroyed. UTF-16 and UTF-32 forms built by `visit` are kept
+     * by the table and freed with it, like the UTF-8 strings.
+     */
+    class intern_table {
+    public:
+        /// Number of shards, each with its own lock
+        static constexpr std::size_t shards = 64;
+
+        /// Constructs an empty table.
+        intern_table() = default;
+
+        intern_table(const intern_table &) = delete;
+
+        intern_table &operator=(const intern_table &) = delete;
+
+        /**
+         * @brief Interns a string.
+         * @tparam text_t String view, string or null terminated pointer of any character type.
+         * @param oText String, ill-formed sequences being stored as U+FFFD.
+         * @return The handle of the string, the same for every call with equal code points.
+         */
+        template<typename text_t>
+        interned intern(const text_t &oText) {
+            return interned(lookup(detail::as_hash_view(oText), true));
+        }
+
+        /**
+         * @brief Finds an interned string without storing it.
+         * @tparam text_t String view, string or null terminated pointer of any character type.
+         * @param oText String.
+         * @return The handle of the string, or an empty handle if it was never interned.
+         */
+        template<typename text_t>
+        interned find(const text_t &oText) const {
+            return interned(lookup(detail::as_hash_view(oText), false));
+        }
+
+        /// @return Number of distinct strings.
+        std::size_t size() const {
+            std::size_t nSize = 0;
+            for (const detail::intern_shard &oShard: m_aShards) {
+                std::lock_guard<std::mutex> oLock(oShard.mutex());
+                nSize += oShard.size();
+            }
+            return nSize;
+        }
+
+        /// @return Bytes taken by the stored UTF-8 strings and their entries.
+        std::size_t bytes() const {
+            std::size_t nBytes = 0;
+            for (const detail::intern_shard &oShard: m_aShards) {
+                std::lock_guard<std::mutex> oLock(oShard.mutex());
+                nBytes += oShard.bytes();
+            }
+            return nBytes;
+        }
+
+    private:
+        /**
+         * @brief Shard of a hash.
+         * @param nHash Hash of a string.
+         * @return The shard, chosen by the high bits so the low ones stay random within it.
+         */
+        detail::intern_shard &shard(const std::uint64_t nHash) const noexcept {
+            return m_aShards[static_cast<std::size_t>(nHash >> 58) % shards];
+        }
+
+        /**
+         * @brief Finds or stores a string under its UTF-8 form.
+         * @tparam char_t Character type.
+         * @param sText String.
+         * @param bInsert Whether to store the string if it is absent.
+         * @return The entry, or null if it is absent and not stored.
+         */
+        template<CharacterType char_t>
+        const detail::intern_entry *lookup(const basic_string_view<char_t> sText, const bool bInsert) const {
+            return detail::intern_lookup(sText, bInsert, [this](const std::uint64_t nHash,
+                                                                const basic_string_view<char8_t> sKey,
+                                                                const bool bStore) {
+                detail::intern_shard &oShard = shard(nHash);
+                std::lock_guard<std::mutex> oLock(oShard.mutex());
+                const detail::intern_entry *pEntry = oShard.find(nHash, sKey);
+                return pEntry != nullptr || !bStore ? pEntry : oShard.insert(nHash, sKey);
+            });
+        }
+
+        mutable detail::intern_shard m_aShards[shards]; ///< Shards, selected by hash
+    };
+#if defined(UTF42_INTERN_SHARED)
+    /// Layout version of shared intern tables
+    constexpr std::uint32_t shared_intern_version = 1;
+
+    /**
+     * @brief Handle of a string in a shared intern table.
+     *
+     * The handle is the position of the string in the shared region, so it
+     * means the same in every process attached to the table and can be
+     * stored in shared memory or sent between processes. Two handles of a
+     * table are equal exactly when their strings are.
+     */
+    struct shared_interned {
+        std::uint32_t nOffset = 0; ///< Offset of the entry in 8-byte units, 0 for the empty handle
+
+        /// @return True for the empty handle.
+        constexpr bool empty() const noexcept { return nOffset == 0; }
+
+        /// @return True if both handles refer to the same string.
+        friend constexpr bool operator==(shared_interned, shared_interned) noexcept = default;
+    };
+
+    namespace detail {
+        /**
+         * @brief Header of a shared intern region.
+         *
+         * The region is the header, a table of `nSlots` 64-bit slots and
+         * the entry area. A slot holds the high half of the hash of its
+         * string and the handle of its entry, 0 if it is free. Fields marked
+         * atomic are only accessed through `std::atomic_ref`.
+         */
+        struct shared_intern_header {
+            char aMagic[8]; ///< "UTF42INT"
+            std::uint32_t nVersion; ///< `shared_intern_version`
+            std::uint32_t nSlots; ///< Number of slots, a power of two at least twice the capacity
+            std::uint64_t nCapacity; ///< Maximum number of strings
+            std::uint64_t nDataOffset; ///< Offset of the entry area
+            std::uint64_t nDataSize; ///< Size of the entry area
+            std::uint64_t nStrings; ///< Strings stored or being stored, atomic
+            std::uint64_t nDataUsed; ///< Bytes taken from the entry area, atomic
+        };
+
+        /**
+         * @brief Entry of a shared intern table.
+         *
+         * The null terminated UTF-8 form follows, in the cache line of the
+         * entry since lookups compare it, then the UTF-16 and UTF-32 forms,
+         * each aligned for its code units.
+         */
+        struct shared_intern_entry {
+            std::uint32_t nUtf8; ///< Length of the UTF-8 form
+            std::uint32_t nUtf16; ///< Length of the UTF-16 form
+            std::uint32_t nUtf32; ///< Length of the UTF-32 form
+            std::uint32_t nReserved; ///< Padding, 0
+        };
+
+        /**
+         * @brief Offsets of the forms of an entry, from the end of its header.
+         * @param nUtf8 Length of the UTF-8 form.
+         * @param nUtf16 Length of the UTF-16 form.
+         * @return Offsets of the UTF-16 and UTF-32 forms; the UTF-8 form is at 0.
+         */
+        constexpr std::pair<std::size_t, std::size_t> shared_intern_forms(const std::size_t nUtf8,
+                                                                          const std::size_t nUtf16) noexcept {
+            const std::size_t nUtf16Offset = (nUtf8 + 1 + 1) & ~std::size_t(1);
+            return {nUtf16Offset, (nUtf16Offset + 2 * (nUtf16 + 1) + 3) & ~std::size_t(3)};
+        }
+
+        /// Magic bytes of a shared intern region
+        constexpr char shared_intern_magic[8] = {'U', 'T', 'F', '4', '2', 'I', 'N', 'T'};
+
+        /**
+         * @brief Size of an entry and its forms.
+         * @param nUtf8 Length of the UTF-8 form.
+         * @param nUtf16 Length of the UTF-16 form.
+         * @param nUtf32 Length of the UTF-32 form.
+         * @return Bytes, a multiple of 8.
+         */
+        constexpr std::size_t shared_intern_footprint(const std::size_t nUtf8, const std::size_t nUtf16,
+                                                      const std::size_t nUtf32) noexcept {
+            const std::size_t nBytes = sizeof(shared_intern_entry) + shared_intern_forms(nUtf8, nUtf16).second +
+                                       4 * (nUtf32 + 1);
+            return (nBytes + 7) & ~std::size_t(7);
+        }
+    }
+
+    /**
+     * @brief Intern table living in a shared mapping, for several processes.
+     *
+     * Every string is stored once for all the processes attached to the
+     * table, in UTF-8, UTF-16 and UTF-32, so `visit` never transcodes. A
+     * process attaches by mapping the region, without reading or building
+     * anything. Insertion is lock-free: an entry is written in space taken
+     * with an atomic add, then published into the slot table with a
+     * compare-and-swap.
+     *
+     * The capacity, in strings and in bytes, is fixed when the region is
+     * created; pages are only backed by memory once written, so a generous
+     * capacity costs nothing. When either runs out `intern` returns an
+     * empty handle. Two processes interning the same new string at once
+     * both write it and one copy stays unused.
+     *
+     * @code
+     * // Parent, before starting the workers
+     * std::optional<utf42::shared_intern_table> oNames = utf42::shared_intern_table::create(1 << 20, 64 << 20);
+     *
+     * // Worker, given the descriptor oNames->fd()
+     * std::optional<utf42::shared_intern_table> oShared = utf42::shared_intern_table::attach(nFd);
+     * utf42::shared_interned oMetric = oShared->intern(std::string_view("tenant-7.cpu"));
+     * std::u16string_view sText = oShared->visit<char16_t>(oMetric);
+     * @endcode
+     */
+    class shared_intern_table {
+    public:
+        shared_intern_table(const shared_intern_table &) = delete;
+
+        shared_intern_table &operator=(const shared_intern_table &) = delete;
+
+        /**
+         * @brief Takes over another table.
+         * @param oOther Table to move, left empty.
+         */
+        shared_intern_table(shared_intern_table &&oOther) noexcept
+            : m_pData(std::exchange(oOther.m_pData, nullptr)), m_nSize(std::exchange(oOther.m_nSize, 0)),
+              m_nFd(std::exchange(oOther.m_nFd, -1)) {
+        }
+
+        /**
+         * @brief Takes over another table.
+         * @param oOther Table to move, left empty.
+         * @return This table.
+         */
+        shared_intern_table &operator=(shared_intern_table &&oOther) noexcept {
+            if (this != &oOther) {
+                release();
+                m_pData = std::exchange(oOther.m_pData, nullptr);
+                m_nSize = std::exchange(oOther.m_nSize, 0);
+                m_nFd = std::exchange(oOther.m_nFd, -1);
+            }
+            return *this;
+        }
+
+        /// Unmaps the region and closes its descriptor. Strings stay for the other processes.
+        ~shared_intern_table() { release(); }
+
+        /**
+         * @brief Creates a table in anonymous shared memory (Linux `memfd`).
+         *
+         * Other processes attach with `attach(fd())`, the descriptor being
+         * inherited or passed over a Unix socket.
+         *
+         * @param nCapacity Maximum number of strings.
+         * @param nBytes Size of the entry area, 32 bytes plus about 7 bytes per UTF-8 byte per string.
+         * @return The table, or nothing if shared memory is unavailable or the capacity is too large.
+         */
+        static std::optional<shared_intern_table> create(const std::size_t nCapacity, const std::size_t nBytes) {
+#if defined(MFD_CLOEXEC)
+            const int nFd = memfd_create("utf42_intern", MFD_CLOEXEC);
+            if (nFd < 0) return std::nullopt;
+            return initialize(nFd, nCapacity, nBytes);
+#else
+            (void) nCapacity;
+            (void) nBytes;
+            return std::nullopt;
+#endif
+        }
+
+        /**
+         * @brief Opens a table in a file, creating it if it is empty or missing.
+         *
+         * Files in `/dev/shm` are memory-backed and outlive the processes.
+         * Concurrent openers are serialized with `flock` while the file is
+         * created; the capacity of an existing table is kept.
+         *
+         * @param sPath Path of the file.
+         * @param nCapacity Maximum number of strings, for a new table.
+         * @param nBytes Size of the entry area, for a new table.
+         * @return The table, or nothing if the file cannot be opened or is not a table.
+         */
+        static std::optional<shared_intern_table> open(const std::string &sPath, const std::size_t nCapacity,
+                                                       const std::size_t nBytes) {
+            const int nFd = ::open(sPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+            if (nFd < 0) return std::nullopt;
+            struct stat oStat{};
+            if (flock(nFd, LOCK_EX) != 0 || fstat(nFd, &oStat) != 0) {
+                ::close(nFd);
+                return std::nullopt;
+            }
+            std::optional<shared_intern_table> oTable = oStat.st_size == 0
+                                                            ? initialize(nFd, nCapacity, nBytes)
+                                                            : map(nFd);
+            if (oTable) flock(nFd, LOCK_UN);
+            return oTable;
+        }
+
+        /**
+         * @brief Attaches to the table of a descriptor.
+         * @param nFd Descriptor of a table region, duplicated.
+         * @return The table, or nothing if the descriptor does not hold a table.
+         */
+        static std::optional<shared_intern_table> attach(const int nFd) {
+            const int nOwn = fcntl(nFd, F_DUPFD_CLOEXEC, 0);
+            if (nOwn < 0) return std::nullopt;
+            return map(nOwn);
+        }
+
+        /// @return Descriptor of the region, to pass to other processes.
+        int fd() const noexcept { return m_nFd; }
+
+        /**
+         * @brief Interns a string.
+         * @tparam text_t String view, string or null terminated pointer of any character type.
+         * @param oText String, ill-formed sequences being stored as U+FFFD.
+         * @return The handle of the string, or an empty handle if the table is full.
+         */
+        template<typename text_t>
+        shared_interned intern(const text_t &oText) {
+            return lookup(detail::as_hash_view(oText), true);
+        }
+
+        /**
+         * @brief Finds an interned string without storing it.
+         * @tparam text_t String view, string or null terminated pointer of any character type.
+         * @param oText String.
+         * @return The handle of the string, or an empty handle if it was never interned.
+         */
+        template<typename text_t>
+        shared_interned find(const text_t &oText) const {
+            return lookup(detail::as_hash_view(oText), false);
+        }
+
+        /**
+         * @brief Views a string in the encoding of a character type.
+         * @tparam char_t Character type.
+         * @param oHandle Handle from this table, in any process.
+         * @return Null terminated view into the shared region, empty for an empty or invalid handle.
+         */
+        template<CharacterType char_t>
+        basic_string_view<char_t> visit(const shared_interned oHandle) const noexcept {
+            const std::size_t nOffset = static_cast<std::size_t>(oHandle.nOffset) * 8;
+            if (oHandle.empty() || nOffset < header().nDataOffset ||
+                nOffset + sizeof(detail::shared_intern_entry) > m_nSize) {
+                return {};
+            }
+            detail::shared_intern_entry oEntry;
+            std::memcpy(&oEntry, m_pData + nOffset, sizeof(oEntry));
+            if (nOffset + detail::shared_intern_footprint(oEntry.nUtf8, oEntry.nUtf16, oEntry.nUtf32) > m_nSize) {
+                return {};
+            }
+            const unsigned char *pForms = m_pData + nOffset + sizeof(detail::shared_intern_entry);
+            if constexpr (sizeof(char_t) == 1) {
+                return {reinterpret_cast<const char_t *>(pForms), oEntry.nUtf8};
+            } else {
+                const auto [nUtf16, nUtf32] = detail::shared_intern_forms(oEntry.nUtf8, oEntry.nUtf16);
+                if constexpr (sizeof(char_t) == 2) {
+                    return {reinterpret_cast<const char_t *>(pForms + nUtf16), oEntry.nUtf16};
+                } else {
+                    return {reinterpret_cast<const char_t *>(pForms + nUtf32), oEntry.nUtf32};
+                }
+            }
+        }
+
+        /// @return Number of strings, over every process.
+        std::size_t size() const noexcept {
+            return static_cast<std::size_t>(
+                std::atomic_ref<std::uint64_t>(header().nStrings).load(std::memory_order_relaxed));
+        }
+
+        /// @return Maximum number of strings.
+        std::size_t capacity() const noexcept { return static_cast<std::size_t>(header().nCapacity); }
+
+        /// @return Bytes taken from the entry area.
+        std::size_t bytes() const noexcept {
+            return static_cast<std::size_t>(
+                std::atomic_ref<std::uint64_t>(header().nDataUsed).load(std::memory_order_relaxed));
+        }
+
+    private:
+        static_assert(std::atomic_ref<std::uint64_t>::is_always_lock_free,
+                      "shared intern tables need address-free 64-bit atomics");
+
+        shared_intern_table() noexcept = default;
+
+        /// @return Header of the region.
+        detail::shared_intern_header &header() const noexcept {
+            return *reinterpret_cast<detail::shared_intern_header *>(m_pData);
+        }
+
+        /**
+         * @brief Slot of the region.
+         * @param nSlot Index of the slot.
+         * @return Atomic reference to the slot.
+         */
+        std::atomic_ref<std::uint64_t> slot(const std::size_t nSlot) const noexcept {
+            return std::atomic_ref<std::uint64_t>(
+                reinterpret_cast<std::uint64_t *>(m_pData + sizeof(detail::shared_intern_header))[nSlot]);
+        }
+
+        /**
+         * @brief Sizes a new region and writes its header.
+         * @param nFd Descriptor of an empty file, owned by the table.
+         * @param nCapacity Maximum number of strings.
+         * @param nBytes Size of the entry area.
+         * @return The table, or nothing if the region cannot be created.
+         */
+        static std::optional<shared_intern_table> initialize(const int nFd, const std::size_t nCapacity,
+                                                             const std::size_t nBytes) {
+            std::size_t nSlots = 16;
+            while (nSlots < 2 * nCapacity) nSlots *= 2;
+            const std::size_t nDataOffset = sizeof(detail::shared_intern_header) + nSlots * sizeof(std::uint64_t);
+            const std::size_t nDataSize = (nBytes + 7) & ~std::size_t(7);
+            // Handles count 8-byte units in 32 bits
+            if (nCapacity == 0 || nSlots > (std::size_t(1) << 31) ||
+                nDataOffset + nDataSize > (std::uint64_t(1) << 35) ||
+                ftruncate(nFd, static_cast<off_t>(nDataOffset + nDataSize)) != 0) {
+                ::close(nFd);
+                return std::nullopt;
+            }
+            std::optional<shared_intern_table> oTable = map(nFd, false);
+            if (!oTable) return std::nullopt;
+            detail::shared_intern_header &oHeader = oTable->header();
+            oHeader.nVersion = shared_intern_version;
+            oHeader.nSlots = static_cast<std::uint32_t>(nSlots);
+            oHeader.nCapacity = nCapacity;
+            oHeader.nDataOffset = nDataOffset;
+            oHeader.nDataSize = nDataSize;
+            std::memcpy(oHeader.aMagic, detail::shared_intern_magic, sizeof(oHeader.aMagic));
+            return oTable;
+        }
+
+        /**
+         * @brief Maps a region.
+         * @param nFd Descriptor, owned by the table.
+         * @param bCheck Whether to check the header.
+         * @return The table, or nothing if the region cannot be mapped or is not a table.
+         */
+        static std::optional<shared_intern_table> map(const int nFd, const bool bCheck = true) {
+            shared_intern_table oTable;
+            oTable.m_nFd = nFd;
+            struct stat oStat{};
+            if (fstat(nFd, &oStat) != 0 || static_cast<std::size_t>(oStat.st_size) < sizeof(detail::shared_intern_header)) {
+                return std::nullopt;
+            }
+            void *pData = mmap(nullptr, static_cast<std::size_t>(oStat.st_size), PROT_READ | PROT_WRITE, MAP_SHARED,
+                               nFd, 0);
+            if (pData == MAP_FAILED) return std::nullopt;
+            oTable.m_pData = static_cast<unsigned char *>(pData);
+            oTable.m_nSize = static_cast<std::size_t>(oStat.st_size);
+            const detail::shared_intern_header &oHeader = oTable.header();
+            if (bCheck &&
+                (std::memcmp(oHeader.aMagic, detail::shared_intern_magic, sizeof(oHeader.aMagic)) != 0 ||
+                 oHeader.nVersion != shared_intern_version || oHeader.nSlots < 16 ||
+                 (oHeader.nSlots & (oHeader.nSlots - 1)) != 0 || oHeader.nSlots < 2 * oHeader.nCapacity ||
+                 oHeader.nDataOffset != sizeof(detail::shared_intern_header) + oHeader.nSlots * sizeof(std::uint64_t) ||
+                 oHeader.nDataOffset + oHeader.nDataSize != oTable.m_nSize)) {
+                return std::nullopt;
+            }
+            return oTable;
+        }
+
+        /**
+         * @brief Finds or stores a string under its UTF-8 form.
+         *
+         * Const like the other helpers: the region is shared between
+         * processes rather than state of this object.
+         *
+         * @tparam char_t Character type.
+         * @param sText String.
+         * @param bInsert Whether to store the string if it is absent.
+         * @return The handle, or an empty handle if the string is absent and not stored.
+         */
+        template<CharacterType char_t>
+        shared_interned lookup(const basic_string_view<char_t> sText, const bool bInsert) const {
+            return detail::intern_lookup(sText, bInsert, [this](const std::uint64_t nHash,
+                                                                const basic_string_view<char8_t> sKey,
+                                                                const bool bStore) {
+                const shared_interned oFound = probe(nHash, sKey);
+                return !oFound.empty() || !bStore ? oFound : insert(nHash, sKey);
+            });
+        }
+
+        /**
+         * @brief Finds a string.
+         * @param nHash Hash of the string.
+         * @param sKey UTF-8 string.
+         * @return The handle, or an empty handle.
+         */
+        shared_interned probe(const std::uint64_t nHash, const basic_string_view<char8_t> sKey) const noexcept {
+            const std::size_t nMask = header().nSlots - 1;
+            for (std::size_t i = static_cast<std::size_t>(nHash) & nMask;; i = (i + 1) & nMask) {
+                const std::uint64_t nSlot = slot(i).load(std::memory_order_acquire);
+                if (nSlot == 0) return {};
+                const shared_interned oHandle{static_cast<std::uint32_t>(nSlot)};
+                if (nSlot >> 32 == nHash >> 32 && visit<char8_t>(oHandle) == sKey) return oHandle;
+            }
+        }
+
+        /**
+         * @brief Stores a string that was not found.
+         * @param nHash Hash of the string.
+         * @param sKey Well-formed UTF-8 string.
+         * @return The handle of the string, stored here or by another process meanwhile, or an empty handle if the table is full.
+         */
+        shared_interned insert(const std::uint64_t nHash, const basic_string_view<char8_t> sKey) const {
+            detail::shared_intern_header &oHeader = header();
+            std::atomic_ref<std::uint64_t> oStrings(oHeader.nStrings);
+            // Reserving the string first keeps the slot table at most half full
+            if (oStrings.fetch_add(1, std::memory_order_relaxed) >= oHeader.nCapacity) {
+                oStrings.fetch_sub(1, std::memory_order_relaxed);
+                return {};
+            }
+            const std::size_t nUtf8 = sKey.size();
+            const std::size_t nUtf16 = transcoded_length<char16_t>(sKey);
+            const std::size_t nUtf32 = transcoded_length<char32_t>(sKey);
+            const std::size_t nBytes = detail::shared_intern_footprint(nUtf8, nUtf16, nUtf32);
+            const std::uint64_t nOffset =
+                    std::atomic_ref<std::uint64_t>(oHeader.nDataUsed).fetch_add(nBytes, std::memory_order_relaxed);
+            if (nOffset + nBytes > oHeader.nDataSize) {
+                oStrings.fetch_sub(1, std::memory_order_relaxed);
+                return {};
+            }
+            unsigned char *pEntry = m_pData + oHeader.nDataOffset + nOffset;
+            const detail::shared_intern_entry oEntry{
+                static_cast<std::uint32_t>(nUtf8), static_cast<std::uint32_t>(nUtf16),
+                static_cast<std::uint32_t>(nUtf32), 0
+            };
+            std::memcpy(pEntry, &oEntry, sizeof(oEntry));
+            const auto [nUtf16Offset, nUtf32Offset] = detail::shared_intern_forms(nUtf8, nUtf16);
+            char8_t *pUtf8 = reinterpret_cast<char8_t *>(pEntry + sizeof(oEntry));
+            char16_t *pUtf16 = reinterpret_cast<char16_t *>(pEntry + sizeof(oEntry) + nUtf16Offset);
+            char32_t *pUtf32 = reinterpret_cast<char32_t *>(pEntry + sizeof(oEntry) + nUtf32Offset);
+            std::copy(sKey.begin(), sKey.end(), pUtf8);
+            transcode_into<char16_t>(sKey, pUtf16);
+            transcode_into<char32_t>(sKey, pUtf32);
+            pUtf8[nUtf8] = 0;
+            pUtf16[nUtf16] = 0;
+            pUtf32[nUtf32] = 0;
+
+            const shared_interned oHandle{static_cast<std::uint32_t>((oHeader.nDataOffset + nOffset) / 8)};
+            const std::uint64_t nMine = (nHash >> 32 << 32) | oHandle.nOffset;
+            const std::size_t nMask = oHeader.nSlots - 1;
+            for (std::size_t i = static_cast<std::size_t>(nHash) & nMask;; i = (i + 1) & nMask) {
+                std::uint64_t nSlot = 0;
+                if (slot(i).compare_exchange_strong(nSlot, nMine, std::memory_order_acq_rel,
+                                                    std::memory_order_acquire)) {
+                    return oHandle;
+                }
+                const shared_interned oOther{static_cast<std::uint32_t>(nSlot)};
+                if (nSlot >> 32 == nHash >> 32 && visit<char8_t>(oOther) == sKey) {
+                    // Another process stored it first, this copy stays unused
+                    oStrings.fetch_sub(1, std::memory_order_relaxed);
+                    return oOther;
+                }
+            }
+        }
+
+        /// Unmaps the region and closes the descriptor
+        void release() noexcept {
+            if (m_pData != nullptr) munmap(m_pData, m_nSize);
+            if (m_nFd >= 0) ::close(m_nFd);
+            m_pData = nullptr;
+            m_nFd = -1;
+        }
+
+        unsigned char *m_pData = nullptr; ///< Mapped region
+        std::size_t m_nSize = 0; ///< Size of the region
+        int m_nFd = -1; ///< Descriptor of the region
+    };
+#endif
+} // namespace utf42
+
+/// Hashes a handle by address, consistent with `==`.
+template<>
+struct std::hash<utf42::interned> {
+    std::size_t operator()(const utf42::interned oHandle) const noexcept {
+        return std::hash<const utf42::detail::intern_entry *>()(oHandle.m_pEntry);
+    }
+};
+
+#endif //LIB_UTF_42_INTERN
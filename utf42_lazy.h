@@ -0,0 +1,392 @@
+/**
+ * @file utf42_lazy.h
+ * @brief Literals stored once in UTF-8, other encodings built on first use.
+ *
+ * `cons_poly_enc` stores a literal five times, once per character type.
+ * A `lazy_enc` made with `lazy_poly_enc` stores only its UTF-8 form. The
+ * UTF-16 and UTF-32 forms (`wchar_t` shares one of them) are transcoded on
+ * their first `visit` into a process-wide arena and reused afterwards, so
+ * large message tables take a fraction of the read-only data in exchange
+ * for a small cost on first use. `utf42::materialize` builds the forms of
+ * a whole table ahead of time, on several threads.
+ *
+ * `lazy_enc` objects hold the pointers to their forms, so tables of them
+ * are declared `constinit` rather than `constexpr`:
+ *
+ * @code
+ * constinit utf42::lazy_enc g_aMessages[] = {lazy_poly_enc("Fichier introuvable"), lazy_poly_enc("Accès refusé")};
+ * std::u16string_view sMessage = g_aMessages[1].visit<char16_t>();
+ * @endcode
+ *
+ * @note Requires C++20 or later.
+ *
+ * @copyright MIT License
+ *
+ * This file is part of utf42.
+ * Copyright (c) 2025 Dante Doménech Martínez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef LIB_UTF_42_LAZY
+#define LIB_UTF_42_LAZY
+
+#include "utf42.h"
+#include "utf42_transcode.h"
+
+// C++ version requirements
+#if __cplusplus < 202002L
+#error "utf42_lazy.h requires C++20 or later"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Macro that stores a string literal once, in UTF-8.
+ *
+ * The other encodings are produced at run time, on first use.
+ *
+ * @param lit String literal.
+ */
+#define lazy_poly_enc(lit) utf42::lazy_enc{u8##lit}
+
+namespace utf42 {
+    namespace detail {
+        /**
+         * @brief Header of a materialized form in the arena.
+         *
+         * The null terminated code units follow the header.
+         */
+        struct lazy_form {
+            std::size_t nLength; ///< Length in code units, excluding the terminator
+
+            /**
+             * @brief Views the code units.
+             * @tparam char_t Character type, of the width of the stored units.
+             * @return View of the form.
+             */
+            template<typename char_t>
+            basic_string_view<char_t> view() const noexcept {
+                return {reinterpret_cast<const char_t *>(this + 1), nLength};
+            }
+
+            /**
+             * @brief Bytes taken in the arena by a form.
+             * @tparam unit_t Code unit type.
+             * @param nLength Length in code units.
+             * @return Size of the header and the terminated units, rounded to the alignment of the header.
+             */
+            template<typename unit_t>
+            static constexpr std::size_t footprint(const std::size_t nLength) noexcept {
+                const std::size_t nBytes = sizeof(lazy_form) + (nLength + 1) * sizeof(unit_t);
+                return (nBytes + alignof(lazy_form) - 1) & ~(alignof(lazy_form) - 1);
+            }
+
+            /**
+             * @brief Writes a form.
+             * @tparam unit_t Code unit type.
+             * @param pOut Arena memory of `footprint<unit_t>(nLength)` bytes.
+             * @param sSource UTF-8 original.
+             * @param nLength Length of the form, as given by `transcoded_length`.
+             * @return The form.
+             */
+            template<typename unit_t>
+            static const lazy_form *write(void *pOut, const basic_string_view<char8_t> sSource,
+                                          const std::size_t nLength) noexcept {
+                auto *pForm = new(pOut) lazy_form{nLength};
+                auto *pUnits = reinterpret_cast<unit_t *>(pForm + 1);
+                transcode_into(sSource, pUnits);
+                pUnits[nLength] = 0;
+                return pForm;
+            }
+        };
+
+        /**
+         * @brief Bump allocator holding materialized forms.
+         *
+         * Forms of the process-wide instance are never freed: views to them
+         * stay valid until the process exits, including in destructors of
+         * static objects. Owners of `lazy_enc` entries with a shorter life,
+         * such as `intern_table`, keep their own arena, freed with them.
+         */
+        class lazy_arena {
+        public:
+            /// Constructs an empty arena.
+            lazy_arena() = default;
+
+            lazy_arena(const lazy_arena &) = delete;
+
+            lazy_arena &operator=(const lazy_arena &) = delete;
+
+            /// @return The arena, created on first use and never destroyed.
+            static lazy_arena &instance() {
+                static lazy_arena *const pArena = new lazy_arena();
+                return *pArena;
+            }
+
+            /**
+             * @brief Allocates arena memory. The caller holds `mutex()`.
+             * @param nBytes Size, a multiple of `alignof(lazy_form)`.
+             * @return Memory aligned for `lazy_form`.
+             */
+            void *allocate(const std::size_t nBytes) {
+                if (nBytes > m_nLeft) {
+                    const std::size_t nChunk = std::max(nBytes, chunk_size);
+                    m_aChunks.push_back(std::make_unique<std::max_align_t[]>(
+                        (nChunk + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t)));
+                    m_pNext = reinterpret_cast<unsigned char *>(m_aChunks.back().get());
+                    m_nLeft = nChunk;
+                    m_nReserved.fetch_add(nChunk, std::memory_order_relaxed);
+                }
+                void *pResult = m_pNext;
+                m_pNext += nBytes;
+                m_nLeft -= nBytes;
+                return pResult;
+            }
+
+            /// @return Mutex serializing allocations and one-time materializations.
+            std::mutex &mutex() noexcept { return m_oMutex; }
+
+            /// @return Bytes obtained from the heap so far.
+            std::size_t reserved() const noexcept { return m_nReserved.load(std::memory_order_relaxed); }
+
+        private:
+            /// Size of the chunks taken from the heap
+            static constexpr std::size_t chunk_size = 64 * 1024;
+
+            std::mutex m_oMutex; ///< Protects the chunks
+            std::vector<std::unique_ptr<std::max_align_t[]> > m_aChunks; ///< Chunks taken from the heap
+            unsigned char *m_pNext = nullptr; ///< Next free byte of the current chunk
+            std::size_t m_nLeft = 0; ///< Free bytes in the current chunk
+            std::atomic<std::size_t> m_nReserved{0}; ///< Sum of the chunk sizes
+        };
+    }
+
+    class lazy_enc;
+    class interned;
+
+    template<CharacterType char_t>
+    void materialize(const lazy_enc *pBegin, const lazy_enc *pEnd,
+                     std::size_t nThreads = std::thread::hardware_concurrency());
+
+    /**
+     * @brief A literal stored in UTF-8 whose other encodings are built on first use.
+     *
+     * `visit` is thread safe. The first `visit` of an encoding transcodes
+     * the literal under the arena lock, exactly once; later visits are a
+     * single atomic load. `char` and `char8_t` views point to the stored
+     * literal, which must be valid UTF-8.
+     */
+    class lazy_enc {
+    public:
+        /**
+         * @brief Stores a UTF-8 literal.
+         * @param sText UTF-8 literal, with static storage duration.
+         */
+        constexpr lazy_enc(const basic_string_view<char8_t> sText) noexcept : m_sText(sText) {
+        }
+
+        lazy_enc(const lazy_enc &) = delete;
+
+        lazy_enc &operator=(const lazy_enc &) = delete;
+
+        /**
+         * @brief Views the literal in the encoding of a character type.
+         * @tparam char_t Character type.
+         * @return A null terminated view, valid until the process exits.
+         */
+        template<CharacterType char_t>
+        basic_string_view<char_t> visit() const {
+            if constexpr (sizeof(char_t) == 1) {
+                return {reinterpret_cast<const char_t *>(m_sText.data()), m_sText.size()};
+            } else {
+                const detail::lazy_form *pForm = m_aForms[form_index<char_t>()].load(std::memory_order_acquire);
+                if (pForm == nullptr) pForm = materialize_form<char_t>(detail::lazy_arena::instance());
+                return pForm->view<char_t>();
+            }
+        }
+
+        /**
+         * @brief Checks whether the form for a character type exists.
+         * @tparam char_t Character type.
+         * @return True if `visit<char_t>()` will not transcode.
+         */
+        template<CharacterType char_t>
+        bool is_materialized() const noexcept {
+            if constexpr (sizeof(char_t) == 1) return true;
+            else return m_aForms[form_index<char_t>()].load(std::memory_order_acquire) != nullptr;
+        }
+
+        /// @return The stored UTF-8 literal.
+        constexpr basic_string_view<char8_t> utf8() const noexcept { return m_sText; }
+
+        /**
+         * @brief Views the literal in every encoding, for functions taking a `poly_enc`.
+         * @return A `poly_enc` over the stored and materialized forms.
+         */
+        poly_enc to_poly_enc() const {
+            return poly_enc(visit<char>(), visit<wchar_t>(), visit<char8_t>(), visit<char16_t>(), visit<char32_t>());
+        }
+
+    private:
+        template<CharacterType char_t>
+        friend void materialize(const lazy_enc *pBegin, const lazy_enc *pEnd, std::size_t nThreads);
+
+        friend class interned;
+
+        /**
+         * @brief Views the literal, building a missing form in a given arena.
+         *
+         * Every visit of a literal must use the same arena.
+         *
+         * @tparam char_t Character type.
+         * @param oArena Arena of the forms, which must outlive the views.
+         * @return A null terminated view.
+         */
+        template<CharacterType char_t>
+        basic_string_view<char_t> visit_in(detail::lazy_arena &oArena) const {
+            if constexpr (sizeof(char_t) == 1) {
+                return visit<char_t>();
+            } else {
+                const detail::lazy_form *pForm = m_aForms[form_index<char_t>()].load(std::memory_order_acquire);
+                if (pForm == nullptr) pForm = materialize_form<char_t>(oArena);
+                return pForm->view<char_t>();
+            }
+        }
+
+        /**
+         * @brief Index of the form of a character type.
+         * @tparam char_t Character type, 2 or 4 bytes wide.
+         * @return 0 for UTF-16, 1 for UTF-32.
+         */
+        template<typename char_t>
+        static constexpr std::size_t form_index() noexcept { return sizeof(char_t) == 2 ? 0 : 1; }
+
+        /**
+         * @brief Code unit type stored for a character type.
+         * @tparam char_t Character type, 2 or 4 bytes wide.
+         */
+        template<typename char_t>
+        using form_unit = std::conditional_t<sizeof(char_t) == 2, char16_t, char32_t>;
+
+        /**
+         * @brief Transcodes the literal for a character type, once.
+         * @tparam char_t Character type, 2 or 4 bytes wide.
+         * @param oArena Arena of the form.
+         * @return The published form.
+         */
+        template<typename char_t>
+        const detail::lazy_form *materialize_form(detail::lazy_arena &oArena) const {
+            using unit_t = form_unit<char_t>;
+            std::atomic<const detail::lazy_form *> &oSlot = m_aForms[form_index<char_t>()];
+            std::lock_guard<std::mutex> oLock(oArena.mutex());
+            const detail::lazy_form *pForm = oSlot.load(std::memory_order_acquire);
+            if (pForm != nullptr) return pForm;
+            const std::size_t nLength = transcoded_length<unit_t>(m_sText);
+            pForm = detail::lazy_form::write<unit_t>(
+                oArena.allocate(detail::lazy_form::footprint<unit_t>(nLength)), m_sText, nLength);
+            oSlot.store(pForm, std::memory_order_release);
+            return pForm;
+        }
+
+        basic_string_view<char8_t> m_sText; ///< UTF-8 literal
+        mutable std::atomic<const detail::lazy_form *> m_aForms[2]{}; ///< UTF-16 and UTF-32 forms, null until built
+    };
+
+    /**
+     * @brief Builds the form of a character type for a table of literals ahead of time.
+     *
+     * The table is split between `nThreads` threads. Each one sizes its
+     * part, takes a single arena allocation for it and publishes every form
+     * it builds; literals visited meanwhile by other threads keep the form
+     * they published first.
+     *
+     * @tparam char_t Character type.
+     * @param pBegin First literal.
+     * @param pEnd Past the last literal.
+     * @param nThreads Number of threads, including the calling one.
+     */
+    template<CharacterType char_t>
+    void materialize(const lazy_enc *pBegin, const lazy_enc *pEnd, std::size_t nThreads) {
+        if constexpr (sizeof(char_t) != 1) {
+            using unit_t = lazy_enc::form_unit<char_t>;
+            constexpr std::size_t nForm = lazy_enc::form_index<char_t>();
+            const auto fnPart = [](const lazy_enc *pFirst, const lazy_enc *pLast) {
+                std::size_t nBytes = 0;
+                for (const lazy_enc *pText = pFirst; pText != pLast; ++pText) {
+                    if (!pText->is_materialized<char_t>()) {
+                        nBytes += detail::lazy_form::footprint<unit_t>(transcoded_length<unit_t>(pText->m_sText));
+                    }
+                }
+                if (nBytes == 0) return;
+                detail::lazy_arena &oArena = detail::lazy_arena::instance();
+                unsigned char *pOut;
+                {
+                    std::lock_guard<std::mutex> oLock(oArena.mutex());
+                    pOut = static_cast<unsigned char *>(oArena.allocate(nBytes));
+                }
+                for (const lazy_enc *pText = pFirst; pText != pLast; ++pText) {
+                    if (pText->is_materialized<char_t>()) continue;
+                    const std::size_t nLength = transcoded_length<unit_t>(pText->m_sText);
+                    const detail::lazy_form *pForm = detail::lazy_form::write<unit_t>(pOut, pText->m_sText, nLength);
+                    pOut += detail::lazy_form::footprint<unit_t>(nLength);
+                    const detail::lazy_form *pExpected = nullptr;
+                    pText->m_aForms[nForm].compare_exchange_strong(pExpected, pForm, std::memory_order_release,
+                                                                   std::memory_order_relaxed);
+                }
+            };
+
+            const std::size_t nCount = static_cast<std::size_t>(pEnd - pBegin);
+            nThreads = std::clamp<std::size_t>(nThreads, 1, std::max<std::size_t>(nCount, 1));
+            std::vector<std::thread> aThreads;
+            aThreads.reserve(nThreads - 1);
+            for (std::size_t i = 1; i < nThreads; ++i) {
+                aThreads.emplace_back(fnPart, pBegin + nCount * i / nThreads, pBegin + nCount * (i + 1) / nThreads);
+            }
+            fnPart(pBegin, pBegin + nCount / nThreads);
+            for (std::thread &oThread: aThreads) oThread.join();
+        }
+    }
+
+    /**
+     * @brief Builds the form of a character type for a table of literals ahead of time.
+     * @tparam char_t Character type.
+     * @tparam N Number of literals.
+     * @param aTexts Table of literals.
+     * @param nThreads Number of threads, including the calling one.
+     */
+    template<CharacterType char_t, std::size_t N>
+    void materialize(const lazy_enc (&aTexts)[N], const std::size_t nThreads = std::thread::hardware_concurrency()) {
+        utf42::materialize<char_t>(aTexts, aTexts + N, nThreads);
+    }
+
+    /**
+     * @brief Memory taken by the materialized forms of every `lazy_enc`.
+     * @return Bytes obtained from the heap by the arena.
+     */
+    inline std::size_t lazy_arena_size() noexcept { return detail::lazy_arena::instance().reserved(); }
+} // namespace utf42
+
+#endif //LIB_UTF_42_LAZY
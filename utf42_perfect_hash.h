@@ -0,0 +1,439 @@
+/**
+ * @file utf42_perfect_hash.h
+ * @brief Compile-time perfect hash tables keyed by `poly_enc` literals.
+ *
+ * `utf42::perfect_hash` is built by a `consteval` constructor from an
+ * array of `cons_poly_enc` literals. Since every key is available in every
+ * encoding, a table is built for each character type: a query given as a
+ * `basic_string_view<char_t>` is looked up in the table of `char_t` and
+ * compared with the key pre-encoded for `char_t`, so a lookup costs one
+ * hash and one comparison and the query is never transcoded.
+ *
+ * The tables use the "hash and displace" scheme: keys are spread into
+ * small buckets by their hash, and each bucket stores the pilot value
+ * that sends all of its keys to free slots.
+ *
+ * @note Requires C++20 or later.
+ *
+ * @copyright MIT License
+ *
+ * This file is part of utf42.
+ * Copyright (c) 2025 Dante Doménech Martínez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef LIB_UTF_42_PERFECT_HASH
+#define LIB_UTF_42_PERFECT_HASH
+
+#include "utf42.h"
+
+// C++ version requirements
+#if __cplusplus < 202002L
+#error "utf42_perfect_hash.h requires C++20 or later"
+#endif
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace utf42 {
+    namespace detail {
+        /// Number of character types, and so of tables per perfect hash
+        constexpr std::size_t character_types = 5;
+
+        /**
+         * @brief Index of the table of a character type.
+         * @tparam char_t Character type.
+         * @return Position of `char_t` among `char`, `wchar_t`, `char8_t`, `char16_t` and `char32_t`.
+         */
+        template<CharacterType char_t>
+        consteval std::size_t character_index() noexcept {
+            if constexpr (std::is_same_v<char_t, char>) return 0;
+            else if constexpr (std::is_same_v<char_t, wchar_t>) return 1;
+            else if constexpr (std::is_same_v<char_t, char8_t>) return 2;
+            else if constexpr (std::is_same_v<char_t, char16_t>) return 3;
+            else return 4;
+        }
+
+        /**
+         * @brief Finalizes a 64-bit hash (MurmurHash3 finalizer).
+         * @param nValue Value to mix.
+         * @return Mixed value.
+         */
+        constexpr std::uint64_t mix64(std::uint64_t nValue) noexcept {
+            nValue ^= nValue >> 33;
+            nValue *= 0xFF51AFD7ED558CCDull;
+            nValue ^= nValue >> 33;
+            nValue *= 0xC4CEB9FE1A85EC53ull;
+            nValue ^= nValue >> 33;
+            return nValue;
+        }
+
+        /**
+         * @brief Hashes a string, packing its code units into 64-bit words.
+         *
+         * Evaluates identically at compile time and at run time.
+         *
+         * @tparam char_t Character type.
+         * @param sText String to hash.
+         * @return 64-bit hash.
+         */
+        template<typename char_t>
+        constexpr std::uint64_t key_hash(const basic_string_view<char_t> sText) noexcept {
+            using unit_t = std::make_unsigned_t<char_t>;
+            constexpr std::size_t nPerWord = 8 / sizeof(char_t);
+            constexpr std::size_t nShift = 8 * sizeof(char_t) % 64;
+            std::uint64_t nHash = 0x9E3779B97F4A7C15ull ^ sText.size();
+            std::size_t i = 0;
+            for (; i + nPerWord <= sText.size(); i += nPerWord) {
+                std::uint64_t nWord = 0;
+                for (std::size_t j = 0; j < nPerWord; ++j) {
+                    nWord |= static_cast<std::uint64_t>(static_cast<unit_t>(sText[i + j])) << (j * nShift);
+                }
+                nHash = (nHash ^ nWord) * 0x9E3779B97F4A7C15ull;
+                nHash ^= nHash >> 32;
+            }
+            std::uint64_t nWord = 0;
+            for (std::size_t j = 0; i + j < sText.size(); ++j) {
+                nWord |= static_cast<std::uint64_t>(static_cast<unit_t>(sText[i + j])) << (j * nShift);
+            }
+            return mix64(nHash ^ nWord);
+        }
+
+        /**
+         * @brief Computes the slot of a key from its hash and the pilot of its bucket.
+         * @param nHash Hash of the key.
+         * @param nPilot Pilot of the bucket.
+         * @param nSlotBits Base two logarithm of the number of slots, from 1 to 63.
+         * @return Slot index.
+         */
+        constexpr std::size_t pilot_slot(const std::uint64_t nHash, const std::uint64_t nPilot,
+                                         const std::size_t nSlotBits) noexcept {
+            // Multiplying then keeping the high bits makes every bit of the hash count
+            return static_cast<std::size_t>(((nHash ^ (nPilot * 0xD6E8FEB86659FD93ull)) * 0x9E3779B97F4A7C15ull)
+                                            >> (64 - nSlotBits));
+        }
+
+        /// Pilots tried per bucket before giving up
+        constexpr std::uint32_t max_pilot = 1u << 16;
+
+        /// Outcome of `place_keys`
+        enum class placement {
+            placed, ///< Every key has a slot
+            duplicate, ///< Two keys are equal
+            collision, ///< Two different keys have the same hash
+            no_pilot ///< A bucket found no pilot
+        };
+
+        /**
+         * @brief Places hashed keys into slots with the hash and displace scheme.
+         *
+         * @tparam index_type Type of the slots.
+         * @tparam N Number of keys.
+         * @tparam B Number of buckets, a power of two.
+         * @tparam S Number of slots, a power of two.
+         * @tparam equal_t Callable telling whether the keys of two indices are equal.
+         * @param aHashes Hash of each key.
+         * @param aPilots Receives the pilot of each bucket.
+         * @param aSlots Receives the key index of each slot, initially all `nEmpty`.
+         * @param nEmpty Marker of an unused slot.
+         * @param fnEqual Compares two keys with the same hash.
+         * @return Whether the keys were placed, or why not.
+         */
+        template<typename index_type, std::size_t N, std::size_t B, std::size_t S, typename equal_t>
+        consteval placement place_keys(const std::array<std::uint64_t, N> &aHashes,
+                                       std::array<std::uint16_t, B> &aPilots, std::array<index_type, S> &aSlots,
+                                       const index_type nEmpty, equal_t &&fnEqual) {
+            constexpr std::size_t nBucketBits = static_cast<std::size_t>(std::countr_zero(B));
+            constexpr std::size_t nSlotBits = static_cast<std::size_t>(std::countr_zero(S));
+            std::array<std::size_t, N> aOrder{};
+            for (std::size_t i = 0; i < N; ++i) {
+                aOrder[i] = i;
+            }
+            // Largest buckets first, they are the hardest to place
+            std::array<std::size_t, B> aBucketSizes{};
+            for (std::size_t i = 0; i < N; ++i) {
+                ++aBucketSizes[aHashes[i] >> (64 - nBucketBits)];
+            }
+            std::sort(aOrder.begin(), aOrder.end(), [&](const std::size_t nLeft, const std::size_t nRight) {
+                const std::size_t nBucketLeft = aHashes[nLeft] >> (64 - nBucketBits);
+                const std::size_t nBucketRight = aHashes[nRight] >> (64 - nBucketBits);
+                if (aBucketSizes[nBucketLeft] != aBucketSizes[nBucketRight]) {
+                    return aBucketSizes[nBucketLeft] > aBucketSizes[nBucketRight];
+                }
+                return nBucketLeft < nBucketRight;
+            });
+
+            std::array<std::size_t, S> aTaken{};
+            std::size_t nAttempt = 0;
+            for (std::size_t nBegin = 0; nBegin < N;) {
+                const std::size_t nBucket = aHashes[aOrder[nBegin]] >> (64 - nBucketBits);
+                const std::size_t nEnd = nBegin + aBucketSizes[nBucket];
+                // Keys with equal hashes can not be separated by any pilot
+                for (std::size_t i = nBegin; i < nEnd; ++i) {
+                    for (std::size_t j = nBegin; j < i; ++j) {
+                        if (aHashes[aOrder[i]] != aHashes[aOrder[j]]) continue;
+                        return fnEqual(aOrder[i], aOrder[j]) ? placement::duplicate : placement::collision;
+                    }
+                }
+                std::uint32_t nPilot = 0;
+                for (;; ++nPilot) {
+                    if (nPilot == max_pilot) return placement::no_pilot;
+                    // Slots are stamped with the attempt to detect collisions within the bucket
+                    const std::size_t nStamp = ++nAttempt;
+                    bool bFree = true;
+                    for (std::size_t i = nBegin; i < nEnd && bFree; ++i) {
+                        const std::size_t nSlot = pilot_slot(aHashes[aOrder[i]], nPilot, nSlotBits);
+                        bFree = aSlots[nSlot] == nEmpty && aTaken[nSlot] != nStamp;
+                        aTaken[nSlot] = nStamp;
+                    }
+                    if (bFree) break;
+                }
+                aPilots[nBucket] = static_cast<std::uint16_t>(nPilot);
+                for (std::size_t i = nBegin; i < nEnd; ++i) {
+                    aSlots[pilot_slot(aHashes[aOrder[i]], nPilot, nSlotBits)] = static_cast<index_type>(aOrder[i]);
+                }
+                nBegin = nEnd;
+            }
+            return placement::placed;
+        }
+    }
+
+    /**
+     * @brief Compile-time perfect hash table of `poly_enc` keys.
+     *
+     * `find` returns the position of a key in the array given to the
+     * constructor, so values can be kept in a parallel array; see also
+     * `perfect_hash_map`.
+     *
+     * @tparam N Number of keys.
+     */
+    template<std::size_t N>
+    class perfect_hash {
+    public:
+        /// Returned by `find` for unknown keys.
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        /**
+         * @brief Builds the tables. Fails to compile if two keys are equal.
+         * @param aKeys Keys, usually `cons_poly_enc` literals.
+         */
+        consteval explicit perfect_hash(const poly_enc (&aKeys)[N]) : perfect_hash(std::to_array(aKeys)) {
+        }
+
+        /**
+         * @brief Builds the tables. Fails to compile if two keys are equal.
+         * @param aKeys Keys, usually `cons_poly_enc` literals.
+         */
+        consteval explicit perfect_hash(const std::array<poly_enc, N> &aKeys) : m_aKeys(aKeys), m_aTables{} {
+            build<char>();
+            build<wchar_t>();
+            build<char8_t>();
+            build<char16_t>();
+            build<char32_t>();
+        }
+
+        /**
+         * @brief Looks up a key.
+         * @tparam char_t Character type of the query.
+         * @param sKey Query, compared with the keys encoded for `char_t`.
+         * @return Index of the key in the constructor argument, `npos` if absent.
+         */
+        template<CharacterType char_t>
+        constexpr std::size_t find(const basic_string_view<char_t> sKey) const noexcept {
+            const table &oTable = m_aTables[detail::character_index<char_t>()];
+            const std::uint64_t nHash = detail::key_hash(sKey);
+            const std::size_t nSlot = detail::pilot_slot(nHash, oTable.aPilots[nHash >> (64 - bucket_bits)], slot_bits);
+            const index_type nIndex = oTable.aSlots[nSlot];
+            if (nIndex == empty_slot) return npos;
+            const basic_string_view<char_t> sCandidate = m_aKeys[nIndex].template visit<char_t>();
+            if (sCandidate.size() != sKey.size()) return npos;
+            if (std::is_constant_evaluated()) return sCandidate == sKey ? nIndex : npos;
+            return std::memcmp(sCandidate.data(), sKey.data(), sKey.size() * sizeof(char_t)) == 0 ? nIndex : npos;
+        }
+
+        /**
+         * @brief Checks whether a key is present.
+         * @tparam char_t Character type of the query.
+         * @param sKey Query.
+         * @return True if `sKey` is one of the keys.
+         */
+        template<CharacterType char_t>
+        constexpr bool contains(const basic_string_view<char_t> sKey) const noexcept {
+            return find(sKey) != npos;
+        }
+
+        /**
+         * @brief Accesses a key.
+         * @param nIndex Index of the key.
+         * @return The key.
+         */
+        constexpr const poly_enc &key(const std::size_t nIndex) const noexcept { return m_aKeys[nIndex]; }
+
+        /// @return Number of keys.
+        static constexpr std::size_t size() noexcept { return N; }
+
+    private:
+        /// Type of the slots, the smallest unsigned type holding every index and the empty marker
+        using index_type = std::conditional_t<(N < 0xFFFF), std::uint16_t, std::uint32_t>;
+
+        /// Marker of an unused slot
+        static constexpr index_type empty_slot = static_cast<index_type>(-1);
+
+        /// Base two logarithm of the number of slots, for a load factor between 0.4 and 0.8
+        static constexpr std::size_t slot_bits = std::max<std::size_t>(1, std::bit_width(N + N / 4));
+
+        /// Base two logarithm of the number of buckets, about two keys per bucket
+        static constexpr std::size_t bucket_bits = std::max<std::size_t>(1, std::bit_width(N / 2));
+
+        // The hash is shifted right by 64 minus these, which must stay below 64
+        static_assert(slot_bits >= 1 && slot_bits < 64 && bucket_bits >= 1 && bucket_bits < 64,
+                      "utf42::perfect_hash: unsupported number of keys");
+
+        /// Number of slots
+        static constexpr std::size_t slot_count = std::size_t(1) << slot_bits;
+
+        /// Number of buckets
+        static constexpr std::size_t bucket_count = std::size_t(1) << bucket_bits;
+
+        /**
+         * @brief Lookup table of one character type
+         */
+        struct table {
+            std::array<std::uint16_t, bucket_count> aPilots; ///< Pilot of each bucket
+            std::array<index_type, slot_count> aSlots; ///< Key index of each slot, `empty_slot` if unused
+        };
+
+        /**
+         * @brief Builds the table of a character type.
+         * @tparam char_t Character type.
+         */
+        template<CharacterType char_t>
+        consteval void build() {
+            table &oTable = m_aTables[detail::character_index<char_t>()];
+            oTable.aSlots.fill(empty_slot);
+            oTable.aPilots.fill(0);
+
+            std::array<std::uint64_t, N> aHashes{};
+            for (std::size_t i = 0; i < N; ++i) {
+                aHashes[i] = detail::key_hash(m_aKeys[i].template visit<char_t>());
+            }
+            const auto fnEqual = [&](const std::size_t nFirst, const std::size_t nSecond) {
+                return m_aKeys[nFirst].template visit<char_t>() == m_aKeys[nSecond].template visit<char_t>();
+            };
+            switch (detail::place_keys(aHashes, oTable.aPilots, oTable.aSlots, empty_slot, fnEqual)) {
+                case detail::placement::placed: break;
+                case detail::placement::duplicate: throw "utf42::perfect_hash: duplicate key";
+                case detail::placement::collision: throw "utf42::perfect_hash: hash collision";
+                case detail::placement::no_pilot: throw "utf42::perfect_hash: no pilot found";
+            }
+        }
+
+        std::array<poly_enc, N> m_aKeys; ///< Keys
+        std::array<table, detail::character_types> m_aTables; ///< One table per character type
+    };
+
+    /**
+     * @brief Key and value of a `perfect_hash_map`.
+     * @tparam value_t Type of the values.
+     */
+    template<typename value_t>
+    struct perfect_hash_entry {
+        poly_enc oKey; ///< Key, usually a `cons_poly_enc` literal
+        value_t oValue; ///< Associated value
+    };
+
+    /**
+     * @brief Compile-time perfect hash map from `poly_enc` keys to values.
+     *
+     * @tparam value_t Type of the values, must be a literal type.
+     * @tparam N Number of entries.
+     */
+    template<typename value_t, std::size_t N>
+    class perfect_hash_map {
+    public:
+        /**
+         * @brief Builds the map. Fails to compile if two keys are equal.
+         * @param aEntries Entries.
+         */
+        consteval explicit perfect_hash_map(const perfect_hash_entry<value_t> (&aEntries)[N])
+            : m_oKeys(keys_of(aEntries)), m_aValues(values_of(aEntries)) {
+        }
+
+        /**
+         * @brief Looks up a key.
+         * @tparam char_t Character type of the query.
+         * @param sKey Query.
+         * @return Pointer to the value, null if the key is absent.
+         */
+        template<CharacterType char_t>
+        constexpr const value_t *find(const basic_string_view<char_t> sKey) const noexcept {
+            const std::size_t nIndex = m_oKeys.find(sKey);
+            return nIndex == perfect_hash<N>::npos ? nullptr : &m_aValues[nIndex];
+        }
+
+        /**
+         * @brief Checks whether a key is present.
+         * @tparam char_t Character type of the query.
+         * @param sKey Query.
+         * @return True if `sKey` is one of the keys.
+         */
+        template<CharacterType char_t>
+        constexpr bool contains(const basic_string_view<char_t> sKey) const noexcept {
+            return m_oKeys.contains(sKey);
+        }
+
+        /// @return Number of entries.
+        static constexpr std::size_t size() noexcept { return N; }
+
+    private:
+        /**
+         * @brief Extracts the keys of the entries.
+         * @param aEntries Entries.
+         * @return Perfect hash of the keys.
+         */
+        static consteval perfect_hash<N> keys_of(const perfect_hash_entry<value_t> (&aEntries)[N]) {
+            return [&]<std::size_t... I>(std::index_sequence<I...>) consteval {
+                return perfect_hash<N>(std::array<poly_enc, N>{aEntries[I].oKey...});
+            }(std::make_index_sequence<N>());
+        }
+
+        /**
+         * @brief Extracts the values of the entries.
+         * @param aEntries Entries.
+         * @return Values in entry order.
+         */
+        static consteval std::array<value_t, N> values_of(const perfect_hash_entry<value_t> (&aEntries)[N]) {
+            std::array<value_t, N> aValues{};
+            for (std::size_t i = 0; i < N; ++i) {
+                aValues[i] = aEntries[i].oValue;
+            }
+            return aValues;
+        }
+
+        perfect_hash<N> m_oKeys; ///< Keys
+        std::array<value_t, N> m_aValues; ///< Values, parallel to the keys
+    };
+} // namespace utf42
+
+#endif //LIB_UTF_42_PERFECT_HASH
@@ -0,0 +1,272 @@
+/**
+ * @file utf42_pipeline.h
+ * @brief Multithreaded read/transcode/write pipeline for streams.
+ *
+ * Inputs that can not be memory-mapped (standard input, pipes, sockets)
+ * are processed by a pipeline of three stages connected by a fixed ring of
+ * buffers:
+ * - one reader thread fills free buffers from the source callback,
+ * - worker threads transcode filled buffers,
+ * - the calling thread hands transcoded buffers to the sink, in order.
+ *
+ * Memory is bounded by the ring: when the sink is slow, the reader blocks
+ * until a buffer is released (backpressure). Buffers are cut before any
+ * unfinished code point, which is carried over to the next buffer, so each
+ * buffer can be transcoded independently.
+ *
+ * @note Requires C++17 or later.
+ *
+ * @copyright MIT License
+ *
+ * This file is part of utf42.
+ * Copyright (c) 2025 Dante Doménech Martínez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef LIB_UTF_42_PIPELINE
+#define LIB_UTF_42_PIPELINE
+
+#include "utf42_transcode.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace utf42 {
+    /**
+     * @brief Sizing of a `transcode_pipeline`.
+     */
+    struct pipeline_options {
+        std::size_t nBufferSize = 64 * 1024; ///< Capacity of each input buffer in code units
+        std::size_t nBuffers = 4; ///< Number of buffers in the ring
+        std::size_t nWorkers = 1; ///< Number of transcoding threads
+    };
+
+    /**
+     * @brief Pipelined transcoder between a source and a sink callback.
+     *
+     * The source is called from the reader thread with a buffer to fill and
+     * returns the number of code units written, 0 at the end of the input.
+     * The sink is called from the thread running `run`, once per buffer read,
+     * in input order. The chunks passed to the sink may be empty and are only
+     * valid during the call.
+     *
+     * An exception thrown by either callback stops the pipeline and is
+     * rethrown by `run`.
+     *
+     * @tparam to_t Destination character type.
+     * @tparam from_t Source character type.
+     */
+    template<typename to_t, typename from_t>
+    class transcode_pipeline {
+    public:
+        /// Source callback: fills up to `nCapacity` units and returns the count, 0 at the end.
+        using source_type = std::function<std::size_t(from_t *pBuffer, std::size_t nCapacity)>;
+        /// Sink callback: consumes one transcoded chunk.
+        using sink_type = std::function<void(basic_string_view<to_t> sChunk)>;
+
+        /**
+         * @brief Constructs a pipeline and allocates its ring of buffers.
+         *
+         * @param fnSource Source callback.
+         * @param fnSink Sink callback.
+         * @param oOptions Sizing of the pipeline.
+         */
+        transcode_pipeline(source_type fnSource, sink_type fnSink, const pipeline_options &oOptions = {})
+            : m_fnSource(std::move(fnSource)),
+              m_fnSink(std::move(fnSink)),
+              m_oOptions(oOptions),
+              m_aSlots(oOptions.nBuffers != 0 ? oOptions.nBuffers : 1) {
+            if (m_oOptions.nBufferSize == 0) m_oOptions.nBufferSize = 1;
+            if (m_oOptions.nWorkers == 0) m_oOptions.nWorkers = 1;
+            for (slot &oSlot: m_aSlots) {
+                oSlot.aInput.resize(m_oOptions.nBufferSize + max_carry);
+                oSlot.aOutput.resize(max_transcoded_length<to_t, from_t>(m_oOptions.nBufferSize + max_carry));
+            }
+        }
+
+        transcode_pipeline(const transcode_pipeline &) = delete;
+
+        transcode_pipeline &operator=(const transcode_pipeline &) = delete;
+
+        /**
+         * @brief Runs the pipeline until the source is exhausted and the sink has drained.
+         *
+         * Must be called at most once.
+         */
+        void run() {
+            std::thread oReader(&transcode_pipeline::read_loop, this);
+            std::vector<std::thread> aWorkers;
+            aWorkers.reserve(m_oOptions.nWorkers);
+            for (std::size_t i = 0; i < m_oOptions.nWorkers; ++i) {
+                aWorkers.emplace_back(&transcode_pipeline::work_loop, this);
+            }
+            write_loop();
+            oReader.join();
+            for (std::thread &oWorker: aWorkers) {
+                oWorker.join();
+            }
+            if (m_pError) std::rethrow_exception(m_pError);
+        }
+
+    private:
+        /// Maximum number of units carried from one buffer to the next
+        static constexpr std::size_t max_carry = stream_transcoder<to_t, from_t>::max_pending;
+
+        /**
+         * @brief Life cycle of a buffer of the ring
+         */
+        enum class slot_state {
+            free, ///< Owned by the reader
+            filled, ///< Waiting for or owned by a worker
+            transcoded, ///< Waiting for the writer
+        };
+
+        /**
+         * @brief Buffer of the ring
+         */
+        struct slot {
+            std::vector<from_t> aInput; ///< Input code units
+            std::vector<to_t> aOutput; ///< Output code units
+            std::size_t nInput = 0; ///< Number of input units
+            std::size_t nOutput = 0; ///< Number of output units
+            slot_state eState = slot_state::free; ///< Current stage
+        };
+
+        /**
+         * @brief Stops every stage after a callback failure
+         */
+        void fail() {
+            std::lock_guard<std::mutex> oLock(m_oMutex);
+            if (!m_pError) m_pError = std::current_exception();
+            m_bStop = true;
+            m_oFree.notify_all();
+            m_oFilled.notify_all();
+            m_oTranscoded.notify_all();
+        }
+
+        /**
+         * @brief Reader stage: fills buffers from the source
+         */
+        void read_loop() {
+            try {
+                from_t aCarry[max_carry] = {};
+                std::size_t nCarry = 0;
+                for (std::size_t nSequence = 0;; ++nSequence) {
+                    slot &oSlot = m_aSlots[nSequence % m_aSlots.size()];
+                    {
+                        std::unique_lock<std::mutex> oLock(m_oMutex);
+                        m_oFree.wait(oLock, [&] { return m_bStop || oSlot.eState == slot_state::free; });
+                        if (m_bStop) return;
+                    }
+                    std::copy(aCarry, aCarry + nCarry, oSlot.aInput.begin());
+                    const std::size_t nRead = m_fnSource(oSlot.aInput.data() + nCarry, m_oOptions.nBufferSize);
+                    const std::size_t nTotal = nCarry + nRead;
+                    const std::size_t nKeep =
+                            nRead == 0 ? 0 : incomplete_suffix(basic_string_view<from_t>(oSlot.aInput.data(), nTotal));
+                    std::copy(oSlot.aInput.begin() + (nTotal - nKeep), oSlot.aInput.begin() + nTotal, aCarry);
+                    nCarry = nKeep;
+                    oSlot.nInput = nTotal - nKeep;
+
+                    std::lock_guard<std::mutex> oLock(m_oMutex);
+                    if (nTotal != 0) {
+                        oSlot.eState = slot_state::filled;
+                        m_nFilled = nSequence + 1;
+                        m_oFilled.notify_one();
+                    }
+                    if (nRead == 0) {
+                        m_bEnd = true;
+                        m_oFilled.notify_all();
+                        m_oTranscoded.notify_all();
+                        return;
+                    }
+                }
+            } catch (...) {
+                fail();
+            }
+        }
+
+        /**
+         * @brief Worker stage: transcodes filled buffers
+         */
+        void work_loop() {
+            for (;;) {
+                std::size_t nSequence = 0;
+                {
+                    std::unique_lock<std::mutex> oLock(m_oMutex);
+                    m_oFilled.wait(oLock, [&] { return m_bStop || m_bEnd || m_nClaimed < m_nFilled; });
+                    if (m_bStop || m_nClaimed == m_nFilled) return;
+                    nSequence = m_nClaimed++;
+                }
+                slot &oSlot = m_aSlots[nSequence % m_aSlots.size()];
+                oSlot.nOutput = transcode_into(basic_string_view<from_t>(oSlot.aInput.data(), oSlot.nInput),
+                                               oSlot.aOutput.data());
+                std::lock_guard<std::mutex> oLock(m_oMutex);
+                oSlot.eState = slot_state::transcoded;
+                m_oTranscoded.notify_all();
+            }
+        }
+
+        /**
+         * @brief Writer stage: hands transcoded buffers to the sink in order
+         */
+        void write_loop() {
+            for (std::size_t nSequence = 0;; ++nSequence) {
+                slot &oSlot = m_aSlots[nSequence % m_aSlots.size()];
+                {
+                    std::unique_lock<std::mutex> oLock(m_oMutex);
+                    m_oTranscoded.wait(oLock, [&] {
+                        return m_bStop || oSlot.eState == slot_state::transcoded || (m_bEnd && nSequence >= m_nFilled);
+                    });
+                    if (m_bStop || oSlot.eState != slot_state::transcoded) return;
+                }
+                try {
+                    m_fnSink(basic_string_view<to_t>(oSlot.aOutput.data(), oSlot.nOutput));
+                } catch (...) {
+                    fail();
+                    return;
+                }
+                std::lock_guard<std::mutex> oLock(m_oMutex);
+                oSlot.eState = slot_state::free;
+                m_oFree.notify_one();
+            }
+        }
+
+        source_type m_fnSource; ///< Source callback
+        sink_type m_fnSink; ///< Sink callback
+        pipeline_options m_oOptions; ///< Sizing
+        std::vector<slot> m_aSlots; ///< Ring of buffers
+
+        std::mutex m_oMutex; ///< Protects the slot states and counters
+        std::condition_variable m_oFree; ///< Signaled when a slot is released
+        std::condition_variable m_oFilled; ///< Signaled when a slot is filled
+        std::condition_variable m_oTranscoded; ///< Signaled when a slot is transcoded
+        std::size_t m_nFilled = 0; ///< Number of slots filled so far
+        std::size_t m_nClaimed = 0; ///< Number of slots claimed by workers so far
+        bool m_bEnd = false; ///< The source is exhausted
+        bool m_bStop = false; ///< A callback failed
+        std::exception_ptr m_pError; ///< First callback failure
+    };
+} // namespace utf42
+
+#endif //LIB_UTF_42_PIPELINE
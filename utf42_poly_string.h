@@ -0,0 +1,390 @@
+/**
+ * @file utf42_poly_string.h
+ * @brief Owning runtime string available in every encoding.
+ *
+ * `utf42::poly_string` is the runtime counterpart of `utf42::poly_enc`: it
+ * owns a copy of a string in its original encoding and produces the other
+ * encodings on demand. The first `visit<char_t>()` of an encoding transcodes
+ * the original and caches the result, later visits return the cached view.
+ *
+ * All the representations materialized so far live in a single heap block.
+ * Character types sharing an encoding share a representation (`char` and
+ * `char8_t`, and `wchar_t` with `char16_t` or `char32_t`), so there are at
+ * most three of them.
+ *
+ * A `poly_string` may be shared between threads without synchronization:
+ * a new representation is published by a compare-and-swap on the block
+ * pointer, so concurrent `visit` calls never block.
+ *
+ * @note Requires C++17 or later.
+ *
+ * @copyright MIT License
+ *
+ * This file is part of utf42.
+ * Copyright (c) 2025 Dante Doménech Martínez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef LIB_UTF_42_POLY_STRING
+#define LIB_UTF_42_POLY_STRING
+
+#include "utf42_transcode.h"
+
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace utf42 {
+    namespace detail {
+        /**
+         * @brief Code unit type used to store a representation.
+         * @tparam eEncoding Encoding of the representation.
+         */
+        template<encoding eEncoding>
+        struct storage_unit;
+
+        /// UTF-8 is stored as `char`
+        template<>
+        struct storage_unit<encoding::utf8> {
+            using type = char;
+        };
+
+        /// UTF-16 is stored as `char16_t`
+        template<>
+        struct storage_unit<encoding::utf16> {
+            using type = char16_t;
+        };
+
+        /// UTF-32 is stored as `char32_t`
+        template<>
+        struct storage_unit<encoding::utf32> {
+            using type = char32_t;
+        };
+
+        /**
+         * @brief Index of the representation of an encoding in a block.
+         * @param eEncoding Encoding.
+         * @return 0 for UTF-8, 1 for UTF-16 and 2 for UTF-32.
+         */
+        constexpr std::size_t encoding_slot(const encoding eEncoding) noexcept {
+            return eEncoding == encoding::utf8 ? 0 : eEncoding == encoding::utf16 ? 1 : 2;
+        }
+
+        /// Number of representations of a `poly_string`
+        constexpr std::size_t encoding_slots = 3;
+
+        /// Null code unit viewed by empty strings
+        template<typename char_t>
+        inline constexpr char_t null_unit = 0;
+
+        /**
+         * @brief Heap block holding the representations of a `poly_string`.
+         *
+         * The representations follow this header, widest code unit first so
+         * that each one is aligned, and are null terminated. A block replaced
+         * by a larger one is kept alive through `pPrevious`, since views into
+         * it may still be in use.
+         */
+        struct poly_string_block {
+            poly_string_block *pPrevious; ///< Superseded block, freed with this one
+            std::size_t nSize; ///< Size of the block in bytes
+            std::size_t aOffset[encoding_slots]; ///< Byte offset of each representation, 0 if absent
+            std::size_t aLength[encoding_slots]; ///< Length of each representation in code units
+
+            /**
+             * @brief Views a representation.
+             * @tparam char_t Character type of the representation.
+             * @param nSlot Index of the representation.
+             * @return View of the representation, excluding the terminator.
+             */
+            template<typename char_t>
+            basic_string_view<char_t> view(const std::size_t nSlot) const noexcept {
+                const auto *pBase = reinterpret_cast<const unsigned char *>(this);
+                return {reinterpret_cast<const char_t *>(pBase + aOffset[nSlot]), aLength[nSlot]};
+            }
+
+            /**
+             * @brief Allocates a block with every representation of another one and a new one.
+             *
+             * @tparam fill_t Callable writing the new representation.
+             * @param pFrom Block whose representations are copied, may be null.
+             * @param nSlot Index of the new representation.
+             * @param nLength Length of the new representation in code units.
+             * @param fnFill Called with the destination of the new representation.
+             * @return The new block, with `pPrevious` set to `pFrom`.
+             */
+            template<typename fill_t>
+            static poly_string_block *extend(poly_string_block *pFrom, const std::size_t nSlot,
+                                             const std::size_t nLength, fill_t &&fnFill) {
+                poly_string_block oHeader{pFrom, sizeof(poly_string_block), {}, {}};
+                for (std::size_t i = encoding_slots; i-- > 0;) {
+                    if (i == nSlot) {
+                        oHeader.aLength[i] = nLength;
+                    } else if (pFrom != nullptr && pFrom->aOffset[i] != 0) {
+                        oHeader.aLength[i] = pFrom->aLength[i];
+                    } else {
+                        continue;
+                    }
+                    oHeader.aOffset[i] = oHeader.nSize;
+                    oHeader.nSize += (oHeader.aLength[i] + 1) << i;
+                }
+
+                auto *pBase = static_cast<unsigned char *>(::operator new(oHeader.nSize));
+                auto *pBlock = new(pBase) poly_string_block(oHeader);
+                for (std::size_t i = 0; i < encoding_slots; ++i) {
+                    if (i == nSlot || pBlock->aOffset[i] == 0) continue;
+                    std::memcpy(pBase + pBlock->aOffset[i],
+                                reinterpret_cast<const unsigned char *>(pFrom) + pFrom->aOffset[i],
+                                (pBlock->aLength[i] + 1) << i);
+                }
+                std::forward<fill_t>(fnFill)(pBase + pBlock->aOffset[nSlot]);
+                std::memset(pBase + pBlock->aOffset[nSlot] + (nLength << nSlot), 0, std::size_t(1) << nSlot);
+                return pBlock;
+            }
+
+            /**
+             * @brief Frees a block and every block it superseded.
+             * @param pBlock Block to free, may be null.
+             */
+            static void release(poly_string_block *pBlock) noexcept {
+                while (pBlock != nullptr) {
+                    poly_string_block *pPrevious = pBlock->pPrevious;
+                    ::operator delete(pBlock);
+                    pBlock = pPrevious;
+                }
+            }
+        };
+    }
+
+    /**
+     * @brief Owning string with lazily cached representations in every encoding.
+     *
+     * The original string is kept as given. Other representations are
+     * produced by `transcode_into`, so ill-formed sequences in the original
+     * appear as U+FFFD in them.
+     *
+     * Views returned by `visit` are null terminated and remain valid until
+     * the `poly_string` is destroyed or assigned to.
+     *
+     * The const member functions are thread safe and lock free. Threads
+     * racing to materialize the same encoding each build a new block; one
+     * of them publishes its block and the others free their copy and use
+     * the published one.
+     */
+    class poly_string {
+    public:
+        /// Constructs an empty string.
+        poly_string() noexcept = default;
+
+        /**
+         * @brief Constructs a string by copying a view.
+         *
+         * @tparam char_t Character type of the original.
+         * @param sText Original string, its encoding is deduced from `char_t`.
+         */
+#if __cplusplus >= 202002L
+        template<CharacterType char_t>
+#else
+        template<typename char_t>
+#endif
+        explicit poly_string(const basic_string_view<char_t> sText)
+            : m_eSource(encoding_of_v<char_t>) {
+            if (sText.empty()) return;
+            m_pBlock.store(detail::poly_string_block::extend(nullptr, detail::encoding_slot(m_eSource), sText.size(),
+                                                             [&](unsigned char *pOut) {
+                                                                 std::memcpy(pOut, sText.data(),
+                                                                             sText.size() * sizeof(char_t));
+                                                             }), std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Constructs a string by copying a null terminated string.
+         *
+         * @tparam char_t Character type of the original.
+         * @param pText Original string, its encoding is deduced from `char_t`.
+         */
+#if __cplusplus >= 202002L
+        template<CharacterType char_t>
+#else
+        template<typename char_t>
+#endif
+        explicit poly_string(const char_t *pText)
+            : poly_string(basic_string_view<char_t>(pText)) {
+        }
+
+        /**
+         * @brief Copies a string with the representations materialized so far.
+         * @param oOther String to copy.
+         */
+        poly_string(const poly_string &oOther)
+            : m_eSource(oOther.m_eSource) {
+            const detail::poly_string_block *pFrom = oOther.m_pBlock.load(std::memory_order_acquire);
+            if (pFrom == nullptr) return;
+            void *pBase = ::operator new(pFrom->nSize);
+            std::memcpy(pBase, pFrom, pFrom->nSize);
+            auto *pBlock = static_cast<detail::poly_string_block *>(pBase);
+            pBlock->pPrevious = nullptr;
+            m_pBlock.store(pBlock, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Takes ownership of another string.
+         * @param oOther String to move from, left empty.
+         */
+        poly_string(poly_string &&oOther) noexcept
+            : m_eSource(oOther.m_eSource),
+              m_pBlock(oOther.m_pBlock.exchange(nullptr, std::memory_order_acq_rel)) {
+        }
+
+        /**
+         * @brief Replaces the contents with those of another string.
+         * @param oOther String to copy or move from.
+         * @return This string.
+         */
+        poly_string &operator=(poly_string oOther) noexcept {
+            swap(oOther);
+            return *this;
+        }
+
+        /// Frees the representations.
+        ~poly_string() {
+            detail::poly_string_block::release(m_pBlock.load(std::memory_order_acquire));
+        }
+
+        /**
+         * @brief Exchanges the contents of two strings.
+         *
+         * Not thread safe: neither string may be in use by another thread.
+         *
+         * @param oOther String to exchange with.
+         */
+        void swap(poly_string &oOther) noexcept {
+            std::swap(m_eSource, oOther.m_eSource);
+            detail::poly_string_block *pBlock = m_pBlock.load(std::memory_order_acquire);
+            m_pBlock.store(oOther.m_pBlock.load(std::memory_order_acquire), std::memory_order_release);
+            oOther.m_pBlock.store(pBlock, std::memory_order_release);
+        }
+
+        /**
+         * @brief Returns the representation for a given character type.
+         *
+         * The first call for an encoding transcodes the original, which
+         * allocates a new block holding every representation. Never blocks.
+         *
+         * @tparam char_t Desired character type.
+         * @return A null terminated view of the string in the encoding of `char_t`.
+         */
+#if __cplusplus >= 202002L
+        template<CharacterType char_t>
+#else
+        template<typename char_t>
+#endif
+        basic_string_view<char_t> visit() const {
+            constexpr std::size_t nSlot = detail::encoding_slot(encoding_of_v<char_t>);
+            const detail::poly_string_block *pBlock = m_pBlock.load(std::memory_order_acquire);
+            if (pBlock == nullptr) return {&detail::null_unit<char_t>, 0};
+            if (pBlock->aOffset[nSlot] == 0) pBlock = materialize<encoding_of_v<char_t> >();
+            return pBlock->view<char_t>(nSlot);
+        }
+
+        /**
+         * @brief Checks whether the representation for a character type is cached.
+         * @tparam char_t Character type.
+         * @return True if `visit<char_t>()` will not transcode.
+         */
+#if __cplusplus >= 202002L
+        template<CharacterType char_t>
+#else
+        template<typename char_t>
+#endif
+        bool is_materialized() const noexcept {
+            const detail::poly_string_block *pBlock = m_pBlock.load(std::memory_order_acquire);
+            return pBlock == nullptr || pBlock->aOffset[detail::encoding_slot(encoding_of_v<char_t>)] != 0;
+        }
+
+        /// @return The encoding of the original string.
+        encoding source_encoding() const noexcept { return m_eSource; }
+
+        /// @return True if the string is empty.
+        bool empty() const noexcept { return m_pBlock.load(std::memory_order_acquire) == nullptr; }
+
+    private:
+        /**
+         * @brief Transcodes the original into a new representation.
+         * @tparam eTarget Encoding of the new representation.
+         * @return A published block holding the new representation.
+         */
+        template<encoding eTarget>
+        const detail::poly_string_block *materialize() const {
+            switch (m_eSource) {
+                case encoding::utf8:
+                    return materialize_from<eTarget, encoding::utf8>();
+                case encoding::utf16:
+                    return materialize_from<eTarget, encoding::utf16>();
+                default:
+                    return materialize_from<eTarget, encoding::utf32>();
+            }
+        }
+
+        /**
+         * @brief Transcodes the original into a new representation.
+         * @tparam eTarget Encoding of the new representation.
+         * @tparam eSource Encoding of the original.
+         * @return A published block holding the new representation.
+         */
+        template<encoding eTarget, encoding eSource>
+        const detail::poly_string_block *materialize_from() const {
+            using to_t = typename detail::storage_unit<eTarget>::type;
+            using from_t = typename detail::storage_unit<eSource>::type;
+            constexpr std::size_t nSlot = detail::encoding_slot(eTarget);
+            detail::poly_string_block *pBlock = m_pBlock.load(std::memory_order_acquire);
+            // Blocks are only freed with the string, so the original stays readable while racing
+            const basic_string_view<from_t> sSource = pBlock->view<from_t>(detail::encoding_slot(eSource));
+            const std::size_t nLength = transcoded_length<to_t>(sSource);
+            for (;;) {
+                detail::poly_string_block *pNew = detail::poly_string_block::extend(
+                    pBlock, nSlot, nLength, [&](unsigned char *pOut) {
+                        transcode_into(sSource, reinterpret_cast<to_t *>(pOut));
+                    });
+                if (m_pBlock.compare_exchange_strong(pBlock, pNew, std::memory_order_acq_rel,
+                                                     std::memory_order_acquire)) {
+                    return pNew;
+                }
+                // Another thread published first: drop the copy and retry only if it lacks our encoding
+                ::operator delete(pNew);
+                if (pBlock->aOffset[nSlot] != 0) return pBlock;
+            }
+        }
+
+        encoding m_eSource = encoding::utf8; ///< Encoding of the original string
+        mutable std::atomic<detail::poly_string_block *> m_pBlock{nullptr}; ///< Newest block, null if empty
+    };
+
+    /**
+     * @brief Exchanges the contents of two strings.
+     * @param oLeft First string.
+     * @param oRight Second string.
+     */
+    inline void swap(poly_string &oLeft, poly_string &oRight) noexcept {
+        oLeft.swap(oRight);
+    }
+} // namespace utf42
+
+#endif //LIB_UTF_42_POLY_STRING
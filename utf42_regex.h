@@ -0,0 +1,814 @@
+/**
+ * @file utf42_regex.h
+ * @brief Compile-time regular expressions matched over any character type.
+ *
+ * `utf42::regex` is parameterized by a `poly_enc` literal holding the
+ * pattern. The pattern is parsed from its UTF-32 form by a `consteval`
+ * compiler into a fixed-size program; matching decodes the text, whatever
+ * its character type, one code point at a time and runs the program as a
+ * Pike virtual machine over thread lists sized at compile time. Matching
+ * therefore parses nothing, allocates nothing, and takes time linear in the
+ * length of the text.
+ *
+ * Supported syntax, with ECMAScript meaning:
+ * - literal code points, `.` (any code point but line feed), `^`, `$`;
+ * - escapes `\\d \\D \\w \\W \\s \\S \\b \\B \\n \\r \\t \\f \\v \\0` and escaped punctuation;
+ * - sets `[...]` and `[^...]` with ranges and the `\\d \\w \\s` classes;
+ * - groups `(...)` and `(?:...)`, which do not capture, and alternation `|`;
+ * - quantifiers `* + ? {n} {n,} {n,m}`, greedy or lazy (`?` suffix).
+ *
+ * The classes `\\d`, `\\w` and `\\s` are ASCII only. Ill-formed input
+ * decodes to U+FFFD.
+ *
+ * @note Requires C++20 or later.
+ *
+ * @copyright MIT License
+ *
+ * This file is part of utf42.
+ * Copyright (c) 2025 Dante Doménech Martínez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef LIB_UTF_42_REGEX
+#define LIB_UTF_42_REGEX
+
+#include "utf42.h"
+#include "utf42_transcode.h"
+
+// C++ version requirements
+#if __cplusplus < 202002L
+#error "utf42_regex.h requires C++20 or later"
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace utf42 {
+    /**
+     * @brief Span of text matched by a `regex`.
+     */
+    struct regex_match {
+        std::size_t nPosition; ///< Offset of the first code unit of the match
+        std::size_t nLength; ///< Length of the match in code units
+
+        /// @return Offset one past the last code unit of the match.
+        constexpr std::size_t end() const noexcept { return nPosition + nLength; }
+    };
+
+    namespace detail {
+        /// Largest count accepted in a `{n,m}` quantifier
+        constexpr std::size_t regex_max_repeat = 1000;
+
+        /// Upper bound of a `{n,}`, `*` or `+` quantifier
+        constexpr std::size_t regex_unbounded = static_cast<std::size_t>(-1);
+
+        /// Code point before the start and after the end of the text
+        constexpr char32_t regex_no_code_point = 0xFFFFFFFF;
+
+        /**
+         * @brief Operations of a regex program.
+         */
+        enum class regex_opcode : std::uint8_t {
+            code_point, ///< Consumes `nFirst`
+            any, ///< Consumes any code point but line feed
+            set, ///< Consumes a code point within (or, if negated, outside) `nSecond` ranges from `nFirst`
+            split, ///< Continues at `nFirst`, then with lower priority at `nSecond`
+            jump, ///< Continues at `nFirst`
+            text_begin, ///< Asserts the start of the text
+            text_end, ///< Asserts the end of the text
+            word_boundary, ///< Asserts a `\b` boundary
+            not_word_boundary, ///< Asserts the absence of a `\b` boundary
+            match ///< Reports a match
+        };
+
+        /**
+         * @brief Instruction of a regex program.
+         */
+        struct regex_instruction {
+            regex_opcode eOpcode; ///< Operation
+            bool bNegated; ///< Negates a `set`
+            std::uint32_t nFirst; ///< Code point, first range or first target
+            std::uint32_t nSecond; ///< Number of ranges or second target
+        };
+
+        /**
+         * @brief Inclusive range of code points of a set.
+         */
+        struct regex_range {
+            char32_t nLow; ///< First code point
+            char32_t nHigh; ///< Last code point
+        };
+
+        /**
+         * @brief Kinds of nodes of a parsed pattern.
+         */
+        enum class regex_node_kind : std::uint8_t {
+            empty, code_point, any, set, text_begin, text_end, word_boundary, not_word_boundary,
+            concatenation, alternation, repetition
+        };
+
+        /**
+         * @brief Node of a parsed pattern.
+         */
+        struct regex_node {
+            regex_node_kind eKind; ///< Kind of node
+            char32_t nCode; ///< Code point of a `code_point` node
+            bool bFlag; ///< Negated set, or greedy repetition
+            std::size_t nFirst; ///< First range of a set, or first child in `aChildren`
+            std::size_t nCount; ///< Number of ranges or children
+            std::size_t nMin; ///< Minimum count of a repetition
+            std::size_t nMax; ///< Maximum count of a repetition, `regex_unbounded` if none
+        };
+
+        /**
+         * @brief Checks whether a code point belongs to `\w`.
+         * @param nCode Code point.
+         * @return True for ASCII letters, digits and underscore.
+         */
+        constexpr bool is_regex_word(const char32_t nCode) noexcept {
+            return (nCode >= U'a' && nCode <= U'z') || (nCode >= U'A' && nCode <= U'Z') ||
+                   (nCode >= U'0' && nCode <= U'9') || nCode == U'_';
+        }
+
+        /**
+         * @brief Parses a pattern and generates its program.
+         *
+         * Only used during constant evaluation. Syntax errors stop the
+         * compilation through a `throw`.
+         */
+        struct regex_compiler {
+            std::u32string_view sPattern; ///< Pattern
+            std::size_t nAt = 0; ///< Parsing position
+            std::vector<regex_node> aNodes; ///< Parsed nodes
+            std::vector<std::size_t> aChildren; ///< Children lists of the nodes
+            std::vector<regex_range> aRanges; ///< Ranges of the sets
+            std::vector<regex_instruction> aProgram; ///< Generated program
+
+            /**
+             * @brief Compiles a pattern.
+             * @param sSource Pattern, as UTF-32.
+             */
+            consteval explicit regex_compiler(const std::u32string_view sSource) : sPattern(sSource) {
+                const std::size_t nRoot = parse_alternation();
+                if (nAt != sPattern.size()) throw "utf42::regex: unmatched ')'";
+                generate(nRoot);
+                emit(regex_opcode::match);
+            }
+
+            /// @return True if the whole pattern was read.
+            consteval bool at_end() const noexcept { return nAt == sPattern.size(); }
+
+            /// @return Next code point of the pattern, which must exist.
+            consteval char32_t peek() const {
+                if (at_end()) throw "utf42::regex: unexpected end of pattern";
+                return sPattern[nAt];
+            }
+
+            /**
+             * @brief Consumes a code point if it is the expected one.
+             * @param nCode Expected code point.
+             * @return True if it was consumed.
+             */
+            consteval bool accept(const char32_t nCode) noexcept {
+                if (at_end() || sPattern[nAt] != nCode) return false;
+                ++nAt;
+                return true;
+            }
+
+            /**
+             * @brief Appends a node.
+             * @param oNode Node.
+             * @return Index of the node.
+             */
+            consteval std::size_t add_node(const regex_node &oNode) {
+                aNodes.push_back(oNode);
+                return aNodes.size() - 1;
+            }
+
+            /**
+             * @brief Appends a node with children, or returns the only child.
+             * @param eKind Kind of node.
+             * @param aItems Children.
+             * @return Index of the node.
+             */
+            consteval std::size_t add_list(const regex_node_kind eKind, const std::vector<std::size_t> &aItems) {
+                if (aItems.empty()) return add_node({regex_node_kind::empty, 0, false, 0, 0, 0, 0});
+                if (aItems.size() == 1) return aItems.front();
+                const std::size_t nFirst = aChildren.size();
+                aChildren.insert(aChildren.end(), aItems.begin(), aItems.end());
+                return add_node({eKind, 0, false, nFirst, aItems.size(), 0, 0});
+            }
+
+            /// @return Node of `a|b|...`.
+            consteval std::size_t parse_alternation() {
+                std::vector<std::size_t> aBranches{parse_concatenation()};
+                while (accept(U'|')) {
+                    aBranches.push_back(parse_concatenation());
+                }
+                return add_list(regex_node_kind::alternation, aBranches);
+            }
+
+            /// @return Node of a sequence of quantified atoms.
+            consteval std::size_t parse_concatenation() {
+                std::vector<std::size_t> aItems;
+                while (!at_end() && sPattern[nAt] != U'|' && sPattern[nAt] != U')') {
+                    aItems.push_back(parse_repetition());
+                }
+                return add_list(regex_node_kind::concatenation, aItems);
+            }
+
+            /// @return Value of the decimal number at the parsing position.
+            consteval std::size_t parse_number() {
+                if (at_end() || sPattern[nAt] < U'0' || sPattern[nAt] > U'9') throw "utf42::regex: expected a number";
+                std::size_t nValue = 0;
+                while (!at_end() && sPattern[nAt] >= U'0' && sPattern[nAt] <= U'9') {
+                    nValue = nValue * 10 + (sPattern[nAt++] - U'0');
+                    if (nValue > regex_max_repeat) throw "utf42::regex: repetition count too large";
+                }
+                return nValue;
+            }
+
+            /// @return Node of an atom followed by its quantifiers.
+            consteval std::size_t parse_repetition() {
+                std::size_t nNode = parse_atom();
+                while (!at_end()) {
+                    std::size_t nMin = 0, nMax = regex_unbounded;
+                    if (accept(U'*')) {
+                    } else if (accept(U'+')) {
+                        nMin = 1;
+                    } else if (accept(U'?')) {
+                        nMax = 1;
+                    } else if (accept(U'{')) {
+                        nMin = parse_number();
+                        nMax = nMin;
+                        if (accept(U',')) nMax = at_end() || sPattern[nAt] != U'}' ? parse_number() : regex_unbounded;
+                        if (!accept(U'}')) throw "utf42::regex: expected '}'";
+                        if (nMax < nMin) throw "utf42::regex: repetition range out of order";
+                    } else {
+                        break;
+                    }
+                    const bool bGreedy = !accept(U'?');
+                    nNode = add_node({regex_node_kind::repetition, 0, bGreedy, nNode, 1, nMin, nMax});
+                }
+                return nNode;
+            }
+
+            /// @return Node of a group, set, escape or code point.
+            consteval std::size_t parse_atom() {
+                const char32_t nCode = peek();
+                ++nAt;
+                switch (nCode) {
+                    case U'(': {
+                        if (accept(U'?') && !accept(U':')) throw "utf42::regex: unsupported group";
+                        const std::size_t nNode = parse_alternation();
+                        if (!accept(U')')) throw "utf42::regex: missing ')'";
+                        return nNode;
+                    }
+                    case U'[':
+                        return parse_set();
+                    case U'.':
+                        return add_node({regex_node_kind::any, 0, false, 0, 0, 0, 0});
+                    case U'^':
+                        return add_node({regex_node_kind::text_begin, 0, false, 0, 0, 0, 0});
+                    case U'$':
+                        return add_node({regex_node_kind::text_end, 0, false, 0, 0, 0, 0});
+                    case U'\\':
+                        return parse_escape();
+                    case U'*':
+                    case U'+':
+                    case U'?':
+                    case U'{':
+                        throw "utf42::regex: nothing to repeat";
+                    default:
+                        return add_node({regex_node_kind::code_point, nCode, false, 0, 0, 0, 0});
+                }
+            }
+
+            /**
+             * @brief Appends the ranges of `\d`, `\w` or `\s`.
+             * @param nClass Letter of the class, lower case.
+             */
+            consteval void add_class_ranges(const char32_t nClass) {
+                if (nClass == U'd') {
+                    aRanges.push_back({U'0', U'9'});
+                } else if (nClass == U'w') {
+                    aRanges.push_back({U'0', U'9'});
+                    aRanges.push_back({U'A', U'Z'});
+                    aRanges.push_back({U'_', U'_'});
+                    aRanges.push_back({U'a', U'z'});
+                } else {
+                    aRanges.push_back({U'\t', U'\r'});
+                    aRanges.push_back({U' ', U' '});
+                }
+            }
+
+            /**
+             * @brief Reads the code point of a single character escape.
+             * @param nCode Code point after the backslash.
+             * @return The escaped code point.
+             */
+            static consteval char32_t escaped_code_point(const char32_t nCode) {
+                switch (nCode) {
+                    case U'n': return U'\n';
+                    case U'r': return U'\r';
+                    case U't': return U'\t';
+                    case U'f': return U'\f';
+                    case U'v': return U'\v';
+                    case U'0': return U'\0';
+                    default:
+                        if ((nCode >= U'a' && nCode <= U'z') || (nCode >= U'A' && nCode <= U'Z') ||
+                            (nCode >= U'0' && nCode <= U'9')) {
+                            throw "utf42::regex: unsupported escape";
+                        }
+                        return nCode;
+                }
+            }
+
+            /// @return Node of the escape after a backslash.
+            consteval std::size_t parse_escape() {
+                const char32_t nCode = peek();
+                ++nAt;
+                switch (nCode) {
+                    case U'd': case U'w': case U's':
+                    case U'D': case U'W': case U'S': {
+                        const std::size_t nFirst = aRanges.size();
+                        add_class_ranges(nCode | 0x20);
+                        return add_node({regex_node_kind::set, 0, (nCode & 0x20) == 0, nFirst, aRanges.size() - nFirst,
+                                         0, 0});
+                    }
+                    case U'b':
+                        return add_node({regex_node_kind::word_boundary, 0, false, 0, 0, 0, 0});
+                    case U'B':
+                        return add_node({regex_node_kind::not_word_boundary, 0, false, 0, 0, 0, 0});
+                    default:
+                        return add_node({regex_node_kind::code_point, escaped_code_point(nCode), false, 0, 0, 0, 0});
+                }
+            }
+
+            /// @return Node of a `[...]` set, the opening bracket consumed.
+            consteval std::size_t parse_set() {
+                const bool bNegated = accept(U'^');
+                const std::size_t nFirst = aRanges.size();
+                for (bool bFirst = true; bFirst || !accept(U']'); bFirst = false) {
+                    char32_t nLow = peek();
+                    ++nAt;
+                    if (nLow == U'\\') {
+                        const char32_t nEscape = peek();
+                        ++nAt;
+                        if (nEscape == U'd' || nEscape == U'w' || nEscape == U's') {
+                            add_class_ranges(nEscape);
+                            continue;
+                        }
+                        nLow = escaped_code_point(nEscape == U'b' ? U'\b' : nEscape);
+                    }
+                    char32_t nHigh = nLow;
+                    if (!at_end() && sPattern[nAt] == U'-' && nAt + 1 < sPattern.size() && sPattern[nAt + 1] != U']') {
+                        ++nAt;
+                        nHigh = peek();
+                        ++nAt;
+                        if (nHigh == U'\\') {
+                            nHigh = escaped_code_point(peek());
+                            ++nAt;
+                        }
+                        if (nHigh < nLow) throw "utf42::regex: set range out of order";
+                    }
+                    aRanges.push_back({nLow, nHigh});
+                }
+                return add_node({regex_node_kind::set, 0, bNegated, nFirst, aRanges.size() - nFirst, 0, 0});
+            }
+
+            /**
+             * @brief Appends an instruction.
+             * @param eOpcode Operation.
+             * @param nFirst First operand.
+             * @param nSecond Second operand.
+             * @param bNegated Negation of a set.
+             * @return Index of the instruction.
+             */
+            consteval std::size_t emit(const regex_opcode eOpcode, const std::size_t nFirst = 0,
+                                       const std::size_t nSecond = 0, const bool bNegated = false) {
+                aProgram.push_back({
+                    eOpcode, bNegated, static_cast<std::uint32_t>(nFirst), static_cast<std::uint32_t>(nSecond)
+                });
+                return aProgram.size() - 1;
+            }
+
+            /**
+             * @brief Generates the code of a node.
+             * @param nNode Index of the node.
+             */
+            consteval void generate(const std::size_t nNode) {
+                const regex_node oNode = aNodes[nNode];
+                switch (oNode.eKind) {
+                    case regex_node_kind::empty:
+                        break;
+                    case regex_node_kind::code_point:
+                        emit(regex_opcode::code_point, oNode.nCode);
+                        break;
+                    case regex_node_kind::any:
+                        emit(regex_opcode::any);
+                        break;
+                    case regex_node_kind::set:
+                        emit(regex_opcode::set, oNode.nFirst, oNode.nCount, oNode.bFlag);
+                        break;
+                    case regex_node_kind::text_begin:
+                        emit(regex_opcode::text_begin);
+                        break;
+                    case regex_node_kind::text_end:
+                        emit(regex_opcode::text_end);
+                        break;
+                    case regex_node_kind::word_boundary:
+                        emit(regex_opcode::word_boundary);
+                        break;
+                    case regex_node_kind::not_word_boundary:
+                        emit(regex_opcode::not_word_boundary);
+                        break;
+                    case regex_node_kind::concatenation:
+                        for (std::size_t i = 0; i < oNode.nCount; ++i) {
+                            generate(aChildren[oNode.nFirst + i]);
+                        }
+                        break;
+                    case regex_node_kind::alternation: {
+                        std::vector<std::size_t> aJumps;
+                        for (std::size_t i = 0; i + 1 < oNode.nCount; ++i) {
+                            const std::size_t nSplit = emit(regex_opcode::split, aProgram.size() + 1);
+                            generate(aChildren[oNode.nFirst + i]);
+                            aJumps.push_back(emit(regex_opcode::jump));
+                            aProgram[nSplit].nSecond = static_cast<std::uint32_t>(aProgram.size());
+                        }
+                        generate(aChildren[oNode.nFirst + oNode.nCount - 1]);
+                        for (const std::size_t nJump: aJumps) {
+                            aProgram[nJump].nFirst = static_cast<std::uint32_t>(aProgram.size());
+                        }
+                        break;
+                    }
+                    case regex_node_kind::repetition:
+                        generate_repetition(oNode);
+                        break;
+                }
+            }
+
+            /**
+             * @brief Points a split at its body and its exit, in priority order.
+             * @param nSplit Index of the split.
+             * @param nBody Start of the repeated code.
+             * @param nExit Code after the repetition.
+             * @param bGreedy True to prefer the body.
+             */
+            consteval void patch_split(const std::size_t nSplit, const std::size_t nBody, const std::size_t nExit,
+                                       const bool bGreedy) {
+                aProgram[nSplit].nFirst = static_cast<std::uint32_t>(bGreedy ? nBody : nExit);
+                aProgram[nSplit].nSecond = static_cast<std::uint32_t>(bGreedy ? nExit : nBody);
+            }
+
+            /**
+             * @brief Generates the code of a repetition by expanding it.
+             * @param oNode Repetition node.
+             */
+            consteval void generate_repetition(const regex_node &oNode) {
+                for (std::size_t i = 0; i < oNode.nMin; ++i) {
+                    generate(oNode.nFirst);
+                }
+                if (oNode.nMax == regex_unbounded) {
+                    const std::size_t nSplit = emit(regex_opcode::split);
+                    generate(oNode.nFirst);
+                    emit(regex_opcode::jump, nSplit);
+                    patch_split(nSplit, nSplit + 1, aProgram.size(), oNode.bFlag);
+                    return;
+                }
+                // Optional copies are nested: skipping one skips the following ones
+                std::vector<std::size_t> aSplits;
+                for (std::size_t i = oNode.nMin; i < oNode.nMax; ++i) {
+                    aSplits.push_back(emit(regex_opcode::split));
+                    generate(oNode.nFirst);
+                }
+                for (const std::size_t nSplit: aSplits) {
+                    patch_split(nSplit, nSplit + 1, aProgram.size(), oNode.bFlag);
+                }
+            }
+        };
+
+        /**
+         * @brief Sizes of a compiled regex.
+         */
+        struct regex_shape {
+            std::size_t nInstructions; ///< Number of instructions
+            std::size_t nRanges; ///< Number of set ranges
+        };
+
+        /**
+         * @brief Compiled regex program.
+         * @tparam shape Sizes of the tables.
+         */
+        template<regex_shape shape>
+        struct regex_program {
+            std::array<regex_instruction, shape.nInstructions> aInstructions; ///< Instructions
+            std::array<regex_range, shape.nRanges> aRanges; ///< Ranges of the sets
+        };
+    }
+
+    /**
+     * @brief Compile-time regular expression.
+     *
+     * @code
+     * static constexpr utf42::poly_enc oMail = cons_poly_enc("[\\w.]+@\\w+\\.(com|org)");
+     * using mail = utf42::regex<oMail>;
+     * std::optional<utf42::regex_match> oFound = mail::search(std::u16string_view(sText));
+     * @endcode
+     *
+     * Positions and lengths are in code units of the searched text.
+     * Searching returns the leftmost match and, among the matches starting
+     * there, the one preferred by the greedy or lazy quantifiers, as in
+     * ECMAScript. Syntax errors fail to compile.
+     *
+     * @tparam oPattern Pattern literal with static storage duration.
+     */
+    template<const poly_enc &oPattern>
+    class regex {
+    public:
+        /**
+         * @brief Checks whether a whole text matches.
+         * @tparam char_t Character type of the text.
+         * @param sText Text.
+         * @return True if the pattern matches all of `sText`.
+         */
+        template<CharacterType char_t>
+        static constexpr bool match(const basic_string_view<char_t> sText) noexcept {
+            return run(sText, 0, true).has_value();
+        }
+
+        /**
+         * @brief Finds the first match in a text.
+         * @tparam char_t Character type of the text.
+         * @param sText Text.
+         * @param nFrom Offset where the search starts, at a code point boundary.
+         * @return The match, or nothing.
+         */
+        template<CharacterType char_t>
+        static constexpr std::optional<regex_match> search(const basic_string_view<char_t> sText,
+                                                           const std::size_t nFrom = 0) noexcept {
+            if (nFrom > sText.size()) return std::nullopt;
+            return run(sText, nFrom, false);
+        }
+
+        /**
+         * @brief Checks whether a text contains a match.
+         * @tparam char_t Character type of the text.
+         * @param sText Text.
+         * @return True if the pattern matches somewhere in `sText`.
+         */
+        template<CharacterType char_t>
+        static constexpr bool contains(const basic_string_view<char_t> sText) noexcept {
+            return search(sText).has_value();
+        }
+
+        /// @return Number of instructions of the compiled program.
+        static constexpr std::size_t size() noexcept { return shape.nInstructions; }
+
+    private:
+        /**
+         * @brief Measures the program of the pattern.
+         * @return Its sizes.
+         */
+        static consteval detail::regex_shape measure() {
+            const detail::regex_compiler oCompiler(oPattern.visit<char32_t>());
+            return {oCompiler.aProgram.size(), oCompiler.aRanges.size()};
+        }
+
+        /// Sizes of the program
+        static constexpr detail::regex_shape shape = measure();
+
+        /**
+         * @brief Compiles the pattern.
+         * @return The program.
+         */
+        static consteval detail::regex_program<shape> compile() {
+            const detail::regex_compiler oCompiler(oPattern.visit<char32_t>());
+            detail::regex_program<shape> oProgram{};
+            std::copy(oCompiler.aProgram.begin(), oCompiler.aProgram.end(), oProgram.aInstructions.begin());
+            std::copy(oCompiler.aRanges.begin(), oCompiler.aRanges.end(), oProgram.aRanges.begin());
+            return oProgram;
+        }
+
+        /// Compiled program
+        static constexpr detail::regex_program<shape> program = compile();
+
+        /// ASCII code point every match starts with, 0 if none. Lets the search skip ahead with `find`
+        static constexpr char32_t first_code_point =
+                program.aInstructions[0].eOpcode == detail::regex_opcode::code_point &&
+                program.aInstructions[0].nFirst < 0x80 && program.aInstructions[0].nFirst != 0
+                    ? program.aInstructions[0].nFirst
+                    : 0;
+
+        /**
+         * @brief Threads of the virtual machine at one position, in priority order.
+         */
+        struct thread_list {
+            std::array<std::uint32_t, shape.nInstructions> aPcs; ///< Instruction of each thread
+            std::array<std::size_t, shape.nInstructions> aStarts; ///< Start of the match of each thread
+            std::size_t nCount; ///< Number of threads
+        };
+
+        /**
+         * @brief State shared by the steps of one run.
+         */
+        struct machine {
+            std::array<std::size_t, shape.nInstructions> aMarks; ///< Last generation that reached each instruction
+            std::array<std::uint32_t, 2 * shape.nInstructions + 1> aStack; ///< Pending instructions of a closure
+            std::size_t nGeneration; ///< Current generation, one per position
+        };
+
+        /**
+         * @brief Checks whether a code point belongs to a set.
+         * @param oInstruction `set` instruction.
+         * @param nCode Code point.
+         * @return True if the set accepts `nCode`.
+         */
+        static constexpr bool in_set(const detail::regex_instruction &oInstruction, const char32_t nCode) noexcept {
+            bool bFound = false;
+            for (std::size_t i = 0; i < oInstruction.nSecond && !bFound; ++i) {
+                const detail::regex_range &oRange = program.aRanges[oInstruction.nFirst + i];
+                bFound = nCode >= oRange.nLow && nCode <= oRange.nHigh;
+            }
+            return bFound != oInstruction.bNegated;
+        }
+
+        /**
+         * @brief Adds a thread and everything reachable from it without consuming input.
+         *
+         * Follows jumps, splits and assertions depth first, in priority
+         * order, so the list keeps the order a backtracking matcher would
+         * try the alternatives in.
+         *
+         * @param oMachine State of the run.
+         * @param oList List to extend.
+         * @param nPc Instruction of the thread.
+         * @param nStart Start of its match.
+         * @param nPrevious Code point before the position.
+         * @param nNext Code point at the position.
+         */
+        static constexpr void add_thread(machine &oMachine, thread_list &oList, const std::uint32_t nPc,
+                                         const std::size_t nStart, const char32_t nPrevious,
+                                         const char32_t nNext) noexcept {
+            // Most threads land on a consuming instruction, which needs no closure
+            const detail::regex_opcode eOpcode = program.aInstructions[nPc].eOpcode;
+            if (eOpcode == detail::regex_opcode::code_point || eOpcode == detail::regex_opcode::set ||
+                eOpcode == detail::regex_opcode::any) {
+                if (oMachine.aMarks[nPc] == oMachine.nGeneration) return;
+                oMachine.aMarks[nPc] = oMachine.nGeneration;
+                oList.aPcs[oList.nCount] = nPc;
+                oList.aStarts[oList.nCount++] = nStart;
+                return;
+            }
+            std::size_t nDepth = 0;
+            oMachine.aStack[nDepth++] = nPc;
+            while (nDepth != 0) {
+                const std::uint32_t nCurrent = oMachine.aStack[--nDepth];
+                if (oMachine.aMarks[nCurrent] == oMachine.nGeneration) continue;
+                oMachine.aMarks[nCurrent] = oMachine.nGeneration;
+                const detail::regex_instruction &oInstruction = program.aInstructions[nCurrent];
+                bool bPass = false;
+                switch (oInstruction.eOpcode) {
+                    case detail::regex_opcode::jump:
+                        oMachine.aStack[nDepth++] = oInstruction.nFirst;
+                        continue;
+                    case detail::regex_opcode::split:
+                        oMachine.aStack[nDepth++] = oInstruction.nSecond;
+                        oMachine.aStack[nDepth++] = oInstruction.nFirst;
+                        continue;
+                    case detail::regex_opcode::text_begin:
+                        bPass = nPrevious == detail::regex_no_code_point;
+                        break;
+                    case detail::regex_opcode::text_end:
+                        bPass = nNext == detail::regex_no_code_point;
+                        break;
+                    case detail::regex_opcode::word_boundary:
+                        bPass = detail::is_regex_word(nPrevious) != detail::is_regex_word(nNext);
+                        break;
+                    case detail::regex_opcode::not_word_boundary:
+                        bPass = detail::is_regex_word(nPrevious) == detail::is_regex_word(nNext);
+                        break;
+                    default:
+                        oList.aPcs[oList.nCount] = nCurrent;
+                        oList.aStarts[oList.nCount++] = nStart;
+                        continue;
+                }
+                if (bPass) oMachine.aStack[nDepth++] = nCurrent + 1;
+            }
+        }
+
+        /**
+         * @brief Runs the virtual machine.
+         * @tparam char_t Character type of the text.
+         * @param sText Text.
+         * @param nFrom Offset where matches may start.
+         * @param bWhole True to only accept a match of the whole text.
+         * @return The preferred match, or nothing.
+         */
+        template<CharacterType char_t>
+        static constexpr std::optional<regex_match> run(const basic_string_view<char_t> sText, std::size_t nFrom,
+                                                        const bool bWhole) noexcept {
+            const char_t *const pBegin = sText.data();
+            const char_t *const pEnd = pBegin + sText.size();
+            machine oMachine{};
+            std::array<thread_list, 2> aLists{};
+            thread_list *pCurrent = &aLists[0];
+            thread_list *pNext = &aLists[1];
+            std::optional<regex_match> oMatch;
+
+            // \w is ASCII, and a unit below 0x80 is a whole code point in every encoding
+            char32_t nPrevious = detail::regex_no_code_point;
+            if (nFrom != 0) {
+                const std::uint32_t nUnit = detail::to_unit(pBegin[nFrom - 1]);
+                nPrevious = nUnit < 0x80 ? nUnit : replacement_character;
+            }
+            const char_t *pUnit = pBegin + nFrom;
+            const char_t *pAfter = pUnit;
+            char32_t nCode = pUnit == pEnd ? detail::regex_no_code_point : decode(pAfter, pEnd);
+
+            ++oMachine.nGeneration;
+            add_thread(oMachine, *pCurrent, 0, nFrom, nPrevious, nCode);
+            for (;;) {
+                if (pCurrent->nCount == 0) {
+                    // Nothing can match any more, or a match may still start further on
+                    if (bWhole || oMatch.has_value()) break;
+                    if constexpr (first_code_point != 0) {
+                        // Jumps to the next unit that can start a match
+                        const std::size_t nFound = sText.find(static_cast<char_t>(first_code_point),
+                                                              static_cast<std::size_t>(pUnit - pBegin));
+                        if (nFound == sText.npos) break;
+                        pUnit = pBegin + nFound;
+                        pAfter = pUnit + 1;
+                        nCode = first_code_point;
+                        ++oMachine.nGeneration;
+                        add_thread(oMachine, *pCurrent, 0, nFound, detail::regex_no_code_point, nCode);
+                    }
+                }
+
+                const std::size_t nPosition = static_cast<std::size_t>(pUnit - pBegin);
+                const char_t *pLookahead = pAfter;
+                const char32_t nFollowing = pAfter == pEnd ? detail::regex_no_code_point : decode(pLookahead, pEnd);
+                const std::size_t nNextPosition = static_cast<std::size_t>(pAfter - pBegin);
+                ++oMachine.nGeneration;
+                pNext->nCount = 0;
+                for (std::size_t i = 0; i < pCurrent->nCount; ++i) {
+                    const std::uint32_t nPc = pCurrent->aPcs[i];
+                    const detail::regex_instruction &oInstruction = program.aInstructions[nPc];
+                    bool bConsumes = false;
+                    switch (oInstruction.eOpcode) {
+                        case detail::regex_opcode::match:
+                            if (bWhole && pUnit != pEnd) continue;
+                            oMatch = regex_match{pCurrent->aStarts[i], nPosition - pCurrent->aStarts[i]};
+                            // Lower priority threads can not win any more
+                            i = pCurrent->nCount;
+                            continue;
+                        case detail::regex_opcode::code_point:
+                            bConsumes = nCode == oInstruction.nFirst;
+                            break;
+                        case detail::regex_opcode::any:
+                            bConsumes = nCode != detail::regex_no_code_point && nCode != U'\n';
+                            break;
+                        case detail::regex_opcode::set:
+                            bConsumes = nCode != detail::regex_no_code_point && in_set(oInstruction, nCode);
+                            break;
+                        default:
+                            break;
+                    }
+                    if (bConsumes) add_thread(oMachine, *pNext, nPc + 1, pCurrent->aStarts[i], nCode, nFollowing);
+                }
+                if (pUnit == pEnd) break;
+                // A match may start at the next position, with the lowest priority
+                if (!bWhole && !oMatch.has_value() && (first_code_point == 0 || nFollowing == first_code_point)) {
+                    add_thread(oMachine, *pNext, 0, nNextPosition, nCode, nFollowing);
+                }
+                std::swap(pCurrent, pNext);
+                pUnit = pAfter;
+                pAfter = pLookahead;
+                nCode = nFollowing;
+            }
+            return oMatch;
+        }
+    };
+} // namespace utf42
+
+#endif //LIB_UTF_42_REGEX
@@ -0,0 +1,231 @@
+/**
+ * @file utf42_search.h
+ * @brief Substring search with `poly_enc` needles.
+ *
+ * A `poly_enc` carries its literal in every encoding, so searching a text
+ * of any character type only needs to pick, at compile time, the needle
+ * encoded for that type: neither side is transcoded.
+ *
+ * Candidate positions are found 8 bytes at a time: the words at the
+ * candidate start and at the candidate end are compared with the first and
+ * last units of the needle, and only positions where both match are
+ * checked with `memcmp`. This filter rejects most positions even when the
+ * first unit of the needle is frequent in the text.
+ *
+ * @note Requires C++20 or later.
+ *
+ * @copyright MIT License
+ *
+ * This file is part of utf42.
+ * Copyright (c) 2025 Dante Doménech Martínez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef LIB_UTF_42_SEARCH
+#define LIB_UTF_42_SEARCH
+
+#include "utf42.h"
+
+// C++ version requirements
+#if __cplusplus < 202002L
+#error "utf42_search.h requires C++20 or later"
+#endif
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace utf42 {
+    /// Returned by `find` when the needle does not occur
+    constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    namespace detail {
+        /// One bit at the bottom of each lane of a 64-bit word of `char_t` units
+        template<typename char_t>
+        constexpr std::uint64_t lane_low_bits = sizeof(char_t) == 1
+                                                    ? 0x0101010101010101ull
+                                                    : sizeof(char_t) == 2
+                                                          ? 0x0001000100010001ull
+                                                          : 0x0000000100000001ull;
+
+        /// One bit at the top of each lane of a 64-bit word of `char_t` units
+        template<typename char_t>
+        constexpr std::uint64_t lane_high_bits = lane_low_bits<char_t> << (8 * sizeof(char_t) - 1);
+
+        /**
+         * @brief Flags the lanes of a word that may be zero.
+         *
+         * The top bit of every zero lane is set. A lane just above a zero
+         * lane may be flagged too, so flagged lanes are only candidates.
+         *
+         * @tparam char_t Character type, gives the lane width.
+         * @param nWord Word to test.
+         * @return Top bit of each candidate lane.
+         */
+        template<typename char_t>
+        constexpr std::uint64_t zero_lanes(const std::uint64_t nWord) noexcept {
+            return (nWord - lane_low_bits<char_t>) & ~nWord & lane_high_bits<char_t>;
+        }
+
+        /**
+         * @brief Loads 8 bytes of units.
+         * @tparam char_t Character type.
+         * @param pData Pointer to at least `8 / sizeof(char_t)` units.
+         * @return The bytes as a native word.
+         */
+        template<typename char_t>
+        inline std::uint64_t load_word(const char_t *pData) noexcept {
+            std::uint64_t nWord = 0;
+            std::memcpy(&nWord, pData, sizeof(nWord));
+            return nWord;
+        }
+
+        /**
+         * @brief Finds a non empty needle with the first/last unit filter.
+         *
+         * @tparam char_t Character type.
+         * @param sText Text to search.
+         * @param sNeedle Needle, not empty.
+         * @param nFrom Offset where the search starts.
+         * @return Offset of the first occurrence at or after `nFrom`, `npos` if none.
+         */
+        template<typename char_t>
+        inline std::size_t filtered_find(const basic_string_view<char_t> sText, const basic_string_view<char_t> sNeedle,
+                                         std::size_t nFrom) noexcept {
+            using unit_t = std::make_unsigned_t<char_t>;
+            constexpr std::size_t nLanes = 8 / sizeof(char_t);
+            const char_t *const pText = sText.data();
+            const char_t *const pNeedle = sNeedle.data();
+            const std::size_t nLast = sNeedle.size() - 1;
+            const std::size_t nBytes = sNeedle.size() * sizeof(char_t);
+
+            if constexpr (std::endian::native == std::endian::little) {
+                const std::uint64_t nFirstUnits = lane_low_bits<char_t> * static_cast<unit_t>(pNeedle[0]);
+                const std::uint64_t nLastUnits = lane_low_bits<char_t> * static_cast<unit_t>(pNeedle[nLast]);
+                // Blocks of two words; the words at the last unit must lie within the text too
+                for (; nFrom + nLast + 2 * nLanes <= sText.size(); nFrom += 2 * nLanes) {
+                    const std::uint64_t nLow = zero_lanes<char_t>(load_word(pText + nFrom) ^ nFirstUnits) &
+                                               zero_lanes<char_t>(load_word(pText + nFrom + nLast) ^ nLastUnits);
+                    const std::uint64_t nHigh =
+                            zero_lanes<char_t>(load_word(pText + nFrom + nLanes) ^ nFirstUnits) &
+                            zero_lanes<char_t>(load_word(pText + nFrom + nLanes + nLast) ^ nLastUnits);
+                    if ((nLow | nHigh) == 0) continue;
+                    for (std::size_t nHalf = 0; nHalf < 2; ++nHalf) {
+                        for (std::uint64_t nCandidates = nHalf == 0 ? nLow : nHigh; nCandidates != 0;
+                             nCandidates &= nCandidates - 1) {
+                            const std::size_t nAt = nFrom + nHalf * nLanes +
+                                                    static_cast<std::size_t>(std::countr_zero(nCandidates)) /
+                                                    (8 * sizeof(char_t));
+                            if (std::memcmp(pText + nAt, pNeedle, nBytes) == 0) return nAt;
+                        }
+                    }
+                }
+            }
+            for (; nFrom + nLast < sText.size(); ++nFrom) {
+                if (pText[nFrom] == pNeedle[0] && pText[nFrom + nLast] == pNeedle[nLast] &&
+                    std::memcmp(pText + nFrom, pNeedle, nBytes) == 0) {
+                    return nFrom;
+                }
+            }
+            return npos;
+        }
+    }
+
+    /**
+     * @brief Finds a literal in a text of any encoding.
+     *
+     * @code
+     * std::size_t nAt = utf42::find(std::u16string_view(sText), cons_poly_enc("été"));
+     * @endcode
+     *
+     * @tparam char_t Character type of the text, selects the encoding of the needle.
+     * @param sText Text to search.
+     * @param oNeedle Literal to find.
+     * @param nFrom Offset where the search starts.
+     * @return Offset in code units of the first occurrence at or after `nFrom`, `npos` if none.
+     *         An empty needle is found at `nFrom` if `nFrom <= sText.size()`.
+     */
+    template<CharacterType char_t>
+    constexpr std::size_t find(const basic_string_view<char_t> sText, const poly_enc &oNeedle,
+                               const std::size_t nFrom = 0) noexcept {
+        const basic_string_view<char_t> sNeedle = oNeedle.visit<char_t>();
+        if (std::is_constant_evaluated()) return sText.find(sNeedle, nFrom);
+        if (nFrom > sText.size()) return npos;
+        if (sNeedle.empty()) return nFrom;
+        return detail::filtered_find(sText, sNeedle, nFrom);
+    }
+
+    /**
+     * @brief Checks whether a text contains a literal.
+     * @tparam char_t Character type of the text.
+     * @param sText Text to search.
+     * @param oNeedle Literal to find.
+     * @return True if `oNeedle` occurs in `sText`.
+     */
+    template<CharacterType char_t>
+    constexpr bool contains(const basic_string_view<char_t> sText, const poly_enc &oNeedle) noexcept {
+        return utf42::find(sText, oNeedle) != npos;
+    }
+
+    /**
+     * @brief Checks whether a text starts with a literal.
+     * @tparam char_t Character type of the text.
+     * @param sText Text to test.
+     * @param oPrefix Literal.
+     * @return True if `sText` starts with `oPrefix`.
+     */
+    template<CharacterType char_t>
+    constexpr bool starts_with(const basic_string_view<char_t> sText, const poly_enc &oPrefix) noexcept {
+        return sText.starts_with(oPrefix.visit<char_t>());
+    }
+
+    /**
+     * @brief Checks whether a text ends with a literal.
+     * @tparam char_t Character type of the text.
+     * @param sText Text to test.
+     * @param oSuffix Literal.
+     * @return True if `sText` ends with `oSuffix`.
+     */
+    template<CharacterType char_t>
+    constexpr bool ends_with(const basic_string_view<char_t> sText, const poly_enc &oSuffix) noexcept {
+        return sText.ends_with(oSuffix.visit<char_t>());
+    }
+
+    /**
+     * @brief Counts the non overlapping occurrences of a literal.
+     * @tparam char_t Character type of the text.
+     * @param sText Text to search.
+     * @param oNeedle Literal to count.
+     * @return Number of occurrences, 0 for an empty needle.
+     */
+    template<CharacterType char_t>
+    constexpr std::size_t count(const basic_string_view<char_t> sText, const poly_enc &oNeedle) noexcept {
+        const std::size_t nLength = oNeedle.visit<char_t>().size();
+        if (nLength == 0) return 0;
+        std::size_t nCount = 0;
+        for (std::size_t nAt = utf42::find(sText, oNeedle); nAt != npos;
+             nAt = utf42::find(sText, oNeedle, nAt + nLength)) {
+            ++nCount;
+        }
+        return nCount;
+    }
+} // namespace utf42
+
+#endif //LIB_UTF_42_SEARCH
@@ -0,0 +1,293 @@
+/**
+ * @file utf42_string_switch.h
+ * @brief Switch statements on strings of any character type.
+ *
+ * `utf42::string_switch<char_t, N>` maps a runtime
+ * `basic_string_view<char_t>` to the index of the matching case among N
+ * `poly_enc` literals, in constant time whatever N:
+ *
+ * - lengths that no case has are rejected with one bit test;
+ * - the other queries are hashed from a few code units only, at positions
+ *   chosen at compile time so that they tell every case apart, and the
+ *   hash indexes a collision free table ("hash and displace", see
+ *   `utf42_perfect_hash.h`);
+ * - the single candidate is compared with `memcmp`.
+ *
+ * The table is built at compile time for `char_t`, from the literals
+ * encoded for `char_t`, so the query is never transcoded.
+ *
+ * @note Requires C++20 or later.
+ *
+ * @copyright MIT License
+ *
+ * This file is part of utf42.
+ * Copyright (c) 2025 Dante Doménech Martínez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef LIB_UTF_42_STRING_SWITCH
+#define LIB_UTF_42_STRING_SWITCH
+
+#include "utf42.h"
+#include "utf42_perfect_hash.h"
+
+// C++ version requirements
+#if __cplusplus < 202002L
+#error "utf42_string_switch.h requires C++20 or later"
+#endif
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace utf42 {
+    namespace detail {
+        /// Maximum number of code units sampled by the hash of a `string_switch`
+        constexpr std::size_t max_switch_samples = 4;
+
+        /// Sampling positions tried, in order: from the start if positive, from the end if negative
+        constexpr std::int8_t switch_sample_candidates[] = {0, -1, 1, -2, 2, -3, 3, -4};
+
+        /// Marks a `string_switch` that hashes whole cases because no small sample tells them apart
+        constexpr std::size_t switch_full_hash = static_cast<std::size_t>(-1);
+
+        /**
+         * @brief Hashes the length and a few code units of a string.
+         *
+         * @tparam char_t Character type.
+         * @param sText String to hash.
+         * @param pSamples Sampling positions, clamped to the string.
+         * @param nSamples Number of sampling positions.
+         * @return 64-bit hash.
+         */
+        template<typename char_t>
+        constexpr std::uint64_t sample_hash(const basic_string_view<char_t> sText, const std::int8_t *pSamples,
+                                            const std::size_t nSamples) noexcept {
+            using unit_t = std::make_unsigned_t<char_t>;
+            const std::size_t nSize = sText.size();
+            std::uint64_t nHash = 0x9E3779B97F4A7C15ull * (nSize + 1);
+            if (nSize != 0) {
+                for (std::size_t i = 0; i < nSamples; ++i) {
+                    const std::ptrdiff_t nOffset = pSamples[i];
+                    const std::size_t nAt = nOffset >= 0
+                                                ? std::min<std::size_t>(static_cast<std::size_t>(nOffset), nSize - 1)
+                                                : nSize - std::min<std::size_t>(static_cast<std::size_t>(-nOffset),
+                                                                                nSize);
+                    nHash = (nHash ^ static_cast<unit_t>(sText[nAt])) * 0xD6E8FEB86659FD93ull;
+                }
+            }
+            return mix64(nHash);
+        }
+    }
+
+    /**
+     * @brief Constant time dispatch on a string among literal cases.
+     *
+     * @code
+     * static constexpr utf42::poly_enc aMethods[] = {cons_poly_enc("GET"), cons_poly_enc("PUT")};
+     * static constexpr auto oMethods = utf42::make_string_switch<char16_t>(aMethods);
+     *
+     * switch (oMethods(sMethod)) {
+     *     case oMethods.index(cons_poly_enc("GET")): ...
+     *     case oMethods.index(cons_poly_enc("PUT")): ...
+     *     default: ... // oMethods.npos
+     * }
+     * @endcode
+     *
+     * @tparam char_t Character type of the queries.
+     * @tparam N Number of cases.
+     */
+    template<CharacterType char_t, std::size_t N>
+    class string_switch {
+        static_assert(N > 0, "utf42::string_switch: no case");
+
+    public:
+        /// Returned for strings that match no case
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        /**
+         * @brief Builds the table. Fails to compile if two cases are equal.
+         * @param aCases Cases, usually `cons_poly_enc` literals.
+         */
+        consteval explicit string_switch(const poly_enc (&aCases)[N]) : m_aCases{}, m_aPilots{}, m_aSlots{} {
+            for (std::size_t i = 0; i < N; ++i) {
+                m_aCases[i] = aCases[i].template visit<char_t>();
+                m_nLengths |= std::uint64_t(1) << std::min<std::size_t>(m_aCases[i].size(), 63);
+            }
+            choose_samples();
+            std::array<std::uint64_t, N> aHashes{};
+            for (std::size_t i = 0; i < N; ++i) {
+                aHashes[i] = hash(m_aCases[i]);
+            }
+            m_aSlots.fill(empty_slot);
+            const auto fnEqual = [&](const std::size_t nFirst, const std::size_t nSecond) {
+                return m_aCases[nFirst] == m_aCases[nSecond];
+            };
+            switch (detail::place_keys(aHashes, m_aPilots, m_aSlots, empty_slot, fnEqual)) {
+                case detail::placement::placed: break;
+                case detail::placement::duplicate: throw "utf42::string_switch: duplicate case";
+                case detail::placement::collision: throw "utf42::string_switch: hash collision";
+                case detail::placement::no_pilot: throw "utf42::string_switch: no pilot found";
+            }
+        }
+
+        /**
+         * @brief Finds the case equal to a string.
+         * @param sText Query.
+         * @return Index of the matching case in the constructor argument, `npos` if none.
+         */
+        constexpr std::size_t operator()(const basic_string_view<char_t> sText) const noexcept {
+            if (((m_nLengths >> std::min<std::size_t>(sText.size(), 63)) & 1) == 0) return npos;
+            const std::uint64_t nHash = hash(sText);
+            const index_type nIndex =
+                    m_aSlots[detail::pilot_slot(nHash, m_aPilots[nHash >> (64 - bucket_bits)], slot_bits)];
+            if (nIndex == empty_slot) return npos;
+            const basic_string_view<char_t> sCase = m_aCases[nIndex];
+            if (sCase.size() != sText.size()) return npos;
+            if (std::is_constant_evaluated()) return sCase == sText ? nIndex : npos;
+            return std::memcmp(sCase.data(), sText.data(), sText.size() * sizeof(char_t)) == 0 ? nIndex : npos;
+        }
+
+        /**
+         * @brief Index of a case, for `case` labels.
+         * @param oCase One of the cases.
+         * @return Its index in the constructor argument. Fails to compile for other strings.
+         */
+        consteval std::size_t index(const poly_enc &oCase) const {
+            const std::size_t nIndex = (*this)(oCase.visit<char_t>());
+            if (nIndex == npos) throw "utf42::string_switch: not a case";
+            return nIndex;
+        }
+
+        /**
+         * @brief Accesses a case.
+         * @param nIndex Index of the case.
+         * @return The case encoded for `char_t`.
+         */
+        constexpr basic_string_view<char_t> at(const std::size_t nIndex) const noexcept { return m_aCases[nIndex]; }
+
+        /**
+         * @brief Number of code units hashed per query.
+         * @return Number of sampled units, `size_t(-1)` if whole strings are hashed.
+         */
+        constexpr std::size_t samples() const noexcept { return m_nSamples; }
+
+        /// @return Number of cases.
+        static constexpr std::size_t size() noexcept { return N; }
+
+    private:
+        /// Type of the slots, the smallest unsigned type holding every index and the empty marker
+        using index_type = std::conditional_t<(N < 0xFFFF), std::uint16_t, std::uint32_t>;
+
+        /// Marker of an unused slot
+        static constexpr index_type empty_slot = static_cast<index_type>(-1);
+
+        /// Base two logarithm of the number of slots, for a load factor between 0.4 and 0.8
+        static constexpr std::size_t slot_bits = std::bit_width(N + N / 4);
+
+        /// Base two logarithm of the number of buckets, about two cases per bucket
+        static constexpr std::size_t bucket_bits = std::max<std::size_t>(1, std::bit_width(N / 2));
+
+        /// Cases above this count hash whole strings, choosing samples would cost too much at compile time
+        static constexpr std::size_t max_sampled_cases = 512;
+
+        /**
+         * @brief Hashes a case or a query.
+         * @param sText String to hash.
+         * @return 64-bit hash.
+         */
+        constexpr std::uint64_t hash(const basic_string_view<char_t> sText) const noexcept {
+            if (m_nSamples == detail::switch_full_hash) return detail::key_hash(sText);
+            return detail::sample_hash(sText, m_aSamples.data(), m_nSamples);
+        }
+
+        /**
+         * @brief Counts the pairs of cases with the same sample hash.
+         * @param nSamples Number of sampling positions to use.
+         * @return Number of colliding pairs.
+         */
+        consteval std::size_t sample_collisions(const std::size_t nSamples) const {
+            std::array<std::uint64_t, N> aHashes{};
+            for (std::size_t i = 0; i < N; ++i) {
+                aHashes[i] = detail::sample_hash(m_aCases[i], m_aSamples.data(), nSamples);
+            }
+            std::size_t nCollisions = 0;
+            for (std::size_t i = 0; i < N; ++i) {
+                for (std::size_t j = 0; j < i; ++j) {
+                    nCollisions += aHashes[i] == aHashes[j];
+                }
+            }
+            return nCollisions;
+        }
+
+        /**
+         * @brief Greedily picks the sampling positions that separate the most cases.
+         *
+         * Falls back to hashing whole strings when `max_switch_samples`
+         * positions are not enough.
+         */
+        consteval void choose_samples() {
+            m_nSamples = detail::switch_full_hash;
+            if (N > max_sampled_cases) return;
+            std::size_t nCollisions = sample_collisions(0);
+            std::size_t nChosen = 0;
+            while (nCollisions != 0 && nChosen < detail::max_switch_samples) {
+                std::size_t nBest = nCollisions;
+                std::int8_t nBestOffset = 0;
+                for (const std::int8_t nOffset: detail::switch_sample_candidates) {
+                    m_aSamples[nChosen] = nOffset;
+                    const std::size_t nCandidate = sample_collisions(nChosen + 1);
+                    if (nCandidate < nBest) {
+                        nBest = nCandidate;
+                        nBestOffset = nOffset;
+                    }
+                }
+                // No position helps: cases only differ in the middle
+                if (nBest == nCollisions) return;
+                m_aSamples[nChosen++] = nBestOffset;
+                nCollisions = nBest;
+            }
+            if (nCollisions == 0) m_nSamples = nChosen;
+        }
+
+        std::array<basic_string_view<char_t>, N> m_aCases; ///< Cases encoded for `char_t`
+        std::uint64_t m_nLengths = 0; ///< Bit `min(length, 63)` is set for the length of every case
+        std::array<std::int8_t, detail::max_switch_samples> m_aSamples{}; ///< Sampling positions
+        std::size_t m_nSamples = 0; ///< Number of sampling positions, or `switch_full_hash`
+        std::array<std::uint16_t, std::size_t(1) << bucket_bits> m_aPilots; ///< Pilot of each bucket
+        std::array<index_type, std::size_t(1) << slot_bits> m_aSlots; ///< Case index of each slot
+    };
+
+    /**
+     * @brief Builds a `string_switch`, deducing the number of cases.
+     * @tparam char_t Character type of the queries.
+     * @tparam N Number of cases.
+     * @param aCases Cases, usually `cons_poly_enc` literals.
+     * @return The switch.
+     */
+    template<CharacterType char_t, std::size_t N>
+    consteval string_switch<char_t, N> make_string_switch(const poly_enc (&aCases)[N]) {
+        return string_switch<char_t, N>(aCases);
+    }
+} // namespace utf42
+
+#endif //LIB_UTF_42_STRING_SWITCH
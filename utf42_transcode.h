@@ -0,0 +1,706 @@
+/**
+ * @file utf42_transcode.h
+ * @brief Runtime transcoding between the supported character types.
+ *
+ * This header complements the compile-time literal selection of `utf42.h`
+ * with runtime conversion of strings whose content is only known at run time.
+ *
+ * The encoding of each character type is deduced from its size:
+ * - 1 byte (`char`, `char8_t`): UTF-8
+ * - 2 bytes (`char16_t`, `wchar_t` on Windows): UTF-16
+ * - 4 bytes (`char32_t`, `wchar_t` elsewhere): UTF-32
+ *
+ * Ill-formed input never fails: every maximal ill-formed subsequence is
+ * replaced by U+FFFD, as recommended by the Unicode standard.
+ *
+ * Strings shorter than `utf42::small_string_threshold` code units take an
+ * inlined path that converts into a stack buffer in a single pass, without
+ * the length pre-pass and block loop setup of the general kernel.
+ *
+ * @note Requires C++17 or later.
+ *
+ * @copyright MIT License
+ *
+ * This file is part of utf42.
+ * Copyright (c) 2025 Dante Doménech Martínez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef LIB_UTF_42_TRANSCODE
+#define LIB_UTF_42_TRANSCODE
+
+#include "utf42.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// C++ version requirements
+#if __cplusplus < 201703L
+#error "utf42_transcode.h requires C++17 or later"
+#endif
+
+/**
+ * @brief Maximum length (in source code units) handled by the small-string path.
+ *
+ * May be overridden before including this header.
+ */
+#ifndef UTF42_SMALL_STRING_THRESHOLD
+#define UTF42_SMALL_STRING_THRESHOLD 32
+#endif
+
+namespace utf42 {
+    /**
+     * @brief Unicode encoding form of a character type.
+     *
+     * The numeric value of each enumerator is the width of its code unit in bytes.
+     */
+    enum class encoding : unsigned char {
+        utf8 = 1, ///< UTF-8
+        utf16 = 2, ///< UTF-16 (native byte order)
+        utf32 = 4, ///< UTF-32 (native byte order)
+    };
+
+    /**
+     * @brief Type trait yielding the encoding form of a character type.
+     *
+     * @tparam char_t Character type.
+     */
+    template<typename char_t>
+    struct encoding_of : std::integral_constant<encoding, static_cast<encoding>(sizeof(char_t))> {
+        static_assert(is_character<char_t>::value, "char_t must be a character.");
+    };
+
+    /**
+     * @brief Convenience variable template for `encoding_of`.
+     *
+     * @tparam char_t Character type.
+     */
+    template<typename char_t>
+    constexpr encoding encoding_of_v = encoding_of<char_t>::value;
+
+    /// Code point substituted for ill-formed input.
+    constexpr char32_t replacement_character = 0xFFFD;
+
+    /// Source strings up to this many code units take the small-string path.
+    constexpr std::size_t small_string_threshold = UTF42_SMALL_STRING_THRESHOLD;
+
+    /**
+     * @namespace utf42::detail
+     * @brief Implementation details. Not part of the public API.
+     */
+    namespace detail {
+        /// Sentinel returned by `decode_checked` on ill-formed input.
+        constexpr char32_t invalid_code_point = 0xFFFFFFFF;
+
+        /**
+         * @brief Reads a code unit as an unsigned integer.
+         *
+         * @tparam char_t Character type.
+         * @param cUnit Code unit.
+         * @return The code unit value without sign extension.
+         */
+        template<typename char_t>
+        constexpr std::uint32_t to_unit(const char_t cUnit) noexcept {
+            return static_cast<std::uint32_t>(static_cast<typename std::make_unsigned<char_t>::type>(cUnit));
+        }
+
+        /**
+         * @brief Decodes one code point and reports ill-formed input.
+         *
+         * On success `pBegin` is advanced past the code point. On failure it is
+         * advanced past the maximal ill-formed subpart (at least one unit) and
+         * `invalid_code_point` is returned.
+         *
+         * @tparam char_t Character type.
+         * @param pBegin Cursor in the input, must be different from `pEnd`.
+         * @param pEnd End of the input.
+         * @return The decoded code point or `invalid_code_point`.
+         */
+        template<typename char_t>
+        constexpr char32_t decode_checked(const char_t *&pBegin, const char_t *pEnd) noexcept {
+            const std::uint32_t nLead = to_unit(*pBegin++);
+            if constexpr (sizeof(char_t) == 1) {
+                if (nLead < 0x80) return nLead;
+                if (nLead < 0xC2 || nLead > 0xF4) return invalid_code_point;
+                const int nTrail = nLead < 0xE0 ? 1 : nLead < 0xF0 ? 2 : 3;
+                char32_t nCode = nLead & (0x3Fu >> nTrail);
+                // The second byte carries the overlong, surrogate and range checks
+                std::uint32_t nLow = 0x80, nHigh = 0xBF;
+                if (nLead == 0xE0) nLow = 0xA0;
+                else if (nLead == 0xED) nHigh = 0x9F;
+                else if (nLead == 0xF0) nLow = 0x90;
+                else if (nLead == 0xF4) nHigh = 0x8F;
+                for (int i = 0; i < nTrail; ++i) {
+                    if (pBegin == pEnd) return invalid_code_point;
+                    const std::uint32_t nUnit = to_unit(*pBegin);
+                    if (nUnit < nLow || nUnit > nHigh) return invalid_code_point;
+                    nCode = (nCode << 6) | (nUnit & 0x3F);
+                    nLow = 0x80;
+                    nHigh = 0xBF;
+                    ++pBegin;
+                }
+                return nCode;
+            } else if constexpr (sizeof(char_t) == 2) {
+                if (nLead < 0xD800 || nLead > 0xDFFF) return nLead;
+                if (nLead > 0xDBFF || pBegin == pEnd) return invalid_code_point;
+                const std::uint32_t nTrail = to_unit(*pBegin);
+                if (nTrail < 0xDC00 || nTrail > 0xDFFF) return invalid_code_point;
+                ++pBegin;
+                return 0x10000 + ((nLead - 0xD800) << 10) + (nTrail - 0xDC00);
+            } else {
+                if (nLead > 0x10FFFF || (nLead >= 0xD800 && nLead <= 0xDFFF)) return invalid_code_point;
+                return nLead;
+            }
+        }
+
+        /**
+         * @brief Maximum number of output units produced per input unit.
+         *
+         * @tparam to_t Destination character type.
+         * @tparam from_t Source character type.
+         * @return The worst-case expansion factor (ill-formed input included).
+         */
+        template<typename to_t, typename from_t>
+        constexpr std::size_t max_expansion() noexcept {
+            if constexpr (sizeof(to_t) == 1) {
+                return sizeof(from_t) == 4 ? 4 : 3;
+            } else if constexpr (sizeof(to_t) == 2) {
+                return sizeof(from_t) == 4 ? 2 : 1;
+            } else {
+                return 1;
+            }
+        }
+
+        /**
+         * @brief Checks whether a block of 16 bytes only contains ASCII code units.
+         *
+         * @tparam char_t Character type.
+         * @param pData Pointer to at least `16 / sizeof(char_t)` code units.
+         * @return True if every code unit is below U+0080.
+         */
+        template<typename char_t>
+        inline bool is_ascii_block(const char_t *pData) noexcept {
+            constexpr std::uint64_t nMask =
+                    sizeof(char_t) == 1
+                        ? 0x8080808080808080ull
+                        : sizeof(char_t) == 2
+                              ? 0xFF80FF80FF80FF80ull
+                              : 0xFFFFFF80FFFFFF80ull;
+            std::uint64_t nWord1 = 0, nWord2 = 0;
+            std::memcpy(&nWord1, pData, sizeof(nWord1));
+            std::memcpy(&nWord2, reinterpret_cast<const unsigned char *>(pData) + 8, sizeof(nWord2));
+            return ((nWord1 | nWord2) & nMask) == 0;
+        }
+    }
+
+    /**
+     * @brief Decodes one code point.
+     *
+     * Ill-formed input decodes to `replacement_character`.
+     *
+     * @tparam char_t Character type.
+     * @param pBegin Cursor in the input, must be different from `pEnd`. Advanced past the code point.
+     * @param pEnd End of the input.
+     * @return The decoded code point.
+     */
+    template<typename char_t>
+    constexpr char32_t decode(const char_t *&pBegin, const char_t *pEnd) noexcept {
+        const char32_t nCode = detail::decode_checked(pBegin, pEnd);
+        return nCode == detail::invalid_code_point ? replacement_character : nCode;
+    }
+
+    /**
+     * @brief Number of code units needed to encode a code point.
+     *
+     * @tparam char_t Character type.
+     * @param nCode A valid Unicode scalar value.
+     * @return The number of code units.
+     */
+    template<typename char_t>
+    constexpr std::size_t encoded_length(const char32_t nCode) noexcept {
+        if constexpr (sizeof(char_t) == 1) {
+            return nCode < 0x80 ? 1 : nCode < 0x800 ? 2 : nCode < 0x10000 ? 3 : 4;
+        } else if constexpr (sizeof(char_t) == 2) {
+            return nCode < 0x10000 ? 1 : 2;
+        } else {
+            return 1;
+        }
+    }
+
+    /**
+     * @brief Encodes one code point.
+     *
+     * @tparam char_t Character type.
+     * @param nCode A valid Unicode scalar value.
+     * @param pOut Output buffer with room for `encoded_length<char_t>(nCode)` units.
+     * @return The number of code units written.
+     */
+    template<typename char_t>
+    constexpr std::size_t encode(const char32_t nCode, char_t *pOut) noexcept {
+        if constexpr (sizeof(char_t) == 1) {
+            if (nCode < 0x80) {
+                pOut[0] = static_cast<char_t>(nCode);
+                return 1;
+            }
+            if (nCode < 0x800) {
+                pOut[0] = static_cast<char_t>(0xC0 | (nCode >> 6));
+                pOut[1] = static_cast<char_t>(0x80 | (nCode & 0x3F));
+                return 2;
+            }
+            if (nCode < 0x10000) {
+                pOut[0] = static_cast<char_t>(0xE0 | (nCode >> 12));
+                pOut[1] = static_cast<char_t>(0x80 | ((nCode >> 6) & 0x3F));
+                pOut[2] = static_cast<char_t>(0x80 | (nCode & 0x3F));
+                return 3;
+            }
+            pOut[0] = static_cast<char_t>(0xF0 | (nCode >> 18));
+            pOut[1] = static_cast<char_t>(0x80 | ((nCode >> 12) & 0x3F));
+            pOut[2] = static_cast<char_t>(0x80 | ((nCode >> 6) & 0x3F));
+            pOut[3] = static_cast<char_t>(0x80 | (nCode & 0x3F));
+            return 4;
+        } else if constexpr (sizeof(char_t) == 2) {
+            if (nCode < 0x10000) {
+                pOut[0] = static_cast<char_t>(nCode);
+                return 1;
+            }
+            pOut[0] = static_cast<char_t>(0xD800 + ((nCode - 0x10000) >> 10));
+            pOut[1] = static_cast<char_t>(0xDC00 + ((nCode - 0x10000) & 0x3FF));
+            return 2;
+        } else {
+            pOut[0] = static_cast<char_t>(nCode);
+            return 1;
+        }
+    }
+
+    namespace detail {
+        /**
+         * @brief Runtime validation skipping ASCII runs 16 bytes at a time. See `validate`.
+         *
+         * @tparam char_t Character type.
+         * @param sText Text to validate.
+         * @return True if the text contains no ill-formed subsequence.
+         */
+        template<typename char_t>
+        bool generic_validate(const basic_string_view<char_t> sText) noexcept {
+            constexpr std::size_t nBlock = 16 / sizeof(char_t);
+            const char_t *pBegin = sText.data();
+            const char_t *pEnd = pBegin + sText.size();
+            while (pBegin != pEnd) {
+                if (static_cast<std::size_t>(pEnd - pBegin) >= nBlock && is_ascii_block(pBegin)) {
+                    pBegin += nBlock;
+                    continue;
+                }
+                const char_t *pStop = static_cast<std::size_t>(pEnd - pBegin) > nBlock ? pBegin + nBlock : pEnd;
+                while (pBegin < pStop) {
+                    if (decode_checked(pBegin, pEnd) == invalid_code_point) return false;
+                }
+            }
+            return true;
+        }
+    }
+
+    /**
+     * @brief Checks whether a string is well-formed in the encoding of its character type.
+     *
+     * @tparam char_t Character type.
+     * @param sText Text to validate.
+     * @return True if the text contains no ill-formed subsequence.
+     */
+    template<typename char_t>
+    constexpr bool validate(const basic_string_view<char_t> sText) noexcept {
+#if defined(__cpp_lib_is_constant_evaluated)
+        if (!std::is_constant_evaluated()) return detail::generic_validate(sText);
+#endif
+        const char_t *pBegin = sText.data();
+        const char_t *pEnd = pBegin + sText.size();
+        while (pBegin != pEnd) {
+            if (detail::decode_checked(pBegin, pEnd) == detail::invalid_code_point) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Upper bound of the transcoded length, valid for any input.
+     *
+     * @tparam to_t Destination character type.
+     * @tparam from_t Source character type.
+     * @param nSize Length of the input in code units.
+     * @return Maximum length of the output in code units.
+     */
+    template<typename to_t, typename from_t>
+    constexpr std::size_t max_transcoded_length(const std::size_t nSize) noexcept {
+        return nSize * detail::max_expansion<to_t, from_t>();
+    }
+
+    namespace detail {
+        /**
+         * @brief Header-only length pre-pass. See `transcoded_length`.
+         *
+         * @tparam to_t Destination character type.
+         * @tparam from_t Source character type.
+         * @param sText Text to measure.
+         * @return Length of `transcode<to_t>(sText)` in code units.
+         */
+        template<typename to_t, typename from_t>
+        std::size_t generic_transcoded_length(const basic_string_view<from_t> sText) noexcept {
+            constexpr std::size_t nBlock = 16 / sizeof(from_t);
+            const from_t *pBegin = sText.data();
+            const from_t *pEnd = pBegin + sText.size();
+            std::size_t nLength = 0;
+            while (pBegin != pEnd) {
+                if (static_cast<std::size_t>(pEnd - pBegin) >= nBlock && is_ascii_block(pBegin)) {
+                    pBegin += nBlock;
+                    nLength += nBlock;
+                    continue;
+                }
+                // Handle a whole block worth of units before retrying the ASCII check
+                const from_t *pStop = static_cast<std::size_t>(pEnd - pBegin) > nBlock ? pBegin + nBlock : pEnd;
+                while (pBegin < pStop) {
+                    nLength += encoded_length<to_t>(decode(pBegin, pEnd));
+                }
+            }
+            return nLength;
+        }
+
+        /**
+         * @brief Header-only general kernel. See `transcode_into`.
+         *
+         * ASCII runs are detected and widened or narrowed 16 bytes at a time,
+         * everything else goes through `decode` and `encode`.
+         *
+         * @tparam to_t Destination character type.
+         * @tparam from_t Source character type.
+         * @param sText Text to transcode.
+         * @param pOut Output buffer of at least `transcoded_length<to_t>(sText)` units.
+         * @return The number of code units written.
+         */
+        template<typename to_t, typename from_t>
+        std::size_t generic_transcode_into(const basic_string_view<from_t> sText, to_t *pOut) noexcept {
+            constexpr std::size_t nBlock = 16 / sizeof(from_t);
+            const from_t *pBegin = sText.data();
+            const from_t *pEnd = pBegin + sText.size();
+            to_t *pCursor = pOut;
+            while (pBegin != pEnd) {
+                if (static_cast<std::size_t>(pEnd - pBegin) >= nBlock && is_ascii_block(pBegin)) {
+                    for (std::size_t i = 0; i < nBlock; ++i) {
+                        pCursor[i] = static_cast<to_t>(pBegin[i]);
+                    }
+                    pBegin += nBlock;
+                    pCursor += nBlock;
+                    continue;
+                }
+                // Handle a whole block worth of units before retrying the ASCII check
+                const from_t *pStop = static_cast<std::size_t>(pEnd - pBegin) > nBlock ? pBegin + nBlock : pEnd;
+                while (pBegin < pStop) {
+                    pCursor += encode(decode(pBegin, pEnd), pCursor);
+                }
+            }
+            return static_cast<std::size_t>(pCursor - pOut);
+        }
+    }
+
+/**
+ * @brief Expands `M(to_t, from_t)` for every supported pair of character types.
+ */
+#if __cplusplus >= 202002L
+#define UTF42_KERNEL_ROW(M, to_t) M(to_t, char) M(to_t, wchar_t) M(to_t, char8_t) M(to_t, char16_t) M(to_t, char32_t)
+#define UTF42_FOR_EACH_KERNEL(M) \
+    UTF42_KERNEL_ROW(M, char) UTF42_KERNEL_ROW(M, wchar_t) UTF42_KERNEL_ROW(M, char8_t) \
+    UTF42_KERNEL_ROW(M, char16_t) UTF42_KERNEL_ROW(M, char32_t)
+#else
+#define UTF42_KERNEL_ROW(M, to_t) M(to_t, char) M(to_t, wchar_t) M(to_t, char16_t) M(to_t, char32_t)
+#define UTF42_FOR_EACH_KERNEL(M) \
+    UTF42_KERNEL_ROW(M, char) UTF42_KERNEL_ROW(M, wchar_t) \
+    UTF42_KERNEL_ROW(M, char16_t) UTF42_KERNEL_ROW(M, char32_t)
+#endif
+
+#if defined(UTF42_DISPATCH)
+    /**
+     * @namespace utf42::kernels
+     * @brief Kernels compiled in the `utf42::dispatch` library.
+     *
+     * Only declared when `UTF42_DISPATCH` is defined, which linking the
+     * `utf42::dispatch` CMake target does automatically. On x86-64 ELF
+     * platforms each kernel is built for several instruction sets and the
+     * best one is bound once by the dynamic loader (GNU IFUNC), so calls are
+     * plain calls without any per call CPU check.
+     */
+    namespace kernels {
+        /**
+         * @brief Tag selecting the destination character type of `transcoded_length`.
+         *
+         * @tparam char_t Destination character type.
+         */
+        template<typename char_t>
+        struct unit_tag {
+        };
+
+#define UTF42_KERNEL_DECLARE(to_t, from_t) \
+        std::size_t transcoded_length(const from_t *pData, std::size_t nSize, unit_tag<to_t>) noexcept; \
+        std::size_t transcode_into(const from_t *pData, std::size_t nSize, to_t *pOut) noexcept;
+
+        UTF42_FOR_EACH_KERNEL(UTF42_KERNEL_DECLARE)
+
+#undef UTF42_KERNEL_DECLARE
+    }
+#endif
+
+// The kernel list is only kept for utf42_dispatch.cpp, which defines the kernels
+#if !defined(UTF42_DISPATCH_KERNELS)
+#undef UTF42_FOR_EACH_KERNEL
+#undef UTF42_KERNEL_ROW
+#endif
+
+    /**
+     * @brief Exact length of the transcoded text (length pre-pass).
+     *
+     * Uses the compiled kernels when `UTF42_DISPATCH` is defined and the
+     * header-only implementation otherwise.
+     *
+     * @tparam to_t Destination character type.
+     * @tparam from_t Source character type.
+     * @param sText Text to measure.
+     * @return Length of `transcode<to_t>(sText)` in code units.
+     */
+    template<typename to_t, typename from_t>
+    inline std::size_t transcoded_length(const basic_string_view<from_t> sText) noexcept {
+#if defined(UTF42_DISPATCH)
+        return kernels::transcoded_length(sText.data(), sText.size(), kernels::unit_tag<to_t>());
+#else
+        return detail::generic_transcoded_length<to_t>(sText);
+#endif
+    }
+
+    /**
+     * @brief Transcodes a string into a caller-provided buffer.
+     *
+     * Uses the compiled kernels when `UTF42_DISPATCH` is defined and the
+     * header-only implementation otherwise.
+     *
+     * @tparam to_t Destination character type.
+     * @tparam from_t Source character type.
+     * @param sText Text to transcode.
+     * @param pOut Output buffer of at least `transcoded_length<to_t>(sText)` units.
+     * @return The number of code units written.
+     */
+    template<typename to_t, typename from_t>
+    inline std::size_t transcode_into(const basic_string_view<from_t> sText, to_t *pOut) noexcept {
+#if defined(UTF42_DISPATCH)
+        return kernels::transcode_into(sText.data(), sText.size(), pOut);
+#else
+        return detail::generic_transcode_into(sText, pOut);
+#endif
+    }
+
+    namespace detail {
+        /**
+         * @brief Single pass transcoding of a short string into a stack buffer.
+         *
+         * The loop has a single well predicted branch per ASCII unit and no
+         * block setup, which beats the general kernel on short keys and tags.
+         *
+         * @tparam to_t Destination character type.
+         * @tparam from_t Source character type.
+         * @param sText Text of at most `small_string_threshold` code units.
+         * @return The transcoded string.
+         */
+        template<typename to_t, typename from_t>
+        inline std::basic_string<to_t> transcode_small(const basic_string_view<from_t> sText) {
+            to_t aBuffer[max_transcoded_length<to_t, from_t>(small_string_threshold)];
+            const from_t *pBegin = sText.data();
+            const from_t *pEnd = pBegin + sText.size();
+            to_t *pCursor = aBuffer;
+            while (pBegin != pEnd) {
+                const std::uint32_t nUnit = to_unit(*pBegin);
+                if (nUnit < 0x80) {
+                    *pCursor++ = static_cast<to_t>(nUnit);
+                    ++pBegin;
+                } else {
+                    pCursor += encode(decode(pBegin, pEnd), pCursor);
+                }
+            }
+            return std::basic_string<to_t>(aBuffer, static_cast<std::size_t>(pCursor - aBuffer));
+        }
+
+        /**
+         * @brief Two pass transcoding using the general kernel.
+         *
+         * @tparam to_t Destination character type.
+         * @tparam from_t Source character type.
+         * @param sText Text to transcode.
+         * @return The transcoded string.
+         */
+        template<typename to_t, typename from_t>
+        std::basic_string<to_t> transcode_large(const basic_string_view<from_t> sText) {
+            std::basic_string<to_t> sResult(transcoded_length<to_t>(sText), to_t());
+            transcode_into(sText, sResult.data());
+            return sResult;
+        }
+    }
+
+    /**
+     * @brief Transcodes a string to another character type.
+     *
+     * Inputs up to `small_string_threshold` code units take the inlined
+     * single pass path, longer inputs take the general kernel.
+     *
+     * @tparam to_t Destination character type.
+     * @tparam from_t Source character type.
+     * @param sText Text to transcode.
+     * @return The transcoded string.
+     */
+#if __cplusplus >= 202002L
+    template<CharacterType to_t, CharacterType from_t>
+#else
+    template<typename to_t, typename from_t>
+#endif
+    inline std::basic_string<to_t> transcode(const basic_string_view<from_t> sText) {
+        if (sText.size() <= small_string_threshold) {
+            return detail::transcode_small<to_t>(sText);
+        }
+        return detail::transcode_large<to_t>(sText);
+    }
+
+    /**
+     * @brief Length of the incomplete code point at the end of a text.
+     *
+     * Cutting a text before this suffix never splits a code point, and
+     * transcoding the two parts separately gives the same result as
+     * transcoding the whole text, even when it is ill-formed.
+     *
+     * @tparam char_t Character type.
+     * @param sText Text to inspect.
+     * @return Number of trailing code units (0 to 3) of an unfinished code point.
+     */
+    template<typename char_t>
+    constexpr std::size_t incomplete_suffix(const basic_string_view<char_t> sText) noexcept {
+        const std::size_t nSize = sText.size();
+        if constexpr (sizeof(char_t) == 1) {
+            for (std::size_t k = 1; k <= 3 && k <= nSize; ++k) {
+                const std::uint32_t nUnit = detail::to_unit(sText[nSize - k]);
+                if ((nUnit & 0xC0) == 0x80) continue;
+                if (nUnit < 0xC2 || nUnit > 0xF4) return 0;
+                const std::size_t nLength = nUnit < 0xE0 ? 2 : nUnit < 0xF0 ? 3 : 4;
+                return nLength > k ? k : 0;
+            }
+            return 0;
+        } else if constexpr (sizeof(char_t) == 2) {
+            return nSize != 0 && (detail::to_unit(sText[nSize - 1]) & 0xFC00) == 0xD800 ? 1 : 0;
+        } else {
+            return 0;
+        }
+    }
+
+    /**
+     * @brief Incremental transcoder for text that arrives in chunks.
+     *
+     * An unfinished code point at the end of a chunk is kept in the state and
+     * completed by the next chunk, so chunks may be cut anywhere. The output of
+     * all chunks followed by `finish` equals `transcode` of the whole text.
+     *
+     * @tparam to_t Destination character type.
+     * @tparam from_t Source character type.
+     */
+    template<typename to_t, typename from_t>
+    class stream_transcoder {
+    public:
+        /// Maximum number of code units kept between chunks.
+        static constexpr std::size_t max_pending = 3;
+
+        /**
+         * @brief Output capacity required to transcode a chunk.
+         *
+         * @param nSize Length of the chunk in code units.
+         * @return Maximum number of code units written by `transcode`.
+         */
+        static constexpr std::size_t max_output(const std::size_t nSize) noexcept {
+            return max_transcoded_length<to_t, from_t>(nSize + max_pending);
+        }
+
+        /**
+         * @brief Transcodes one chunk.
+         *
+         * @param sChunk Next chunk of the input.
+         * @param pOut Output buffer of at least `max_output(sChunk.size())` units.
+         * @return The number of code units written.
+         */
+        std::size_t transcode(const basic_string_view<from_t> sChunk, to_t *pOut) noexcept {
+            to_t *pCursor = pOut;
+            std::size_t nConsumed = 0;
+            if (m_nPending != 0) {
+                // Complete the pending code point with the head of the chunk
+                from_t aJoin[max_pending + 4] = {};
+                const std::size_t nHead = sChunk.size() < 4 ? sChunk.size() : 4;
+                std::memcpy(aJoin, m_aPending, m_nPending * sizeof(from_t));
+                std::memcpy(aJoin + m_nPending, sChunk.data(), nHead * sizeof(from_t));
+                const std::size_t nJoin = m_nPending + nHead;
+                if (nHead < 4) {
+                    // The whole chunk fits in the join buffer
+                    const std::size_t nKeep = incomplete_suffix(basic_string_view<from_t>(aJoin, nJoin));
+                    pCursor += detail::generic_transcode_into(basic_string_view<from_t>(aJoin, nJoin - nKeep), pCursor);
+                    std::memcpy(m_aPending, aJoin + nJoin - nKeep, nKeep * sizeof(from_t));
+                    m_nPending = nKeep;
+                    return static_cast<std::size_t>(pCursor - pOut);
+                }
+                const from_t *pBegin = aJoin;
+                const from_t *pEnd = aJoin + nJoin;
+                while (pBegin < aJoin + m_nPending) {
+                    pCursor += encode(decode(pBegin, pEnd), pCursor);
+                }
+                nConsumed = static_cast<std::size_t>(pBegin - aJoin) - m_nPending;
+                m_nPending = 0;
+            }
+            const std::size_t nKeep = incomplete_suffix(sChunk);
+            pCursor += transcode_into(
+                basic_string_view<from_t>(sChunk.data() + nConsumed, sChunk.size() - nConsumed - nKeep), pCursor);
+            std::memcpy(m_aPending, sChunk.data() + sChunk.size() - nKeep, nKeep * sizeof(from_t));
+            m_nPending = nKeep;
+            return static_cast<std::size_t>(pCursor - pOut);
+        }
+
+        /**
+         * @brief Flushes the state at the end of the input.
+         *
+         * An unfinished code point is ill-formed and produces U+FFFD.
+         *
+         * @param pOut Output buffer of at least `max_output(0)` units.
+         * @return The number of code units written.
+         */
+        std::size_t finish(to_t *pOut) noexcept {
+            const std::size_t nWritten =
+                    detail::generic_transcode_into(basic_string_view<from_t>(m_aPending, m_nPending), pOut);
+            m_nPending = 0;
+            return nWritten;
+        }
+
+        /**
+         * @brief Number of code units kept from the previous chunk.
+         *
+         * @return Pending code units.
+         */
+        std::size_t pending() const noexcept { return m_nPending; }
+
+    private:
+        from_t m_aPending[max_pending] = {}; ///< Unfinished code point
+        std::size_t m_nPending = 0; ///< Number of pending code units
+    };
+} // namespace utf42
+
+#endif //LIB_UTF_42_TRANSCODE
@@ -0,0 +1,450 @@
+/**
+ * @file utf42_valid.h
+ * @brief Views over text known to be well-formed, and their unchecked kernels.
+ *
+ * The runtime algorithms of utf42 accept arbitrary input, so every code
+ * point they decode is range checked and ill-formed sequences become
+ * U+FFFD. Literals of a `poly_enc` are written by the compiler and text
+ * that was validated once does not change, so these checks are wasted on
+ * them.
+ *
+ * `utf42::valid_view` is a string view that can only be obtained from
+ * text proven well-formed: from a literal checked at compile time with
+ * `visit_valid`, from a runtime check with `validated`, or by an explicit
+ * `valid_view::assume`. The transcoding, searching and counting overloads
+ * taking a `valid_view` compute lengths from the lead units alone, copy
+ * between encodings of the same width and decode UTF-8 without any check.
+ *
+ * @note Requires C++20 or later.
+ *
+ * @copyright MIT License
+ *
+ * This file is part of utf42.
+ * Copyright (c) 2025 Dante Doménech Martínez
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef LIB_UTF_42_VALID
+#define LIB_UTF_42_VALID
+
+#include "utf42.h"
+#include "utf42_transcode.h"
+#include "utf42_search.h"
+
+// C++ version requirements
+#if __cplusplus < 202002L
+#error "utf42_valid.h requires C++20 or later"
+#endif
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+
+/**
+ * @brief Selects the encoded literal matching `char_t` as a `utf42::valid_view`.
+ *
+ * Like `make_poly_enc`, but compilation fails if the literal is ill-formed
+ * in any encoding, for instance because of a lone surrogate.
+ *
+ * @param char_t Desired character type.
+ * @param lit A string literal.
+ *
+ * @return A `utf42::valid_view<char_t>` referring to the selected literal.
+ */
+#define make_valid_enc(char_t, lit) utf42::visit_valid<char_t>(cons_poly_enc(lit))
+
+namespace utf42 {
+    /**
+     * @brief String view over text that is well-formed in the encoding of `char_t`.
+     *
+     * Only `visit_valid`, `validated` and `assume` create non empty views,
+     * so holding one is a proof that the text decodes without errors.
+     *
+     * @code
+     * constexpr utf42::valid_view<char16_t> sName = make_valid_enc(char16_t, "Zoë");
+     * std::string sUtf8 = utf42::transcode<char>(sName); // Unchecked kernel
+     * @endcode
+     *
+     * @tparam char_t Character type.
+     */
+    template<CharacterType char_t>
+    class valid_view {
+    public:
+        using value_type = char_t; ///< Code unit type
+        using const_iterator = const char_t *; ///< Iterator over the code units
+
+        /// Empty view
+        constexpr valid_view() noexcept = default;
+
+        /**
+         * @brief Trusts a view without checking it.
+         *
+         * @param sText Text the caller knows to be well-formed. Passing
+         *              ill-formed text to the unchecked kernels is undefined behavior.
+         * @return The view.
+         */
+        static constexpr valid_view assume(const basic_string_view<char_t> sText) noexcept {
+            return valid_view(sText);
+        }
+
+        /**
+         * @brief Underlying string view.
+         * @return The viewed text.
+         */
+        constexpr basic_string_view<char_t> view() const noexcept { return m_sText; }
+
+        /**
+         * @brief Converts to the underlying string view.
+         * @return The viewed text.
+         */
+        constexpr operator basic_string_view<char_t>() const noexcept { return m_sText; }
+
+        /**
+         * @brief Pointer to the first code unit.
+         * @return The data pointer.
+         */
+        constexpr const char_t *data() const noexcept { return m_sText.data(); }
+
+        /**
+         * @brief Length in code units.
+         * @return The number of code units.
+         */
+        constexpr std::size_t size() const noexcept { return m_sText.size(); }
+
+        /**
+         * @brief Checks whether the view is empty.
+         * @return True if the view has no code units.
+         */
+        constexpr bool empty() const noexcept { return m_sText.empty(); }
+
+        /**
+         * @brief Iterator to the first code unit.
+         * @return The begin iterator.
+         */
+        constexpr const_iterator begin() const noexcept { return m_sText.data(); }
+
+        /**
+         * @brief Iterator past the last code unit.
+         * @return The end iterator.
+         */
+        constexpr const_iterator end() const noexcept { return m_sText.data() + m_sText.size(); }
+
+    private:
+        /**
+         * @brief Wraps a well-formed view.
+         * @param sText Well-formed text.
+         */
+        explicit constexpr valid_view(const basic_string_view<char_t> sText) noexcept : m_sText(sText) {
+        }
+
+        basic_string_view<char_t> m_sText; ///< Viewed text
+    };
+
+    /**
+     * @brief Checks every encoding of a polymorphic literal.
+     *
+     * Narrow and wide literals may hold arbitrary code units through escape
+     * sequences (`"\xFF"`, `u"\xD800"`), so a literal is not well-formed by
+     * construction.
+     *
+     * @param oPolyEnc Polymorphic literal.
+     * @return True if none of its encodings contains an ill-formed subsequence.
+     */
+    constexpr bool validate(const poly_enc &oPolyEnc) noexcept {
+        return validate(oPolyEnc.TXT_CHAR) && validate(oPolyEnc.TXT_CHAR_W) && validate(oPolyEnc.TXT_CHAR_8) &&
+               validate(oPolyEnc.TXT_CHAR_16) && validate(oPolyEnc.TXT_CHAR_32);
+    }
+
+    /**
+     * @brief Selects the encoded literal matching `char_t` as a `valid_view`.
+     *
+     * Compilation fails if the selected literal is ill-formed.
+     *
+     * @tparam char_t Desired character type.
+     * @param oPolyEnc Polymorphic literal.
+     * @return A view of the literal encoded for `char_t`.
+     */
+    template<CharacterType char_t>
+    consteval valid_view<char_t> visit_valid(const poly_enc &oPolyEnc) {
+        const basic_string_view<char_t> sText = oPolyEnc.visit<char_t>();
+        if (!validate(sText)) throw "utf42::visit_valid: ill-formed literal (lone surrogate or invalid code unit)";
+        return valid_view<char_t>::assume(sText);
+    }
+
+    /**
+     * @brief Validates a text once, for use with the unchecked kernels.
+     *
+     * @tparam char_t Character type.
+     * @param sText Text to validate.
+     * @return The text as a `valid_view`, or no value if it is ill-formed.
+     */
+    template<CharacterType char_t>
+    constexpr std::optional<valid_view<char_t> > validated(const basic_string_view<char_t> sText) noexcept {
+        if (!validate(sText)) return std::nullopt;
+        return valid_view<char_t>::assume(sText);
+    }
+
+    namespace detail {
+        /**
+         * @brief Decodes one code point of well-formed text.
+         *
+         * @tparam char_t Character type.
+         * @param pBegin Cursor at the start of a code point. Advanced past it.
+         * @return The decoded code point.
+         */
+        template<typename char_t>
+        constexpr char32_t decode_unchecked(const char_t *&pBegin) noexcept {
+            const std::uint32_t nLead = to_unit(*pBegin++);
+            if constexpr (sizeof(char_t) == 1) {
+                if (nLead < 0x80) return nLead;
+                if (nLead < 0xE0) return ((nLead & 0x1F) << 6) | (to_unit(*pBegin++) & 0x3F);
+                if (nLead < 0xF0) {
+                    const std::uint32_t nCode = ((nLead & 0x0F) << 12) | ((to_unit(pBegin[0]) & 0x3F) << 6) |
+                                                (to_unit(pBegin[1]) & 0x3F);
+                    pBegin += 2;
+                    return nCode;
+                }
+                const std::uint32_t nCode = ((nLead & 0x07) << 18) | ((to_unit(pBegin[0]) & 0x3F) << 12) |
+                                            ((to_unit(pBegin[1]) & 0x3F) << 6) | (to_unit(pBegin[2]) & 0x3F);
+                pBegin += 3;
+                return nCode;
+            } else if constexpr (sizeof(char_t) == 2) {
+                if ((nLead & 0xFC00) != 0xD800) return nLead;
+                return 0x10000 + ((nLead - 0xD800) << 10) + (to_unit(*pBegin++) - 0xDC00);
+            } else {
+                return nLead;
+            }
+        }
+
+        /**
+         * @brief Counts the bytes of a word that satisfy a per byte bit test.
+         *
+         * @param nFlags Word whose byte top bits flag the counted bytes.
+         * @return Number of flagged bytes.
+         */
+        inline std::size_t count_flagged_bytes(const std::uint64_t nFlags) noexcept {
+            return static_cast<std::size_t>(std::popcount(nFlags & 0x8080808080808080ull));
+        }
+
+        /**
+         * @brief Length pre-pass for well-formed text, computed from the lead units.
+         *
+         * UTF-8 sources are measured 8 bytes at a time: every byte that is not a
+         * continuation byte starts a code point, and every byte from 0xF0 up
+         * starts a code point outside the BMP.
+         *
+         * @tparam to_t Destination character type.
+         * @tparam from_t Source character type.
+         * @param sText Well-formed text to measure.
+         * @return Length of the transcoded text in code units.
+         */
+        template<typename to_t, typename from_t>
+        constexpr std::size_t unchecked_transcoded_length(const basic_string_view<from_t> sText) noexcept {
+            const std::size_t nSize = sText.size();
+            if constexpr (sizeof(to_t) == sizeof(from_t)) {
+                return nSize;
+            } else if constexpr (sizeof(from_t) == 1) {
+                std::size_t nStarts = 0, nSupplementary = 0, i = 0;
+                if (!std::is_constant_evaluated()) {
+                    for (; i + 8 <= nSize; i += 8) {
+                        std::uint64_t nWord = 0;
+                        std::memcpy(&nWord, sText.data() + i, sizeof(nWord));
+                        // 10xxxxxx is a continuation byte, 1111xxxx leads four bytes
+                        nStarts += 8 - count_flagged_bytes(nWord & ~(nWord << 1));
+                        nSupplementary += count_flagged_bytes(nWord & (nWord << 1) & (nWord << 2) & (nWord << 3));
+                    }
+                }
+                for (; i < nSize; ++i) {
+                    const std::uint32_t nUnit = to_unit(sText[i]);
+                    nStarts += (nUnit & 0xC0) != 0x80;
+                    nSupplementary += nUnit >= 0xF0;
+                }
+                return sizeof(to_t) == 2 ? nStarts + nSupplementary : nStarts;
+            } else if constexpr (sizeof(from_t) == 2) {
+                std::size_t nLength = 0;
+                for (std::size_t i = 0; i < nSize; ++i) {
+                    const std::uint32_t nUnit = to_unit(sText[i]);
+                    if constexpr (sizeof(to_t) == 1) {
+                        // Each half of a surrogate pair accounts for 2 of its 4 bytes
+                        nLength += 1 + (nUnit >= 0x80) + ((nUnit >= 0x800) & ((nUnit & 0xF800) != 0xD800));
+                    } else {
+                        nLength += (nUnit & 0xFC00) != 0xDC00;
+                    }
+                }
+                return nLength;
+            } else {
+                std::size_t nLength = 0;
+                // Branch free, so that the loop vectorizes
+                for (std::size_t i = 0; i < nSize; ++i) {
+                    const std::uint32_t nCode = to_unit(sText[i]);
+                    nLength += sizeof(to_t) == 1 ? 1 + (nCode >= 0x80) + (nCode >= 0x800) + (nCode >= 0x10000)
+                                                 : 1 + (nCode >= 0x10000);
+                }
+                return nLength;
+            }
+        }
+
+        /**
+         * @brief Transcoding kernel for well-formed text.
+         *
+         * Same structure as `generic_transcode_into`, with `decode_unchecked`
+         * in place of `decode`.
+         *
+         * @tparam to_t Destination character type.
+         * @tparam from_t Source character type.
+         * @param sText Well-formed text to transcode.
+         * @param pOut Output buffer of at least `unchecked_transcoded_length<to_t>(sText)` units.
+         * @return The number of code units written.
+         */
+        template<typename to_t, typename from_t>
+        std::size_t unchecked_transcode_into(const basic_string_view<from_t> sText, to_t *pOut) noexcept {
+            constexpr std::size_t nBlock = 16 / sizeof(from_t);
+            const from_t *pBegin = sText.data();
+            const from_t *pEnd = pBegin + sText.size();
+            to_t *pCursor = pOut;
+            while (pBegin != pEnd) {
+                if (static_cast<std::size_t>(pEnd - pBegin) >= nBlock && is_ascii_block(pBegin)) {
+                    for (std::size_t i = 0; i < nBlock; ++i) {
+                        pCursor[i] = static_cast<to_t>(pBegin[i]);
+                    }
+                    pBegin += nBlock;
+                    pCursor += nBlock;
+                    continue;
+                }
+                // Code points never cross the end, so the stop may be overshot
+                const from_t *pStop = static_cast<std::size_t>(pEnd - pBegin) > nBlock ? pBegin + nBlock : pEnd;
+                while (pBegin < pStop) {
+                    pCursor += encode(decode_unchecked(pBegin), pCursor);
+                }
+            }
+            return static_cast<std::size_t>(pCursor - pOut);
+        }
+    }
+
+    /**
+     * @brief Exact transcoded length of well-formed text.
+     *
+     * @tparam to_t Destination character type.
+     * @tparam from_t Source character type.
+     * @param sText Text to measure.
+     * @return Length of `transcode<to_t>(sText)` in code units.
+     */
+    template<CharacterType to_t, CharacterType from_t>
+    constexpr std::size_t transcoded_length(const valid_view<from_t> sText) noexcept {
+        return detail::unchecked_transcoded_length<to_t>(sText.view());
+    }
+
+    /**
+     * @brief Transcodes well-formed text into a caller provided buffer.
+     *
+     * @tparam to_t Destination character type.
+     * @tparam from_t Source character type.
+     * @param sText Text to transcode.
+     * @param pOut Output buffer of at least `transcoded_length<to_t>(sText)` units.
+     * @return The number of code units written.
+     */
+    template<CharacterType to_t, CharacterType from_t>
+    inline std::size_t transcode_into(const valid_view<from_t> sText, to_t *pOut) noexcept {
+        if constexpr (sizeof(to_t) == sizeof(from_t)) {
+            if (!sText.empty()) std::memcpy(pOut, sText.data(), sText.size() * sizeof(to_t));
+            return sText.size();
+        } else if constexpr (sizeof(from_t) == 1) {
+            return detail::unchecked_transcode_into(sText.view(), pOut);
+        } else {
+            // The checks of UTF-16 and UTF-32 decoding cost next to nothing, keep the compiled kernels
+            return utf42::transcode_into(sText.view(), pOut);
+        }
+    }
+
+    /**
+     * @brief Transcodes well-formed text to another character type.
+     *
+     * The exact length is known from the lead units, so a single allocation
+     * of the right size is made whatever the length of the input.
+     *
+     * @tparam to_t Destination character type.
+     * @tparam from_t Source character type.
+     * @param sText Text to transcode.
+     * @return The transcoded string.
+     */
+    template<CharacterType to_t, CharacterType from_t>
+    inline std::basic_string<to_t> transcode(const valid_view<from_t> sText) {
+        std::basic_string<to_t> sResult(utf42::transcoded_length<to_t>(sText), to_t());
+        utf42::transcode_into(sText, sResult.data());
+        return sResult;
+    }
+
+    /**
+     * @brief Number of code points in well-formed text.
+     *
+     * @tparam char_t Character type.
+     * @param sText Text to measure.
+     * @return The number of code points.
+     */
+    template<CharacterType char_t>
+    constexpr std::size_t count_code_points(const valid_view<char_t> sText) noexcept {
+        return detail::unchecked_transcoded_length<char32_t>(sText.view());
+    }
+
+    /**
+     * @brief Finds a literal in well-formed text.
+     *
+     * Both sides being well-formed, a match never starts or ends inside a
+     * code point, so the offset can be used to split `sText` into valid views.
+     *
+     * @tparam char_t Character type of the text.
+     * @param sText Text to search.
+     * @param oNeedle Literal to find.
+     * @param nFrom Offset where the search starts.
+     * @return Offset in code units of the first occurrence at or after `nFrom`, `npos` if none.
+     */
+    template<CharacterType char_t>
+    constexpr std::size_t find(const valid_view<char_t> sText, const poly_enc &oNeedle,
+                               const std::size_t nFrom = 0) noexcept {
+        return utf42::find(sText.view(), oNeedle, nFrom);
+    }
+
+    /**
+     * @brief Checks whether well-formed text contains a literal.
+     * @tparam char_t Character type of the text.
+     * @param sText Text to search.
+     * @param oNeedle Literal to find.
+     * @return True if `oNeedle` occurs in `sText`.
+     */
+    template<CharacterType char_t>
+    constexpr bool contains(const valid_view<char_t> sText, const poly_enc &oNeedle) noexcept {
+        return utf42::find(sText.view(), oNeedle) != npos;
+    }
+
+    /**
+     * @brief Counts the non overlapping occurrences of a literal in well-formed text.
+     * @tparam char_t Character type of the text.
+     * @param sText Text to search.
+     * @param oNeedle Literal to count.
+     * @return Number of occurrences, 0 for an empty needle.
+     */
+    template<CharacterType char_t>
+    constexpr std::size_t count(const valid_view<char_t> sText, const poly_enc &oNeedle) noexcept {
+        return utf42::count(sText.view(), oNeedle);
+    }
+} // namespace utf42
+
+#endif //LIB_UTF_42_VALID